@@ -28,6 +28,7 @@
 #include "SWGAMDemodReport.h"
 
 #include "dsp/downchannelizer.h"
+#include "dsp/filerecord.h"
 #include "audio/audiooutput.h"
 #include "dsp/dspengine.h"
 #include "dsp/threadedbasebandsamplesink.h"
@@ -39,6 +40,7 @@
 
 MESSAGE_CLASS_DEFINITION(AMDemod::MsgConfigureAMDemod, Message)
 MESSAGE_CLASS_DEFINITION(AMDemod::MsgConfigureChannelizer, Message)
+MESSAGE_CLASS_DEFINITION(AMDemod::MsgFileRecord, Message)
 
 const QString AMDemod::m_channelIdURI = "sdrangel.channel.amdemod";
 const QString AMDemod::m_channelId = "AMDemod";
@@ -147,6 +149,8 @@ void AMDemod::feed(const SampleVector::const_iterator& begin, const SampleVector
 	}
 
 	m_settingsMutex.unlock();
+
+	m_channelizer->setRecordTrigger(m_squelchOpen); // channel recordings can be triggered by the squelch
 }
 
 void AMDemod::processOneSample(Complex &ci)
@@ -318,6 +322,17 @@ bool AMDemod::handleMessage(const Message& cmd)
 
         return true;
 	}
+    else if (MsgFileRecord::match(cmd))
+    {
+        MsgFileRecord& conf = (MsgFileRecord&) cmd;
+        qDebug() << "AMDemod::handleMessage: MsgFileRecord: " << conf.getStartStop();
+
+        // the channel samples are recorded by the channelizer at its output rate
+        m_channelizer->record(m_channelizer->getInputMessageQueue(), conf.getStartStop() ?
+            FileRecord::genUniqueFileName(m_deviceAPI->getDeviceUID(), getIndexInDeviceSet()) : QString());
+
+        return true;
+    }
 	else if (MsgConfigureAMDemod::match(cmd))
 	{
         MsgConfigureAMDemod& cfg = (MsgConfigureAMDemod&) cmd;
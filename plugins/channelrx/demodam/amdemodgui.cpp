@@ -192,6 +192,18 @@ void AMDemodGUI::on_audioMute_toggled(bool checked)
 	applySettings();
 }
 
+void AMDemodGUI::on_record_toggled(bool checked)
+{
+    if (checked) {
+        ui->record->setStyleSheet("QToolButton { background-color : red; }");
+    } else {
+        ui->record->setStyleSheet("QToolButton { background:rgb(79,79,79); }");
+    }
+
+    AMDemod::MsgFileRecord* message = AMDemod::MsgFileRecord::create(checked);
+    m_amDemod->getInputMessageQueue()->push(message);
+}
+
 void AMDemodGUI::onWidgetRolled(QWidget* widget __attribute__((unused)), bool rollDown __attribute__((unused)))
 {
 	/*
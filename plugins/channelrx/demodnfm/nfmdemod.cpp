@@ -26,6 +26,7 @@
 #include "SWGNFMDemodReport.h"
 
 #include "dsp/downchannelizer.h"
+#include "dsp/filerecord.h"
 #include "util/stepfunctions.h"
 #include "util/db.h"
 #include "audio/audiooutput.h"
@@ -38,6 +39,7 @@
 
 MESSAGE_CLASS_DEFINITION(NFMDemod::MsgConfigureNFMDemod, Message)
 MESSAGE_CLASS_DEFINITION(NFMDemod::MsgConfigureChannelizer, Message)
+MESSAGE_CLASS_DEFINITION(NFMDemod::MsgFileRecord, Message)
 MESSAGE_CLASS_DEFINITION(NFMDemod::MsgReportCTCSSFreq, Message)
 
 const QString NFMDemod::m_channelIdURI = "sdrangel.channel.nfmdemod";
@@ -329,6 +331,8 @@ void NFMDemod::feed(const SampleVector::const_iterator& begin, const SampleVecto
 	}
 
 	m_settingsMutex.unlock();
+
+	m_channelizer->setRecordTrigger(m_squelchOpen); // channel recordings can be triggered by the squelch
 }
 
 void NFMDemod::start()
@@ -372,6 +376,17 @@ bool NFMDemod::handleMessage(const Message& cmd)
 
         return true;
     }
+    else if (MsgFileRecord::match(cmd))
+    {
+        MsgFileRecord& conf = (MsgFileRecord&) cmd;
+        qDebug() << "NFMDemod::handleMessage: MsgFileRecord: " << conf.getStartStop();
+
+        // the channel samples are recorded by the channelizer at its output rate
+        m_channelizer->record(m_channelizer->getInputMessageQueue(), conf.getStartStop() ?
+            FileRecord::genUniqueFileName(m_deviceAPI->getDeviceUID(), getIndexInDeviceSet()) : QString());
+
+        return true;
+    }
 	else if (MsgConfigureNFMDemod::match(cmd))
 	{
 	    MsgConfigureNFMDemod& cfg = (MsgConfigureNFMDemod&) cmd;
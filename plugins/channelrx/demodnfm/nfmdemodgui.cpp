@@ -206,6 +206,18 @@ void NFMDemodGUI::on_audioMute_toggled(bool checked)
 	applySettings();
 }
 
+void NFMDemodGUI::on_record_toggled(bool checked)
+{
+    if (checked) {
+        ui->record->setStyleSheet("QToolButton { background-color : red; }");
+    } else {
+        ui->record->setStyleSheet("QToolButton { background:rgb(79,79,79); }");
+    }
+
+    NFMDemod::MsgFileRecord* message = NFMDemod::MsgFileRecord::create(checked);
+    m_nfmDemod->getInputMessageQueue()->push(message);
+}
+
 void NFMDemodGUI::on_ctcss_currentIndexChanged(int index)
 {
 	m_settings.m_ctcssIndex = index;
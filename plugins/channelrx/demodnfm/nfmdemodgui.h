@@ -77,6 +77,7 @@ private slots:
 	void on_ctcss_currentIndexChanged(int index);
 	void on_ctcssOn_toggled(bool checked);
 	void on_audioMute_toggled(bool checked);
+	void on_record_toggled(bool checked);
 	void onWidgetRolled(QWidget* widget, bool rollDown);
 	void onMenuDialogCalled(const QPoint& p);
     void handleInputMessages();
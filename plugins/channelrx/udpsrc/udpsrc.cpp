@@ -15,9 +15,15 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
+
 #include <QUdpSocket>
 #include <QHostAddress>
 
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "SWGChannelSettings.h"
 #include "SWGUDPSrcSettings.h"
 #include "SWGChannelReport.h"
@@ -62,9 +68,9 @@ UDPSrc::UDPSrc(DeviceSourceAPI *deviceAPI) :
 {
 	setObjectName(m_channelId);
 
-	m_udpBuffer16 = new UDPSink<Sample16>(this, udpBlockSize, m_settings.m_udpPort);
-	m_udpBufferMono16 = new UDPSink<int16_t>(this, udpBlockSize, m_settings.m_udpPort);
-    m_udpBuffer24 = new UDPSink<Sample24>(this, udpBlockSize, m_settings.m_udpPort);
+	m_udpBuffer16 = new UDPSink<Sample16>(udpBlockSize, m_settings.m_udpPort);
+	m_udpBufferMono16 = new UDPSink<int16_t>(udpBlockSize, m_settings.m_udpPort);
+    m_udpBuffer24 = new UDPSink<Sample24>(udpBlockSize, m_settings.m_udpPort);
 	m_audioSocket = new QUdpSocket(this);
 	m_udpAudioBuf = new char[m_udpAudioPayloadSize];
 
@@ -310,6 +316,8 @@ void UDPSrc::feed(const SampleVector::const_iterator& begin, const SampleVector:
 		}
 	}
 
+	udpFlush();
+
 	//qDebug() << "UDPSrc::feed: " << m_sampleBuffer.size() * 4;
 
 	if((m_spectrum != 0) && (m_spectrumEnabled))
@@ -320,6 +328,113 @@ void UDPSrc::feed(const SampleVector::const_iterator& begin, const SampleVector:
 	m_settingsMutex.unlock();
 }
 
+void UDPSrc::udpFlush()
+{
+    if (m_udpIQBuffer.size() > 0)
+    {
+        int nbSamples = m_udpIQBuffer.size();
+
+        if (m_settings.m_sampleFormat == UDPSrcSettings::FormatIQ24)
+        {
+            m_udpIQ24.resize(nbSamples);
+            convertIQ24(&m_udpIQBuffer[0], &m_udpIQ24[0], nbSamples);
+            m_udpBuffer24->write(&m_udpIQ24[0], nbSamples);
+        }
+        else
+        {
+            m_udpIQ16.resize(nbSamples);
+            convertIQ16(&m_udpIQBuffer[0], &m_udpIQ16[0], nbSamples);
+            m_udpBuffer16->write(&m_udpIQ16[0], nbSamples);
+        }
+
+        m_udpIQBuffer.clear();
+    }
+
+    if (m_udpMonoBuffer.size() > 0)
+    {
+        int nbSamples = m_udpMonoBuffer.size();
+        m_udpMono16.resize(nbSamples);
+        convertMono16(&m_udpMonoBuffer[0], &m_udpMono16[0], nbSamples);
+        m_udpBufferMono16->write(&m_udpMono16[0], nbSamples);
+        m_udpMonoBuffer.clear();
+    }
+
+    m_udpBuffer16->sendQueued();
+    m_udpBufferMono16->sendQueued();
+    m_udpBuffer24->sendQueued();
+}
+
+void UDPSrc::convertIQ16(const Sample *samples, Sample16 *out, int nbSamples)
+{
+#if SDR_RX_SAMP_SZ == 16
+    memcpy((void *) out, samples, nbSamples*sizeof(Sample16));
+#else
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128i *in128 = (const __m128i *) samples;
+    __m128i *out128 = (__m128i *) out;
+
+    for (; i + 4 <= nbSamples; i += 4) // 4 samples of 2x32 bits to 4 samples of 2x16 bits
+    {
+        __m128i lo = _mm_srai_epi32(_mm_loadu_si128(in128++), 8);
+        __m128i hi = _mm_srai_epi32(_mm_loadu_si128(in128++), 8);
+        _mm_storeu_si128(out128++, _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < nbSamples; i++) {
+        // saturate like _mm_packs_epi32
+        out[i] = Sample16(qBound(-32768, samples[i].m_real>>8, 32767), qBound(-32768, samples[i].m_imag>>8, 32767));
+    }
+#endif
+}
+
+void UDPSrc::convertIQ24(const Sample *samples, Sample24 *out, int nbSamples)
+{
+#if SDR_RX_SAMP_SZ == 24
+    memcpy((void *) out, samples, nbSamples*sizeof(Sample24));
+#else
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128i *in128 = (const __m128i *) samples;
+    __m128i *out128 = (__m128i *) out;
+
+    for (; i + 4 <= nbSamples; i += 4) // 4 samples of 2x16 bits to 4 samples of 2x32 bits
+    {
+        __m128i in = _mm_loadu_si128(in128++);
+        // 16 bit values in the upper half then arithmetic shift gives the sign extended value << 8
+        _mm_storeu_si128(out128++, _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), in), 8));
+        _mm_storeu_si128(out128++, _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), in), 8));
+    }
+#endif
+    for (; i < nbSamples; i++) {
+        out[i] = Sample24(samples[i].m_real<<8, samples[i].m_imag<<8);
+    }
+#endif
+}
+
+void UDPSrc::convertMono16(const FixReal *samples, int16_t *out, int nbSamples)
+{
+#if SDR_RX_SAMP_SZ == 16
+    memcpy(out, samples, nbSamples*sizeof(int16_t));
+#else
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128i *in128 = (const __m128i *) samples;
+    __m128i *out128 = (__m128i *) out;
+
+    for (; i + 8 <= nbSamples; i += 8)
+    {
+        __m128i lo = _mm_srai_epi32(_mm_loadu_si128(in128++), 8);
+        __m128i hi = _mm_srai_epi32(_mm_loadu_si128(in128++), 8);
+        _mm_storeu_si128(out128++, _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < nbSamples; i++) {
+        out[i] = qBound(-32768, samples[i]>>8, 32767); // saturate like _mm_packs_epi32
+    }
+#endif
+}
+
 void UDPSrc::start()
 {
 	m_phaseDiscri.reset();
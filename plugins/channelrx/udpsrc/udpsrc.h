@@ -200,6 +200,11 @@ protected:
 	UDPSink<Sample16> *m_udpBuffer16;
 	UDPSink<int16_t> *m_udpBufferMono16;
     UDPSink<Sample24> *m_udpBuffer24;
+    SampleVector m_udpIQBuffer;            //!< I/Q output samples of the current feed
+    std::vector<FixReal> m_udpMonoBuffer;  //!< mono output samples of the current feed
+    std::vector<Sample16> m_udpIQ16;
+    std::vector<Sample24> m_udpIQ24;
+    std::vector<int16_t> m_udpMono16;
 
 	AudioVector m_audioBuffer;
 	uint m_audioBufferFill;
@@ -235,6 +240,11 @@ protected:
     void webapiFormatChannelSettings(SWGSDRangel::SWGChannelSettings& response, const UDPSrcSettings& settings);
     void webapiFormatChannelReport(SWGSDRangel::SWGChannelReport& response);
 
+    void udpFlush(); //!< format the output samples of the feed in blocks and send them
+    static void convertIQ16(const Sample *samples, Sample16 *out, int nbSamples);
+    static void convertIQ24(const Sample *samples, Sample24 *out, int nbSamples);
+    static void convertMono16(const FixReal *samples, int16_t *out, int nbSamples);
+
     inline void calculateSquelch(double value)
     {
         if ((!m_settings.m_squelchEnabled) || (value > m_squelch))
@@ -295,38 +305,12 @@ protected:
 
     void udpWrite(FixReal real, FixReal imag)
     {
-        if (SDR_RX_SAMP_SZ == 16)
-        {
-            if (m_settings.m_sampleFormat == UDPSrcSettings::FormatIQ16) {
-                m_udpBuffer16->write(Sample16(real, imag));
-            } else if (m_settings.m_sampleFormat == UDPSrcSettings::FormatIQ24) {
-                m_udpBuffer24->write(Sample24(real<<8, imag<<8));
-            } else {
-                m_udpBuffer16->write(Sample16(real, imag));
-            }
-        }
-        else if (SDR_RX_SAMP_SZ == 24)
-        {
-            if (m_settings.m_sampleFormat == UDPSrcSettings::FormatIQ16) {
-                m_udpBuffer16->write(Sample16(real>>8, imag>>8));
-            } else if (m_settings.m_sampleFormat == UDPSrcSettings::FormatIQ24) {
-                m_udpBuffer24->write(Sample24(real, imag));
-            } else {
-                m_udpBuffer16->write(Sample16(real>>8, imag>>8));
-            }
-        }
+        m_udpIQBuffer.push_back(Sample(real, imag));
     }
 
     void udpWriteMono(FixReal sample)
     {
-        if (SDR_RX_SAMP_SZ == 16)
-        {
-            m_udpBufferMono16->write(sample);
-        }
-        else if (SDR_RX_SAMP_SZ == 24)
-        {
-            m_udpBufferMono16->write(sample>>8);
-        }
+        m_udpMonoBuffer.push_back(sample);
     }
 
     void udpWriteNorm(Real real, Real imag)
@@ -205,6 +205,7 @@ void FileSinkGui::displaySettings()
 {
     ui->centerFrequency->setValue(m_settings.m_centerFrequency / 1000);
     ui->sampleRate->setValue(m_settings.m_sampleRate);
+    ui->freeRun->setChecked(m_settings.m_freeRun);
 }
 
 void FileSinkGui::sendSettings()
@@ -275,6 +276,12 @@ void FileSinkGui::on_interp_currentIndexChanged(int index)
     sendSettings();
 }
 
+void FileSinkGui::on_freeRun_toggled(bool checked)
+{
+    m_settings.m_freeRun = checked;
+    sendSettings();
+}
+
 void FileSinkGui::on_startStop_toggled(bool checked)
 {
     if (m_doApplySettings)
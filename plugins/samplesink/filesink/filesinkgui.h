@@ -89,6 +89,7 @@ private slots:
 	void on_startStop_toggled(bool checked);
 	void on_showFileDialog_clicked(bool checked);
 	void on_interp_currentIndexChanged(int index);
+	void on_freeRun_toggled(bool checked);
     void updateHardware();
     void updateStatus();
 	void tick();
@@ -42,6 +42,7 @@ MESSAGE_CLASS_DEFINITION(FileSinkOutput::MsgReportFileSinkStreamTiming, Message)
 FileSinkOutput::FileSinkOutput(DeviceSinkAPI *deviceAPI) :
     m_deviceAPI(deviceAPI),
 	m_settings(),
+	m_fileWriter(2, 1<<22), // double buffering
 	m_fileSinkThread(0),
 	m_deviceDescription("FileSink"),
 	m_fileName("./test.sdriq"),
@@ -62,18 +63,18 @@ void FileSinkOutput::destroy()
 
 void FileSinkOutput::openFileStream()
 {
-	if (m_ofstream.is_open()) {
-		m_ofstream.close();
-	}
+	// the samples are written from the file writer thread and the producer waits for a free buffer rather than dropping samples
+	m_fileWriter.setBlocking(true);
 
-	m_ofstream.open(m_fileName.toStdString().c_str(), std::ios::binary);
+	if (!m_fileWriter.open(m_fileName, false)) {
+		return;
+	}
 
 	int actualSampleRate = m_settings.m_sampleRate * (1<<m_settings.m_log2Interp);
-	m_ofstream.write((const char *) &actualSampleRate, sizeof(int));
-    //m_ofstream.write((const char *) &m_settings.m_sampleRate, sizeof(int));
-	m_ofstream.write((const char *) &m_settings.m_centerFrequency, sizeof(quint64));
+	m_fileWriter.write((const char *) &actualSampleRate, sizeof(int));
+	m_fileWriter.write((const char *) &m_settings.m_centerFrequency, sizeof(quint64));
     m_startingTimeStamp = time(0);
-    m_ofstream.write((const char *) &m_startingTimeStamp, sizeof(std::time_t));
+    m_fileWriter.write((const char *) &m_startingTimeStamp, sizeof(std::time_t));
 
 	qDebug() << "FileSinkOutput::openFileStream: " << m_fileName.toStdString().c_str();
 }
@@ -90,9 +91,10 @@ bool FileSinkOutput::start()
 
 	openFileStream();
 
-	m_fileSinkThread = new FileSinkThread(&m_ofstream, &m_sampleSourceFifo);
+	m_fileSinkThread = new FileSinkThread(&m_fileWriter, &m_sampleSourceFifo);
 	m_fileSinkThread->setSamplerate(m_settings.m_sampleRate);
 	m_fileSinkThread->setLog2Interpolation(m_settings.m_log2Interp);
+	m_fileSinkThread->setFreeRun(m_settings.m_freeRun);
 	m_fileSinkThread->connectTimer(m_masterTimer);
 	m_fileSinkThread->startWork();
 
@@ -121,9 +123,7 @@ void FileSinkOutput::stop()
 		m_fileSinkThread = 0;
 	}
 
-    if (m_ofstream.is_open()) {
-        m_ofstream.close();
-    }
+    m_fileWriter.close();
 
     if (getMessageQueueToGUI())
     {
@@ -301,6 +301,16 @@ void FileSinkOutput::applySettings(const FileSinkSettings& settings, bool force)
         forwardChange = true;
     }
 
+    if (force || (m_settings.m_freeRun != settings.m_freeRun))
+    {
+        m_settings.m_freeRun = settings.m_freeRun;
+
+        if (m_fileSinkThread != 0)
+        {
+            m_fileSinkThread->setFreeRun(m_settings.m_freeRun);
+        }
+    }
+
     if (forwardChange)
     {
         qDebug("FileSinkOutput::applySettings: forward: m_centerFrequency: %llu m_sampleRate: %llu m_log2Interp: %d",
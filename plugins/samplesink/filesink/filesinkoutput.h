@@ -20,10 +20,9 @@
 #include <QString>
 #include <QTimer>
 #include <ctime>
-#include <iostream>
-#include <fstream>
 
 #include "dsp/devicesamplesink.h"
+#include "dsp/filerecordwriter.h"
 #include "filesinksettings.h"
 
 class FileSinkThread;
@@ -203,7 +202,7 @@ private:
     DeviceSinkAPI *m_deviceAPI;
 	QMutex m_mutex;
 	FileSinkSettings m_settings;
-	std::ofstream m_ofstream;
+	FileRecordWriter m_fileWriter;
 	FileSinkThread* m_fileSinkThread;
 	QString m_deviceDescription;
 	QString m_fileName;
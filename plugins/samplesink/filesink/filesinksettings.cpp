@@ -27,6 +27,7 @@ void FileSinkSettings::resetToDefaults()
     m_centerFrequency = 435000*1000;
     m_sampleRate = 48000;
     m_log2Interp = 0;
+    m_freeRun = false;
 }
 
 QByteArray FileSinkSettings::serialize() const
@@ -35,6 +36,7 @@ QByteArray FileSinkSettings::serialize() const
 
     s.writeU64(1, m_sampleRate);
     s.writeU32(2, m_log2Interp);
+    s.writeBool(3, m_freeRun);
 
     return s.final();
 }
@@ -53,6 +55,7 @@ bool FileSinkSettings::deserialize(const QByteArray& data)
     {
         d.readU64(1, &m_sampleRate, 48000);
         d.readU32(2, &m_log2Interp, 0);
+        d.readBool(3, &m_freeRun, false);
         return true;
     }
     else
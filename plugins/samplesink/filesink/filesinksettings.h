@@ -23,6 +23,7 @@ struct FileSinkSettings {
     quint64 m_centerFrequency;
     quint64 m_sampleRate;
     quint32 m_log2Interp;
+    bool    m_freeRun; //!< write as fast as the samples are produced instead of the sample rate pace
 
     FileSinkSettings();
     void resetToDefaults();
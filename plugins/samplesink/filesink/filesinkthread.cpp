@@ -21,16 +21,19 @@
 #include <QDebug>
 
 #include "dsp/samplesourcefifo.h"
+#include "dsp/filerecordwriter.h"
 #include "filesinkthread.h"
 
-FileSinkThread::FileSinkThread(std::ofstream *samplesStream, SampleSourceFifo* sampleFifo, QObject* parent) :
+FileSinkThread::FileSinkThread(FileRecordWriter *fileWriter, SampleSourceFifo* sampleFifo, QObject* parent) :
 	QThread(parent),
 	m_running(false),
-	m_ofstream(samplesStream),
+	m_freeRun(false),
+	m_fileWriter(fileWriter),
 	m_bufsize(0),
 	m_samplesChunkSize(0),
 	m_sampleFifo(sampleFifo),
 	m_samplesCount(0),
+    m_initialSamples(0),
     m_samplerate(0),
     m_log2Interpolation(0),
     m_throttlems(FILESINK_THROTTLE_MS),
@@ -38,7 +41,7 @@ FileSinkThread::FileSinkThread(std::ofstream *samplesStream, SampleSourceFifo* s
     m_throttleToggle(false),
     m_buf(0)
 {
-    assert(m_ofstream != 0);
+    assert(m_fileWriter != 0);
 }
 
 FileSinkThread::~FileSinkThread()
@@ -54,7 +57,7 @@ void FileSinkThread::startWork()
 {
 	qDebug() << "FileSinkThread::startWork: ";
 
-    if (m_ofstream->is_open())
+    if (m_fileWriter->isOpen())
     {
         qDebug() << "FileSinkThread::startWork: file stream open, starting...";
         m_maxThrottlems = 0;
@@ -97,6 +100,7 @@ void FileSinkThread::setSamplerate(int samplerate)
 		// resize sample FIFO
 		if (m_sampleFifo) {
 		    m_sampleFifo->resize(samplerate); // 1s buffer
+		    m_initialSamples = m_sampleFifo->size() / 2;
 		}
 
         // resize output buffer
@@ -145,14 +149,29 @@ void FileSinkThread::setLog2Interpolation(int log2Interpolation)
     }
 }
 
+void FileSinkThread::setFreeRun(bool freeRun)
+{
+    m_freeRun = freeRun;
+    qDebug("FileSinkThread::setFreeRun: %s", freeRun ? "on" : "off");
+}
+
 void FileSinkThread::run()
 {
 	m_running = true;
 	m_startWaiter.wakeAll();
 
-	while(m_running) // actual work is in the tick() function
+	while(m_running)
 	{
-		sleep(1);
+		if (m_freeRun)
+		{
+			if (!writeFreeRun()) {
+				usleep(1000); // wait for the DSP to fill the FIFO
+			}
+		}
+		else // actual work is in the tick() function
+		{
+			msleep(FILESINK_THROTTLE_MS);
+		}
 	}
 
 	m_running = false;
@@ -183,46 +202,75 @@ void FileSinkThread::tick()
 //            m_maxThrottlems = m_throttlems;
 //        }
 
-        SampleVector::iterator readUntil;
+        if (m_freeRun) { // samples are pulled by the thread loop
+            return;
+        }
 
-        m_sampleFifo->readAdvance(readUntil, m_samplesChunkSize);
-        SampleVector::iterator beginRead = readUntil - m_samplesChunkSize;
-        m_samplesCount += m_samplesChunkSize;
+        writeChunk(m_samplesChunkSize);
+	}
+}
 
-        if (m_log2Interpolation == 0)
-        {
-            m_ofstream->write(reinterpret_cast<char*>(&(*beginRead)), m_samplesChunkSize*sizeof(Sample));
-        }
-        else
+bool FileSinkThread::writeFreeRun()
+{
+    unsigned int chunkSamples = (m_samplerate * FILESINK_THROTTLE_MS) / 1000;
+    chunkSamples = chunkSamples == 0 ? 1 : chunkSamples;
+
+    // back pressure: only read samples that the DSP has already written in the FIFO
+    if (m_sampleFifo->getWriteLead() < chunkSamples) {
+        return false;
+    }
+
+    writeChunk(chunkSamples);
+    return true;
+}
+
+void FileSinkThread::writeChunk(unsigned int nbSamples)
+{
+    SampleVector::iterator readUntil;
+
+    m_sampleFifo->readAdvance(readUntil, nbSamples);
+    SampleVector::iterator beginRead = readUntil - nbSamples;
+
+    // the FIFO starts with half of its size of silence before the first samples from the DSP
+    unsigned int skip = std::min(m_initialSamples, nbSamples);
+    m_initialSamples -= skip;
+    skip = m_freeRun ? skip : 0;
+    m_samplesCount += nbSamples - skip;
+
+    // the file writer copies the samples to its buffers and the disk is written from its own thread
+    if (m_log2Interpolation == 0)
+    {
+        m_fileWriter->write(reinterpret_cast<char*>(&(*(beginRead + skip))), (nbSamples - skip)*sizeof(Sample));
+    }
+    else
+    {
+        int chunkSize = std::min((int) nbSamples, m_samplerate);
+
+        switch (m_log2Interpolation)
         {
-            int chunkSize = std::min((int) m_samplesChunkSize, m_samplerate);
-
-            switch (m_log2Interpolation)
-            {
-            case 1:
-                m_interpolators.interpolate2_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
-                break;
-            case 2:
-                m_interpolators.interpolate4_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
-                break;
-            case 3:
-                m_interpolators.interpolate8_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
-                break;
-            case 4:
-                m_interpolators.interpolate16_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
-                break;
-            case 5:
-                m_interpolators.interpolate32_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
-                break;
-            case 6:
-                m_interpolators.interpolate64_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
-                break;
-            default:
-                break;
-            }
-
-            m_ofstream->write(reinterpret_cast<char*>(m_buf), m_samplesChunkSize*(1<<m_log2Interpolation)*2*sizeof(int16_t));
+        case 1:
+            m_interpolators.interpolate2_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
+            break;
+        case 2:
+            m_interpolators.interpolate4_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
+            break;
+        case 3:
+            m_interpolators.interpolate8_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
+            break;
+        case 4:
+            m_interpolators.interpolate16_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
+            break;
+        case 5:
+            m_interpolators.interpolate32_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
+            break;
+        case 6:
+            m_interpolators.interpolate64_cen(&beginRead, m_buf, chunkSize*(1<<m_log2Interpolation)*2);
+            break;
+        default:
+            break;
         }
 
-	}
+        m_fileWriter->write(reinterpret_cast<char*>(m_buf + skip*(1<<m_log2Interpolation)*2),
+                (nbSamples - skip)*(1<<m_log2Interpolation)*2*sizeof(int16_t));
+    }
 }
@@ -22,8 +22,6 @@
 #include <QWaitCondition>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <iostream>
-#include <fstream>
 #include <cstdlib>
 #include <stdint.h>
 
@@ -33,18 +31,20 @@
 #define FILESINK_THROTTLE_MS 50
 
 class SampleSourceFifo;
+class FileRecordWriter;
 
 class FileSinkThread : public QThread {
 	Q_OBJECT
 
 public:
-	FileSinkThread(std::ofstream *samplesStream, SampleSourceFifo* sampleFifo, QObject* parent = 0);
+	FileSinkThread(FileRecordWriter *fileWriter, SampleSourceFifo* sampleFifo, QObject* parent = 0);
 	~FileSinkThread();
 
 	void startWork();
 	void stopWork();
 	void setSamplerate(int samplerate);
 	void setLog2Interpolation(int log2Interpolation);
+	void setFreeRun(bool freeRun);
     void setBuffer(std::size_t chunksize);
 	bool isRunning() const { return m_running; }
     std::size_t getSamplesCount() const { return m_samplesCount; }
@@ -56,12 +56,14 @@ private:
 	QMutex m_startWaitMutex;
 	QWaitCondition m_startWaiter;
 	volatile bool m_running;
+	volatile bool m_freeRun;
 
-	std::ofstream* m_ofstream;
+	FileRecordWriter* m_fileWriter;
 	std::size_t m_bufsize;
 	unsigned int m_samplesChunkSize;
 	SampleSourceFifo* m_sampleFifo;
     std::size_t m_samplesCount;
+    unsigned int m_initialSamples; //!< silence the FIFO starts with that is not written in free run
 
 	int m_samplerate;
 	int m_log2Interpolation;
@@ -74,6 +76,8 @@ private:
     int16_t *m_buf;
 
 	void run();
+	bool writeFreeRun();
+	void writeChunk(unsigned int nbSamples);
 
 private slots:
 	void tick();
@@ -137,6 +137,32 @@ void CSocket::FillAddr( const string & localAddress, unsigned short localPort, s
     ////cout<<"\n returning from  Fille addr";
 }
 
+socklen_t CSocket::FillAddr( const string & address, unsigned short port, sockaddr_storage& addr,
+    NetworkLayerProtocol protocol )
+{
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = protocol == UnknownNetworkLayerProtocol ? AF_UNSPEC : (int) protocol;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    if (getaddrinfo(address.c_str(), 0, &hints, &res) != 0) {
+        throw CSocketException("Failed to resolve name (getaddrinfo())");
+    }
+
+    socklen_t addrLen = res->ai_addrlen;
+    memset(&addr, 0, sizeof(addr));
+    memcpy(&addr, res->ai_addr, addrLen);
+    freeaddrinfo(res);
+
+    if (addr.ss_family == AF_INET6) {
+        ((sockaddr_in6 *) &addr)->sin6_port = htons(port);
+    } else {
+        ((sockaddr_in *) &addr)->sin_port = htons(port);
+    }
+
+    return addrLen;
+}
+
 unsigned long int CSocket::GetReadBufferSize()
 {
     unsigned long int nSize;
@@ -309,25 +335,72 @@ void CSocket::SetBindToDevice( const string& sInterface )
     }*/
 }
 
-UDPSocket::UDPSocket():CSocket(UdpSocket,IPv4Protocol)
+UDPSocket::UDPSocket():CSocket(UdpSocket,IPv4Protocol),
+m_protocol(IPv4Protocol),
+m_destPort(0),
+m_destAddrLen(0)
 {
     SetBroadcast();
 }
 
 UDPSocket::UDPSocket( unsigned short localPort ):
-CSocket(UdpSocket,IPv4Protocol)
+CSocket(UdpSocket,IPv4Protocol),
+m_protocol(IPv4Protocol),
+m_destPort(0),
+m_destAddrLen(0)
 {
     BindLocalPort(localPort);
     SetBroadcast();
 }
 
 UDPSocket::UDPSocket( const string &localAddress, unsigned short localPort ):
-CSocket(UdpSocket,IPv4Protocol)
+CSocket(UdpSocket,IPv4Protocol),
+m_protocol(IPv4Protocol),
+m_destPort(0),
+m_destAddrLen(0)
 {
     BindLocalAddressAndPort(localAddress, localPort);
     SetBroadcast();
 }
 
+UDPSocket::UDPSocket( NetworkLayerProtocol protocol ):
+CSocket(UdpSocket,protocol),
+m_protocol(protocol),
+m_destPort(0),
+m_destAddrLen(0)
+{
+    if (protocol == IPv4Protocol) {
+        SetBroadcast();
+    }
+}
+
+CSocket::NetworkLayerProtocol UDPSocket::GetAddressProtocol( const string &address )
+{
+    sockaddr_storage addr;
+    FillAddr(address, 0, addr, UnknownNetworkLayerProtocol);
+    return addr.ss_family == AF_INET6 ? IPv6Protocol : IPv4Protocol;
+}
+
+bool UDPSocket::IsMulticastAddress( const string &address )
+{
+    sockaddr_storage addr;
+
+    try
+    {
+        FillAddr(address, 0, addr, UnknownNetworkLayerProtocol);
+    }
+    catch (CSocketException& e)
+    {
+        return false;
+    }
+
+    if (addr.ss_family == AF_INET6) {
+        return IN6_IS_ADDR_MULTICAST(&((sockaddr_in6 *) &addr)->sin6_addr);
+    } else {
+        return IN_MULTICAST(ntohl(((sockaddr_in *) &addr)->sin_addr.s_addr));
+    }
+}
+
 void UDPSocket::DisconnectFromHost()
 {
     sockaddr_in nullAddr;
@@ -346,30 +419,104 @@ void UDPSocket::DisconnectFromHost()
 void UDPSocket::SendDataGram( const void *buffer, int bufferLen, const string &foreignAddress,
     unsigned short foreignPort )
 {
-    //cout<<"Befor Fill addr";
-    sockaddr_in destAddr;
-    FillAddr(foreignAddress, foreignPort, destAddr);
+    const sockaddr_storage& destAddr = GetDestAddr(foreignAddress, foreignPort);
     //cout<<"Befor socket send";
     // Write out the whole buffer as a single message.
-    if (sendto(m_sockDesc, (void *) buffer, bufferLen, 0,(sockaddr *) &destAddr, sizeof(destAddr)) != bufferLen)
+    if (sendto(m_sockDesc, (void *) buffer, bufferLen, 0,(sockaddr *) &destAddr, m_destAddrLen) != bufferLen)
     {
         throw CSocketException("Send failed (sendto())", true);
     }
 
 }
 
-int UDPSocket::RecvDataGram( void *buffer, int bufferLen, string &sourceAddress, unsigned short &sourcePort )
+int UDPSocket::SendDataGrams( const void * const *buffers, int nbBuffers, int bufferLen, const string &foreignAddress,
+    unsigned short foreignPort )
+{
+    const sockaddr_storage& destAddr = GetDestAddr(foreignAddress, foreignPort);
+    int nbSent = 0;
+#ifdef __linux__
+    struct mmsghdr messages[m_maxBatchSize];
+    struct iovec iovecs[m_maxBatchSize];
+
+    while (nbSent < nbBuffers)
+    {
+        int nbMessages = nbBuffers - nbSent < m_maxBatchSize ? nbBuffers - nbSent : m_maxBatchSize;
+
+        for (int i = 0; i < nbMessages; i++)
+        {
+            iovecs[i].iov_base = (void *) buffers[nbSent + i];
+            iovecs[i].iov_len = bufferLen;
+            memset(&messages[i], 0, sizeof(struct mmsghdr));
+            messages[i].msg_hdr.msg_name = (void *) &destAddr;
+            messages[i].msg_hdr.msg_namelen = m_destAddrLen;
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int ret = sendmmsg(m_sockDesc, messages, nbMessages, 0);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw CSocketException("Send failed (sendmmsg())", true);
+        }
+
+        nbSent += ret; // the datagrams not sent are sent at next iteration
+    }
+#else
+    for (; nbSent < nbBuffers; nbSent++)
+    {
+        if (sendto(m_sockDesc, (void *) buffers[nbSent], bufferLen, 0, (sockaddr *) &destAddr, m_destAddrLen) != bufferLen) {
+            throw CSocketException("Send failed (sendto())", true);
+        }
+    }
+#endif
+    return nbSent;
+}
+
+const sockaddr_storage& UDPSocket::GetDestAddr( const string &foreignAddress, unsigned short foreignPort )
+{
+    // resolve the name only when it changes and not for each datagram
+    if ((m_destAddrLen == 0) || (foreignAddress != m_destAddress) || (foreignPort != m_destPort))
+    {
+        m_destAddrLen = FillAddr(foreignAddress, foreignPort, m_destAddr, m_protocol);
+        m_destAddress = foreignAddress;
+        m_destPort = foreignPort;
+    }
+
+    return m_destAddr;
+}
+
+int UDPSocket::RecvDataGram( void *buffer, int bufferLen, string &sourceAddress, unsigned short &sourcePort, bool wait )
 {
-    sockaddr_in clntAddr;
+    sockaddr_storage clntAddr;
     socklen_t addrLen = sizeof(clntAddr);
     int nBytes;
-    if ((nBytes = recvfrom(m_sockDesc, (void *) buffer, bufferLen, 0, (sockaddr *) &clntAddr,
+    if ((nBytes = recvfrom(m_sockDesc, (void *) buffer, bufferLen, wait ? 0 : MSG_DONTWAIT, (sockaddr *) &clntAddr,
         (socklen_t *) &addrLen)) < 0)
     {
+        if (!wait && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            return -1;
+        }
         throw CSocketException("Receive failed (recvfrom())", true);
     }
-    sourceAddress = inet_ntoa(clntAddr.sin_addr);
-    sourcePort    = ntohs(clntAddr.sin_port);
+    char addrStr[INET6_ADDRSTRLEN];
+
+    if (clntAddr.ss_family == AF_INET6)
+    {
+        inet_ntop(AF_INET6, &((sockaddr_in6 *) &clntAddr)->sin6_addr, addrStr, sizeof(addrStr));
+        sourcePort = ntohs(((sockaddr_in6 *) &clntAddr)->sin6_port);
+    }
+    else
+    {
+        inet_ntop(AF_INET, &((sockaddr_in *) &clntAddr)->sin_addr, addrStr, sizeof(addrStr));
+        sourcePort = ntohs(((sockaddr_in *) &clntAddr)->sin_port);
+    }
+
+    sourceAddress = addrStr;
     char* sData = static_cast<char *>(buffer);
     sData[nBytes] = '\0';
     return nBytes;
@@ -377,12 +524,66 @@ int UDPSocket::RecvDataGram( void *buffer, int bufferLen, string &sourceAddress,
 
 void UDPSocket::SetMulticastTTL( unsigned char multicastTTL )
 {
-    if (setsockopt(m_sockDesc, IPPROTO_IP, IP_MULTICAST_TTL, (void *) &multicastTTL, sizeof(multicastTTL)) < 0)
+    int ret;
+
+    if (m_protocol == IPv6Protocol)
+    {
+        int hops = multicastTTL;
+        ret = setsockopt(m_sockDesc, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, (void *) &hops, sizeof(hops));
+    }
+    else
+    {
+        ret = setsockopt(m_sockDesc, IPPROTO_IP, IP_MULTICAST_TTL, (void *) &multicastTTL, sizeof(multicastTTL));
+    }
+
+    if (ret < 0)
     {
         throw CSocketException("Multicast TTL set failed (setsockopt())", true);
     }
 }
 
+void UDPSocket::SetMulticastInterface( const string &multicastInterface )
+{
+    int ret;
+    unsigned int ifIndex = multicastInterface.size() == 0 ? 0 : if_nametoindex(multicastInterface.c_str());
+
+    if (m_protocol == IPv6Protocol)
+    {
+        if ((multicastInterface.size() != 0) && (ifIndex == 0)) {
+            throw CSocketException("Unknown multicast interface (if_nametoindex())", true);
+        }
+
+        ret = setsockopt(m_sockDesc, IPPROTO_IPV6, IPV6_MULTICAST_IF, (void *) &ifIndex, sizeof(ifIndex));
+    }
+    else if (ifIndex != 0) // interface given by name
+    {
+#ifdef __linux__
+        struct ip_mreqn multicastRequest;
+        memset(&multicastRequest, 0, sizeof(multicastRequest));
+        multicastRequest.imr_ifindex = ifIndex;
+        ret = setsockopt(m_sockDesc, IPPROTO_IP, IP_MULTICAST_IF, (void *) &multicastRequest, sizeof(multicastRequest));
+#else
+        throw CSocketException("Multicast interface must be given by its IPv4 address on this system");
+#endif
+    }
+    else // interface given by its address or default interface
+    {
+        struct in_addr interfaceAddr;
+        interfaceAddr.s_addr = htonl(INADDR_ANY);
+
+        if ((multicastInterface.size() != 0) && (inet_pton(AF_INET, multicastInterface.c_str(), &interfaceAddr) != 1)) {
+            throw CSocketException("Unknown multicast interface (inet_pton())");
+        }
+
+        ret = setsockopt(m_sockDesc, IPPROTO_IP, IP_MULTICAST_IF, (void *) &interfaceAddr, sizeof(interfaceAddr));
+    }
+
+    if (ret < 0)
+    {
+        throw CSocketException("Multicast interface set failed (setsockopt())", true);
+    }
+}
+
 void UDPSocket::JoinGroup( const string &multicastGroup )
 {
     struct ip_mreq multicastRequest;
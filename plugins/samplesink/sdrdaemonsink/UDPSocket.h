@@ -29,7 +29,7 @@
 #include <netdb.h>           // For gethostbyname()
 #include <arpa/inet.h>       // For inet_addr()
 #include <unistd.h>          // For close()
-#include <netinet/in.h>      // For sockaddr_in
+#include <netinet/in.h>      // For sockaddr_in and sockaddr_in6
 #include <errno.h>
 #include <climits>
 
@@ -236,6 +236,8 @@ protected:
     CSocket(SocketType type, NetworkLayerProtocol protocol);
     CSocket(int sockDesc);
     static void FillAddr( const string & localAddress, unsigned short localPort, sockaddr_in& localAddr );
+    static socklen_t FillAddr( const string & address, unsigned short port, sockaddr_storage& addr,
+        NetworkLayerProtocol protocol );
 
 private:
     // Prevent the user from trying to use Exact copy of this object
@@ -270,6 +272,33 @@ public:
    */
     UDPSocket(const string &localAddress, unsigned short localPort);
 
+  /**
+   *   Construct an unbound UDP socket of the given network layer protocol
+   *   @param protocol IPv4Protocol or IPv6Protocol
+   *   @exception SocketException thrown if unable to create UDP socket
+   */
+    UDPSocket(NetworkLayerProtocol protocol);
+
+    /**
+     *   Network layer protocol the socket was created with
+     */
+    NetworkLayerProtocol GetProtocol() const { return m_protocol; }
+
+    /**
+     *   Get the network layer protocol of an address
+     *   @param address address (IP address or name)
+     *   @return IPv4Protocol or IPv6Protocol
+     *   @exception SocketException thrown if unable to resolve the address
+     */
+    static NetworkLayerProtocol GetAddressProtocol(const string &address);
+
+    /**
+     *   Tell if an address is an IPv4 or IPv6 multicast group address
+     *   @param address address (IP address or name)
+     *   @return true if the address is a multicast group
+     */
+    static bool IsMulticastAddress(const string &address);
+
   /**
    *   Unset foreign address and port
    *   @return true if disassociation is successful
@@ -296,6 +325,21 @@ public:
     void SendDataGram(const void *buffer, int bufferLen, const string &foreignAddress,
         unsigned short foreignPort);
 
+  /**
+   *   Send several buffers of the same length as UDP datagrams to the
+   *   specified address/port. This takes a single system call (sendmmsg)
+   *   where it is available.
+   *   @param buffers buffers to be written
+   *   @param nbBuffers number of buffers (datagrams)
+   *   @param bufferLen number of bytes to write from each buffer
+   *   @param foreignAddress address (IP address or name) to send to
+   *   @param foreignPort port number to send to
+   *   @return number of datagrams sent
+   *   @exception SocketException thrown if unable to send datagrams
+   */
+    int SendDataGrams(const void * const *buffers, int nbBuffers, int bufferLen, const string &foreignAddress,
+        unsigned short foreignPort);
+
     /**
      *   Read read up to bufferLen bytes data from this socket.  The given buffer
      *   is where the data will be placed
@@ -303,19 +347,28 @@ public:
      *   @param bufferLen maximum number of bytes to receive
      *   @param sourceAddress address of datagram source
      *   @param sourcePort port of data source
-     *   @return number of bytes received and -1 for error
+     *   @param wait wait for a datagram if there is none pending
+     *   @return number of bytes received and -1 if there is no datagram pending when not waiting
      *   @exception SocketException thrown if unable to receive datagram
      */
     int RecvDataGram(void *buffer, int bufferLen, string &sourceAddress,
-               unsigned short &sourcePort);
+               unsigned short &sourcePort, bool wait = true);
 
     /**
-    *   Set the multicast TTL
+    *   Set the multicast TTL (hop limit for IPv6)
     *   @param multicastTTL multicast TTL
     *   @exception SocketException thrown if unable to set TTL
     */
     void SetMulticastTTL(unsigned char multicastTTL);
 
+    /**
+    *   Set the interface multicast datagrams are sent from
+    *   @param multicastInterface interface name (e.g. eth0) or IPv4 address of the interface.
+    *          Empty string selects the system default interface.
+    *   @exception SocketException thrown if unable to set the interface
+    */
+    void SetMulticastInterface(const string &multicastInterface);
+
     /**
      *   Join the specified multicast group
      *   @param multicastGroup multicast group address to join
@@ -332,7 +385,14 @@ public:
 
 private:
     void SetBroadcast();
-
+    const sockaddr_storage& GetDestAddr(const string &foreignAddress, unsigned short foreignPort);
+
+    static const int m_maxBatchSize = 64; //!< datagrams per sendmmsg call
+    NetworkLayerProtocol m_protocol;
+    string m_destAddress;       //!< last destination address resolved...
+    unsigned short m_destPort;
+    sockaddr_storage m_destAddr; //!< ...and its socket address
+    socklen_t m_destAddrLen;
 };
 
 
@@ -33,6 +33,7 @@
 #include "gui/glspectrum.h"
 #include "dsp/dspengine.h"
 #include "dsp/dspcommands.h"
+#include "dsp/iqpacker.h"
 
 #include "mainwindow.h"
 
@@ -235,8 +236,10 @@ void SDRdaemonSinkGui::updateSampleRateAndFrequency()
 
 void SDRdaemonSinkGui::updateTxDelayTooltip()
 {
-    double delay = ((127*127*m_settings.m_txDelay) / m_settings.m_sampleRate)/(128 + m_settings.m_nbFECBlocks);
-    ui->txDelayText->setToolTip(tr("%1 us").arg(QString::number(delay*1e6, 'f', 0)));
+    int samplesPerBlock = IQPacker::getSamplesPerBlock((IQPacker::Encoding) m_settings.m_payloadEncoding, m_settings.m_udpSize - 4); // 4 bytes of block header
+    double delay = ((127*samplesPerBlock*m_settings.m_txDelay) / m_settings.m_sampleRate)/(128 + m_settings.m_nbFECBlocks);
+    double rate = delay > 0.0 ? (m_settings.m_udpSize*8) / (delay*1e6) : 0.0; // Mb/s
+    ui->txDelayText->setToolTip(tr("%1 us %2 Mb/s").arg(QString::number(delay*1e6, 'f', 0)).arg(QString::number(rate, 'f', 1)));
 }
 
 void SDRdaemonSinkGui::displaySettings()
@@ -252,9 +255,14 @@ void SDRdaemonSinkGui::displaySettings()
     QString s0 = QString::number(128 + m_settings.m_nbFECBlocks, 'f', 0);
     QString s1 = QString::number(m_settings.m_nbFECBlocks, 'f', 0);
     ui->nominalNbBlocksText->setText(tr("%1/%2").arg(s0).arg(s1));
+    ui->adaptiveFEC->setChecked(m_settings.m_adaptiveFEC);
+    ui->udpSize->setValue(m_settings.m_udpSize);
+    ui->payloadEncoding->setCurrentIndex(m_settings.m_payloadEncoding);
 
     ui->address->setText(m_settings.m_address);
     ui->dataPort->setText(tr("%1").arg(m_settings.m_dataPort));
+    ui->multicastTTL->setValue(m_settings.m_multicastTTL);
+    ui->multicastInterface->setText(m_settings.m_multicastInterface);
     ui->controlPort->setText(tr("%1").arg(m_settings.m_controlPort));
     ui->specificParms->setText(m_settings.m_specificParameters);
 }
@@ -440,6 +448,45 @@ void SDRdaemonSinkGui::on_nbFECBlocks_valueChanged(int value)
     sendSettings();
 }
 
+void SDRdaemonSinkGui::on_udpSize_valueChanged(int value)
+{
+    m_settings.m_udpSize = value;
+    updateTxDelayTooltip();
+    sendSettings();
+}
+
+void SDRdaemonSinkGui::on_adaptiveFEC_toggled(bool checked)
+{
+    m_settings.m_adaptiveFEC = checked;
+    sendSettings();
+}
+
+void SDRdaemonSinkGui::on_payloadEncoding_currentIndexChanged(int index)
+{
+    if ((index < 0) || (index >= IQPacker::EncodingEnd)) {
+        return;
+    }
+
+    m_settings.m_payloadEncoding = index;
+    updateTxDelayTooltip();
+    sendSettings();
+}
+
+void SDRdaemonSinkGui::on_multicastTTL_valueChanged(int value)
+{
+    m_settings.m_multicastTTL = value;
+    sendSettings();
+}
+
+void SDRdaemonSinkGui::on_multicastInterface_editingFinished()
+{
+    if (m_settings.m_multicastInterface != ui->multicastInterface->text())
+    {
+        m_settings.m_multicastInterface = ui->multicastInterface->text();
+        sendSettings();
+    }
+}
+
 void SDRdaemonSinkGui::on_address_returnPressed()
 {
     m_settings.m_address = ui->address->text();
@@ -102,9 +102,14 @@ private slots:
     void on_interp_currentIndexChanged(int index);
     void on_txDelay_valueChanged(int value);
     void on_nbFECBlocks_valueChanged(int value);
+    void on_adaptiveFEC_toggled(bool checked);
+    void on_udpSize_valueChanged(int value);
+    void on_payloadEncoding_currentIndexChanged(int index);
     void on_address_returnPressed();
     void on_dataPort_returnPressed();
     void on_controlPort_returnPressed();
+    void on_multicastTTL_valueChanged(int value);
+    void on_multicastInterface_editingFinished();
     void on_specificParms_returnPressed();
     void on_applyButton_clicked(bool checked);
     void on_sendButton_clicked(bool checked);
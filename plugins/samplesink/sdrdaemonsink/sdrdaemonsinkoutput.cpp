@@ -27,6 +27,7 @@
 #include "dsp/dspcommands.h"
 #include "dsp/dspengine.h"
 #include "dsp/filerecord.h"
+#include "dsp/iqpacker.h"
 
 #include "device/devicesinkapi.h"
 
@@ -66,15 +67,19 @@ bool SDRdaemonSinkOutput::start()
 	qDebug() << "SDRdaemonSinkOutput::start";
 
 	m_sdrDaemonSinkThread = new SDRdaemonSinkThread(&m_sampleSourceFifo);
-	m_sdrDaemonSinkThread->setRemoteAddress(m_settings.m_address, m_settings.m_dataPort);
+	m_sdrDaemonSinkThread->setRemoteAddress(m_settings.m_address, m_settings.m_dataPort, m_settings.m_multicastTTL, m_settings.m_multicastInterface);
 	m_sdrDaemonSinkThread->setCenterFrequency(m_settings.m_centerFrequency);
 	m_sdrDaemonSinkThread->setSamplerate(m_settings.m_sampleRate);
 	m_sdrDaemonSinkThread->setNbBlocksFEC(m_settings.m_nbFECBlocks);
+	m_sdrDaemonSinkThread->setAdaptiveFEC(m_settings.m_adaptiveFEC);
+	m_sdrDaemonSinkThread->setUdpSize(m_settings.m_udpSize);
+	m_sdrDaemonSinkThread->setPayloadEncoding((IQPacker::Encoding) m_settings.m_payloadEncoding);
 	m_sdrDaemonSinkThread->connectTimer(m_masterTimer);
 	m_sdrDaemonSinkThread->startWork();
 
-    double delay = ((127*127*m_settings.m_txDelay) / m_settings.m_sampleRate)/(128 + m_settings.m_nbFECBlocks);
-    m_sdrDaemonSinkThread->setTxDelay((int) (delay*1e6));
+    int samplesPerBlock = IQPacker::getSamplesPerBlock((IQPacker::Encoding) m_settings.m_payloadEncoding, m_settings.m_udpSize - sizeof(UDPSinkFEC::Header));
+    double delay = ((127*samplesPerBlock*m_settings.m_txDelay) / m_settings.m_sampleRate)/(128 + m_settings.m_nbFECBlocks);
+    m_sdrDaemonSinkThread->setTxDelay((uint32_t) (delay*1e9));
 
 	mutexLocker.unlock();
 	//applySettings(m_generalSettings, m_settings, true);
@@ -246,14 +251,18 @@ void SDRdaemonSinkOutput::applySettings(const SDRdaemonSinkSettings& settings, b
     bool forwardChange = false;
     bool changeTxDelay = false;
 
-    if (force || (m_settings.m_address != settings.m_address) || (m_settings.m_dataPort != settings.m_dataPort))
+    if (force || (m_settings.m_address != settings.m_address) || (m_settings.m_dataPort != settings.m_dataPort)
+        || (m_settings.m_multicastTTL != settings.m_multicastTTL) || (m_settings.m_multicastInterface != settings.m_multicastInterface))
     {
         m_settings.m_address = settings.m_address;
         m_settings.m_dataPort = settings.m_dataPort;
+        m_settings.m_multicastTTL = settings.m_multicastTTL;
+        m_settings.m_multicastInterface = settings.m_multicastInterface;
 
         if (m_sdrDaemonSinkThread != 0)
         {
-            m_sdrDaemonSinkThread->setRemoteAddress(m_settings.m_address, m_settings.m_dataPort);
+            m_sdrDaemonSinkThread->setRemoteAddress(m_settings.m_address, m_settings.m_dataPort,
+                    m_settings.m_multicastTTL, m_settings.m_multicastInterface);
         }
     }
 
@@ -300,36 +309,75 @@ void SDRdaemonSinkOutput::applySettings(const SDRdaemonSinkSettings& settings, b
         changeTxDelay = true;
     }
 
+    if (force || (m_settings.m_adaptiveFEC != settings.m_adaptiveFEC))
+    {
+        m_settings.m_adaptiveFEC = settings.m_adaptiveFEC;
+
+        if (m_sdrDaemonSinkThread != 0) {
+            m_sdrDaemonSinkThread->setAdaptiveFEC(m_settings.m_adaptiveFEC);
+        }
+    }
+
     if (force || (m_settings.m_txDelay != settings.m_txDelay))
     {
         m_settings.m_txDelay = settings.m_txDelay;
         changeTxDelay = true;
     }
 
+    if (force || (m_settings.m_udpSize != settings.m_udpSize))
+    {
+        m_settings.m_udpSize = settings.m_udpSize;
+
+        if (m_sdrDaemonSinkThread != 0)
+        {
+            m_sdrDaemonSinkThread->setUdpSize(m_settings.m_udpSize);
+        }
+
+        changeTxDelay = true;
+    }
+
+    if (force || (m_settings.m_payloadEncoding != settings.m_payloadEncoding))
+    {
+        m_settings.m_payloadEncoding = settings.m_payloadEncoding;
+
+        if (m_sdrDaemonSinkThread != 0)
+        {
+            m_sdrDaemonSinkThread->setPayloadEncoding((IQPacker::Encoding) m_settings.m_payloadEncoding);
+        }
+
+        changeTxDelay = true;
+    }
+
     if (changeTxDelay)
     {
-        double delay = ((127*127*m_settings.m_txDelay) / m_settings.m_sampleRate)/(128 + m_settings.m_nbFECBlocks);
-        qDebug("SDRdaemonSinkOutput::applySettings: Tx delay: %f us", delay*1e6);
+        int samplesPerBlock = IQPacker::getSamplesPerBlock((IQPacker::Encoding) m_settings.m_payloadEncoding, m_settings.m_udpSize - sizeof(UDPSinkFEC::Header));
+        double delay = ((127*samplesPerBlock*m_settings.m_txDelay) / m_settings.m_sampleRate)/(128 + m_settings.m_nbFECBlocks);
+        qDebug("SDRdaemonSinkOutput::applySettings: Tx delay: %f us target rate: %f Mb/s",
+                delay*1e6, delay > 0.0 ? (m_settings.m_udpSize*8) / (delay*1e6) : 0.0);
 
         if (m_sdrDaemonSinkThread != 0)
         {
             // delay is calculated as a fraction of the nominal UDP block process time
-            // frame size: 127 * 127 samples
+            // frame size: 127 blocks of samples
             // divided by sample rate gives the frame process time
             // divided by the number of actual blocks including FEC blocks gives the block (i.e. UDP block) process time
-            m_sdrDaemonSinkThread->setTxDelay((int) (delay*1e6));
+            // the sender paces the datagrams at this interval in average (nanoseconds)
+            m_sdrDaemonSinkThread->setTxDelay((uint32_t) (delay*1e9));
         }
     }
 
     mutexLocker.unlock();
 
-    qDebug("SDRdaemonSinkOutput::applySettings: %s m_centerFrequency: %llu m_sampleRate: %llu m_log2Interp: %d m_txDelay: %f m_nbFECBlocks: %d",
+    qDebug("SDRdaemonSinkOutput::applySettings: %s m_centerFrequency: %llu m_sampleRate: %llu m_log2Interp: %d m_txDelay: %f m_nbFECBlocks: %d m_adaptiveFEC: %s m_udpSize: %u m_payloadEncoding: %u",
             forwardChange ? "forward change" : "",
             m_settings.m_centerFrequency,
             m_settings.m_sampleRate,
             m_settings.m_log2Interp,
             m_settings.m_txDelay,
-            m_settings.m_nbFECBlocks);
+            m_settings.m_nbFECBlocks,
+            m_settings.m_adaptiveFEC ? "true" : "false",
+            m_settings.m_udpSize,
+            m_settings.m_payloadEncoding);
 
     if (forwardChange)
     {
@@ -397,12 +445,32 @@ int SDRdaemonSinkOutput::webapiSettingsPutPatch(
     if (deviceSettingsKeys.contains("nbFECBlocks")) {
         settings.m_nbFECBlocks = response.getSdrDaemonSinkSettings()->getNbFecBlocks();
     }
+    if (deviceSettingsKeys.contains("adaptiveFEC")) {
+        settings.m_adaptiveFEC = response.getSdrDaemonSinkSettings()->getAdaptiveFec() != 0;
+    }
+    if (deviceSettingsKeys.contains("udpSize"))
+    {
+        int udpSize = response.getSdrDaemonSinkSettings()->getUdpSize();
+        settings.m_udpSize = udpSize < (int) UDPSinkFEC::m_udpSizeMin ? UDPSinkFEC::m_udpSizeMin :
+            udpSize > (int) UDPSinkFEC::m_udpSizeMax ? UDPSinkFEC::m_udpSizeMax : udpSize;
+    }
+    if (deviceSettingsKeys.contains("payloadEncoding"))
+    {
+        int payloadEncoding = response.getSdrDaemonSinkSettings()->getPayloadEncoding();
+        settings.m_payloadEncoding = (payloadEncoding < 0) || (payloadEncoding >= (int) IQPacker::EncodingEnd) ? (int) IQPacker::Encoding16 : payloadEncoding;
+    }
     if (deviceSettingsKeys.contains("address")) {
         settings.m_address = *response.getSdrDaemonSinkSettings()->getAddress();
     }
     if (deviceSettingsKeys.contains("dataPort")) {
         settings.m_dataPort = response.getSdrDaemonSinkSettings()->getDataPort();
     }
+    if (deviceSettingsKeys.contains("multicastTTL")) {
+        settings.m_multicastTTL = response.getSdrDaemonSinkSettings()->getMulticastTtl();
+    }
+    if (deviceSettingsKeys.contains("multicastInterface")) {
+        settings.m_multicastInterface = *response.getSdrDaemonSinkSettings()->getMulticastInterface();
+    }
     if (deviceSettingsKeys.contains("controlPort")) {
         settings.m_controlPort = response.getSdrDaemonSinkSettings()->getControlPort();
     }
@@ -440,8 +508,13 @@ void SDRdaemonSinkOutput::webapiFormatDeviceSettings(SWGSDRangel::SWGDeviceSetti
     response.getSdrDaemonSinkSettings()->setLog2Interp(settings.m_log2Interp);
     response.getSdrDaemonSinkSettings()->setTxDelay(settings.m_txDelay);
     response.getSdrDaemonSinkSettings()->setNbFecBlocks(settings.m_nbFECBlocks);
+    response.getSdrDaemonSinkSettings()->setAdaptiveFec(settings.m_adaptiveFEC ? 1 : 0);
+    response.getSdrDaemonSinkSettings()->setUdpSize(settings.m_udpSize);
+    response.getSdrDaemonSinkSettings()->setPayloadEncoding(settings.m_payloadEncoding);
     response.getSdrDaemonSinkSettings()->setAddress(new QString(settings.m_address));
     response.getSdrDaemonSinkSettings()->setDataPort(settings.m_dataPort);
+    response.getSdrDaemonSinkSettings()->setMulticastTtl(settings.m_multicastTTL);
+    response.getSdrDaemonSinkSettings()->setMulticastInterface(new QString(settings.m_multicastInterface));
     response.getSdrDaemonSinkSettings()->setControlPort(settings.m_controlPort);
     response.getSdrDaemonSinkSettings()->setSpecificParameters(new QString(settings.m_specificParameters));
 }
@@ -450,6 +523,7 @@ void SDRdaemonSinkOutput::webapiFormatDeviceReport(SWGSDRangel::SWGDeviceReport&
 {
     response.getSdrDaemonSinkReport()->setBufferRwBalance(m_sampleSourceFifo.getRWBalance());
     response.getSdrDaemonSinkReport()->setSampleCount(m_sdrDaemonSinkThread ? (int) m_sdrDaemonSinkThread->getSamplesCount() : 0);
+    response.getSdrDaemonSinkReport()->setNbFecBlocks(m_sdrDaemonSinkThread ? (int) m_sdrDaemonSinkThread->getNbBlocksFEC() : 0);
 }
 
 
@@ -15,6 +15,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include "util/simpleserializer.h"
+#include "dsp/iqpacker.h"
 #include "sdrdaemonsinksettings.h"
 
 SDRdaemonSinkSettings::SDRdaemonSinkSettings()
@@ -29,8 +30,13 @@ void SDRdaemonSinkSettings::resetToDefaults()
     m_log2Interp = 4;
     m_txDelay = 0.5;
     m_nbFECBlocks = 0;
+    m_adaptiveFEC = false;
+    m_udpSize = 512;
+    m_payloadEncoding = IQPacker::Encoding16;
     m_address = "127.0.0.1";
     m_dataPort = 9092;
+    m_multicastTTL = 1;
+    m_multicastInterface = "";
     m_controlPort = 9093;
     m_specificParameters = "";
 }
@@ -47,6 +53,11 @@ QByteArray SDRdaemonSinkSettings::serialize() const
     s.writeU32(6, m_dataPort);
     s.writeU32(7, m_controlPort);
     s.writeString(8, m_specificParameters);
+    s.writeU32(9, m_udpSize);
+    s.writeU32(10, m_payloadEncoding);
+    s.writeBool(11, m_adaptiveFEC);
+    s.writeU32(12, m_multicastTTL);
+    s.writeString(13, m_multicastInterface);
 
     return s.final();
 }
@@ -74,6 +85,14 @@ bool SDRdaemonSinkSettings::deserialize(const QByteArray& data)
         d.readU32(7, &uintval, 9090);
         m_controlPort = uintval % (1<<16);
         d.readString(8, &m_specificParameters, "");
+        d.readU32(9, &uintval, 512);
+        m_udpSize = uintval < 512 ? 512 : uintval > 8192 ? 8192 : uintval;
+        d.readU32(10, &uintval, IQPacker::Encoding16);
+        m_payloadEncoding = uintval < IQPacker::EncodingEnd ? uintval : IQPacker::Encoding16;
+        d.readBool(11, &m_adaptiveFEC, false);
+        d.readU32(12, &uintval, 1);
+        m_multicastTTL = uintval < 1 ? 1 : uintval > 255 ? 255 : uintval;
+        d.readString(13, &m_multicastInterface, "");
         return true;
     }
     else
@@ -24,9 +24,14 @@ struct SDRdaemonSinkSettings {
     quint64 m_sampleRate;
     quint32 m_log2Interp;
     float   m_txDelay;
-    quint32 m_nbFECBlocks;
+    quint32 m_nbFECBlocks;  //!< the largest when adaptive
+    bool    m_adaptiveFEC;  //!< number of FEC blocks following the loss reports of the receiver
+    quint32 m_udpSize;      //!< size of the datagrams in bytes (512 to 8192)
+    quint32 m_payloadEncoding; //!< IQPacker::Encoding of the samples in the datagrams
     QString m_address;
     quint16 m_dataPort;
+    quint32 m_multicastTTL;       //!< TTL (IPv4) or hop limit (IPv6) when the address is a multicast group
+    QString m_multicastInterface; //!< interface name or IPv4 address multicast is sent from (empty for default)
     quint16 m_controlPort;
     QString m_specificParameters;
 
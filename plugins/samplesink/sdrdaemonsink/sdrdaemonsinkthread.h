@@ -49,8 +49,14 @@ public:
     void setCenterFrequency(uint64_t centerFrequency) { m_udpSinkFEC.setCenterFrequency(centerFrequency); }
 	void setSamplerate(int samplerate);
     void setNbBlocksFEC(uint32_t nbBlocksFEC) { m_udpSinkFEC.setNbBlocksFEC(nbBlocksFEC); };
+    void setAdaptiveFEC(bool adaptiveFEC) { m_udpSinkFEC.setAdaptiveFEC(adaptiveFEC); }
+    uint32_t getNbBlocksFEC() const { return m_udpSinkFEC.getNbBlocksFEC(); }
     void setTxDelay(uint32_t txDelay) { m_udpSinkFEC.setTxDelay(txDelay); };
-    void setRemoteAddress(const QString& address, uint16_t port) { m_udpSinkFEC.setRemoteAddress(address, port); }
+    void setUdpSize(uint32_t udpSize) { m_udpSinkFEC.setUdpSize(udpSize); }
+    void setPayloadEncoding(IQPacker::Encoding encoding) { m_udpSinkFEC.setPayloadEncoding(encoding); }
+    void setRemoteAddress(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface) {
+        m_udpSinkFEC.setRemoteAddress(address, port, multicastTTL, multicastInterface);
+    }
 
     bool isRunning() const { return m_running; }
 
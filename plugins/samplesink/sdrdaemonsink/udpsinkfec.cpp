@@ -17,6 +17,7 @@
 #include <QDebug>
 
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #include <boost/crc.hpp>
 #include <boost/cstdint.hpp>
@@ -30,21 +31,31 @@ MESSAGE_CLASS_DEFINITION(UDPSinkFECWorker::MsgConfigureRemoteAddress, Message)
 UDPSinkFEC::UDPSinkFEC() :
     m_centerFrequency(100000),
     m_sampleRate(48000),
-    m_sampleBytes(1),
-    m_sampleBits(8),
     m_nbSamples(0),
     m_nbBlocksFEC(0),
+    m_adaptiveFEC(false),
+    m_frameNbBlocksFEC(0),
+    m_filler(0),
     m_txDelay(0),
+    m_udpSize(m_udpSizeMin),
+    m_nextUdpSize(m_udpSizeMin),
+    m_encoding(IQPacker::Encoding16),
+    m_nextEncoding(IQPacker::Encoding16),
+    m_samplesPerBlock(IQPacker::getSamplesPerBlock(m_encoding, m_udpSizeMin - sizeof(Header))),
     m_txBlockIndex(0),
     m_txBlocksIndex(0),
     m_frameCount(0),
     m_sampleIndex(0)
 {
-    memset((char *) m_txBlocks, 0, 4*256*sizeof(SuperBlock));
-    memset((char *) &m_superBlock, 0, sizeof(SuperBlock));
+    for (int i = 0; i < 4; i++)
+    {
+        m_txFrames[i] = 0;
+        m_txFramesUdpSize[i] = 0;
+    }
+
     m_currentMetaFEC.init();
-    m_bufMeta = new uint8_t[m_udpSize];
-    m_buf = new uint8_t[m_udpSize];
+    m_bufMeta = new uint8_t[m_udpSizeMax];
+    m_buf = new uint8_t[m_udpSizeMax];
     m_udpThread = new QThread();
     m_udpWorker = new UDPSinkFECWorker();
 
@@ -63,6 +74,11 @@ UDPSinkFEC::~UDPSinkFEC()
 
     delete[] m_buf;
     delete[] m_bufMeta;
+
+    for (int i = 0; i < 4; i++) {
+        delete[] m_txFrames[i];
+    }
+
     delete m_udpWorker;
     delete m_udpThread;
 }
@@ -77,12 +93,51 @@ void UDPSinkFEC::setNbBlocksFEC(uint32_t nbBlocksFEC)
 {
     qDebug() << "UDPSinkFEC::setNbBlocksFEC: nbBlocksFEC: " << nbBlocksFEC;
     m_nbBlocksFEC = nbBlocksFEC;
+    m_udpWorker->setMaxNbBlocksFEC(nbBlocksFEC);
+}
+
+void UDPSinkFEC::setAdaptiveFEC(bool adaptiveFEC)
+{
+    qDebug() << "UDPSinkFEC::setAdaptiveFEC: adaptiveFEC: " << adaptiveFEC;
+    m_adaptiveFEC = adaptiveFEC;
+}
+
+void UDPSinkFEC::setUdpSize(uint32_t udpSize)
+{
+    qDebug() << "UDPSinkFEC::setUdpSize: udpSize: " << udpSize;
+
+    if (udpSize < m_udpSizeMin) {
+        m_nextUdpSize = m_udpSizeMin;
+    } else if (udpSize > m_udpSizeMax) {
+        m_nextUdpSize = m_udpSizeMax;
+    } else {
+        m_nextUdpSize = udpSize;
+    }
 }
 
-void UDPSinkFEC::setRemoteAddress(const QString& address, uint16_t port)
+void UDPSinkFEC::setPayloadEncoding(IQPacker::Encoding encoding)
 {
-    qDebug() << "UDPSinkFEC::setRemoteAddress: address: " << address << " port: " << port;
-    m_udpWorker->setRemoteAddress(address, port);
+    qDebug() << "UDPSinkFEC::setPayloadEncoding: encoding: " << IQPacker::getName(encoding);
+    m_nextEncoding = encoding;
+}
+
+void UDPSinkFEC::allocateTxFrame()
+{
+    if (m_txFramesUdpSize[m_txBlocksIndex] != m_udpSize)
+    {
+        // the worker is done with this frame since it was pushed 4 frames ago
+        delete[] m_txFrames[m_txBlocksIndex];
+        m_txFrames[m_txBlocksIndex] = new uint8_t[256 * m_udpSize];
+        memset(m_txFrames[m_txBlocksIndex], 0, 256 * m_udpSize);
+        m_txFramesUdpSize[m_txBlocksIndex] = m_udpSize;
+    }
+}
+
+void UDPSinkFEC::setRemoteAddress(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface)
+{
+    qDebug() << "UDPSinkFEC::setRemoteAddress: address: " << address << " port: " << port
+            << " multicastTTL: " << multicastTTL << " multicastInterface: " << multicastInterface;
+    m_udpWorker->setRemoteAddress(address, port, multicastTTL, multicastInterface);
 }
 
 void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunkSize)
@@ -102,13 +157,21 @@ void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunk
 
             gettimeofday(&tv, 0);
 
+            // the datagram size, the encoding and the number of FEC blocks change at frame boundaries only
+            m_udpSize = m_nextUdpSize;
+            m_encoding = m_nextEncoding;
+            m_samplesPerBlock = IQPacker::getSamplesPerBlock(m_encoding, m_udpSize - sizeof(Header));
+            allocateTxFrame();
+            m_frameNbBlocksFEC = m_adaptiveFEC ? m_udpWorker->getAdaptiveNbBlocksFEC() : m_nbBlocksFEC;
+            m_filler = m_adaptiveFEC ? 1 : 0; // ask the receiver for loss reports
+
             // create meta data TODO: semaphore
             metaData.m_centerFrequency = m_centerFrequency;
             metaData.m_sampleRate = m_sampleRate;
-            metaData.m_sampleBytes = m_sampleBytes;
-            metaData.m_sampleBits = m_sampleBits;
+            metaData.m_sampleBytes = IQPacker::getSampleBytes(m_encoding);
+            metaData.m_sampleBits = IQPacker::getSampleBits(m_encoding);
             metaData.m_nbOriginalBlocks = m_nbOriginalBlocks;
-            metaData.m_nbFECBlocks = m_nbBlocksFEC;
+            metaData.m_nbFECBlocks = m_frameNbBlocksFEC;
             metaData.m_tv_sec = tv.tv_sec;
             metaData.m_tv_usec = tv.tv_usec;
 
@@ -116,12 +179,14 @@ void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunk
             crc32.process_bytes(&metaData, 20);
 
             metaData.m_crc32 = crc32.checksum();
+            metaData.m_udpSize = m_udpSize;
 
-            memset((char *) &m_superBlock, 0, sizeof(m_superBlock));
-
-            m_superBlock.header.frameIndex = m_frameCount;
-            m_superBlock.header.blockIndex = m_txBlockIndex;
-            memcpy((char *) &m_superBlock.protectedBlock, (const char *) &metaData, sizeof(MetaDataFEC));
+            SuperBlock& metaBlock = getTxBlock(0);
+            memset((char *) &metaBlock, 0, m_udpSize); // only this part is sent
+            metaBlock.header.frameIndex = m_frameCount;
+            metaBlock.header.blockIndex = m_txBlockIndex;
+            metaBlock.header.filler = m_filler;
+            memcpy((char *) &metaBlock.protectedBlock, (const char *) &metaData, sizeof(MetaDataFEC));
 
             if (!(metaData == m_currentMetaFEC))
             {
@@ -132,6 +197,7 @@ void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunk
                         << ":" << (int) metaData.m_sampleBits
                         << "|" << (int) metaData.m_nbOriginalBlocks
                         << ":" << (int) metaData.m_nbFECBlocks
+                        << ":" << metaData.m_udpSize
                         << "|" << metaData.m_tv_sec
                         << ":" << metaData.m_tv_usec
                         << "|";
@@ -139,13 +205,12 @@ void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunk
                 m_currentMetaFEC = metaData;
             }
 
-            m_txBlocks[m_txBlocksIndex][0] = m_superBlock;
             m_txBlockIndex = 1; // next Tx block with data
         }
 
-        if (m_sampleIndex + inRemainingSamples < samplesPerBlock) // there is still room in the current super block
+        if (m_sampleIndex + inRemainingSamples < m_samplesPerBlock) // there is still room in the current super block
         {
-            memcpy((char *) &m_superBlock.protectedBlock.m_samples[m_sampleIndex],
+            memcpy((char *) &m_blockSamples[m_sampleIndex],
                     (const char *) &(*it),
                     inRemainingSamples * sizeof(Sample));
             m_sampleIndex += inRemainingSamples;
@@ -153,24 +218,27 @@ void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunk
         }
         else // complete super block and initiate the next if not end of frame
         {
-            memcpy((char *) &m_superBlock.protectedBlock.m_samples[m_sampleIndex],
+            memcpy((char *) &m_blockSamples[m_sampleIndex],
                     (const char *) &(*it),
-                    (samplesPerBlock - m_sampleIndex) * sizeof(Sample));
-            it += samplesPerBlock - m_sampleIndex;
+                    (m_samplesPerBlock - m_sampleIndex) * sizeof(Sample));
+            it += m_samplesPerBlock - m_sampleIndex;
             m_sampleIndex = 0;
 
-            m_superBlock.header.frameIndex = m_frameCount;
-            m_superBlock.header.blockIndex = m_txBlockIndex;
-            m_txBlocks[m_txBlocksIndex][m_txBlockIndex] =  m_superBlock;
+            SuperBlock& txBlock = getTxBlock(m_txBlockIndex);
+            txBlock.header.frameIndex = m_frameCount;
+            txBlock.header.blockIndex = m_txBlockIndex;
+            txBlock.header.filler = m_filler;
+            uint32_t packedSize = IQPacker::pack(m_encoding, m_blockSamples, txBlock.protectedBlock.m_buf, m_samplesPerBlock, SDR_TX_SAMP_SZ);
+            memset((char *) &txBlock.protectedBlock.m_buf[packedSize], 0, m_udpSize - sizeof(Header) - packedSize); // spare bytes
 
             if (m_txBlockIndex == m_nbOriginalBlocks - 1) // frame complete
             {
-                int nbBlocksFEC = m_nbBlocksFEC;
+                int nbBlocksFEC = m_frameNbBlocksFEC;
                 int txDelay = m_txDelay;
 
                 // TODO: send blocks
                 //qDebug("UDPSinkFEC::write: push frame to worker: %u", m_frameCount);
-                m_udpWorker->pushTxFrame(m_txBlocks[m_txBlocksIndex], nbBlocksFEC, txDelay, m_frameCount);
+                m_udpWorker->pushTxFrame(m_txFrames[m_txBlocksIndex], nbBlocksFEC, txDelay, m_frameCount, m_udpSize);
                 //m_txThread = new std::thread(transmitUDP, this, m_txBlocks[m_txBlocksIndex], m_frameCount, nbBlocksFEC, txDelay, m_cm256Valid);
                 //transmitUDP(this, m_txBlocks[m_txBlocksIndex], m_frameCount, m_nbBlocksFEC, m_txDelay, m_cm256Valid);
 
@@ -188,9 +256,27 @@ void UDPSinkFEC::write(const SampleVector::iterator& begin, uint32_t sampleChunk
 
 UDPSinkFECWorker::UDPSinkFECWorker() :
         m_running(false),
-        m_remotePort(9090)
+        m_socket(0),
+        m_remotePort(9090),
+        m_pacerTimeNs(0),
+        m_maxNbBlocksFEC(0),
+        m_adaptiveNbBlocksFEC(m_noFECReport),
+        m_fecReportTimeNs(0),
+        m_nbFECDecreaseReports(0)
 {
     m_cm256Valid = m_cm256.isInitialized();
+    m_fecBlocks = 0;
+    m_fecBlockSize = 0;
+
+    try
+    {
+        m_socket = new UDPSocket();
+    }
+    catch (CSocketException& e)
+    {
+        qWarning("UDPSinkFECWorker::UDPSinkFECWorker: %s", e.what());
+    }
+
     connect(&m_inputMessageQueue, SIGNAL(messageEnqueued()), this, SLOT(handleInputMessages()), Qt::DirectConnection);
 }
 
@@ -198,20 +284,23 @@ UDPSinkFECWorker::~UDPSinkFECWorker()
 {
     disconnect(&m_inputMessageQueue, SIGNAL(messageEnqueued()), this, SLOT(handleInputMessages()));
     m_inputMessageQueue.clear();
+    delete m_socket;
+    delete[] m_fecBlocks;
 }
 
-void UDPSinkFECWorker::pushTxFrame(UDPSinkFEC::SuperBlock *txBlocks,
+void UDPSinkFECWorker::pushTxFrame(uint8_t *txFrame,
     uint32_t nbBlocksFEC,
     uint32_t txDelay,
-    uint16_t frameIndex)
+    uint16_t frameIndex,
+    uint32_t udpSize)
 {
     //qDebug("UDPSinkFECWorker::pushTxFrame. %d", m_inputMessageQueue.size());
-    m_inputMessageQueue.push(MsgUDPFECEncodeAndSend::create(txBlocks, nbBlocksFEC, txDelay, frameIndex));
+    m_inputMessageQueue.push(MsgUDPFECEncodeAndSend::create(txFrame, nbBlocksFEC, txDelay, frameIndex, udpSize));
 }
 
-void UDPSinkFECWorker::setRemoteAddress(const QString& address, uint16_t port)
+void UDPSinkFECWorker::setRemoteAddress(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface)
 {
-    m_inputMessageQueue.push(MsgConfigureRemoteAddress::create(address, port));
+    m_inputMessageQueue.push(MsgConfigureRemoteAddress::create(address, port, multicastTTL, multicastInterface));
 }
 
 void UDPSinkFECWorker::process()
@@ -223,6 +312,7 @@ void UDPSinkFECWorker::process()
     while (m_running)
     {
         usleep(250000);
+        readFECReports();
     }
 
     qDebug("UDPSinkFECWorker::process: stopped");
@@ -243,59 +333,61 @@ void UDPSinkFECWorker::handleInputMessages()
         if (MsgUDPFECEncodeAndSend::match(*message))
         {
             MsgUDPFECEncodeAndSend *sendMsg = (MsgUDPFECEncodeAndSend *) message;
-            encodeAndTransmit(sendMsg->getTxBlocks(), sendMsg->getFrameIndex(), sendMsg->getNbBlocsFEC(), sendMsg->getTxDelay());
+            encodeAndTransmit(sendMsg->getTxFrame(), sendMsg->getFrameIndex(), sendMsg->getNbBlocsFEC(), sendMsg->getTxDelay(), sendMsg->getUdpSize());
         }
         else if (MsgConfigureRemoteAddress::match(*message))
         {
             qDebug("UDPSinkFECWorker::handleInputMessages: %s", message->getIdentifier());
             MsgConfigureRemoteAddress *addressMsg = (MsgConfigureRemoteAddress *) message;
-            m_remoteAddress = addressMsg->getAddress();
-            m_remotePort = addressMsg->getPort();
+            configureSocket(*addressMsg);
         }
 
         delete message;
     }
 }
 
-void UDPSinkFECWorker::encodeAndTransmit(UDPSinkFEC::SuperBlock *txBlockx, uint16_t frameIndex, uint32_t nbBlocksFEC, uint32_t txDelay)
+void UDPSinkFECWorker::encodeAndTransmit(uint8_t *txFrame, uint16_t frameIndex, uint32_t nbBlocksFEC, uint32_t txDelay, uint32_t udpSize)
 {
     CM256::cm256_encoder_params cm256Params;  //!< Main interface with CM256 encoder
     CM256::cm256_block descriptorBlocks[256]; //!< Pointers to data for CM256 encoder
-    UDPSinkFEC::ProtectedBlock fecBlocks[256];   //!< FEC data
+    int blockSize = udpSize - sizeof(UDPSinkFEC::Header); // only this part of the blocks is sent
 
     if ((nbBlocksFEC == 0) || !m_cm256Valid)
     {
 //        qDebug("UDPSinkFECWorker::encodeAndTransmit: transmit frame without FEC to %s:%d", m_remoteAddress.toStdString().c_str(), m_remotePort);
-
-        for (unsigned int i = 0; i < UDPSinkFEC::m_nbOriginalBlocks; i++)
-        {
-            m_socket.SendDataGram((const void *) &txBlockx[i], (int) UDPSinkFEC::m_udpSize, m_remoteAddress.toStdString(), (uint32_t) m_remotePort);
-            //m_udpSocket->writeDatagram((const char *) &txBlockx[i], (int) UDPSinkFEC::m_udpSize, m_remoteAddress, m_remotePort);
-            usleep(txDelay);
-        }
+        transmitBlocks(txFrame, UDPSinkFEC::m_nbOriginalBlocks, udpSize, txDelay);
     }
     else
     {
-        cm256Params.BlockBytes = sizeof(UDPSinkFEC::ProtectedBlock);
+        cm256Params.BlockBytes = blockSize;
         cm256Params.OriginalCount = UDPSinkFEC::m_nbOriginalBlocks;
         cm256Params.RecoveryCount = nbBlocksFEC;
 
+        if (blockSize != m_fecBlockSize) // datagram size changed
+        {
+            delete[] m_fecBlocks;
+            m_fecBlocks = new uint8_t[256 * blockSize];
+            m_fecBlockSize = blockSize;
+        }
 
         // Fill pointers to data
         for (int i = 0; i < cm256Params.OriginalCount + cm256Params.RecoveryCount; ++i)
         {
+            UDPSinkFEC::SuperBlock *txBlock = (UDPSinkFEC::SuperBlock *) &txFrame[i * udpSize];
+
             if (i >= cm256Params.OriginalCount) {
-                memset((char *) &txBlockx[i].protectedBlock, 0, sizeof(UDPSinkFEC::ProtectedBlock));
+                memset((char *) &txBlock->protectedBlock, 0, blockSize);
             }
 
-            txBlockx[i].header.frameIndex = frameIndex;
-            txBlockx[i].header.blockIndex = i;
-            descriptorBlocks[i].Block = (void *) &(txBlockx[i].protectedBlock);
-            descriptorBlocks[i].Index = txBlockx[i].header.blockIndex;
+            txBlock->header.frameIndex = frameIndex;
+            txBlock->header.blockIndex = i;
+            txBlock->header.filler = ((UDPSinkFEC::SuperBlock *) txFrame)->header.filler;
+            descriptorBlocks[i].Block = (void *) &(txBlock->protectedBlock);
+            descriptorBlocks[i].Index = txBlock->header.blockIndex;
         }
 
         // Encode FEC blocks
-        if (m_cm256.cm256_encode(cm256Params, descriptorBlocks, fecBlocks))
+        if (m_cm256.cm256_encode(cm256Params, descriptorBlocks, m_fecBlocks))
         {
             qDebug("UDPSinkFECWorker::encodeAndTransmit: CM256 encode failed. No transmission.");
             return;
@@ -304,37 +396,228 @@ void UDPSinkFECWorker::encodeAndTransmit(UDPSinkFEC::SuperBlock *txBlockx, uint1
         // Merge FEC with data to transmit
         for (int i = 0; i < cm256Params.RecoveryCount; i++)
         {
-            txBlockx[i + cm256Params.OriginalCount].protectedBlock = fecBlocks[i];
+            UDPSinkFEC::SuperBlock *txBlock = (UDPSinkFEC::SuperBlock *) &txFrame[(i + cm256Params.OriginalCount) * udpSize];
+            memcpy((char *) &txBlock->protectedBlock, &m_fecBlocks[i * blockSize], blockSize);
         }
 
         // Transmit all blocks
 
 //        qDebug("UDPSinkFECWorker::encodeAndTransmit: transmit frame with FEC to %s:%d", m_remoteAddress.toStdString().c_str(), m_remotePort);
+        transmitBlocks(txFrame, cm256Params.OriginalCount + cm256Params.RecoveryCount, udpSize, txDelay);
+    }
+}
+
+void UDPSinkFECWorker::transmitBlocks(uint8_t *txFrame, int nbBlocks, uint32_t udpSize, uint32_t txDelay)
+{
+    const void *datagrams[m_maxBurst];
+    // number of datagrams sent at once: enough to wait at least m_minWaitNs between bursts as shorter
+    // waits are not accurate. The average rate is kept by the pacer.
+    int burst = m_maxBurst;
 
-        for (int i = 0; i < cm256Params.OriginalCount + cm256Params.RecoveryCount; i++)
+    if ((txDelay > 0) && ((uint64_t) txDelay * m_maxBurst > (uint64_t) m_minWaitNs)) {
+        burst = (m_minWaitNs + txDelay - 1) / txDelay;
+    }
+
+    int i = 0;
+
+    while (i < nbBlocks)
+    {
+        int nbDatagrams = 0;
+
+        for (; (i < nbBlocks) && (nbDatagrams < burst); i++)
         {
 #ifdef SDRDAEMON_PUNCTURE
             if (i == SDRDAEMON_PUNCTURE) {
                 continue;
             }
 #endif
-//            std::cerr << "UDPSinkFEC::transmitUDP:"
-//                  << " i: " << i
-//                  << " frameIndex: " << (int) m_txBlocks[i].header.frameIndex
-//                  << " blockIndex: " << (int) m_txBlocks[i].header.blockIndex
-//                  << " i.q:";
-//
-//            for (int j = 0; j < 10; j++)
-//            {
-//                std::cerr << " " << (int) m_txBlocks[i].protectedBlock.m_samples[j].m_real
-//                        << "." << (int) m_txBlocks[i].protectedBlock.m_samples[j].m_imag;
-//            }
-//
-//            std::cerr << std::endl;
-
-            m_socket.SendDataGram((const void *) &txBlockx[i], (int) UDPSinkFEC::m_udpSize, m_remoteAddress.toStdString(), (uint32_t) m_remotePort);
-            //m_udpSocket->writeDatagram((const char *) &txBlockx[i], (int) UDPSinkFEC::m_udpSize, m_remoteAddress, m_remotePort);
-            usleep(txDelay);
+            datagrams[nbDatagrams++] = (const void *) &txFrame[i * udpSize];
+        }
+
+        if (txDelay > 0) {
+            waitForTokens(nbDatagrams, txDelay, burst);
+        }
+
+        QMutexLocker mutexLocker(&m_socketMutex);
+
+        if (!m_socket) {
+            return;
+        }
+
+        try
+        {
+            m_socket->SendDataGrams(datagrams, nbDatagrams, (int) udpSize, m_remoteAddress.toStdString(), (uint32_t) m_remotePort);
+        }
+        catch (CSocketException& e)
+        {
+            qWarning("UDPSinkFECWorker::transmitBlocks: %s", e.what());
+            return;
+        }
+    }
+}
+
+void UDPSinkFECWorker::waitForTokens(int nbDatagrams, uint32_t txDelay, int burst)
+{
+    // Token bucket: a token is added every txDelay nanoseconds and sending a datagram takes one.
+    // m_pacerTimeNs is the time when the bucket has enough tokens for the next datagram. The bucket
+    // holds at least a burst or m_minBucketNs worth of tokens so that late wake ups are caught up.
+    int64_t nowNs = getMonotonicTimeNs();
+    int64_t bucketNs = (int64_t) burst * txDelay;
+
+    if (bucketNs < m_minBucketNs) {
+        bucketNs = m_minBucketNs;
+    }
+
+    if (m_pacerTimeNs < nowNs - bucketNs) { // idle: the bucket is full
+        m_pacerTimeNs = nowNs - bucketNs;
+    }
+
+    if (m_pacerTimeNs > nowNs)
+    {
+#ifdef __linux__
+        struct timespec wakeUp;
+        wakeUp.tv_sec = m_pacerTimeNs / 1000000000LL;
+        wakeUp.tv_nsec = m_pacerTimeNs % 1000000000LL;
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeUp, 0) == EINTR) {}
+#else
+        usleep((m_pacerTimeNs - nowNs) / 1000);
+#endif
+    }
+
+    m_pacerTimeNs += (int64_t) nbDatagrams * txDelay;
+}
+
+void UDPSinkFECWorker::configureSocket(const MsgConfigureRemoteAddress& addressMsg)
+{
+    QMutexLocker mutexLocker(&m_socketMutex);
+    std::string address = addressMsg.getAddress().toStdString();
+
+    m_remoteAddress = addressMsg.getAddress();
+    m_remotePort = addressMsg.getPort();
+
+    try
+    {
+        // the socket must be of the destination's family
+        CSocket::NetworkLayerProtocol protocol = UDPSocket::GetAddressProtocol(address);
+
+        if (!m_socket || (m_socket->GetProtocol() != protocol))
+        {
+            delete m_socket;
+            m_socket = 0;
+            m_socket = new UDPSocket(protocol);
         }
+
+        // one send serves all the receivers that joined the group
+        if (UDPSocket::IsMulticastAddress(address))
+        {
+            m_socket->SetMulticastTTL(addressMsg.getMulticastTTL() > 255 ? 255 : addressMsg.getMulticastTTL());
+            m_socket->SetMulticastInterface(addressMsg.getMulticastInterface().toStdString());
+        }
+    }
+    catch (CSocketException& e)
+    {
+        qWarning("UDPSinkFECWorker::configureSocket: %s: %s", address.c_str(), e.what());
     }
 }
+
+uint32_t UDPSinkFECWorker::getAdaptiveNbBlocksFEC() const
+{
+    uint32_t maxNbBlocksFEC = m_maxNbBlocksFEC;
+    uint32_t adaptiveNbBlocksFEC = m_adaptiveNbBlocksFEC;
+    return adaptiveNbBlocksFEC < maxNbBlocksFEC ? adaptiveNbBlocksFEC : maxNbBlocksFEC;
+}
+
+void UDPSinkFECWorker::readFECReports()
+{
+    UDPSinkFEC::FECReport report;
+    // a report plus one byte to spot larger datagrams plus the zero RecvDataGram appends to the data
+    uint8_t buf[sizeof(UDPSinkFEC::FECReport) + 2];
+    std::string address;
+    unsigned short port;
+    int nbBytes;
+    QMutexLocker mutexLocker(&m_socketMutex);
+
+    try
+    {
+        for (int i = 0; (i < m_maxFECReportsPerPoll) && m_socket; i++) // a flood of datagrams does not hold the socket
+        {
+            if ((nbBytes = m_socket->RecvDataGram(buf, sizeof(buf) - 1, address, port, false)) < 0) {
+                break;
+            }
+
+            if (nbBytes != sizeof(UDPSinkFEC::FECReport)) {
+                continue;
+            }
+
+            memcpy(&report, buf, sizeof(UDPSinkFEC::FECReport));
+            boost::crc_32_type crc32;
+            crc32.process_bytes(&report, 16);
+
+            if ((report.m_magic == UDPSinkFEC::m_fecReportMagic) && (crc32.checksum() == report.m_crc32)) {
+                processFECReport(report);
+            }
+        }
+    }
+    catch (CSocketException& e)
+    {
+        qWarning("UDPSinkFECWorker::readFECReports: %s", e.what());
+    }
+
+    // without reports (receiver not reporting or back channel lost) play safe
+    if ((m_adaptiveNbBlocksFEC != m_noFECReport) && (getMonotonicTimeNs() - m_fecReportTimeNs > m_fecReportTimeoutNs))
+    {
+        qDebug("UDPSinkFECWorker::readFECReports: no loss report: back to the largest number of FEC blocks");
+        m_adaptiveNbBlocksFEC = m_noFECReport;
+        m_nbFECDecreaseReports = 0;
+    }
+}
+
+void UDPSinkFECWorker::processFECReport(const UDPSinkFEC::FECReport& report)
+{
+    // Protect against the worst frame of the period with a margin of half its losses. More
+    // blocks are added at once while they are removed one at a time after several reports
+    // with fewer losses so that the redundancy stays in place through bursts of losses.
+    int maxNbBlocksFEC = m_maxNbBlocksFEC;
+    int nbBlocksFEC = getAdaptiveNbBlocksFEC();
+    int nbLostBlocks = report.m_maxNbLostBlocks;
+    int targetNbBlocksFEC = nbLostBlocks + (nbLostBlocks < 2 ? 1 : nbLostBlocks / 2);
+
+    if (targetNbBlocksFEC > maxNbBlocksFEC) {
+        targetNbBlocksFEC = maxNbBlocksFEC;
+    }
+
+    if (targetNbBlocksFEC >= nbBlocksFEC)
+    {
+        nbBlocksFEC = targetNbBlocksFEC;
+        m_nbFECDecreaseReports = 0;
+    }
+    else if (++m_nbFECDecreaseReports >= m_fecDecreaseReports)
+    {
+        nbBlocksFEC--;
+        m_nbFECDecreaseReports = 0;
+    }
+
+    if (nbBlocksFEC != (int) m_adaptiveNbBlocksFEC)
+    {
+        qDebug("UDPSinkFECWorker::processFECReport: frame: %u frames: %u lost: %u max lost: %u unrecoverable: %u FEC: %u -> %d",
+                report.m_frameIndex, report.m_nbFrames, report.m_nbLostBlocks, report.m_maxNbLostBlocks,
+                report.m_nbUnrecoverable, report.m_nbFECBlocks, nbBlocksFEC);
+    }
+
+    m_adaptiveNbBlocksFEC = nbBlocksFEC;
+    m_fecReportTimeNs = getMonotonicTimeNs();
+}
+
+int64_t UDPSinkFECWorker::getMonotonicTimeNs()
+{
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000000000LL + tv.tv_usec * 1000LL;
+#endif
+}
@@ -24,10 +24,12 @@
 #include <QHostAddress>
 #include <QString>
 #include <QThread>
+#include <QMutex>
 
 #include "cm256.h"
 
 #include "dsp/dsptypes.h"
+#include "dsp/iqpacker.h"
 #include "util/CRC64.h"
 #include "util/messagequeue.h"
 #include "util/message.h"
@@ -40,7 +42,8 @@ class UDPSinkFEC : public QObject
 {
     Q_OBJECT
 public:
-    static const uint32_t m_udpSize = 512;          //!< Size of UDP block in number of bytes
+    static const uint32_t m_udpSizeMin = 512;       //!< Smallest and default size of UDP block in number of bytes
+    static const uint32_t m_udpSizeMax = 8192;      //!< Largest size of UDP block in number of bytes (jumbo frames)
     static const uint32_t m_nbOriginalBlocks = 128; //!< Number of original blocks in a protected block sequence
 #pragma pack(push, 1)
     struct MetaDataFEC
@@ -54,6 +57,7 @@ public:
         uint32_t m_tv_sec;            //!< 16 seconds of timestamp at start time of super-frame processing
         uint32_t m_tv_usec;           //!< 20 microseconds of timestamp at start time of super-frame processing
         uint32_t m_crc32;             //!< 24 CRC32 of the above
+        uint16_t m_udpSize;           //!< 26 size of the datagrams in bytes (not covered by CRC so that older receivers still check it)
 
         bool operator==(const MetaDataFEC& rhs)
         {
@@ -71,14 +75,29 @@ public:
     {
         uint16_t frameIndex;
         uint8_t  blockIndex;
-        uint8_t  filler;
+        uint8_t  filler;      //!< bit 0: the sender wants loss reports (see FECReport)
     };
 
-    static const int samplesPerBlock = (m_udpSize - sizeof(Header)) / sizeof(Sample);
+    /** Loss statistics sent back by the receiver to the source address of the datagrams */
+    struct FECReport
+    {
+        uint32_t m_magic;             //!<  4 m_fecReportMagic
+        uint16_t m_frameIndex;        //!<  6 last frame received
+        uint16_t m_nbFrames;          //!<  8 number of frames received since the last report
+        uint32_t m_nbLostBlocks;      //!< 12 total number of blocks lost in these frames
+        uint8_t  m_nbFECBlocks;       //!< 13 number of FEC blocks of the last frame
+        uint8_t  m_maxNbLostBlocks;   //!< 14 largest number of blocks lost in a frame
+        uint16_t m_nbUnrecoverable;   //!< 16 number of frames with more blocks lost than FEC blocks
+        uint32_t m_crc32;             //!< 20 CRC32 of the above
+    };
+
+    static const uint32_t m_fecReportMagic = 0x52434546; //!< "FECR"
+
+    static const int m_samplesPerBlockMax = (m_udpSizeMax - sizeof(Header)) / 2; //!< Most samples in a block (8 bit encoding)
 
     struct ProtectedBlock
     {
-        Sample m_samples[samplesPerBlock];
+        uint8_t m_buf[m_udpSizeMax - sizeof(Header)]; //!< Room for the largest blocks. Only udpSize - sizeof(Header) bytes are allocated in the frames
     };
 
     struct SuperBlock
@@ -115,12 +134,13 @@ public:
     /** Set sample rate given in Hz */
     void setSampleRate(uint32_t sampleRate) { m_sampleRate = sampleRate; }
 
-    void setSampleBytes(uint8_t sampleBytes) { m_sampleBytes = (sampleBytes & 0x0F) + (m_sampleBytes & 0xF0); }
-    void setSampleBits(uint8_t sampleBits) { m_sampleBits = sampleBits; }
-
-    void setNbBlocksFEC(uint32_t nbBlocksFEC);
-    void setTxDelay(uint32_t txDelay);
-    void setRemoteAddress(const QString& address, uint16_t port);
+    void setNbBlocksFEC(uint32_t nbBlocksFEC); //!< Largest number of FEC blocks when adaptive
+    void setAdaptiveFEC(bool adaptiveFEC);     //!< Adapt the number of FEC blocks to the losses reported by the receiver
+    uint32_t getNbBlocksFEC() const { return m_frameNbBlocksFEC; } //!< Number of FEC blocks of the current frame
+    void setTxDelay(uint32_t txDelay); //!< Nanoseconds between two datagrams
+    void setUdpSize(uint32_t udpSize); //!< Takes effect at the next frame
+    void setPayloadEncoding(IQPacker::Encoding encoding); //!< Takes effect at the next frame
+    void setRemoteAddress(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface);
 
     /** Return true if the stream is OK, return false if there is an error. */
     operator bool() const
@@ -133,8 +153,6 @@ private:
 
     uint32_t     m_centerFrequency;   //!< center frequency in kHz
     uint32_t     m_sampleRate;        //!< sample rate in Hz
-    uint8_t      m_sampleBytes;       //!< number of bytes per sample
-    uint8_t      m_sampleBits;        //!< number of effective bits per sample
     uint32_t     m_nbSamples;         //!< total number of samples sent int the last frame
 
     QHostAddress m_ownAddress;
@@ -144,10 +162,19 @@ private:
     uint8_t*     m_buf;
 
     MetaDataFEC m_currentMetaFEC;        //!< Meta data for current frame
-    uint32_t m_nbBlocksFEC;              //!< Variable number of FEC blocks
-    uint32_t m_txDelay;                  //!< Delay in microseconds (usleep) between each sending of an UDP datagram
-    SuperBlock m_txBlocks[4][256];       //!< UDP blocks to send with original data + FEC
-    SuperBlock m_superBlock;             //!< current super block being built
+    uint32_t m_nbBlocksFEC;              //!< Variable number of FEC blocks (the largest when adaptive)
+    bool m_adaptiveFEC;                  //!< The number of FEC blocks follows the loss reports
+    uint32_t m_frameNbBlocksFEC;         //!< Number of FEC blocks of the current frame
+    uint8_t m_filler;                    //!< Header filler of the blocks of the current frame
+    uint32_t m_txDelay;                  //!< Delay in nanoseconds between each sending of an UDP datagram (0 for no pacing)
+    uint32_t m_udpSize;                  //!< Size of the UDP datagrams of the current frame
+    uint32_t m_nextUdpSize;              //!< Size of the UDP datagrams from the next frame
+    IQPacker::Encoding m_encoding;       //!< Encoding of the samples of the current frame
+    IQPacker::Encoding m_nextEncoding;   //!< Encoding of the samples from the next frame
+    int m_samplesPerBlock;               //!< Number of samples in a block of the current frame
+    uint8_t *m_txFrames[4];              //!< UDP blocks to send with original data + FEC, one every m_udpSize bytes
+    uint32_t m_txFramesUdpSize[4];       //!< Datagram size the frames are allocated for
+    Sample m_blockSamples[m_samplesPerBlockMax]; //!< samples of the current block before they are packed
     int m_txBlockIndex;                  //!< Current index in blocks to transmit in the Tx row
     int m_txBlocksIndex;                 //!< Current index of Tx blocks row
     uint16_t m_frameCount;               //!< transmission frame count
@@ -155,6 +182,9 @@ private:
 
     QThread *m_udpThread;
     UDPSinkFECWorker *m_udpWorker;
+
+    void allocateTxFrame(); //!< Size the current frame for the datagram size of the frame
+    SuperBlock& getTxBlock(int blockIndex) { return *((SuperBlock *) &m_txFrames[m_txBlocksIndex][blockIndex * m_udpSize]); }
 };
 
 
@@ -166,35 +196,40 @@ public:
     {
         MESSAGE_CLASS_DECLARATION
     public:
-        UDPSinkFEC::SuperBlock *getTxBlocks() const { return m_txBlockx; }
+        uint8_t *getTxFrame() const { return m_txFrame; }
         uint32_t getNbBlocsFEC() const { return m_nbBlocksFEC; }
         uint32_t getTxDelay() const { return m_txDelay; }
         uint16_t getFrameIndex() const { return m_frameIndex; }
+        uint32_t getUdpSize() const { return m_udpSize; }
 
         static MsgUDPFECEncodeAndSend* create(
-                UDPSinkFEC::SuperBlock *txBlocks,
+                uint8_t *txFrame,
                 uint32_t nbBlocksFEC,
                 uint32_t txDelay,
-                uint16_t frameIndex)
+                uint16_t frameIndex,
+                uint32_t udpSize)
         {
-            return new MsgUDPFECEncodeAndSend(txBlocks, nbBlocksFEC, txDelay, frameIndex);
+            return new MsgUDPFECEncodeAndSend(txFrame, nbBlocksFEC, txDelay, frameIndex, udpSize);
         }
 
     private:
-        UDPSinkFEC::SuperBlock *m_txBlockx;
+        uint8_t *m_txFrame;
         uint32_t m_nbBlocksFEC;
         uint32_t m_txDelay;
         uint16_t m_frameIndex;
+        uint32_t m_udpSize;
 
         MsgUDPFECEncodeAndSend(
-                UDPSinkFEC::SuperBlock *txBlocks,
+                uint8_t *txFrame,
                 uint32_t nbBlocksFEC,
                 uint32_t txDelay,
-                uint16_t frameIndex) :
-            m_txBlockx(txBlocks),
+                uint16_t frameIndex,
+                uint32_t udpSize) :
+            m_txFrame(txFrame),
             m_nbBlocksFEC(nbBlocksFEC),
             m_txDelay(txDelay),
-            m_frameIndex(frameIndex)
+            m_frameIndex(frameIndex),
+            m_udpSize(udpSize)
         {}
     };
 
@@ -204,30 +239,39 @@ public:
     public:
         const QString& getAddress() const { return m_address; }
         uint16_t getPort() const { return m_port; }
+        uint32_t getMulticastTTL() const { return m_multicastTTL; }
+        const QString& getMulticastInterface() const { return m_multicastInterface; }
 
-        static MsgConfigureRemoteAddress* create(const QString& address, uint16_t port)
+        static MsgConfigureRemoteAddress* create(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface)
         {
-            return new MsgConfigureRemoteAddress(address, port);
+            return new MsgConfigureRemoteAddress(address, port, multicastTTL, multicastInterface);
         }
 
     private:
         QString m_address;
         uint16_t m_port;
+        uint32_t m_multicastTTL;
+        QString m_multicastInterface;
 
-        MsgConfigureRemoteAddress(const QString& address, uint16_t port) :
+        MsgConfigureRemoteAddress(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface) :
             m_address(address),
-            m_port(port)
+            m_port(port),
+            m_multicastTTL(multicastTTL),
+            m_multicastInterface(multicastInterface)
         {}
     };
 
     UDPSinkFECWorker();
     ~UDPSinkFECWorker();
 
-    void pushTxFrame(UDPSinkFEC::SuperBlock *txBlocks,
+    void pushTxFrame(uint8_t *txFrame,
         uint32_t nbBlocksFEC,
         uint32_t txDelay,
-        uint16_t frameIndex);
-    void setRemoteAddress(const QString& address, uint16_t port);
+        uint16_t frameIndex,
+        uint32_t udpSize);
+    void setRemoteAddress(const QString& address, uint16_t port, uint32_t multicastTTL, const QString& multicastInterface);
+    void setMaxNbBlocksFEC(uint32_t nbBlocksFEC) { m_maxNbBlocksFEC = nbBlocksFEC; }
+    uint32_t getAdaptiveNbBlocksFEC() const; //!< Number of FEC blocks following the loss reports
     void stop();
 
     MessageQueue m_inputMessageQueue;    //!< Queue for asynchronous inbound communication
@@ -242,14 +286,36 @@ private slots:
     void handleInputMessages();
 
 private:
-    void encodeAndTransmit(UDPSinkFEC::SuperBlock *txBlockx, uint16_t frameIndex, uint32_t nbBlocksFEC, uint32_t txDelay);
+    void encodeAndTransmit(uint8_t *txFrame, uint16_t frameIndex, uint32_t nbBlocksFEC, uint32_t txDelay, uint32_t udpSize);
+    void transmitBlocks(uint8_t *txFrame, int nbBlocks, uint32_t udpSize, uint32_t txDelay);
+    void waitForTokens(int nbDatagrams, uint32_t txDelay, int burst); //!< Pacer: waits until the datagrams can be sent
+    void configureSocket(const MsgConfigureRemoteAddress& addressMsg);
+    void readFECReports();
+    void processFECReport(const UDPSinkFEC::FECReport& report);
+    static int64_t getMonotonicTimeNs();
+
+    static const int m_maxBurst = 64;        //!< Most datagrams sent with one system call
+    static const int m_minWaitNs = 100000;   //!< Shortest wait of the pacer
+    static const int m_minBucketNs = 1000000; //!< Smallest capacity of the pacer token bucket in time
+    static const int64_t m_fecReportTimeoutNs = 5000000000LL; //!< Back to the largest number of FEC blocks without reports
+    static const int m_fecDecreaseReports = 5; //!< Reports with fewer losses before removing a FEC block
+    static const uint32_t m_noFECReport = 255; //!< Adaptive number of FEC blocks without reports (capped by the largest)
+    static const int m_maxFECReportsPerPoll = 4; //!< Most datagrams read from the back channel at each poll
 
     volatile bool m_running;
     CM256 m_cm256;                       //!< CM256 library object
     bool m_cm256Valid;                   //!< true if CM256 library is initialized correctly
-    UDPSocket    m_socket;
+    uint8_t *m_fecBlocks;                //!< FEC data (recovery blocks one after the other)
+    int m_fecBlockSize;                  //!< Size of the blocks m_fecBlocks is allocated for
+    UDPSocket    *m_socket;              //!< Replaced when the destination changes from IPv4 to IPv6 or back
     QString      m_remoteAddress;
     uint16_t     m_remotePort;
+    QMutex       m_socketMutex;          //!< Socket and destination are changed and used from different threads
+    int64_t      m_pacerTimeNs;          //!< Monotonic time when the next datagram can be sent
+    volatile uint32_t m_maxNbBlocksFEC;      //!< Largest number of FEC blocks
+    volatile uint32_t m_adaptiveNbBlocksFEC; //!< Number of FEC blocks following the loss reports
+    int64_t      m_fecReportTimeNs;      //!< Monotonic time of the last loss report
+    int          m_nbFECDecreaseReports; //!< Consecutive reports allowing fewer FEC blocks
 };
 
 
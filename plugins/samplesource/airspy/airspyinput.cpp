@@ -22,6 +22,7 @@
 #include "SWGDeviceSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGAirspyReport.h"
 
 #include "airspyinput.h"
@@ -707,6 +708,9 @@ int AirspyInput::webapiReportGet(
     response.setAirspyReport(new SWGSDRangel::SWGAirspyReport());
     response.getAirspyReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
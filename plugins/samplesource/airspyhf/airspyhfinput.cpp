@@ -21,6 +21,7 @@
 #include "SWGDeviceSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGAirspyHFReport.h"
 
 #include <device/devicesourceapi.h>
@@ -575,6 +576,9 @@ int AirspyHFInput::webapiReportGet(
     response.setAirspyHfReport(new SWGSDRangel::SWGAirspyHFReport());
     response.getAirspyHfReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
@@ -30,12 +30,14 @@ SOURCES += filesourcegui.cpp\
 	filesourceinput.cpp\
 	filesourceplugin.cpp\
 	filesourcethread.cpp\
+	filesourcemap.cpp\
 	filesourcesettings.cpp
 
 HEADERS += filesourcegui.h\
 	filesourceinput.h\
 	filesourceplugin.h\
 	filesourcethread.h\
+	filesourcemap.h\
 	filesourcesettings.h
 
 FORMS += filesourcegui.ui
@@ -49,6 +49,7 @@ FileSourceGui::FileSourceGui(DeviceUISet *deviceUISet, QWidget* parent) :
 	m_recordLength(0),
 	m_startingTimeStamp(0),
 	m_samplesCount(0),
+	m_elapsedNs(0),
 	m_tickCount(0),
 	m_enableNavTime(false),
 	m_lastEngineState(DSPDeviceSourceEngine::StNotStarted)
@@ -186,6 +187,7 @@ bool FileSourceGui::handleMessage(const Message& message)
 	else if (FileSourceInput::MsgReportFileSourceStreamTiming::match(message))
 	{
 		m_samplesCount = ((FileSourceInput::MsgReportFileSourceStreamTiming&)message).getSamplesCount();
+		m_elapsedNs = ((FileSourceInput::MsgReportFileSourceStreamTiming&)message).getElapsedNs();
 		updateWithStreamTime();
 		return true;
 	}
@@ -213,10 +215,16 @@ void FileSourceGui::updateSampleRateAndFrequency()
 
 void FileSourceGui::displaySettings()
 {
+	ui->freeRun->setChecked(m_settings.m_freeRun);
 }
 
 void FileSourceGui::sendSettings()
 {
+	if (m_doApplySettings)
+	{
+		FileSourceInput::MsgConfigureFileSource* message = FileSourceInput::MsgConfigureFileSource::create(m_settings);
+		m_sampleSource->getInputMessageQueue()->push(message);
+	}
 }
 
 void FileSourceGui::on_playLoop_toggled(bool checked __attribute__((unused)))
@@ -270,6 +278,12 @@ void FileSourceGui::on_play_toggled(bool checked)
 	m_enableNavTime = !checked;
 }
 
+void FileSourceGui::on_freeRun_toggled(bool checked)
+{
+	m_settings.m_freeRun = checked;
+	sendSettings();
+}
+
 void FileSourceGui::on_navTimeSlider_valueChanged(int value)
 {
 	if (m_enableNavTime && ((value >= 0) && (value <= 100)))
@@ -283,10 +297,17 @@ void FileSourceGui::on_navTimeSlider_valueChanged(int value)
 	}
 }
 
+void FileSourceGui::on_seekTime_editingFinished()
+{
+	qint64 timestampNs = ui->seekTime->dateTime().toMSecsSinceEpoch() * 1000000LL;
+	FileSourceInput::MsgConfigureFileSourceSeekTime* message = FileSourceInput::MsgConfigureFileSourceSeekTime::create(timestampNs);
+	m_sampleSource->getInputMessageQueue()->push(message);
+}
+
 void FileSourceGui::on_showFileDialog_clicked(bool checked __attribute__((unused)))
 {
 	QString fileName = QFileDialog::getOpenFileName(this,
-	    tr("Open I/Q record file"), ".", tr("SDR I/Q Files (*.sdriq)"), 0, QFileDialog::DontUseNativeDialog);
+	    tr("Open I/Q record file or playlist"), ".", tr("I/Q Files (*.sdriq *.m3u *.cu8 *.cs8 *.cs16 *.cf32 *.raw *.sigmf-data *.wav)"), 0, QFileDialog::DontUseNativeDialog);
 
 	if (fileName != "")
 	{
@@ -308,6 +329,7 @@ void FileSourceGui::updateWithAcquisition()
 	ui->play->setEnabled(m_acquisition);
 	ui->play->setChecked(m_acquisition);
 	ui->showFileDialog->setEnabled(!m_acquisition);
+	ui->seekTime->setEnabled(m_acquisition);
 }
 
 void FileSourceGui::updateWithStreamData()
@@ -320,6 +342,9 @@ void FileSourceGui::updateWithStreamData()
 	recordLength = recordLength.addSecs(m_recordLength);
 	QString s_time = recordLength.toString("HH:mm:ss");
 	ui->recordLengthText->setText(s_time);
+	QDateTime startTime = QDateTime::fromMSecsSinceEpoch((quint64) m_startingTimeStamp * 1000LL);
+	ui->seekTime->setDateTimeRange(startTime, startTime.addSecs(m_recordLength));
+	ui->seekTime->setDateTime(startTime);
 	updateWithStreamTime(); // TODO: remove when time data is implemented
 }
 
@@ -329,8 +354,8 @@ void FileSourceGui::updateWithStreamTime()
 	int t_msec = 0;
 
 	if (m_sampleRate > 0){
-		t_sec = m_samplesCount / m_sampleRate;
-		t_msec = (m_samplesCount - (t_sec * m_sampleRate)) * 1000 / m_sampleRate;
+		t_sec = m_elapsedNs / 1000000000LL;
+		t_msec = (m_elapsedNs % 1000000000LL) / 1000000LL;
 	}
 
 	QTime t(0, 0, 0, 0);
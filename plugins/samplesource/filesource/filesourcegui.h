@@ -68,6 +68,7 @@ private:
 	quint32 m_recordLength;
 	std::time_t m_startingTimeStamp;
 	int m_samplesCount;
+	qint64 m_elapsedNs;
 	std::size_t m_tickCount;
 	bool m_enableNavTime;
     int m_deviceSampleRate;
@@ -90,7 +91,9 @@ private slots:
 	void on_startStop_toggled(bool checked);
 	void on_playLoop_toggled(bool checked);
 	void on_play_toggled(bool checked);
+	void on_freeRun_toggled(bool checked);
 	void on_navTimeSlider_valueChanged(int value);
+	void on_seekTime_editingFinished();
 	void on_showFileDialog_clicked(bool checked);
     void updateStatus();
 	void tick();
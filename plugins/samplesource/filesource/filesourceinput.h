@@ -1,289 +1,350 @@
-///////////////////////////////////////////////////////////////////////////////////
-// Copyright (C) 2015 Edouard Griffiths, F4EXB                                   //
-//                                                                               //
-// This program is free software; you can redistribute it and/or modify          //
-// it under the terms of the GNU General Public License as published by          //
-// the Free Software Foundation as version 3 of the License, or                  //
-//                                                                               //
-// This program is distributed in the hope that it will be useful,               //
-// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
-// GNU General Public License V3 for more details.                               //
-//                                                                               //
-// You should have received a copy of the GNU General Public License             //
-// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
-///////////////////////////////////////////////////////////////////////////////////
-
-#ifndef INCLUDE_FILESOURCEINPUT_H
-#define INCLUDE_FILESOURCEINPUT_H
-
-#include <QString>
-#include <QByteArray>
-#include <QTimer>
-#include <ctime>
-#include <iostream>
-#include <fstream>
-
-#include <dsp/devicesamplesource.h>
-#include "filesourcesettings.h"
-
-class FileSourceThread;
-class DeviceSourceAPI;
-
-class FileSourceInput : public DeviceSampleSource {
-public:
-	class MsgConfigureFileSource : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		const FileSourceSettings& getSettings() const { return m_settings; }
-
-		static MsgConfigureFileSource* create(const FileSourceSettings& settings)
-		{
-			return new MsgConfigureFileSource(settings);
-		}
-
-	private:
-		FileSourceSettings m_settings;
-
-		MsgConfigureFileSource(const FileSourceSettings& settings) :
-			Message(),
-			m_settings(settings)
-		{ }
-	};
-
-	class MsgConfigureFileSourceName : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		const QString& getFileName() const { return m_fileName; }
-
-		static MsgConfigureFileSourceName* create(const QString& fileName)
-		{
-			return new MsgConfigureFileSourceName(fileName);
-		}
-
-	private:
-		QString m_fileName;
-
-		MsgConfigureFileSourceName(const QString& fileName) :
-			Message(),
-			m_fileName(fileName)
-		{ }
-	};
-
-	class MsgConfigureFileSourceWork : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		bool isWorking() const { return m_working; }
-
-		static MsgConfigureFileSourceWork* create(bool working)
-		{
-			return new MsgConfigureFileSourceWork(working);
-		}
-
-	private:
-		bool m_working;
-
-		MsgConfigureFileSourceWork(bool working) :
-			Message(),
-			m_working(working)
-		{ }
-	};
-
-	class MsgConfigureFileSourceStreamTiming : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-
-		static MsgConfigureFileSourceStreamTiming* create()
-		{
-			return new MsgConfigureFileSourceStreamTiming();
-		}
-
-	private:
-
-		MsgConfigureFileSourceStreamTiming() :
-			Message()
-		{ }
-	};
-
-	class MsgConfigureFileSourceSeek : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		int getPercentage() const { return m_seekPercentage; }
-
-		static MsgConfigureFileSourceSeek* create(int seekPercentage)
-		{
-			return new MsgConfigureFileSourceSeek(seekPercentage);
-		}
-
-	protected:
-		int m_seekPercentage; //!< percentage of seek position from the beginning 0..100
-
-		MsgConfigureFileSourceSeek(int seekPercentage) :
-			Message(),
-			m_seekPercentage(seekPercentage)
-		{ }
-	};
-
-	class MsgReportFileSourceAcquisition : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		bool getAcquisition() const { return m_acquisition; }
-
-		static MsgReportFileSourceAcquisition* create(bool acquisition)
-		{
-			return new MsgReportFileSourceAcquisition(acquisition);
-		}
-
-	protected:
-		bool m_acquisition;
-
-		MsgReportFileSourceAcquisition(bool acquisition) :
-			Message(),
-			m_acquisition(acquisition)
-		{ }
-	};
-
-    class MsgStartStop : public Message {
-        MESSAGE_CLASS_DECLARATION
-
-    public:
-        bool getStartStop() const { return m_startStop; }
-
-        static MsgStartStop* create(bool startStop) {
-            return new MsgStartStop(startStop);
-        }
-
-    protected:
-        bool m_startStop;
-
-        MsgStartStop(bool startStop) :
-            Message(),
-            m_startStop(startStop)
-        { }
-    };
-
-	class MsgReportFileSourceStreamData : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		int getSampleRate() const { return m_sampleRate; }
-		quint32 getSampleSize() const { return m_sampleSize; }
-		quint64 getCenterFrequency() const { return m_centerFrequency; }
-		std::time_t getStartingTimeStamp() const { return m_startingTimeStamp; }
-		quint32 getRecordLength() const { return m_recordLength; }
-
-		static MsgReportFileSourceStreamData* create(int sampleRate,
-		        quint32 sampleSize,
-				quint64 centerFrequency,
-				std::time_t startingTimeStamp,
-				quint32 recordLength)
-		{
-			return new MsgReportFileSourceStreamData(sampleRate, sampleSize, centerFrequency, startingTimeStamp, recordLength);
-		}
-
-	protected:
-		int m_sampleRate;
-		quint32 m_sampleSize;
-		quint64 m_centerFrequency;
-		std::time_t m_startingTimeStamp;
-		quint32 m_recordLength;
-
-		MsgReportFileSourceStreamData(int sampleRate,
-		        quint32 sampleSize,
-				quint64 centerFrequency,
-				std::time_t startingTimeStamp,
-				quint32 recordLength) :
-			Message(),
-			m_sampleRate(sampleRate),
-			m_sampleSize(sampleSize),
-			m_centerFrequency(centerFrequency),
-			m_startingTimeStamp(startingTimeStamp),
-			m_recordLength(recordLength)
-		{ }
-	};
-
-	class MsgReportFileSourceStreamTiming : public Message {
-		MESSAGE_CLASS_DECLARATION
-
-	public:
-		std::size_t getSamplesCount() const { return m_samplesCount; }
-
-		static MsgReportFileSourceStreamTiming* create(std::size_t samplesCount)
-		{
-			return new MsgReportFileSourceStreamTiming(samplesCount);
-		}
-
-	protected:
-		std::size_t m_samplesCount;
-
-		MsgReportFileSourceStreamTiming(std::size_t samplesCount) :
-			Message(),
-			m_samplesCount(samplesCount)
-		{ }
-	};
-
-	FileSourceInput(DeviceSourceAPI *deviceAPI);
-	virtual ~FileSourceInput();
-	virtual void destroy();
-
-    virtual void init();
-	virtual bool start();
-	virtual void stop();
-
-    virtual QByteArray serialize() const;
-    virtual bool deserialize(const QByteArray& data);
-
-    virtual void setMessageQueueToGUI(MessageQueue *queue) { m_guiMessageQueue = queue; }
-	virtual const QString& getDeviceDescription() const;
-	virtual int getSampleRate() const;
-	virtual quint64 getCenterFrequency() const;
-    virtual void setCenterFrequency(qint64 centerFrequency);
-	std::time_t getStartingTimeStamp() const;
-
-	virtual bool handleMessage(const Message& message);
-
-	virtual int webapiSettingsGet(
-	            SWGSDRangel::SWGDeviceSettings& response,
-	            QString& errorMessage);
-
-    virtual int webapiRunGet(
-            SWGSDRangel::SWGDeviceState& response,
-            QString& errorMessage);
-
-    virtual int webapiRun(
-            bool run,
-            SWGSDRangel::SWGDeviceState& response,
-            QString& errorMessage);
-
-    virtual int webapiReportGet(
-            SWGSDRangel::SWGDeviceReport& response,
-            QString& errorMessage);
-
-	private:
-	DeviceSourceAPI *m_deviceAPI;
-	QMutex m_mutex;
-	FileSourceSettings m_settings;
-	std::ifstream m_ifstream;
-	FileSourceThread* m_fileSourceThread;
-	QString m_deviceDescription;
-	QString m_fileName;
-	int m_sampleRate;
-	quint32 m_sampleSize;
-	quint64 m_centerFrequency;
-	quint32 m_recordLength; //!< record length in seconds computed from file size
-	std::time_t m_startingTimeStamp;
-	const QTimer& m_masterTimer;
-
-	void openFileStream();
-	void seekFileStream(int seekPercentage);
-	bool applySettings(const FileSourceSettings& settings, bool force = false);
-    void webapiFormatDeviceReport(SWGSDRangel::SWGDeviceReport& response);
-};
-
-#endif // INCLUDE_FILESOURCEINPUT_H
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2015 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_FILESOURCEINPUT_H
+#define INCLUDE_FILESOURCEINPUT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QTimer>
+#include <ctime>
+#include <vector>
+
+#include <dsp/devicesamplesource.h>
+#include "filesourcesettings.h"
+#include "filesourcemap.h"
+
+class FileSourceThread;
+class DeviceSourceAPI;
+
+class FileSourceInput : public DeviceSampleSource {
+public:
+	class MsgConfigureFileSource : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		const FileSourceSettings& getSettings() const { return m_settings; }
+
+		static MsgConfigureFileSource* create(const FileSourceSettings& settings)
+		{
+			return new MsgConfigureFileSource(settings);
+		}
+
+	private:
+		FileSourceSettings m_settings;
+
+		MsgConfigureFileSource(const FileSourceSettings& settings) :
+			Message(),
+			m_settings(settings)
+		{ }
+	};
+
+	class MsgConfigureFileSourceName : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		const QString& getFileName() const { return m_fileName; }
+
+		static MsgConfigureFileSourceName* create(const QString& fileName)
+		{
+			return new MsgConfigureFileSourceName(fileName);
+		}
+
+	private:
+		QString m_fileName;
+
+		MsgConfigureFileSourceName(const QString& fileName) :
+			Message(),
+			m_fileName(fileName)
+		{ }
+	};
+
+	class MsgConfigureFileSourceWork : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		bool isWorking() const { return m_working; }
+
+		static MsgConfigureFileSourceWork* create(bool working)
+		{
+			return new MsgConfigureFileSourceWork(working);
+		}
+
+	private:
+		bool m_working;
+
+		MsgConfigureFileSourceWork(bool working) :
+			Message(),
+			m_working(working)
+		{ }
+	};
+
+	class MsgConfigureFileSourceStreamTiming : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+
+		static MsgConfigureFileSourceStreamTiming* create()
+		{
+			return new MsgConfigureFileSourceStreamTiming();
+		}
+
+	private:
+
+		MsgConfigureFileSourceStreamTiming() :
+			Message()
+		{ }
+	};
+
+	class MsgConfigureFileSourceSeek : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		int getPercentage() const { return m_seekPercentage; }
+
+		static MsgConfigureFileSourceSeek* create(int seekPercentage)
+		{
+			return new MsgConfigureFileSourceSeek(seekPercentage);
+		}
+
+	protected:
+		int m_seekPercentage; //!< percentage of seek position from the beginning 0..100
+
+		MsgConfigureFileSourceSeek(int seekPercentage) :
+			Message(),
+			m_seekPercentage(seekPercentage)
+		{ }
+	};
+
+	class MsgConfigureFileSourceSeekTime : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		qint64 getTimestampNs() const { return m_timestampNs; }
+
+		static MsgConfigureFileSourceSeekTime* create(qint64 timestampNs)
+		{
+			return new MsgConfigureFileSourceSeekTime(timestampNs);
+		}
+
+	protected:
+		qint64 m_timestampNs; //!< absolute time of the sample to seek to in nanoseconds since epoch
+
+		MsgConfigureFileSourceSeekTime(qint64 timestampNs) :
+			Message(),
+			m_timestampNs(timestampNs)
+		{ }
+	};
+
+	class MsgReportFileSourceAcquisition : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		bool getAcquisition() const { return m_acquisition; }
+
+		static MsgReportFileSourceAcquisition* create(bool acquisition)
+		{
+			return new MsgReportFileSourceAcquisition(acquisition);
+		}
+
+	protected:
+		bool m_acquisition;
+
+		MsgReportFileSourceAcquisition(bool acquisition) :
+			Message(),
+			m_acquisition(acquisition)
+		{ }
+	};
+
+    class MsgStartStop : public Message {
+        MESSAGE_CLASS_DECLARATION
+
+    public:
+        bool getStartStop() const { return m_startStop; }
+
+        static MsgStartStop* create(bool startStop) {
+            return new MsgStartStop(startStop);
+        }
+
+    protected:
+        bool m_startStop;
+
+        MsgStartStop(bool startStop) :
+            Message(),
+            m_startStop(startStop)
+        { }
+    };
+
+	class MsgReportFileSourceStreamData : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		int getSampleRate() const { return m_sampleRate; }
+		quint32 getSampleSize() const { return m_sampleSize; }
+		quint64 getCenterFrequency() const { return m_centerFrequency; }
+		std::time_t getStartingTimeStamp() const { return m_startingTimeStamp; }
+		quint32 getRecordLength() const { return m_recordLength; }
+
+		static MsgReportFileSourceStreamData* create(int sampleRate,
+		        quint32 sampleSize,
+				quint64 centerFrequency,
+				std::time_t startingTimeStamp,
+				quint32 recordLength)
+		{
+			return new MsgReportFileSourceStreamData(sampleRate, sampleSize, centerFrequency, startingTimeStamp, recordLength);
+		}
+
+	protected:
+		int m_sampleRate;
+		quint32 m_sampleSize;
+		quint64 m_centerFrequency;
+		std::time_t m_startingTimeStamp;
+		quint32 m_recordLength;
+
+		MsgReportFileSourceStreamData(int sampleRate,
+		        quint32 sampleSize,
+				quint64 centerFrequency,
+				std::time_t startingTimeStamp,
+				quint32 recordLength) :
+			Message(),
+			m_sampleRate(sampleRate),
+			m_sampleSize(sampleSize),
+			m_centerFrequency(centerFrequency),
+			m_startingTimeStamp(startingTimeStamp),
+			m_recordLength(recordLength)
+		{ }
+	};
+
+	class MsgReportFileSourceStreamTiming : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		std::size_t getSamplesCount() const { return m_samplesCount; }
+		qint64 getElapsedNs() const { return m_elapsedNs; }
+
+		static MsgReportFileSourceStreamTiming* create(std::size_t samplesCount, qint64 elapsedNs)
+		{
+			return new MsgReportFileSourceStreamTiming(samplesCount, elapsedNs);
+		}
+
+	protected:
+		std::size_t m_samplesCount;
+		qint64 m_elapsedNs; //!< time elapsed since the starting time stamp of the record
+
+		MsgReportFileSourceStreamTiming(std::size_t samplesCount, qint64 elapsedNs) :
+			Message(),
+			m_samplesCount(samplesCount),
+			m_elapsedNs(elapsedNs)
+		{ }
+	};
+
+	class MsgReportFileSourceStreamChange : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		int getSampleRate() const { return m_sampleRate; }
+		quint64 getCenterFrequency() const { return m_centerFrequency; }
+		unsigned int getFileIndex() const { return m_fileIndex; }
+
+		static MsgReportFileSourceStreamChange* create(int sampleRate, quint64 centerFrequency, unsigned int fileIndex)
+		{
+			return new MsgReportFileSourceStreamChange(sampleRate, centerFrequency, fileIndex);
+		}
+
+	protected:
+		int m_sampleRate;
+		quint64 m_centerFrequency;
+		unsigned int m_fileIndex; //!< in the playlist
+
+		MsgReportFileSourceStreamChange(int sampleRate, quint64 centerFrequency, unsigned int fileIndex) :
+			Message(),
+			m_sampleRate(sampleRate),
+			m_centerFrequency(centerFrequency),
+			m_fileIndex(fileIndex)
+		{ }
+	};
+
+	FileSourceInput(DeviceSourceAPI *deviceAPI);
+	virtual ~FileSourceInput();
+	virtual void destroy();
+
+    virtual void init();
+	virtual bool start();
+	virtual void stop();
+
+    virtual QByteArray serialize() const;
+    virtual bool deserialize(const QByteArray& data);
+
+    virtual void setMessageQueueToGUI(MessageQueue *queue) { m_guiMessageQueue = queue; }
+	virtual const QString& getDeviceDescription() const;
+	virtual int getSampleRate() const;
+	virtual quint64 getCenterFrequency() const;
+    virtual void setCenterFrequency(qint64 centerFrequency);
+	std::time_t getStartingTimeStamp() const;
+
+	virtual bool handleMessage(const Message& message);
+
+	virtual int webapiSettingsGet(
+	            SWGSDRangel::SWGDeviceSettings& response,
+	            QString& errorMessage);
+
+    virtual int webapiSettingsPutPatch(
+                bool force,
+                const QStringList& deviceSettingsKeys,
+                SWGSDRangel::SWGDeviceSettings& response, // query + response
+                QString& errorMessage);
+
+    virtual int webapiRunGet(
+            SWGSDRangel::SWGDeviceState& response,
+            QString& errorMessage);
+
+    virtual int webapiRun(
+            bool run,
+            SWGSDRangel::SWGDeviceState& response,
+            QString& errorMessage);
+
+    virtual int webapiReportGet(
+            SWGSDRangel::SWGDeviceReport& response,
+            QString& errorMessage);
+
+	private:
+	DeviceSourceAPI *m_deviceAPI;
+	QMutex m_mutex;
+	FileSourceSettings m_settings;
+	std::vector<FileSourceMap*> m_fileMaps; //!< files of the playlist (a single file is a playlist of one)
+	unsigned int m_fileIndex;                //!< file being replayed
+	FileSourceThread* m_fileSourceThread;
+	QString m_deviceDescription;
+	QString m_fileName;
+	int m_sampleRate;
+	quint32 m_sampleSize;
+	quint64 m_centerFrequency;
+	quint32 m_recordLength; //!< record length in seconds computed from the time index (or file size)
+	std::time_t m_startingTimeStamp;
+	const QTimer& m_masterTimer;
+
+	void openFileStream(const QString& fileName);
+	void closeFileStreams();
+	void readFileInfo();
+	static bool readPlaylist(const QString& playlistName, QStringList& fileNames);
+	void seekFileStream(int seekPercentage);
+	void seekFileStreamTime(qint64 timestampNs);
+	qint64 getElapsedNs(quint64 samplesCount) const;
+	bool applySettings(const FileSourceSettings& settings, bool force = false);
+    void webapiFormatDeviceReport(SWGSDRangel::SWGDeviceReport& response);
+};
+
+#endif // INCLUDE_FILESOURCEINPUT_H
@@ -0,0 +1,507 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+#include <algorithm>
+#include <QFileInfo>
+#include <QDebug>
+
+#include "dsp/iqconverters.h"
+#include "filesourcemap.h"
+
+FileSourceMap::FileSourceMap() :
+    m_map(0),
+    m_samples(0),
+    m_fileSize(0),
+    m_nbSamples(0),
+    m_sampleBytes(4),
+    m_format(IQFileFormat::FormatSDRiq),
+    m_dataOffset(FileRecord::m_headerSize),
+    m_fileSampleBytes(4),
+    m_hasIndex(false),
+    m_decodedBlock(-1),
+    m_convertedStart(0),
+    m_convertedCount(0)
+{
+    m_header.sampleRate = 0;
+    m_header.centerFrequency = 0;
+    m_header.startTimeStamp = 0;
+    m_header.sampleSize = 16;
+    m_header.codec = FileRecordCodec::CodecNone;
+}
+
+FileSourceMap::~FileSourceMap()
+{
+    close();
+}
+
+bool FileSourceMap::open(const QString& fileName)
+{
+    close();
+    m_file.setFileName(fileName);
+
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qCritical("FileSourceMap::open: cannot open %s: %s", qPrintable(fileName), qPrintable(m_file.errorString()));
+        return false;
+    }
+
+    m_fileSize = m_file.size();
+    m_format = IQFileFormat::getFormatFromFileName(fileName);
+
+    if ((m_fileSize == 0) || ((m_format == IQFileFormat::FormatSDRiq) && (m_fileSize < FileRecord::m_headerSize)))
+    {
+        qCritical("FileSourceMap::open: %s is too short to be a record", qPrintable(fileName));
+        m_file.close();
+        return false;
+    }
+
+    // the whole file is mapped once so that seeks never remap
+    m_map = m_file.map(0, m_fileSize);
+
+    if (!m_map)
+    {
+        qCritical("FileSourceMap::open: cannot map %s: %s", qPrintable(fileName), qPrintable(m_file.errorString()));
+        m_file.close();
+        return false;
+    }
+
+#ifndef _WIN32
+    madvise(m_map, m_fileSize, MADV_SEQUENTIAL);
+#endif
+
+    if ((m_format != IQFileFormat::FormatSDRiq) || ((m_fileSize >= 4) && (memcmp(m_map, "RIFF", 4) == 0))) {
+        return openForeign(fileName);
+    }
+
+    FileRecord::readHeader((const char *) m_map, m_header);
+    m_sampleBytes = m_header.sampleSize > 16 ? 2 * sizeof(qint32) : 2 * sizeof(qint16);
+    m_fileSampleBytes = m_sampleBytes;
+    m_dataOffset = FileRecord::m_headerSize;
+    m_samples = m_map + m_dataOffset;
+    quint64 indexSize = readIndex();
+
+    if (isCompressed()) {
+        m_nbSamples = scanBlocks(m_fileSize - indexSize);
+    } else {
+        m_nbSamples = (m_fileSize - FileRecord::m_headerSize - indexSize) / m_sampleBytes;
+    }
+
+    makeSegments();
+
+    qDebug("FileSourceMap::open: %s: %llu bytes %llu samples of %u bits compression: %s blocks: %u index entries: %u segments: %u",
+            qPrintable(fileName), m_fileSize, m_nbSamples, m_header.sampleSize,
+            FileRecordCodec::getName((FileRecordCodec::Codec) m_header.codec), (unsigned int) m_blocks.size(),
+            m_hasIndex ? (unsigned int) m_index.size() : 0, (unsigned int) m_segments.size());
+    return true;
+}
+
+bool FileSourceMap::openForeign(const QString& fileName)
+{
+    IQFileFormat::Info info;
+
+    if ((m_fileSize >= 4) && (memcmp(m_map, "RIFF", 4) == 0))
+    {
+        if (!IQFileFormat::readWavHeader(m_map, m_fileSize, info))
+        {
+            qCritical("FileSourceMap::openForeign: %s: unsupported WAV file", qPrintable(fileName));
+            close();
+            return false;
+        }
+    }
+    else
+    {
+        // the SigMF metadata may give another sample type than the extension
+        info.m_format = m_format;
+        IQFileFormat::readSigMF(fileName, info);
+        info.m_dataOffset = 0;
+        info.m_dataSize = m_fileSize;
+    }
+
+    IQFileFormat::parseFileName(fileName, info); // fills what the metadata does not give
+
+    if (info.m_sampleRate <= 0)
+    {
+        qCritical("FileSourceMap::openForeign: %s: unknown sample rate. Give it in a SigMF file or in the file name (e.g. _2.4Msps_)",
+                qPrintable(fileName));
+        close();
+        return false;
+    }
+
+    m_format = info.m_format;
+    m_fileSampleBytes = IQFileFormat::getSampleBytes(m_format);
+    m_sampleBytes = sizeof(Sample);
+    m_dataOffset = info.m_dataOffset;
+    m_samples = m_map + m_dataOffset;
+    m_nbSamples = info.m_dataSize / m_fileSampleBytes;
+
+    m_header.sampleRate = info.m_sampleRate;
+    m_header.centerFrequency = info.m_centerFrequency;
+    m_header.sampleSize = SDR_RX_SAMP_SZ;
+    m_header.codec = FileRecordCodec::CodecNone;
+
+    if (info.m_startTimeMs == 0) // assume the file was written in real time
+    {
+        qint64 durationMs = (m_nbSamples * 1000) / info.m_sampleRate;
+        info.m_startTimeMs = QFileInfo(fileName).lastModified().toMSecsSinceEpoch() - durationMs;
+    }
+
+    m_header.startTimeStamp = info.m_startTimeMs / 1000;
+    m_index.clear();
+
+    for (unsigned int i = 0; i < info.m_captures.size(); i++)
+    {
+        FileRecord::IndexEntry entry;
+        entry.sampleIndex = info.m_captures[i].m_sampleIndex;
+        entry.timestampMs = info.m_captures[i].m_timestampMs != 0 ? info.m_captures[i].m_timestampMs : info.m_startTimeMs
+                + (qint64) ((info.m_captures[i].m_sampleIndex * 1000) / info.m_sampleRate);
+        entry.centerFrequency = info.m_captures[i].m_centerFrequency;
+        entry.sampleRate = info.m_sampleRate;
+        entry.reserved = 0;
+        m_index.push_back(entry);
+    }
+
+    m_hasIndex = m_index.size() > 0;
+    makeSegments();
+
+    qDebug("FileSourceMap::openForeign: %s: format: %s %llu bytes %llu samples at %d S/s center frequency: %llu Hz segments: %u",
+            qPrintable(fileName), IQFileFormat::getName(m_format), m_fileSize, m_nbSamples, info.m_sampleRate,
+            info.m_centerFrequency, (unsigned int) m_segments.size());
+    return true;
+}
+
+quint64 FileSourceMap::readIndex()
+{
+    FileRecord::IndexTrailer trailer;
+    quint64 dataSize = m_fileSize - FileRecord::m_headerSize;
+    m_index.clear();
+    m_hasIndex = false;
+
+    if (dataSize >= sizeof(FileRecord::IndexTrailer))
+    {
+        memcpy(&trailer, m_map + m_fileSize - sizeof(FileRecord::IndexTrailer), sizeof(FileRecord::IndexTrailer));
+
+        if ((memcmp(trailer.magic, "SIDX", 4) == 0)
+            && (trailer.version == 1)
+            && (trailer.nbEntries <= (dataSize - sizeof(FileRecord::IndexTrailer)) / sizeof(FileRecord::IndexEntry)))
+        {
+            quint64 indexSize = trailer.nbEntries * sizeof(FileRecord::IndexEntry) + sizeof(FileRecord::IndexTrailer);
+            m_index.resize(trailer.nbEntries);
+            // the index is generally not aligned in the map
+            memcpy(m_index.data(), m_map + m_fileSize - indexSize, trailer.nbEntries * sizeof(FileRecord::IndexEntry));
+            m_hasIndex = true;
+            return indexSize;
+        }
+    }
+
+    return 0;
+}
+
+quint64 FileSourceMap::scanBlocks(quint64 dataEnd)
+{
+    quint64 offset = FileRecord::m_headerSize;
+    quint64 nbSamples = 0;
+    FileRecordCodec::BlockHeader header;
+    m_blocks.clear();
+
+    while (offset + sizeof(FileRecordCodec::BlockHeader) <= dataEnd)
+    {
+        memcpy(&header, m_map + offset, sizeof(FileRecordCodec::BlockHeader));
+
+        // a record that was not closed properly can end with a partial block
+        if ((header.nbSamples == 0) || (header.size > dataEnd - offset - sizeof(FileRecordCodec::BlockHeader))) {
+            break;
+        }
+
+        Block block;
+        block.m_offset = offset;
+        block.m_start = nbSamples;
+        m_blocks.push_back(block);
+        nbSamples += header.nbSamples;
+        offset += sizeof(FileRecordCodec::BlockHeader) + header.size;
+    }
+
+    if (offset != dataEnd) {
+        qWarning("FileSourceMap::scanBlocks: %llu bytes ignored at the end of the record", dataEnd - offset);
+    }
+
+    return nbSamples;
+}
+
+unsigned int FileSourceMap::findBlock(quint64 index) const
+{
+    std::vector<Block>::const_iterator it = std::upper_bound(m_blocks.begin(), m_blocks.end(), index,
+        [](quint64 i, const Block& block) { return i < block.m_start; });
+    return (it - m_blocks.begin()) - 1; // the first block starts at sample 0
+}
+
+const quint8 *FileSourceMap::getSamples(quint64 index, quint64& count)
+{
+    if (m_format != IQFileFormat::FormatSDRiq)
+    {
+        // convert by pieces that stay in cache
+        if ((index < m_convertedStart) || (index >= m_convertedStart + m_convertedCount))
+        {
+            m_convertedStart = index;
+            m_convertedCount = std::min(m_nbSamples - index, (quint64) (1<<16));
+            m_decoded.resize(m_convertedCount * sizeof(Sample));
+            convertSamples(m_samples + index * m_fileSampleBytes, (Sample *) m_decoded.data(), m_convertedCount);
+        }
+
+        quint64 available = m_convertedStart + m_convertedCount - index;
+        count = count < available ? count : available;
+        return m_decoded.data() + (index - m_convertedStart) * m_sampleBytes;
+    }
+
+    if (!isCompressed()) {
+        return m_samples + index * m_sampleBytes;
+    }
+
+    unsigned int blockIndex = findBlock(index);
+    const Block& block = m_blocks[blockIndex];
+    FileRecordCodec::BlockHeader header;
+    memcpy(&header, m_map + block.m_offset, sizeof(FileRecordCodec::BlockHeader));
+
+    if ((int) blockIndex != m_decodedBlock)
+    {
+        m_decoded.resize((quint64) header.nbSamples * m_sampleBytes);
+
+        if (!FileRecordCodec::decode(header, (const char *) m_map + block.m_offset + sizeof(FileRecordCodec::BlockHeader),
+                m_sampleBytes, (char *) m_decoded.data()))
+        {
+            qWarning("FileSourceMap::getSamples: corrupt block %u replaced by silence", blockIndex);
+            std::fill(m_decoded.begin(), m_decoded.end(), 0);
+        }
+
+        m_decodedBlock = blockIndex;
+    }
+
+    quint64 available = block.m_start + header.nbSamples - index;
+    count = count < available ? count : available;
+    return m_decoded.data() + (index - block.m_start) * m_sampleBytes;
+}
+
+void FileSourceMap::convertSamples(const quint8 *in, Sample *out, unsigned int nbSamples) const
+{
+    switch (m_format)
+    {
+    case IQFileFormat::FormatCU8:
+        IQConverters::fromCU8(in, out, nbSamples);
+        break;
+    case IQFileFormat::FormatCS8:
+        IQConverters::fromCS8((const qint8 *) in, out, nbSamples);
+        break;
+    case IQFileFormat::FormatCS16:
+        IQConverters::fromCS16((const qint16 *) in, out, nbSamples);
+        break;
+    case IQFileFormat::FormatCF32:
+        IQConverters::fromCF32((const float *) in, out, nbSamples);
+        break;
+    default:
+        break;
+    }
+}
+
+void FileSourceMap::makeSegments()
+{
+    // keep only consistent entries so that searches can rely on increasing sample indexes
+    std::vector<FileRecord::IndexEntry> index;
+
+    for (unsigned int i = 0; i < m_index.size(); i++)
+    {
+        if ((m_index[i].sampleRate > 0)
+            && (m_index[i].sampleIndex < m_nbSamples)
+            && (index.empty() || (m_index[i].sampleIndex > index.back().sampleIndex))) {
+            index.push_back(m_index[i]);
+        }
+    }
+
+    if (index.empty() || (index[0].sampleIndex != 0))
+    {
+        FileRecord::IndexEntry entry;
+        entry.sampleIndex = 0;
+        entry.timestampMs = (qint64) m_header.startTimeStamp * 1000LL;
+        entry.centerFrequency = m_header.centerFrequency;
+        entry.sampleRate = m_header.sampleRate;
+        entry.reserved = 0;
+        index.insert(index.begin(), entry);
+    }
+
+    m_index.swap(index);
+    m_segments.clear();
+
+    for (unsigned int i = 0; i < m_index.size(); i++)
+    {
+        if (m_segments.empty()
+            || (m_segments.back().m_sampleRate != m_index[i].sampleRate)
+            || (m_segments.back().m_centerFrequency != m_index[i].centerFrequency))
+        {
+            if (!m_segments.empty()) {
+                m_segments.back().m_end = m_index[i].sampleIndex;
+            }
+
+            Segment segment;
+            segment.m_start = m_index[i].sampleIndex;
+            segment.m_end = m_nbSamples;
+            segment.m_sampleRate = m_index[i].sampleRate;
+            segment.m_centerFrequency = m_index[i].centerFrequency;
+            m_segments.push_back(segment);
+        }
+    }
+}
+
+const FileSourceMap::Segment& FileSourceMap::getSegment(quint64 index) const
+{
+    unsigned int low = 0;
+    unsigned int high = m_segments.size();
+
+    while (high - low > 1) // last segment starting at or before index
+    {
+        unsigned int mid = (low + high) / 2;
+
+        if (m_segments[mid].m_start <= index) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    return m_segments[low];
+}
+
+qint32 FileSourceMap::getMaxSampleRate() const
+{
+    qint32 maxSampleRate = m_header.sampleRate;
+
+    for (unsigned int i = 0; i < m_segments.size(); i++) {
+        maxSampleRate = std::max(maxSampleRate, m_segments[i].m_sampleRate);
+    }
+
+    return maxSampleRate;
+}
+
+void FileSourceMap::close()
+{
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = 0;
+        m_samples = 0;
+    }
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    m_fileSize = 0;
+    m_nbSamples = 0;
+    m_hasIndex = false;
+    m_index.clear();
+    m_segments.clear();
+    m_blocks.clear();
+    m_decodedBlock = -1;
+    m_convertedStart = 0;
+    m_convertedCount = 0;
+    m_format = IQFileFormat::FormatSDRiq;
+    m_header.codec = FileRecordCodec::CodecNone;
+}
+
+quint64 FileSourceMap::getSampleIndex(qint64 timestampNs) const
+{
+    if (m_nbSamples == 0) {
+        return 0;
+    }
+
+    // last index entry at or before the timestamp
+    std::vector<FileRecord::IndexEntry>::const_iterator it = std::upper_bound(m_index.begin(), m_index.end(), timestampNs,
+        [](qint64 t, const FileRecord::IndexEntry& entry) { return t < entry.timestampMs * 1000000LL; });
+
+    if (it == m_index.begin()) {
+        return 0;
+    }
+
+    --it;
+    quint64 next = (it + 1) == m_index.end() ? m_nbSamples : (it + 1)->sampleIndex;
+    qint64 deltaNs = timestampNs - it->timestampMs * 1000000LL;
+
+    // split seconds and nanoseconds so that long records at high rates do not overflow
+    quint64 index = it->sampleIndex + (deltaNs / 1000000000LL) * it->sampleRate
+            + ((deltaNs % 1000000000LL) * it->sampleRate + 500000000LL) / 1000000000LL;
+
+    // a timestamp in a gap between entries is at the last sample before the gap
+    return index < next ? index : next - 1;
+}
+
+qint64 FileSourceMap::getTimestampNs(quint64 index) const
+{
+    if (m_index.empty()) {
+        return (qint64) m_header.startTimeStamp * 1000000000LL;
+    }
+
+    // last index entry at or before the sample
+    std::vector<FileRecord::IndexEntry>::const_iterator it = std::upper_bound(m_index.begin(), m_index.end(), index,
+        [](quint64 i, const FileRecord::IndexEntry& entry) { return i < entry.sampleIndex; });
+    --it; // the first entry is always at sample 0
+
+    if (it->sampleRate <= 0) {
+        return it->timestampMs * 1000000LL;
+    }
+
+    quint64 delta = index - it->sampleIndex;
+    return it->timestampMs * 1000000LL + (delta / it->sampleRate) * 1000000000LL
+            + ((delta % it->sampleRate) * 1000000000LL) / it->sampleRate;
+}
+
+void FileSourceMap::prefetch(quint64 index, quint64 nbSamples) const
+{
+#ifndef _WIN32
+    if (!m_map || (index >= m_nbSamples) || (nbSamples == 0)) {
+        return;
+    }
+
+    if (nbSamples > m_nbSamples - index) {
+        nbSamples = m_nbSamples - index;
+    }
+
+    quint64 start, end;
+
+    if (isCompressed())
+    {
+        start = m_blocks[findBlock(index)].m_offset;
+        unsigned int endBlock = findBlock(index + nbSamples - 1) + 1;
+        end = endBlock < m_blocks.size() ? m_blocks[endBlock].m_offset : m_fileSize;
+    }
+    else
+    {
+        start = m_dataOffset + index * m_fileSampleBytes;
+        end = start + nbSamples * m_fileSampleBytes;
+    }
+
+    // madvise needs a page aligned address
+    quint64 pageSize = sysconf(_SC_PAGESIZE);
+    quint64 alignedStart = (start / pageSize) * pageSize;
+    madvise(m_map + alignedStart, end - alignedStart, MADV_WILLNEED);
+#else
+    (void) index;
+    (void) nbSamples;
+#endif
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PLUGINS_SAMPLESOURCE_FILESOURCE_FILESOURCEMAP_H_
+#define PLUGINS_SAMPLESOURCE_FILESOURCE_FILESOURCEMAP_H_
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+#include "dsp/filerecord.h"
+#include "dsp/iqfileformat.h"
+
+/**
+ * Read only memory map of a .sdriq record. The samples are addressed by their index from
+ * the start of the record so that seeking is just pointer arithmetic and never touches
+ * the file. Pages are read ahead by the kernel (sequential access advice) and can be
+ * prefetched explicitly after a seek.
+ *
+ * The time index that FileRecord appends to the record is loaded in memory. Records without
+ * index are described by a single entry made from the header. Times are interpolated from
+ * the closest entry with the sample rate in effect and the record is split in segments of
+ * constant sample rate and center frequency.
+ *
+ * Compressed records are made of blocks that are located when the file is opened and decoded
+ * one at a time when their samples are read.
+ *
+ * Raw and WAV files of other tools (see IQFileFormat) are mapped the same way. Their samples
+ * are converted to the native Sample format by pieces when read and the header is made from
+ * their metadata.
+ */
+class FileSourceMap
+{
+public:
+    struct Segment
+    {
+        quint64 m_start;           //!< first sample
+        quint64 m_end;             //!< sample past the last one
+        qint32  m_sampleRate;
+        quint64 m_centerFrequency;
+    };
+
+    FileSourceMap();
+    ~FileSourceMap();
+
+    bool open(const QString& fileName);
+    void close();
+    bool isOpen() const { return m_samples != 0; }
+
+    const FileRecord::Header& getHeader() const { return m_header; }
+    quint64 getFileSize() const { return m_fileSize; }
+    quint64 getNbSamples() const { return m_nbSamples; }
+    quint32 getSampleBytes() const { return m_sampleBytes; } //!< bytes per I/Q sample
+    bool isCompressed() const { return m_header.codec != FileRecordCodec::CodecNone; }
+    IQFileFormat::Format getFormat() const { return m_format; }
+    /**
+     * I/Q samples from index (must be less than the number of samples). On input count is the
+     * number of samples wanted and on output the number of samples available at the returned
+     * address (up to the end of the block for compressed records or of the converted piece for
+     * other formats). Valid until the next call.
+     */
+    const quint8 *getSamples(quint64 index, quint64& count);
+
+    /** Index of the sample nearest to the given absolute time in nanoseconds since epoch (clamped to the record) */
+    quint64 getSampleIndex(qint64 timestampNs) const;
+    /** Absolute time of a sample in nanoseconds since epoch */
+    qint64 getTimestampNs(quint64 index) const;
+    /** Ask the kernel to read the given samples in advance (e.g. after a seek) */
+    void prefetch(quint64 index, quint64 nbSamples) const;
+
+    bool hasIndex() const { return m_hasIndex; }
+    /** Segment containing the sample (the last segment for indexes past the end) */
+    const Segment& getSegment(quint64 index) const;
+    unsigned int getNbSegments() const { return m_segments.size(); }
+    qint32 getMaxSampleRate() const;
+
+private:
+    QFile m_file;
+    uchar *m_map;
+    const quint8 *m_samples;
+    quint64 m_fileSize;
+    quint64 m_nbSamples;
+    quint32 m_sampleBytes;
+    IQFileFormat::Format m_format;
+    quint64 m_dataOffset;         //!< of the first sample in file
+    quint32 m_fileSampleBytes;    //!< bytes per I/Q sample in file (differs from m_sampleBytes for other formats)
+    FileRecord::Header m_header;
+    bool m_hasIndex;
+    std::vector<FileRecord::IndexEntry> m_index;
+    std::vector<Segment> m_segments;
+
+    struct Block
+    {
+        quint64 m_offset; //!< of the block header in file
+        quint64 m_start;  //!< first sample
+    };
+
+    std::vector<Block> m_blocks;  //!< compressed records only
+    int m_decodedBlock;           //!< block in m_decoded (-1 for none)
+    std::vector<quint8> m_decoded;
+    quint64 m_convertedStart;     //!< first sample in m_decoded for other formats
+    quint64 m_convertedCount;
+
+    bool openForeign(const QString& fileName);
+    quint64 readIndex(); //!< returns the size of the index at the end of the file
+    void makeSegments();
+    void convertSamples(const quint8 *in, Sample *out, unsigned int nbSamples) const;
+    quint64 scanBlocks(quint64 dataEnd); //!< returns the number of samples
+    unsigned int findBlock(quint64 index) const;
+};
+
+#endif /* PLUGINS_SAMPLESOURCE_FILESOURCE_FILESOURCEMAP_H_ */
@@ -28,12 +28,14 @@ void FileSourceSettings::resetToDefaults()
     m_centerFrequency = 435000000;
     m_sampleRate = 48000;
     m_fileName = "./test.sdriq";
+    m_freeRun = false;
 }
 
 QByteArray FileSourceSettings::serialize() const
 {
     SimpleSerializer s(1);
     s.writeString(1, m_fileName);
+    s.writeBool(2, m_freeRun);
     return s.final();
 }
 
@@ -48,6 +50,7 @@ bool FileSourceSettings::deserialize(const QByteArray& data)
 
     if(d.getVersion() == 1) {
         d.readString(1, &m_fileName, "./test.sdriq");
+        d.readBool(2, &m_freeRun, false);
         return true;
     } else {
         resetToDefaults();
@@ -24,6 +24,7 @@ struct FileSourceSettings {
     quint64 m_centerFrequency;
     qint32  m_sampleRate;
     QString m_fileName;
+    bool    m_freeRun; //!< replay as fast as the samples are processed and stop at the end of file
 
     FileSourceSettings();
     ~FileSourceSettings() {}
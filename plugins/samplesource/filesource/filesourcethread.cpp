@@ -19,27 +19,34 @@
 #include <assert.h>
 #include <QDebug>
 
-#include "dsp/filerecord.h"
 #include "filesourcethread.h"
+#include "filesourcemap.h"
+#include "filesourceinput.h"
 #include "dsp/samplesinkfifo.h"
+#include "util/messagequeue.h"
 
-FileSourceThread::FileSourceThread(std::ifstream *samplesStream, SampleSinkFifo* sampleFifo, QObject* parent) :
+FileSourceThread::FileSourceThread(const std::vector<FileSourceMap*>& fileMaps, SampleSinkFifo* sampleFifo, MessageQueue *sourceMessageQueue, QObject* parent) :
 	QThread(parent),
 	m_running(false),
-	m_ifstream(samplesStream),
-	m_fileBuf(0),
-	m_convertBuf(0),
-	m_bufsize(0),
-	m_chunksize(0),
+	m_fileMaps(fileMaps),
+	m_fileIndex(0),
+	m_fileMap(fileMaps.front()),
+	m_nextPrefetched(false),
+	m_chunkSamples(0),
 	m_sampleFifo(sampleFifo),
 	m_samplesCount(0),
+	m_freeRun(false),
+	m_sourceMessageQueue(sourceMessageQueue),
+	m_segmentStart(0),
+	m_segmentEnd(0),
+	m_centerFrequency(fileMaps.front()->getHeader().centerFrequency),
+	m_replayCompleted(false),
     m_samplerate(0),
 	m_samplesize(0),
-	m_samplebytes(0),
     m_throttlems(FILESOURCE_THROTTLE_MS),
     m_throttleToggle(false)
 {
-    assert(m_ifstream != 0);
+    assert(m_fileMap != 0);
 }
 
 FileSourceThread::~FileSourceThread()
@@ -47,23 +54,15 @@ FileSourceThread::~FileSourceThread()
 	if (m_running) {
 		stopWork();
 	}
-
-	if (m_fileBuf != 0) {
-		free(m_fileBuf);
-	}
-
-	if (m_convertBuf != 0) {
-		free(m_convertBuf);
-	}
 }
 
 void FileSourceThread::startWork()
 {
 	qDebug() << "FileSourceThread::startWork: ";
 
-    if (m_ifstream->is_open())
+    if (m_fileMap->isOpen())
     {
-        qDebug() << "FileSourceThread::startWork: file stream open, starting...";
+        qDebug() << "FileSourceThread::startWork: file mapped, starting...";
         m_startWaitMutex.lock();
         m_elapsedTimer.start();
         start();
@@ -73,7 +72,7 @@ void FileSourceThread::startWork()
     }
     else
     {
-        qDebug() << "FileSourceThread::startWork: file stream closed, not starting.";
+        qDebug() << "FileSourceThread::startWork: file not mapped, not starting.";
     }
 }
 
@@ -94,58 +93,31 @@ void FileSourceThread::setSampleRateAndSize(int samplerate, quint32 samplesize)
 
 	if ((samplerate != m_samplerate) || (samplesize != m_samplesize))
 	{
-		if (m_running) {
-			stopWork();
-		}
-
 		m_samplerate = samplerate;
 		m_samplesize = samplesize;
-		m_samplebytes = m_samplesize > 16 ? sizeof(int32_t) : sizeof(int16_t);
         // TODO: implement FF and slow motion here. 2 corresponds to live. 1 is half speed, 4 is double speed
-        m_chunksize = (m_samplerate * 2 * m_samplebytes * m_throttlems) / 1000;
-
-        setBuffers(m_chunksize);
+        m_chunkSamples = (m_samplerate * m_throttlems) / 1000;
 	}
-
-	//m_samplerate = samplerate;
 }
 
-void FileSourceThread::setBuffers(std::size_t chunksize)
+void FileSourceThread::seek(quint64 sampleIndex)
 {
-    if (chunksize > m_bufsize)
-    {
-        m_bufsize = chunksize;
-        int nbSamples = m_bufsize/(2 * m_samplebytes);
-
-        if (m_fileBuf == 0)
-        {
-            qDebug() << "FileSourceThread::setBuffers: Allocate file buffer";
-            m_fileBuf = (quint8*) malloc(m_bufsize);
-        }
-        else
-        {
-            qDebug() << "FileSourceThread::setBuffers: Re-allocate file buffer";
-            quint8 *buf = m_fileBuf;
-            m_fileBuf = (quint8*) realloc((void*) m_fileBuf, m_bufsize);
-            if (!m_fileBuf) free(buf);
-        }
-
-        if (m_convertBuf == 0)
-        {
-            qDebug() << "FileSourceThread::setBuffers: Allocate conversion buffer";
-            m_convertBuf = (quint8*) malloc(nbSamples*sizeof(Sample));
-        }
-        else
-        {
-            qDebug() << "FileSourceThread::setBuffers: Re-allocate conversion buffer";
-            quint8 *buf = m_convertBuf;
-            m_convertBuf = (quint8*) realloc((void*) m_convertBuf, nbSamples*sizeof(Sample));
-            if (!m_convertBuf) free(buf);
-        }
+    QMutexLocker mutexLocker(&m_mutex);
+    quint64 nbSamples = m_fileMap->getNbSamples();
+    m_samplesCount = sampleIndex < nbSamples ? sampleIndex : 0;
+    m_replayCompleted = false;
+    m_nextPrefetched = false;
+    // have about one second of samples ready so that playback resumes without waiting for the disk
+    m_fileMap->prefetch(m_samplesCount, m_samplerate);
+    qDebug("FileSourceThread::seek: sample %llu of %llu", m_samplesCount, nbSamples);
+}
 
-        qDebug() << "FileSourceThread::setBuffers: size: " << m_bufsize
-                << " #samples: " << nbSamples;
-    }
+void FileSourceThread::setFreeRun(bool freeRun)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    m_freeRun = freeRun;
+    m_replayCompleted = false;
+    qDebug("FileSourceThread::setFreeRun: %s", freeRun ? "on" : "off");
 }
 
 void FileSourceThread::run()
@@ -153,9 +125,18 @@ void FileSourceThread::run()
 	m_running = true;
 	m_startWaiter.wakeAll();
 
-	while(m_running) // actual work is in the tick() function
+	while(m_running)
 	{
-		sleep(1);
+		if (m_freeRun && !m_replayCompleted)
+		{
+			if (!writeFreeRun()) {
+				usleep(1000); // wait for the DSP to drain the FIFO
+			}
+		}
+		else // actual work is in the tick() function
+		{
+			msleep(FILESOURCE_THROTTLE_MS);
+		}
 	}
 
 	m_running = false;
@@ -176,76 +157,182 @@ void FileSourceThread::tick()
         if (throttlems != m_throttlems)
         {
             m_throttlems = throttlems;
-            m_chunksize = 2 * m_samplebytes * ((m_samplerate * (m_throttlems+(m_throttleToggle ? 1 : 0))) / 1000);
+            m_chunkSamples = (m_samplerate * (m_throttlems+(m_throttleToggle ? 1 : 0))) / 1000;
             m_throttleToggle = !m_throttleToggle;
-            setBuffers(m_chunksize);
         }
 
-		// read samples directly feeding the SampleFifo (no callback)
-		m_ifstream->read(reinterpret_cast<char*>(m_fileBuf), m_chunksize);
+        if (m_freeRun) { // samples are pushed by the thread loop
+            return;
+        }
+
+        QMutexLocker mutexLocker(&m_mutex);
+        quint64 remainder = m_chunkSamples;
 
-        if (m_ifstream->eof())
+        // feed the SampleFifo from the mapped files (decoded block by block if compressed)
+        // the chunk continues with the next file of the playlist so that there is no gap
+        while (remainder > 0)
         {
-        	writeToSampleFifo(m_fileBuf, (qint32) m_ifstream->gcount());
-            //m_sampleFifo->write(m_buf, m_ifstream->gcount());
-            // TODO: handle loop playback situation
-    		m_ifstream->clear();
-            m_ifstream->seekg(sizeof(FileRecord::Header), std::ios::beg);
-    		m_samplesCount = 0;
-            //stopWork();
-            //m_ifstream->close();
+            if (m_samplesCount >= m_fileMap->getNbSamples()) {
+                nextFile(true); // loop playback
+            }
+
+            if ((m_samplesCount < m_segmentStart) || (m_samplesCount >= m_segmentEnd)) {
+                updateSegment();
+            }
+
+            quint64 count = m_segmentEnd - m_samplesCount;
+            count = remainder < count ? remainder : count;
+            const quint8 *samples = m_fileMap->getSamples(m_samplesCount, count); // may reduce count
+            writeToSampleFifo(samples, count);
+            m_samplesCount += count;
+            remainder -= count;
+        }
+
+        prefetchNextFile();
+	}
+}
+
+bool FileSourceThread::writeFreeRun()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    quint64 chunkSamples = (m_samplerate * FILESOURCE_THROTTLE_MS) / 1000;
+    chunkSamples = chunkSamples == 0 ? 1 : chunkSamples;
+
+    // back pressure: only write when the whole chunk fits in the FIFO
+    if (m_sampleFifo->size() - m_sampleFifo->fill() < chunkSamples) {
+        return false;
+    }
+
+    if ((m_samplesCount >= m_fileMap->getNbSamples()) && !nextFile(false))
+    {
+        qDebug("FileSourceThread::writeFreeRun: end of playlist reached after %llu samples of the last file", m_samplesCount);
+        m_replayCompleted = true;
+        return true;
+    }
+
+    if ((m_samplesCount < m_segmentStart) || (m_samplesCount >= m_segmentEnd)) {
+        updateSegment();
+    }
+
+    quint64 count = m_segmentEnd - m_samplesCount;
+    count = chunkSamples < count ? chunkSamples : count;
+    const quint8 *samples = m_fileMap->getSamples(m_samplesCount, count); // may reduce count
+    writeToSampleFifo(samples, count);
+    m_samplesCount += count;
+
+    prefetchNextFile();
+    return true;
+}
+
+bool FileSourceThread::nextFile(bool loop)
+{
+    unsigned int fileIndex = m_fileIndex + 1;
+
+    if (fileIndex == m_fileMaps.size())
+    {
+        if (!loop) {
+            return false;
         }
-        else
+
+        fileIndex = 0;
+    }
+
+    m_fileIndex = fileIndex;
+    m_fileMap = m_fileMaps[fileIndex];
+    m_samplesCount = 0;
+    m_segmentStart = 0;
+    m_segmentEnd = 0;
+    m_samplesize = m_fileMap->getHeader().sampleSize;
+    m_nextPrefetched = false;
+    qDebug("FileSourceThread::nextFile: file %u of %u", fileIndex + 1, (unsigned int) m_fileMaps.size());
+
+    // the input needs to know about the new file even if it has the same sample rate and center frequency
+    if (!updateSegment() && m_sourceMessageQueue)
+    {
+        FileSourceInput::MsgReportFileSourceStreamChange *report =
+                FileSourceInput::MsgReportFileSourceStreamChange::create(m_samplerate, m_centerFrequency, m_fileIndex);
+        m_sourceMessageQueue->push(report);
+    }
+
+    return true;
+}
+
+void FileSourceThread::prefetchNextFile()
+{
+    // have the kernel read the start of the next file while the last second of this one is replayed
+    if (!m_nextPrefetched && (m_fileMap->getNbSamples() - m_samplesCount < (quint64) m_samplerate))
+    {
+        FileSourceMap *nextMap = m_fileMaps[(m_fileIndex + 1) % m_fileMaps.size()];
+        nextMap->prefetch(0, nextMap->getHeader().sampleRate);
+        m_nextPrefetched = true;
+    }
+}
+
+bool FileSourceThread::updateSegment()
+{
+    const FileSourceMap::Segment& segment = m_fileMap->getSegment(m_samplesCount);
+    m_segmentStart = segment.m_start;
+    m_segmentEnd = segment.m_end;
+
+    if ((segment.m_sampleRate != m_samplerate) || (segment.m_centerFrequency != m_centerFrequency))
+    {
+        qDebug("FileSourceThread::updateSegment: sample %llu: rate: %d frequency: %llu",
+                m_samplesCount, segment.m_sampleRate, segment.m_centerFrequency);
+        m_samplerate = segment.m_sampleRate;
+        m_centerFrequency = segment.m_centerFrequency;
+        m_chunkSamples = (m_samplerate * m_throttlems) / 1000;
+
+        if (m_sourceMessageQueue)
         {
-        	writeToSampleFifo(m_fileBuf, (qint32) m_chunksize);
-            //m_sampleFifo->write(m_buf, m_chunksize);
-    		m_samplesCount += m_chunksize / (2 * m_samplebytes);
+            FileSourceInput::MsgReportFileSourceStreamChange *report =
+                    FileSourceInput::MsgReportFileSourceStreamChange::create(m_samplerate, m_centerFrequency, m_fileIndex);
+            m_sourceMessageQueue->push(report);
         }
-	}
+
+        return true;
+    }
+
+    return false;
 }
 
-void FileSourceThread::writeToSampleFifo(const quint8* buf, qint32 nbBytes)
+void FileSourceThread::writeToSampleFifo(const quint8* buf, quint32 nbSamples)
 {
-	if (m_samplesize == 16)
+	if (m_samplesize == SDR_RX_SAMP_SZ)
 	{
-		if (SDR_RX_SAMP_SZ == 16)
-		{
-			m_sampleFifo->write(buf, nbBytes);
-		}
-		else if (SDR_RX_SAMP_SZ == 24)
-		{
-			FixReal *convertBuf = (FixReal *) m_convertBuf;
-			const int16_t *fileBuf = (int16_t *) buf;
-			int nbSamples = nbBytes / (2 * m_samplebytes);
-
-			for (int is = 0; is < nbSamples; is++)
-			{
-				convertBuf[2*is]   = fileBuf[2*is] << 8;
-				convertBuf[2*is+1] = fileBuf[2*is+1] << 8;
-			}
+		m_sampleFifo->write(buf, nbSamples*sizeof(Sample));
+		return;
+	}
 
-			m_sampleFifo->write((quint8*) convertBuf, nbSamples*sizeof(Sample));
-		}
+	if (m_convertBuf.size() < nbSamples) {
+		m_convertBuf.resize(nbSamples);
 	}
-	else if (m_samplesize == 24)
+
+	FixReal *convertBuf = (FixReal *) m_convertBuf.data();
+
+	if (m_samplesize == 16) // to 24 bits
 	{
-		if (SDR_RX_SAMP_SZ == 24)
+		const int16_t *fileBuf = (int16_t *) buf;
+
+		for (quint32 is = 0; is < nbSamples; is++)
 		{
-			m_sampleFifo->write(buf, nbBytes);
+			convertBuf[2*is]   = fileBuf[2*is] << 8;
+			convertBuf[2*is+1] = fileBuf[2*is+1] << 8;
 		}
-		else if (SDR_RX_SAMP_SZ == 16)
-		{
-			FixReal *convertBuf = (FixReal *) m_convertBuf;
-			const int32_t *fileBuf = (int32_t *) buf;
-			int nbSamples = nbBytes / (2 * m_samplebytes);
-
-			for (int is = 0; is < nbSamples; is++)
-			{
-				convertBuf[2*is]   = fileBuf[2*is] >> 8;
-				convertBuf[2*is+1] = fileBuf[2*is+1] >> 8;
-			}
+	}
+	else if (m_samplesize == 24) // to 16 bits
+	{
+		const int32_t *fileBuf = (int32_t *) buf;
 
-			m_sampleFifo->write((quint8*) convertBuf, nbSamples*sizeof(Sample));
+		for (quint32 is = 0; is < nbSamples; is++)
+		{
+			convertBuf[2*is]   = fileBuf[2*is] >> 8;
+			convertBuf[2*is+1] = fileBuf[2*is+1] >> 8;
 		}
 	}
+	else
+	{
+		return;
+	}
+
+	m_sampleFifo->write((quint8*) convertBuf, nbSamples*sizeof(Sample));
 }
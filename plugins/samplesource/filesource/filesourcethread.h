@@ -22,30 +22,34 @@
 #include <QWaitCondition>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <iostream>
-#include <fstream>
-#include <cstdlib>
+#include <vector>
 
-#include "dsp/inthalfbandfilter.h"
+#include "dsp/dsptypes.h"
 
 #define FILESOURCE_THROTTLE_MS 50
 
 class SampleSinkFifo;
+class FileSourceMap;
+class MessageQueue;
 
 class FileSourceThread : public QThread {
 	Q_OBJECT
 
 public:
-	FileSourceThread(std::ifstream *samplesStream, SampleSinkFifo* sampleFifo, QObject* parent = NULL);
+	FileSourceThread(const std::vector<FileSourceMap*>& fileMaps, SampleSinkFifo* sampleFifo, MessageQueue *sourceMessageQueue, QObject* parent = NULL);
 	~FileSourceThread();
 
 	void startWork();
 	void stopWork();
 	void setSampleRateAndSize(int samplerate, quint32 samplesize);
-    void setBuffers(std::size_t chunksize);
 	bool isRunning() const { return m_running; }
-	std::size_t getSamplesCount() const { return m_samplesCount; }
-	void setSamplesCount(int samplesCount) { m_samplesCount = samplesCount; }
+	quint64 getSamplesCount() const { return m_samplesCount; }
+	unsigned int getFileIndex() const { return m_fileIndex; }
+	/** Continue from this sample index of the current file. Takes effect at the next tick whether playing or not. */
+	void seek(quint64 sampleIndex);
+	/** Push samples as fast as the sample FIFO drains instead of following the master timer */
+	void setFreeRun(bool freeRun);
+	bool isReplayCompleted() const { return m_replayCompleted; }
 
 	void connectTimer(const QTimer& timer);
 
@@ -54,24 +58,35 @@ private:
 	QWaitCondition m_startWaiter;
 	volatile bool m_running;
 
-	std::ifstream* m_ifstream;
-	quint8  *m_fileBuf;
-	quint8  *m_convertBuf;
-	std::size_t m_bufsize;
-	std::size_t m_chunksize;
+	std::vector<FileSourceMap*> m_fileMaps; //!< playlist
+	volatile unsigned int m_fileIndex;
+	FileSourceMap* m_fileMap;   //!< file being replayed
+	bool m_nextPrefetched;      //!< start of the next file already requested from the disk
+	SampleVector m_convertBuf;
+	std::size_t m_chunkSamples; //!< number of I/Q samples sent at each tick
 	SampleSinkFifo* m_sampleFifo;
-	std::size_t m_samplesCount;
+	QMutex m_mutex;             //!< protects the play position against seeks
+	quint64 m_samplesCount;     //!< play position as a sample index from the start of the current file
+	volatile bool m_freeRun;
+	MessageQueue *m_sourceMessageQueue; //!< FileSourceInput queue to report sample rate or frequency changes
+	quint64 m_segmentStart;     //!< samples of the current record segment (constant rate and frequency)
+	quint64 m_segmentEnd;
+	quint64 m_centerFrequency;
+	volatile bool m_replayCompleted; //!< end of the last file reached in free run mode
 
 	int m_samplerate;      //!< File I/Q stream original sample rate
 	quint32 m_samplesize;  //!< File effective sample size in bits (I or Q). Ex: 16, 24.
-	quint32 m_samplebytes; //!< Number of bytes used to store a I or Q sample. Ex: 2. 4.
     int m_throttlems;
     QElapsedTimer m_elapsedTimer;
     bool m_throttleToggle;
 
 	void run();
 	//void decimate1(SampleVector::iterator* it, const qint16* buf, qint32 len);
-	void writeToSampleFifo(const quint8* buf, qint32 nbBytes);
+	void writeToSampleFifo(const quint8* buf, quint32 nbSamples);
+	bool writeFreeRun();
+	bool updateSegment();
+	bool nextFile(bool loop);
+	void prefetchNextFile();
 private slots:
 	void tick();
 };
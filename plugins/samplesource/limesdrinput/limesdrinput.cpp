@@ -24,6 +24,7 @@
 #include "SWGLimeSdrInputSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGLimeSdrInputReport.h"
 
 #include "device/devicesourceapi.h"
@@ -1394,6 +1395,9 @@ int LimeSDRInput::webapiReportGet(
     response.setLimeSdrInputReport(new SWGSDRangel::SWGLimeSdrInputReport());
     response.getLimeSdrInputReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
@@ -19,6 +19,7 @@
 #include "SWGDeviceSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGPerseusReport.h"
 
 #include "dsp/filerecord.h"
@@ -500,6 +501,9 @@ int PerseusInput::webapiReportGet(
     response.setPerseusReport(new SWGSDRangel::SWGPerseusReport());
     response.getPerseusReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
@@ -19,6 +19,7 @@
 #include "SWGDeviceSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGPlutoSdrInputReport.h"
 
 #include "dsp/filerecord.h"
@@ -742,6 +743,9 @@ int PlutoSDRInput::webapiReportGet(
     response.setPlutoSdrInputReport(new SWGSDRangel::SWGPlutoSdrInputReport());
     response.getPlutoSdrInputReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
@@ -23,6 +23,7 @@
 #include "SWGRtlSdrSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGRtlSdrReport.h"
 
 #include "rtlsdrinput.h"
@@ -669,6 +670,9 @@ int RTLSDRInput::webapiReportGet(
     response.setRtlSdrReport(new SWGSDRangel::SWGRtlSdrReport());
     response.getRtlSdrReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
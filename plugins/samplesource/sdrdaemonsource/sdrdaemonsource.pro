@@ -42,18 +42,24 @@ CONFIG(MINGW64):INCLUDEPATH += "D:\boost_1_58_0"
 CONFIG(macx):INCLUDEPATH += "../../../boost_1_64_0"
 
 SOURCES += sdrdaemonsourcebuffer.cpp\
+sdrdaemonsourcefecpool.cpp\
+sdrdaemonsourceoutputthread.cpp\
 sdrdaemonsourcegui.cpp\
 sdrdaemonsourceinput.cpp\
 sdrdaemonsourcesettings.cpp\
 sdrdaemonsourceplugin.cpp\
-sdrdaemonsourceudphandler.cpp
+sdrdaemonsourceudphandler.cpp\
+sdrdaemonsourceudpthread.cpp
 
 HEADERS += sdrdaemonsourcebuffer.h\
+sdrdaemonsourcefecpool.h\
+sdrdaemonsourceoutputthread.h\
 sdrdaemonsourcegui.h\
 sdrdaemonsourceinput.h\
 sdrdaemonsourcesettings.h\
 sdrdaemonsourceplugin.h\
-sdrdaemonsourceudphandler.h
+sdrdaemonsourceudphandler.h\
+sdrdaemonsourceudpthread.h
 
 FORMS += sdrdaemonsourcegui.ui
 
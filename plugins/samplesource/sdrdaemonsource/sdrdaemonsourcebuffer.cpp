@@ -15,6 +15,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <QDebug>
+#include <QThread>
 #include <cassert>
 #include <cstring>
 #include <cmath>
@@ -22,13 +23,20 @@
 #include <boost/crc.hpp>
 #include <boost/cstdint.hpp>
 #include "sdrdaemonsourcebuffer.h"
+#include "sdrdaemonsourcefecpool.h"
 
 
 
-const int SDRdaemonSourceBuffer::m_sampleSize = 2;
-const int SDRdaemonSourceBuffer::m_iqSampleSize = 2 * m_sampleSize;
+const int SDRdaemonSourceBuffer::m_sampleSize = sizeof(FixReal);
+const int SDRdaemonSourceBuffer::m_iqSampleSize = sizeof(Sample);
 
 SDRdaemonSourceBuffer::SDRdaemonSourceBuffer() :
+        m_blockSize(0),
+        m_blocksFrameSize(0),
+        m_encoding(IQPacker::Encoding16),
+        m_samplesPerBlock(0),
+        m_frameSize(0),
+        m_framesNbBytes(0),
         m_decoderIndexHead(nbDecoderSlots/2),
         m_frameHead(0),
         m_curNbBlocks(0),
@@ -38,23 +46,20 @@ SDRdaemonSourceBuffer::SDRdaemonSourceBuffer() :
         m_curNbRecovery(0),
         m_maxNbRecovery(0),
         m_framesDecoded(true),
+        m_fecReportRequested(false),
+        m_reportNbFrames(0),
+        m_reportNbLostBlocks(0),
+        m_reportMaxNbLostBlocks(0),
+        m_reportNbUnrecoverable(0),
         m_readIndex(0),
         m_readBuffer(0),
         m_readSize(0),
         m_bufferLenSec(0.0f),
-        m_nbReads(0),
-        m_nbWrites(0),
-        m_balCorrection(0),
-	    m_balCorrLimit(0)
+	    m_fecPool(0)
 {
 	m_currentMeta.init();
-	m_framesNbBytes = nbDecoderSlots * sizeof(BufferFrame);
-	m_wrDeltaEstimate = m_framesNbBytes / 2;
 	m_tvOut_sec = 0;
 	m_tvOut_usec = 0;
-	m_readNbBytes = 1;
-    m_paramsCM256.BlockBytes = sizeof(ProtectedBlock); // never changes
-    m_paramsCM256.OriginalCount = m_nbOriginalBlocks;  // never changes
 
     if (!m_cm256.isInitialized()) {
         m_cm256_OK = false;
@@ -64,11 +69,26 @@ SDRdaemonSourceBuffer::SDRdaemonSourceBuffer() :
     }
 
     std::fill(m_decoderSlots, m_decoderSlots + nbDecoderSlots, DecoderSlot());
-    std::fill(m_frames, m_frames + nbDecoderSlots, BufferFrame());
+    setBlockSize(SDRDAEMONSOURCE_UDPSIZE - sizeof(Header));
+
+    if (m_cm256_OK)
+    {
+        m_fecPool = new SDRdaemonSourceFECPool(this, nbDecoderSlots, std::min(4, std::max(1, QThread::idealThreadCount() / 2)));
+
+        if (m_fecPool->getNbWorkers() == 0) // decode in the reception thread
+        {
+            delete m_fecPool;
+            m_fecPool = 0;
+        }
+    }
 }
 
 SDRdaemonSourceBuffer::~SDRdaemonSourceBuffer()
 {
+    if (m_fecPool) {
+        delete m_fecPool;
+    }
+
 	if (m_readBuffer) {
 		delete[] m_readBuffer;
 	}
@@ -81,11 +101,14 @@ void SDRdaemonSourceBuffer::initDecodeAllSlots()
         m_decoderSlots[i].m_blockCount = 0;
         m_decoderSlots[i].m_originalCount = 0;
         m_decoderSlots[i].m_recoveryCount = 0;
+        m_decoderSlots[i].m_maxOriginalIndex = -1;
         m_decoderSlots[i].m_decoded = false;
         m_decoderSlots[i].m_metaRetrieved = false;
         resetOriginalBlocks(i);
-        memset((void *) m_decoderSlots[i].m_recoveryBlocks, 0, m_nbOriginalBlocks * sizeof(ProtectedBlock));
+        memset((void *) m_decoderSlots[i].m_recoveryBlocks.data(), 0, m_decoderSlots[i].m_recoveryBlocks.size());
     }
+
+    std::fill(m_frames.begin(), m_frames.end(), 0);
 }
 
 void SDRdaemonSourceBuffer::initDecodeSlot(int slotIndex)
@@ -112,72 +135,126 @@ void SDRdaemonSourceBuffer::initDecodeSlot(int slotIndex)
         m_maxNbRecovery = m_curNbRecovery;
     }
 
+    if (m_curNbBlocks > 0) // loss report
+    {
+        int nbFECBlocks = m_decoderSlots[slotIndex].m_metaRetrieved ? getMetaData(slotIndex)->m_nbFECBlocks : m_currentMeta.m_nbFECBlocks;
+        int nbLostBlocks = std::max(0, m_nbOriginalBlocks + nbFECBlocks - m_curNbBlocks);
+        m_reportNbFrames++;
+        m_reportNbLostBlocks += nbLostBlocks;
+        m_reportMaxNbLostBlocks = std::max(m_reportMaxNbLostBlocks, nbLostBlocks);
+
+        if (m_curNbBlocks < m_nbOriginalBlocks) {
+            m_reportNbUnrecoverable++;
+        }
+    }
+
     // void the slot
 
     m_decoderSlots[slotIndex].m_blockCount = 0;
     m_decoderSlots[slotIndex].m_originalCount = 0;
     m_decoderSlots[slotIndex].m_recoveryCount = 0;
+    m_decoderSlots[slotIndex].m_maxOriginalIndex = -1;
     m_decoderSlots[slotIndex].m_decoded = false;
     m_decoderSlots[slotIndex].m_metaRetrieved = false;
 
     resetOriginalBlocks(slotIndex);
-    memset((void *) m_decoderSlots[slotIndex].m_recoveryBlocks, 0, m_nbOriginalBlocks * sizeof(ProtectedBlock));
+    memset((void *) m_decoderSlots[slotIndex].m_recoveryBlocks.data(), 0, m_decoderSlots[slotIndex].m_recoveryBlocks.size());
 }
 
-void SDRdaemonSourceBuffer::initReadIndex()
+void SDRdaemonSourceBuffer::setBlockSize(uint32_t blockSize)
 {
-    m_readIndex = ((m_decoderIndexHead + (nbDecoderSlots/2)) % nbDecoderSlots) * sizeof(BufferFrame);
-    m_wrDeltaEstimate = m_framesNbBytes / 2;
-    m_nbReads = 0;
-    m_nbWrites = 0;
+    if (m_fecPool) {
+        m_fecPool->waitAll(); // the decodes use the buffers
+    }
+
+    m_releaseQueue.clear();
+    m_blockSize = blockSize;
+    m_blocksFrameSize = (m_nbOriginalBlocks - 1) * blockSize;
+    m_blocks.assign(nbDecoderSlots * m_blocksFrameSize, 0);
+
+    for (int i = 0; i < nbDecoderSlots; i++)
+    {
+        m_decoderSlots[i].m_blockZero.assign(blockSize, 0);
+        m_decoderSlots[i].m_recoveryBlocks.assign(m_nbOriginalBlocks * blockSize, 0);
+    }
+
+    m_frameHead = -1; // start over at next block
+    setEncoding(m_encoding);
+
+    qDebug("SDRdaemonSourceBuffer::setBlockSize: UDP size: %u", getUdpSize());
 }
 
-void SDRdaemonSourceBuffer::rwCorrectionEstimate(int slotIndex)
+void SDRdaemonSourceBuffer::setEncoding(IQPacker::Encoding encoding)
 {
-	if (m_nbReads >= 40) // check every ~1s as tick is ~50ms
-	{
-		int targetPivotSlot = (slotIndex + (nbDecoderSlots/2))  % nbDecoderSlots; // slot at half buffer opposite of current write slot
-		int targetPivotIndex = targetPivotSlot * sizeof(BufferFrame);             // buffer index corresponding to start of above slot
-		int normalizedReadIndex = (m_readIndex < targetPivotIndex ? m_readIndex + nbDecoderSlots * sizeof(BufferFrame) :  m_readIndex)
-				- (targetPivotSlot * sizeof(BufferFrame)); // normalize read index so it is positive and zero at start of pivot slot
-		int dBytes;
-        int rwDelta = (m_nbReads * m_readNbBytes) - (m_nbWrites * sizeof(BufferFrame));
-
-		if (normalizedReadIndex < (nbDecoderSlots/ 2) * (int) sizeof(BufferFrame)) // read leads
-		{
-			dBytes = - normalizedReadIndex - rwDelta;
-		}
-		else // read lags
-		{
-			dBytes = (nbDecoderSlots * sizeof(BufferFrame)) - normalizedReadIndex - rwDelta;
-		}
-
-        m_balCorrection = (m_balCorrection / 4) + (dBytes / (int) (m_iqSampleSize * m_nbReads)); // correction is in number of samples. Alpha = 0.25
-
-        if (m_balCorrection < -m_balCorrLimit) {
-            m_balCorrection = -m_balCorrLimit;
-        } else if (m_balCorrection > m_balCorrLimit) {
-            m_balCorrection = m_balCorrLimit;
-        }
+    m_encoding = encoding;
+    m_samplesPerBlock = IQPacker::getSamplesPerBlock(encoding, m_blockSize);
+    m_frameSize = (m_nbOriginalBlocks - 1) * m_samplesPerBlock * m_iqSampleSize;
+    m_framesNbBytes = nbDecoderSlots * m_frameSize;
+    m_frames.assign(m_framesNbBytes, 0);
+    initReadIndex();
 
-	    m_nbReads = 0;
-	    m_nbWrites = 0;
-	}
+    int sampleRate = m_currentMeta.m_sampleRate;
+
+    if (sampleRate > 0) {
+        m_bufferLenSec = (float) m_framesNbBytes / (float) (sampleRate * m_iqSampleSize);
+    }
+
+    qDebug("SDRdaemonSourceBuffer::setEncoding: %s: %d samples per block buffer: %d bytes",
+            IQPacker::getName(encoding), m_samplesPerBlock, m_framesNbBytes);
+}
+
+void SDRdaemonSourceBuffer::unpackSlot(int slotIndex)
+{
+    const MetaDataFEC *metaData = m_decoderSlots[slotIndex].m_metaRetrieved ? getMetaData(slotIndex) : &m_currentMeta;
+    IQPacker::Encoding encoding = IQPacker::getEncoding(metaData->m_sampleBytes);
+
+    if (encoding != m_encoding) { // the sender changed the encoding
+        setEncoding(encoding);
+    }
+
+    Sample *samples = (Sample *) &m_frames[slotIndex * m_frameSize];
+
+    for (int blockIndex = 1; blockIndex < m_nbOriginalBlocks; blockIndex++, samples += m_samplesPerBlock) {
+        IQPacker::unpack(m_encoding, getOriginalBlock(slotIndex, blockIndex), samples, m_samplesPerBlock, SDR_RX_SAMP_SZ);
+    }
+}
+
+bool SDRdaemonSourceBuffer::isSizeAnnounced(const Header& header, const uint8_t *block, uint32_t blockSize)
+{
+    if ((header.blockIndex != 0) || (blockSize < sizeof(MetaDataFEC)) || (blockSize + sizeof(Header) > (uint32_t) m_udpSizeMax)) {
+        return false;
+    }
+
+    const MetaDataFEC *metaData = (const MetaDataFEC *) block;
+    boost::crc_32_type crc32;
+    crc32.process_bytes(metaData, 20);
+
+    if (crc32.checksum() != metaData->m_crc32) {
+        return false;
+    }
+
+    uint32_t udpSize = metaData->m_udpSize == 0 ? SDRDAEMONSOURCE_UDPSIZE : metaData->m_udpSize;
+    return udpSize == blockSize + sizeof(Header);
+}
+
+void SDRdaemonSourceBuffer::initReadIndex()
+{
+    m_readIndex = ((m_decoderIndexHead + (nbDecoderSlots/2)) % nbDecoderSlots) * m_frameSize;
+    m_wrDeltaEstimate = m_framesNbBytes / 2;
 }
 
 void SDRdaemonSourceBuffer::checkSlotData(int slotIndex)
 {
-    int pseudoWriteIndex = slotIndex * sizeof(BufferFrame);
+    int pseudoWriteIndex = ((slotIndex + 1) % nbDecoderSlots) * m_frameSize; // the frame is written up to the next slot
     m_wrDeltaEstimate = pseudoWriteIndex - m_readIndex;
-    m_nbWrites++;
 
-    int rwDelayBytes = (m_wrDeltaEstimate > 0 ? m_wrDeltaEstimate : sizeof(BufferFrame) * nbDecoderSlots + m_wrDeltaEstimate);
+    int rwDelayBytes = (m_wrDeltaEstimate > 0 ? m_wrDeltaEstimate : m_framesNbBytes + m_wrDeltaEstimate);
     int sampleRate = m_currentMeta.m_sampleRate;
 
     if (sampleRate > 0)
     {
         int64_t ts = m_currentMeta.m_tv_sec * 1000000LL + m_currentMeta.m_tv_usec;
-        ts -= (rwDelayBytes * 1000000LL) / (sampleRate * sizeof(SDRdaemonSample));
+        ts -= (rwDelayBytes * 1000000LL) / (sampleRate * m_iqSampleSize);
         m_tvOut_sec = ts / 1000000LL;
         m_tvOut_usec = ts - (m_tvOut_sec * 1000000LL);
     }
@@ -190,16 +267,57 @@ void SDRdaemonSourceBuffer::checkSlotData(int slotIndex)
     }
 }
 
-void SDRdaemonSourceBuffer::writeData(char *array)
+void SDRdaemonSourceBuffer::writeData(char *array, uint32_t length)
+{
+    if (length < sizeof(Header)) {
+        return;
+    }
+
+    Header header;
+    memcpy(&header, array, sizeof(Header));
+    writeData(header, (const uint8_t *) &array[sizeof(Header)], length - sizeof(Header));
+}
+
+uint8_t *SDRdaemonSourceBuffer::getExpectedBlock(int n, Header& header)
 {
-    SuperBlock *superBlock = (SuperBlock *) array;
-    int frameIndex = superBlock->header.frameIndex;
+    const DecoderSlot& slot = m_decoderSlots[m_decoderIndexHead];
+    int blockIndex = slot.m_maxOriginalIndex + 1 + n;
+
+    // block zero and recovery blocks go to the decoder slot and the next frame would re-initialize its slot first
+    if ((m_frameHead < 0) || (blockIndex < 1) || (blockIndex >= m_nbOriginalBlocks) || (slot.m_blockCount + n >= m_nbOriginalBlocks)) {
+        return 0;
+    }
+
+    header.frameIndex = m_frameHead;
+    header.blockIndex = blockIndex;
+    header.filler = 0;
+    return getOriginalBlock(m_decoderIndexHead, blockIndex);
+}
+
+void SDRdaemonSourceBuffer::writeData(const Header& header, const uint8_t *block, uint32_t blockSize)
+{
+    if (blockSize != m_blockSize) // the sender changed the datagram size or this is garbage
+    {
+        if (isSizeAnnounced(header, block, blockSize)) {
+            setBlockSize(blockSize);
+        } else {
+            return;
+        }
+    }
+
+    int frameIndex = header.frameIndex;
     int decoderIndex = frameIndex % nbDecoderSlots;
+    m_fecReportRequested = (header.filler & 1) != 0;
 
     // frame break
 
     if (m_frameHead == -1) // initial state
     {
+        if (m_fecPool) {
+            m_fecPool->waitAll();
+        }
+
+        m_releaseQueue.clear();
         m_decoderIndexHead = decoderIndex; // new decoder slot head
         m_frameHead = frameIndex;
         initReadIndex(); // reset read index
@@ -207,10 +325,10 @@ void SDRdaemonSourceBuffer::writeData(char *array)
     }
     else if (m_frameHead != frameIndex) // frame break => new frame starts
     {
+        m_releaseQueue.push_back(m_decoderIndexHead); // previous frame is closed
         m_decoderIndexHead = decoderIndex; // new decoder slot head
         m_frameHead = frameIndex;          // new frame head
-        checkSlotData(decoderIndex);       // check slot before re-init
-        rwCorrectionEstimate(decoderIndex);
+        releaseFrames();                   // release decoded frames and the new slot if still in use
         initDecodeSlot(decoderIndex);      // collect stats and re-initialize current slot
     }
 
@@ -218,7 +336,7 @@ void SDRdaemonSourceBuffer::writeData(char *array)
 
     if (m_decoderSlots[decoderIndex].m_blockCount < m_nbOriginalBlocks) // not enough blocks to decode -> store data
     {
-        int blockIndex = superBlock->header.blockIndex;
+        int blockIndex = header.blockIndex;
         int blockCount = m_decoderSlots[decoderIndex].m_blockCount;
         int recoveryCount = m_decoderSlots[decoderIndex].m_recoveryCount;
         m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[blockCount].Index = blockIndex;
@@ -230,13 +348,15 @@ void SDRdaemonSourceBuffer::writeData(char *array)
 
         if (blockIndex < m_nbOriginalBlocks) // original data
         {
-            m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[blockCount].Block = (void *) storeOriginalBlock(decoderIndex, blockIndex, superBlock->protectedBlock);
+            m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[blockCount].Block = (void *) storeOriginalBlock(decoderIndex, blockIndex, block);
             m_decoderSlots[decoderIndex].m_originalCount++;
+            m_decoderSlots[decoderIndex].m_maxOriginalIndex = std::max(m_decoderSlots[decoderIndex].m_maxOriginalIndex, blockIndex);
         }
         else // recovery data
         {
-            m_decoderSlots[decoderIndex].m_recoveryBlocks[recoveryCount] = superBlock->protectedBlock;
-            m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[blockCount].Block = (void *) &m_decoderSlots[decoderIndex].m_recoveryBlocks[recoveryCount];
+            uint8_t *recoveryBlock = getRecoveryBlock(decoderIndex, recoveryCount);
+            memcpy(recoveryBlock, block, m_blockSize);
+            m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[blockCount].Block = (void *) recoveryBlock;
             m_decoderSlots[decoderIndex].m_recoveryCount++;
         }
     }
@@ -249,78 +369,146 @@ void SDRdaemonSourceBuffer::writeData(char *array)
 
         if (m_cm256_OK && (m_decoderSlots[decoderIndex].m_recoveryCount > 0)) // recovery data used => need to decode FEC
         {
-            m_paramsCM256.BlockBytes = sizeof(ProtectedBlock); // never changes
-            m_paramsCM256.OriginalCount = m_nbOriginalBlocks;  // never changes
+            int recoveryCount;
 
             if (m_decoderSlots[decoderIndex].m_metaRetrieved) {
-                m_paramsCM256.RecoveryCount = m_currentMeta.m_nbFECBlocks;
+                recoveryCount = getMetaData(decoderIndex)->m_nbFECBlocks; // m_currentMeta may already be the next frame
             } else {
-                m_paramsCM256.RecoveryCount = m_decoderSlots[decoderIndex].m_recoveryCount;
+                recoveryCount = m_decoderSlots[decoderIndex].m_recoveryCount;
             }
 
-            if (m_cm256.cm256_decode(m_paramsCM256, m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks)) // CM256 decode
-            {
-                qDebug() << "SDRdaemonSourceBuffer::writeData: decode CM256 error:"
-                        << " m_originalCount: " << m_decoderSlots[decoderIndex].m_originalCount
-                        << " m_recoveryCount: " << m_decoderSlots[decoderIndex].m_recoveryCount;
+            if (m_fecPool) {
+                m_fecPool->push(decoderIndex, recoveryCount); // the slot is left alone until decoded
+            } else {
+                decodeSlot(decoderIndex, recoveryCount, m_cm256);
             }
-            else
-            {
-                qDebug() << "SDRdaemonSourceBuffer::writeData: decode CM256 success:"
-                        << " m_originalCount: " << m_decoderSlots[decoderIndex].m_originalCount
-                        << " m_recoveryCount: " << m_decoderSlots[decoderIndex].m_recoveryCount;
+        }
+    } // decode
+}
 
-                for (int ir = 0; ir < m_decoderSlots[decoderIndex].m_recoveryCount; ir++) // restore missing blocks
-                {
-                    int recoveryIndex = m_nbOriginalBlocks - m_decoderSlots[decoderIndex].m_recoveryCount + ir;
-                    int blockIndex = m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[recoveryIndex].Index;
-                    ProtectedBlock *recoveredBlock = (ProtectedBlock *) m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[recoveryIndex].Block;
-
-                    if (blockIndex == 0) // first block with meta
-                    {
-                        MetaDataFEC *metaData = (MetaDataFEC *) recoveredBlock;
-
-                        boost::crc_32_type crc32;
-                        crc32.process_bytes(metaData, 20);
-
-                        if (crc32.checksum() == metaData->m_crc32)
-                        {
-                            m_decoderSlots[decoderIndex].m_metaRetrieved = true;
-                            printMeta("SDRdaemonSourceBuffer::writeData: recovered meta", metaData);
-                        }
-                        else
-                        {
-                            qDebug() << "SDRdaemonSourceBuffer::writeData: recovered meta: invalid CRC32";
-                        }
-                    }
-
-                    storeOriginalBlock(decoderIndex, blockIndex, *recoveredBlock);
-
-                    qDebug() << "SDRdaemonSourceBuffer::writeData: recovered block #" << blockIndex;
-                } // restore missing blocks
-            } // CM256 decode
-        } // revovery
-
-        if (m_decoderSlots[decoderIndex].m_metaRetrieved) // block zero with its meta data has been received
+void SDRdaemonSourceBuffer::decodeSlot(int slotIndex, int recoveryCount, CM256& cm256)
+{
+    DecoderSlot& slot = m_decoderSlots[slotIndex];
+    CM256::cm256_encoder_params paramsCM256;
+    paramsCM256.BlockBytes = m_blockSize;             // changes with the datagram size only
+    paramsCM256.OriginalCount = m_nbOriginalBlocks;   // never changes
+    paramsCM256.RecoveryCount = recoveryCount;
+
+    if (cm256.cm256_decode(paramsCM256, slot.m_cm256DescriptorBlocks)) // CM256 decode
+    {
+        qDebug() << "SDRdaemonSourceBuffer::decodeSlot: decode CM256 error:"
+                << " m_originalCount: " << slot.m_originalCount
+                << " m_recoveryCount: " << slot.m_recoveryCount;
+    }
+    else
+    {
+        qDebug() << "SDRdaemonSourceBuffer::decodeSlot: decode CM256 success:"
+                << " m_originalCount: " << slot.m_originalCount
+                << " m_recoveryCount: " << slot.m_recoveryCount;
+
+        for (int ir = 0; ir < slot.m_recoveryCount; ir++) // restore missing blocks
         {
-            MetaDataFEC *metaData = getMetaData(decoderIndex);
+            int recoveryIndex = m_nbOriginalBlocks - slot.m_recoveryCount + ir;
+            int blockIndex = slot.m_cm256DescriptorBlocks[recoveryIndex].Index;
+            uint8_t *recoveredBlock = (uint8_t *) slot.m_cm256DescriptorBlocks[recoveryIndex].Block;
 
-            if (!(*metaData == m_currentMeta))
+            if (blockIndex == 0) // first block with meta
             {
-                int sampleRate =  metaData->m_sampleRate;
+                MetaDataFEC *metaData = (MetaDataFEC *) recoveredBlock;
 
-                if (sampleRate > 0) {
-                    m_bufferLenSec = (float) m_framesNbBytes / (float) (sampleRate * m_iqSampleSize);
-                    m_balCorrLimit = sampleRate / 1000; // +/- 1 ms correction max per read
-                    m_readNbBytes = (sampleRate * m_iqSampleSize) / 20;
+                boost::crc_32_type crc32;
+                crc32.process_bytes(metaData, 20);
+
+                if (crc32.checksum() == metaData->m_crc32)
+                {
+                    slot.m_metaRetrieved = true;
+                    printMeta("SDRdaemonSourceBuffer::decodeSlot: recovered meta", metaData);
+                }
+                else
+                {
+                    qDebug() << "SDRdaemonSourceBuffer::decodeSlot: recovered meta: invalid CRC32";
                 }
+            }
+
+            storeOriginalBlock(slotIndex, blockIndex, recoveredBlock);
 
-                printMeta("SDRdaemonSourceBuffer::writeData: new meta", metaData); // print for change other than timestamp
+            qDebug() << "SDRdaemonSourceBuffer::decodeSlot: recovered block #" << blockIndex;
+        } // restore missing blocks
+    } // CM256 decode
+}
+
+void SDRdaemonSourceBuffer::releaseFrames()
+{
+    // the new head slot is re-used right after so its frame and the ones before must be released whatever
+    std::deque<int>::iterator headIt = std::find(m_releaseQueue.begin(), m_releaseQueue.end(), m_decoderIndexHead);
+    int nbForced = headIt == m_releaseQueue.end() ? 0 : (headIt - m_releaseQueue.begin()) + 1;
+
+    while (!m_releaseQueue.empty())
+    {
+        int slotIndex = m_releaseQueue.front();
+
+        if (m_fecPool)
+        {
+            if ((nbForced > 0) || (m_releaseQueue.size() > m_maxPendingFrames)) {
+                m_fecPool->wait(slotIndex);
+            } else if (m_fecPool->isDecoding(slotIndex)) {
+                break; // frames are released in order
             }
+        }
 
-            m_currentMeta = *metaData; // renew current meta
-        } // check block 0
-    } // decode
+        m_releaseQueue.pop_front();
+        releaseFrame(slotIndex);
+        nbForced--;
+    }
+}
+
+void SDRdaemonSourceBuffer::releaseFrame(int slotIndex)
+{
+    if (m_decoderSlots[slotIndex].m_metaRetrieved) // block zero with its meta data has been received
+    {
+        MetaDataFEC *metaData = getMetaData(slotIndex);
+
+        if (!(*metaData == m_currentMeta))
+        {
+            int sampleRate =  metaData->m_sampleRate;
+
+            if (sampleRate > 0) {
+                m_bufferLenSec = (float) m_framesNbBytes / (float) (sampleRate * m_iqSampleSize);
+            }
+
+            printMeta("SDRdaemonSourceBuffer::releaseFrame: new meta", metaData); // print for change other than timestamp
+        }
+
+        m_currentMeta = *metaData; // renew current meta
+    }
+
+    unpackSlot(slotIndex);
+    checkSlotData(slotIndex);
+}
+
+bool SDRdaemonSourceBuffer::getFECReport(FECReport& report)
+{
+    if (!m_fecReportRequested || (m_reportNbFrames == 0)) {
+        return false;
+    }
+
+    report.m_magic = m_fecReportMagic;
+    report.m_frameIndex = m_frameHead;
+    report.m_nbFrames = std::min(m_reportNbFrames, 65535);
+    report.m_nbLostBlocks = m_reportNbLostBlocks;
+    report.m_nbFECBlocks = m_currentMeta.m_nbFECBlocks;
+    report.m_maxNbLostBlocks = std::min(m_reportMaxNbLostBlocks, 255);
+    report.m_nbUnrecoverable = std::min(m_reportNbUnrecoverable, 65535);
+
+    boost::crc_32_type crc32;
+    crc32.process_bytes(&report, 16);
+    report.m_crc32 = crc32.checksum();
+
+    m_reportNbFrames = 0;
+    m_reportNbLostBlocks = 0;
+    m_reportMaxNbLostBlocks = 0;
+    m_reportNbUnrecoverable = 0;
+    return true;
 }
 
 void SDRdaemonSourceBuffer::writeData0(char *array __attribute__((unused)), uint32_t length __attribute__((unused)))
@@ -398,14 +586,12 @@ void SDRdaemonSourceBuffer::writeData0(char *array __attribute__((unused)), uint
 
 uint8_t *SDRdaemonSourceBuffer::readData(int32_t length)
 {
-    uint8_t *buffer = (uint8_t *) m_frames;
+    uint8_t *buffer = m_frames.data();
     uint32_t readIndex = m_readIndex;
 
-    m_nbReads++;
-
     // SEGFAULT FIX: arbitratily truncate so that it does not exceed buffer length
-    if (length > framesSize) {
-        length = framesSize;
+    if (length > m_framesNbBytes) {
+        length = m_framesNbBytes;
     }
 
     if (m_readIndex + length < m_framesNbBytes) // ends before buffer bound
@@ -443,10 +629,11 @@ void SDRdaemonSourceBuffer::printMeta(const QString& header, MetaDataFEC *metaDa
 	qDebug() << header << ": "
             << "|" << metaData->m_centerFrequency
             << ":" << metaData->m_sampleRate
-            << ":" << (int) (metaData->m_sampleBytes & 0xF)
+            << ":" << IQPacker::getName(IQPacker::getEncoding(metaData->m_sampleBytes))
             << ":" << (int) metaData->m_sampleBits
             << ":" << (int) metaData->m_nbOriginalBlocks
             << ":" << (int) metaData->m_nbFECBlocks
+            << ":" << (metaData->m_udpSize == 0 ? SDRDAEMONSOURCE_UDPSIZE : metaData->m_udpSize)
             << "|" << metaData->m_tv_sec
             << ":" << metaData->m_tv_usec
             << "|";
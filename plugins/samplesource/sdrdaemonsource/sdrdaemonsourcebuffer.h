@@ -20,13 +20,21 @@
 #include <QString>
 #include <QDebug>
 #include <cstdlib>
+#include <vector>
+#include <deque>
 #include "cm256.h"
+#include "dsp/dsptypes.h"
+#include "dsp/iqpacker.h"
 #include "util/movingaverage.h"
 
 
-#define SDRDAEMONSOURCE_UDPSIZE 512               // UDP payload size
+#define SDRDAEMONSOURCE_UDPSIZE 512               // default UDP payload size
+#define SDRDAEMONSOURCE_UDPSIZEMAX 8192           // largest UDP payload size (jumbo frames)
 #define SDRDAEMONSOURCE_NBORIGINALBLOCKS 128      // number of sample blocks per frame excluding FEC blocks
 #define SDRDAEMONSOURCE_NBDECODERSLOTS 16         // power of two sub multiple of uint16_t size. A too large one is superfluous.
+#define SDRDAEMONSOURCE_MAXPENDINGFRAMES 4        // most closed frames waiting for their FEC decode before reception waits
+
+class SDRdaemonSourceFECPool;
 
 class SDRdaemonSourceBuffer
 {
@@ -36,13 +44,14 @@ public:
     {
         uint32_t m_centerFrequency;   //!<  4 center frequency in kHz
         uint32_t m_sampleRate;        //!<  8 sample rate in Hz
-        uint8_t  m_sampleBytes;       //!<  9 MSB(4): indicators, LSB(4) number of bytes per sample
+        uint8_t  m_sampleBytes;       //!<  9 MSB(4): indicators, LSB(4) number of bytes per sample (see IQPacker)
         uint8_t  m_sampleBits;        //!< 10 number of effective bits per sample
         uint8_t  m_nbOriginalBlocks;  //!< 11 number of blocks with original (protected) data
         uint8_t  m_nbFECBlocks;       //!< 12 number of blocks carrying FEC
         uint32_t m_tv_sec;            //!< 16 seconds of timestamp at start time of super-frame processing
         uint32_t m_tv_usec;           //!< 20 microseconds of timestamp at start time of super-frame processing
         uint32_t m_crc32;             //!< 24 CRC32 of the above
+        uint16_t m_udpSize;           //!< 26 size of the datagrams in bytes (0 from older senders that use 512)
 
         bool operator==(const MetaDataFEC& rhs)
         {
@@ -55,41 +64,50 @@ public:
         }
     };
 
-    struct SDRdaemonSample
-    {
-        int16_t i;
-        int16_t q;
-    };
-
     struct Header
     {
         uint16_t frameIndex;
         uint8_t  blockIndex;
-        uint8_t  filler;
+        uint8_t  filler;      //!< bit 0: the sender wants loss reports (see FECReport)
     };
 
-    static const int samplesPerBlock = (SDRDAEMONSOURCE_UDPSIZE - sizeof(Header)) / sizeof(SDRdaemonSample);
-    static const int framesSize = SDRDAEMONSOURCE_NBDECODERSLOTS * (SDRDAEMONSOURCE_NBORIGINALBLOCKS - 1) * (SDRDAEMONSOURCE_UDPSIZE - sizeof(Header));
-
-    struct ProtectedBlock
+    /** Loss statistics sent back to the source address of the datagrams */
+    struct FECReport
     {
-        SDRdaemonSample samples[samplesPerBlock];
+        uint32_t m_magic;             //!<  4 m_fecReportMagic
+        uint16_t m_frameIndex;        //!<  6 last frame received
+        uint16_t m_nbFrames;          //!<  8 number of frames received since the last report
+        uint32_t m_nbLostBlocks;      //!< 12 total number of blocks lost in these frames
+        uint8_t  m_nbFECBlocks;       //!< 13 number of FEC blocks of the last frame
+        uint8_t  m_maxNbLostBlocks;   //!< 14 largest number of blocks lost in a frame
+        uint16_t m_nbUnrecoverable;   //!< 16 number of frames with more blocks lost than FEC blocks
+        uint32_t m_crc32;             //!< 20 CRC32 of the above
     };
 
-    struct SuperBlock
-    {
-        Header         header;
-        ProtectedBlock protectedBlock;
-    };
 #pragma pack(pop)
 
+    static const uint32_t m_fecReportMagic = 0x52434546; //!< "FECR"
+
 	SDRdaemonSourceBuffer();
 	~SDRdaemonSourceBuffer();
 
 	// R/W operations
-	void writeData(char *array); //!< Write data into buffer.
+	void writeData(char *array, uint32_t length); //!< Write a datagram into buffer.
+	/**
+	 * Write a block into buffer. The copy is skipped if the block is already at its place (see getExpectedBlock).
+	 * Blocks of another size than the current one are dropped unless this is a block zero that announces this
+	 * size in its meta data. The buffer then starts over with the new size.
+	 */
+	void writeData(const Header& header, const uint8_t *block, uint32_t blockSize);
+	/**
+	 * Storage of the n-th original block expected after the last one received in the current frame or
+	 * null if it cannot be predicted. A batch receiver can have the payloads received there directly.
+	 */
+	uint8_t *getExpectedBlock(int n, Header& header);
+	uint32_t getUdpSize() const { return m_blockSize + sizeof(Header); } //!< size of the datagrams in bytes
+	uint32_t getBlockSize() const { return m_blockSize; } //!< size of the blocks (datagram payload) in bytes
     void writeData0(char *array, uint32_t length); //!< Write data into buffer.
-	uint8_t *readData(int32_t length);            //!< Read data from buffer
+	uint8_t *readData(int32_t length);            //!< Read samples (native Sample type) from buffer
 
 	// meta data
 	const MetaDataFEC& getCurrentMeta() const { return m_currentMeta; }
@@ -128,6 +146,9 @@ public:
         return maxNbRecovery;
     }
 
+    /** Loss statistics since the last call. Returns false if the sender does not want them or there are none. */
+    bool getFECReport(FECReport& report);
+
     bool allFramesDecoded()
     {
         bool framesDecoded = m_framesDecoded;
@@ -136,7 +157,7 @@ public:
     }
 
     float getBufferLengthInSecs() const { return m_bufferLenSec; }
-    int32_t getRWBalanceCorrection() const { return m_balCorrection; }
+    int getFramesNbBytes() const { return m_framesNbBytes; } //!< size of the samples buffer (zero until the first frame)
 
     /** Get buffer gauge value in % of buffer size ([-50:50])
      *  [-50:0] : write leads or read lags
@@ -156,38 +177,37 @@ public:
         }
     }
 
-    static const int m_udpPayloadSize = SDRDAEMONSOURCE_UDPSIZE;
+    static const int m_udpSizeMax = SDRDAEMONSOURCE_UDPSIZEMAX;
     static const int m_nbOriginalBlocks = SDRDAEMONSOURCE_NBORIGINALBLOCKS;
 	static const int m_sampleSize;
 	static const int m_iqSampleSize;
 
 private:
     static const int nbDecoderSlots = SDRDAEMONSOURCE_NBDECODERSLOTS;
-
-#pragma pack(push, 1)
-    struct BufferFrame
-    {
-        ProtectedBlock  m_blocks[m_nbOriginalBlocks - 1];
-    };
-#pragma pack(pop)
+    static const unsigned int m_maxPendingFrames = SDRDAEMONSOURCE_MAXPENDINGFRAMES;
 
     struct DecoderSlot
     {
-        ProtectedBlock       m_blockZero;                                 //!< First block of a frame. Has meta data.
-        ProtectedBlock       m_originalBlocks[m_nbOriginalBlocks];        //!< Original blocks retrieved directly or by later FEC
-        ProtectedBlock       m_recoveryBlocks[m_nbOriginalBlocks];        //!< Recovery blocks (FEC blocks) with max size
+        std::vector<uint8_t> m_blockZero;                                 //!< First block of a frame. Has meta data.
+        std::vector<uint8_t> m_recoveryBlocks;                            //!< Recovery blocks (FEC blocks) with max count
         CM256::cm256_block   m_cm256DescriptorBlocks[m_nbOriginalBlocks]; //!< CM256 decoder descriptors (block addresses and block indexes)
         int                  m_blockCount;         //!< number of blocks received for this frame
         int                  m_originalCount;      //!< number of original blocks received
         int                  m_recoveryCount;      //!< number of recovery blocks received
+        int                  m_maxOriginalIndex;   //!< highest index of the original blocks received (-1 for none)
         bool                 m_decoded;            //!< true if decoded
         bool                 m_metaRetrieved;      //!< true if meta data (block zero) was retrieved
     };
 
     MetaDataFEC          m_currentMeta;          //!< Stored current meta data
-    CM256::cm256_encoder_params m_paramsCM256;          //!< CM256 decoder parameters block
     DecoderSlot          m_decoderSlots[nbDecoderSlots]; //!< CM256 decoding control/buffer slots
-    BufferFrame          m_frames[nbDecoderSlots];       //!< Samples buffer
+    uint32_t             m_blockSize;                    //!< Size of the blocks (datagram payload) in bytes
+    int                  m_blocksFrameSize;              //!< Number of bytes of blocks in a frame (the blocks but block zero)
+    std::vector<uint8_t> m_blocks;                       //!< Blocks buffer: the original blocks of all slots one after the other
+    IQPacker::Encoding   m_encoding;                     //!< Encoding of the samples in the blocks
+    int                  m_samplesPerBlock;              //!< Number of samples in a block with this encoding
+    int                  m_frameSize;                    //!< Number of bytes of unpacked samples in a frame
+    std::vector<uint8_t> m_frames;                       //!< Samples buffer: the unpacked frames of all slots one after the other
     int                  m_framesNbBytes;                //!< Number of bytes in samples buffer
     int                  m_decoderIndexHead;     //!< index of the current head frame slot in decoding slots
     int                  m_frameHead;            //!< index of the current head frame sent
@@ -201,70 +221,77 @@ private:
     MovingAverageUtil<int, int, 10> m_avgOrigBlocks; //!< (stats) average number of original blocks received
     MovingAverageUtil<int, int, 10> m_avgNbRecovery; //!< (stats) average number of recovery blocks used
     bool                 m_framesDecoded;        //!< [stats] true if all frames were decoded since last poll
+    bool                 m_fecReportRequested;   //!< the sender of the last block wants loss reports
+    int                  m_reportNbFrames;       //!< (report) number of frames since last report
+    int                  m_reportNbLostBlocks;   //!< (report) number of blocks lost since last report
+    int                  m_reportMaxNbLostBlocks; //!< (report) largest number of blocks lost in a frame since last report
+    int                  m_reportNbUnrecoverable; //!< (report) number of frames that could not be restored since last report
     int                  m_readIndex;            //!< current byte read index in frames buffer
     int                  m_wrDeltaEstimate;      //!< Sampled estimate of write to read indexes difference
     uint32_t             m_tvOut_sec;            //!< Estimated returned samples timestamp (seconds)
     uint32_t             m_tvOut_usec;           //!< Estimated returned samples timestamp (microseconds)
-    int                  m_readNbBytes;          //!< Nominal number of bytes per read (50ms)
 
     uint8_t* m_readBuffer;         //!< Read buffer to hold samples when looping back to beginning of raw buffer
     int      m_readSize;           //!< Read buffer size
 
     float    m_bufferLenSec;
 
-    int      m_nbReads;       //!< Number of buffer reads since start of auto R/W balance correction period
-    int      m_nbWrites;      //!< Number of buffer writes since start of auto R/W balance correction period
-    int      m_balCorrection; //!< R/W balance correction in number of samples
-    int      m_balCorrLimit;  //!< Correction absolute value limit in number of samples
     CM256    m_cm256;         //!< CM256 library
     bool     m_cm256_OK;      //!< CM256 library initialized OK
+    SDRdaemonSourceFECPool *m_fecPool;  //!< CM256 decode threads (decode in the reception thread if there are none)
+    std::deque<int> m_releaseQueue;     //!< slots of the closed frames to be released in order (unpacked for reading)
 
-    inline ProtectedBlock* storeOriginalBlock(int slotIndex, int blockIndex, const ProtectedBlock& protectedBlock)
+    inline uint8_t* storeOriginalBlock(int slotIndex, int blockIndex, const uint8_t *protectedBlock)
     {
-        if (blockIndex == 0) {
-            // m_decoderSlots[slotIndex].m_originalBlocks[0] = protectedBlock;
-            // return &m_decoderSlots[slotIndex].m_originalBlocks[0];
-            m_decoderSlots[slotIndex].m_blockZero = protectedBlock;
-            return &m_decoderSlots[slotIndex].m_blockZero;
-        } else {
-            // m_decoderSlots[slotIndex].m_originalBlocks[blockIndex] = protectedBlock;
-            // return &m_decoderSlots[slotIndex].m_originalBlocks[blockIndex];
-            m_frames[slotIndex].m_blocks[blockIndex - 1] = protectedBlock;
-            return &m_frames[slotIndex].m_blocks[blockIndex - 1];
+        uint8_t *block = getOriginalBlock(slotIndex, blockIndex);
+
+        if (block != protectedBlock) { // not received in place
+            memcpy(block, protectedBlock, m_blockSize);
         }
+
+        return block;
     }
 
-    inline ProtectedBlock& getOriginalBlock(int slotIndex, int blockIndex)
+    inline uint8_t* getOriginalBlock(int slotIndex, int blockIndex)
     {
         if (blockIndex == 0) {
-            // return m_decoderSlots[slotIndex].m_originalBlocks[0];
-            return m_decoderSlots[slotIndex].m_blockZero;
+            return m_decoderSlots[slotIndex].m_blockZero.data();
         } else {
-            // return m_decoderSlots[slotIndex].m_originalBlocks[blockIndex];
-            return m_frames[slotIndex].m_blocks[blockIndex - 1];
+            return &m_blocks[slotIndex * m_blocksFrameSize + (blockIndex - 1) * m_blockSize];
         }
     }
 
+    inline uint8_t* getRecoveryBlock(int slotIndex, int recoveryIndex)
+    {
+        return &m_decoderSlots[slotIndex].m_recoveryBlocks[recoveryIndex * m_blockSize];
+    }
+
     inline MetaDataFEC *getMetaData(int slotIndex)
     {
-        // return (MetaDataFEC *) &m_decoderSlots[slotIndex].m_originalBlocks[0];
-        return (MetaDataFEC *) &m_decoderSlots[slotIndex].m_blockZero;
+        return (MetaDataFEC *) m_decoderSlots[slotIndex].m_blockZero.data();
     }
 
     inline void resetOriginalBlocks(int slotIndex)
     {
-        // memset((void *) m_decoderSlots[slotIndex].m_originalBlocks, 0, m_nbOriginalBlocks * sizeof(ProtectedBlock));
-        memset((void *) &m_decoderSlots[slotIndex].m_blockZero, 0, sizeof(ProtectedBlock));
-        memset((void *) m_frames[slotIndex].m_blocks, 0, (m_nbOriginalBlocks - 1) * sizeof(ProtectedBlock));
+        memset((void *) m_decoderSlots[slotIndex].m_blockZero.data(), 0, m_blockSize);
+        memset((void *) &m_blocks[slotIndex * m_blocksFrameSize], 0, m_blocksFrameSize);
     }
 
     void initDecodeAllSlots();
     void initReadIndex();
-    void rwCorrectionEstimate(int slotIndex);
     void checkSlotData(int slotIndex);
     void initDecodeSlot(int slotIndex);
+    void decodeSlot(int slotIndex, int recoveryCount, CM256& cm256); //!< CM256 decode and restore of the missing blocks (any thread)
+    void releaseFrames();              //!< releases the closed frames in order as soon as they are decoded
+    void releaseFrame(int slotIndex);  //!< takes the meta data and unpacks the samples of a closed frame
+    void setBlockSize(uint32_t blockSize); //!< (re)allocates the buffers and starts over
+    void setEncoding(IQPacker::Encoding encoding); //!< (re)allocates the samples buffer and starts over reading
+    void unpackSlot(int slotIndex);        //!< unpacks the samples of a frame in the samples buffer
+    bool isSizeAnnounced(const Header& header, const uint8_t *block, uint32_t blockSize); //!< block zero announcing this size
 
     static void printMeta(const QString& header, MetaDataFEC *metaData);
+
+    friend class SDRdaemonSourceFECPool;
 };
 
 
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDebug>
+#include <QMutexLocker>
+
+#include "sdrdaemonsourcebuffer.h"
+#include "sdrdaemonsourcefecpool.h"
+
+SDRdaemonSourceFECPool::SDRdaemonSourceFECPool(SDRdaemonSourceBuffer *buffer, int nbDecoderSlots, int nbWorkers) :
+    m_buffer(buffer),
+    m_decoding(nbDecoderSlots, false),
+    m_nbDecoding(0),
+    m_running(true)
+{
+    for (int i = 0; i < nbWorkers; i++)
+    {
+        Worker *worker = new Worker(this);
+
+        if (!worker->isCM256Initialized())
+        {
+            qWarning("SDRdaemonSourceFECPool::SDRdaemonSourceFECPool: cannot initialize CM256 library");
+            delete worker;
+            break;
+        }
+
+        m_workers.push_back(worker);
+        worker->start();
+    }
+
+    qDebug("SDRdaemonSourceFECPool::SDRdaemonSourceFECPool: %d workers", (int) m_workers.size());
+}
+
+SDRdaemonSourceFECPool::~SDRdaemonSourceFECPool()
+{
+    m_mutex.lock();
+    m_running = false;
+    m_jobCondition.wakeAll();
+    m_mutex.unlock();
+
+    for (std::vector<Worker*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+    {
+        (*it)->wait();
+        delete *it;
+    }
+}
+
+void SDRdaemonSourceFECPool::push(int slotIndex, int recoveryCount)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    Job job;
+    job.m_slotIndex = slotIndex;
+    job.m_recoveryCount = recoveryCount;
+    m_jobs.push_back(job);
+    m_decoding[slotIndex] = true;
+    m_nbDecoding++;
+    m_jobCondition.wakeOne();
+}
+
+bool SDRdaemonSourceFECPool::isDecoding(int slotIndex)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    return m_decoding[slotIndex];
+}
+
+void SDRdaemonSourceFECPool::wait(int slotIndex)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    while (m_decoding[slotIndex]) {
+        m_doneCondition.wait(&m_mutex);
+    }
+}
+
+void SDRdaemonSourceFECPool::waitAll()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    while (m_nbDecoding > 0) {
+        m_doneCondition.wait(&m_mutex);
+    }
+}
+
+void SDRdaemonSourceFECPool::Worker::run()
+{
+    QMutexLocker mutexLocker(&m_pool->m_mutex);
+
+    while (true)
+    {
+        while (m_pool->m_running && m_pool->m_jobs.empty()) {
+            m_pool->m_jobCondition.wait(&m_pool->m_mutex);
+        }
+
+        if (!m_pool->m_running) {
+            break;
+        }
+
+        Job job = m_pool->m_jobs.front();
+        m_pool->m_jobs.pop_front();
+        mutexLocker.unlock();
+
+        m_pool->m_buffer->decodeSlot(job.m_slotIndex, job.m_recoveryCount, m_cm256);
+
+        mutexLocker.relock();
+        m_pool->m_decoding[job.m_slotIndex] = false;
+        m_pool->m_nbDecoding--;
+        m_pool->m_doneCondition.wakeAll();
+    }
+}
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEFECPOOL_H_
+#define PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEFECPOOL_H_
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <vector>
+
+#include "cm256.h"
+
+class SDRdaemonSourceBuffer;
+
+/**
+ * Small pool of threads running the CM256 decode of the frames that need recovery blocks
+ * so that the decode spikes do not hold the UDP reception. Each decode works on its own
+ * decoder slot of the buffer. The buffer does not touch a slot while it is being decoded
+ * and releases the frames in order once decoded.
+ */
+class SDRdaemonSourceFECPool
+{
+public:
+    SDRdaemonSourceFECPool(SDRdaemonSourceBuffer *buffer, int nbDecoderSlots, int nbWorkers);
+    ~SDRdaemonSourceFECPool();
+
+    void push(int slotIndex, int recoveryCount); //!< queue the decode of a slot
+    bool isDecoding(int slotIndex);              //!< true while the decode of the slot is queued or running
+    void wait(int slotIndex);                    //!< wait for the end of the decode of the slot
+    void waitAll();                              //!< wait for the end of all decodes
+    int getNbWorkers() const { return m_workers.size(); }
+
+private:
+    class Worker : public QThread
+    {
+    public:
+        Worker(SDRdaemonSourceFECPool *pool) : m_pool(pool) {}
+        bool isCM256Initialized() { return m_cm256.isInitialized(); }
+
+    private:
+        SDRdaemonSourceFECPool *m_pool;
+        CM256 m_cm256; //!< one per thread
+
+        void run();
+    };
+
+    struct Job
+    {
+        int m_slotIndex;
+        int m_recoveryCount;
+    };
+
+    SDRdaemonSourceBuffer *m_buffer;
+    std::vector<Worker*> m_workers;
+    std::deque<Job> m_jobs;
+    std::vector<bool> m_decoding;   //!< per slot
+    int m_nbDecoding;
+    bool m_running;
+    QMutex m_mutex;
+    QWaitCondition m_jobCondition;  //!< a job was queued
+    QWaitCondition m_doneCondition; //!< a decode is done
+};
+
+#endif /* PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEFECPOOL_H_ */
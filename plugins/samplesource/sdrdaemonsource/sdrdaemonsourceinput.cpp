@@ -31,6 +31,7 @@
 #include "SWGDeviceSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGSDRdaemonSourceReport.h"
 
 #include "util/simpleserializer.h"
@@ -512,6 +513,9 @@ int SDRdaemonSourceInput::webapiReportGet(
     response.setSdrDaemonSourceReport(new SWGSDRangel::SWGSDRdaemonSourceReport());
     response.getSdrDaemonSourceReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
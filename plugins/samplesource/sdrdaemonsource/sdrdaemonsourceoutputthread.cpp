@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QMutex>
+#include <QDebug>
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "dsp/samplesinkfifo.h"
+#include "sdrdaemonsourceoutputthread.h"
+
+const float SDRdaemonSourceOutputThread::m_gaugeGain = 4e-4f;       // 2% at the buffer bounds
+const float SDRdaemonSourceOutputThread::m_correctionLimit = 0.02f;
+
+SDRdaemonSourceOutputThread::SDRdaemonSourceOutputThread(SDRdaemonSourceBuffer& buffer, QMutex& bufferMutex, SampleSinkFifo *sampleFifo) :
+    m_buffer(buffer),
+    m_bufferMutex(bufferMutex),
+    m_sampleFifo(sampleFifo),
+    m_running(false),
+    m_rateCorrection(true),
+    m_correction(0.0f),
+    m_samplesDue(0.0)
+{
+}
+
+SDRdaemonSourceOutputThread::~SDRdaemonSourceOutputThread()
+{
+    stopWork();
+}
+
+void SDRdaemonSourceOutputThread::startWork()
+{
+    if (m_running) {
+        return;
+    }
+
+    qDebug("SDRdaemonSourceOutputThread::startWork: read every %lld us", m_periodNs / 1000);
+    m_samplesDue = 0.0;
+    m_correction = 0.0f;
+    m_running = true;
+    start(QThread::HighPriority);
+}
+
+void SDRdaemonSourceOutputThread::stopWork()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    wait();
+    qDebug("SDRdaemonSourceOutputThread::stopWork");
+}
+
+void SDRdaemonSourceOutputThread::run()
+{
+    int64_t lastNs = getMonotonicTimeNs();
+    int64_t wakeUpNs = lastNs + m_periodNs;
+
+    while (m_running)
+    {
+        sleepUntil(wakeUpNs);
+        int64_t nowNs = getMonotonicTimeNs();
+        int64_t elapsedNs = nowNs - lastNs;
+        lastNs = nowNs;
+        wakeUpNs += m_periodNs;
+
+        if (wakeUpNs <= nowNs) { // too late (stalled): restart the schedule from now
+            wakeUpNs = nowNs + m_periodNs;
+        }
+
+        readSamples(elapsedNs < m_maxElapsedNs ? elapsedNs : m_maxElapsedNs);
+    }
+}
+
+void SDRdaemonSourceOutputThread::readSamples(int64_t elapsedNs)
+{
+    QMutexLocker mutexLocker(&m_bufferMutex);
+    int sampleRate = m_buffer.getCurrentMeta().m_sampleRate;
+
+    if ((sampleRate == 0) || (m_buffer.getFramesNbBytes() == 0)) {
+        return;
+    }
+
+    if (m_rateCorrection)
+    {
+        // gauge is positive when the read index leads i.e. the buffer runs short: slow down
+        float correction = -m_gaugeGain * m_buffer.getBufferGauge();
+        m_correction = correction < -m_correctionLimit ? -m_correctionLimit : correction > m_correctionLimit ? m_correctionLimit : correction;
+    }
+    else
+    {
+        m_correction = 0.0f;
+    }
+
+    m_samplesDue += (sampleRate * (1.0 + m_correction) * elapsedNs) / 1e9;
+    int32_t nbSamples = (int32_t) m_samplesDue;
+    m_samplesDue -= nbSamples;
+
+    if (nbSamples == 0) {
+        return;
+    }
+
+    int32_t length = nbSamples * SDRdaemonSourceBuffer::m_iqSampleSize;
+    // read samples directly feeding the SampleFifo (no callback). They are unpacked to the native Sample type by the buffer.
+    m_sampleFifo->write(m_buffer.readData(length), length);
+}
+
+int64_t SDRdaemonSourceOutputThread::getMonotonicTimeNs()
+{
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1000000000LL + tv.tv_usec * 1000LL;
+#endif
+}
+
+void SDRdaemonSourceOutputThread::sleepUntil(int64_t timeNs)
+{
+#ifdef __linux__
+    struct timespec wakeUp;
+    wakeUp.tv_sec = timeNs / 1000000000LL;
+    wakeUp.tv_nsec = timeNs % 1000000000LL;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeUp, 0) == EINTR) {}
+#else
+    int64_t nowNs = getMonotonicTimeNs();
+
+    if (timeNs > nowNs) {
+        usleep((timeNs - nowNs) / 1000);
+    }
+#endif
+}
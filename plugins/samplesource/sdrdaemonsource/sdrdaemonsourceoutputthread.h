@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEOUTPUTTHREAD_H_
+#define PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEOUTPUTTHREAD_H_
+
+#include <QThread>
+#include <QMutex>
+#include <stdint.h>
+
+#include "sdrdaemonsourcebuffer.h"
+
+class SampleSinkFifo;
+
+/**
+ * Moves the samples from the buffer to the sample FIFO at the stream sample rate on its own
+ * thread woken up every few milliseconds by the monotonic clock. The number of samples of each
+ * read follows the actual elapsed time so that late wake ups do not accumulate. A proportional
+ * controller on the buffer gauge trims the rate so that the read index stays half a buffer away
+ * from the write index whatever the clock difference with the sender.
+ */
+class SDRdaemonSourceOutputThread : public QThread
+{
+public:
+    SDRdaemonSourceOutputThread(SDRdaemonSourceBuffer& buffer, QMutex& bufferMutex, SampleSinkFifo *sampleFifo);
+    ~SDRdaemonSourceOutputThread();
+
+    void startWork();
+    void stopWork();
+    void setRateCorrection(bool rateCorrection) { m_rateCorrection = rateCorrection; }
+    float getRateCorrection() const { QMutexLocker mutexLocker(&m_bufferMutex); return m_correction; } //!< current relative rate correction
+
+private:
+    static const int64_t m_periodNs = 5000000LL;     //!< time between two reads
+    static const int64_t m_maxElapsedNs = 100000000LL; //!< most time caught up at once after a stall
+    static const float m_gaugeGain;                 //!< relative rate correction per % of buffer gauge
+    static const float m_correctionLimit;           //!< largest relative rate correction
+
+    SDRdaemonSourceBuffer& m_buffer;
+    QMutex& m_bufferMutex;
+    SampleSinkFifo *m_sampleFifo;
+    volatile bool m_running;
+    volatile bool m_rateCorrection;
+    float m_correction;  //!< with the buffer locked
+    double m_samplesDue; //!< samples owed to the FIFO including the fraction left by the last read
+
+    void run();
+    void readSamples(int64_t elapsedNs);
+    static int64_t getMonotonicTimeNs();
+    static void sleepUntil(int64_t timeNs);
+};
+
+#endif /* PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEOUTPUTTHREAD_H_ */
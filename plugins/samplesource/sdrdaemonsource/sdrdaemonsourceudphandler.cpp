@@ -17,6 +17,7 @@
 #include <QUdpSocket>
 #include <QDebug>
 #include <QTimer>
+#include <QMutexLocker>
 #include <unistd.h>
 
 #include "dsp/dspcommands.h"
@@ -25,6 +26,8 @@
 
 #include "sdrdaemonsourceinput.h"
 #include "sdrdaemonsourceudphandler.h"
+#include "sdrdaemonsourceudpthread.h"
+#include "sdrdaemonsourceoutputthread.h"
 
 SDRdaemonSourceUDPHandler::SDRdaemonSourceUDPHandler(SampleSinkFifo *sampleFifo, DeviceSourceAPI *deviceAPI) :
     m_deviceAPI(deviceAPI),
@@ -32,9 +35,12 @@ SDRdaemonSourceUDPHandler::SDRdaemonSourceUDPHandler(SampleSinkFifo *sampleFifo,
     m_masterTimerConnected(false),
     m_running(false),
     m_rateDivider(1000/SDRDAEMONSOURCE_THROTTLE_MS),
+	m_udpThread(0),
+	m_outputThread(0),
 	m_dataSocket(0),
 	m_dataAddress(QHostAddress::LocalHost),
 	m_remoteAddress(QHostAddress::LocalHost),
+	m_remotePort(0),
 	m_dataPort(9090),
 	m_dataConnected(false),
 	m_udpBuf(0),
@@ -46,17 +52,15 @@ SDRdaemonSourceUDPHandler::SDRdaemonSourceUDPHandler(SampleSinkFifo *sampleFifo,
 	m_tv_usec(0),
 	m_outputMessageQueueToGUI(0),
 	m_tickCount(0),
-	m_samplesCount(0),
 	m_timer(0),
     m_throttlems(SDRDAEMONSOURCE_THROTTLE_MS),
-    m_readLengthSamples(0),
-    m_readLength(0),
-    m_converterBuffer(0),
-    m_converterBufferNbSamples(0),
-    m_throttleToggle(false),
 	m_autoCorrBuffer(true)
 {
-    m_udpBuf = new char[SDRdaemonSourceBuffer::m_udpPayloadSize];
+    m_udpBuf = new char[SDRdaemonSourceBuffer::m_udpSizeMax];
+    m_outputThread = new SDRdaemonSourceOutputThread(m_sdrDaemonBuffer, m_bufferMutex, m_sampleFifo);
+#ifdef __linux__
+    m_udpThread = new SDRdaemonSourceUDPThread(m_sdrDaemonBuffer, m_bufferMutex, this);
+#endif
 
 #ifdef USE_INTERNAL_TIMER
 #warning "Uses internal timer"
@@ -72,8 +76,9 @@ SDRdaemonSourceUDPHandler::SDRdaemonSourceUDPHandler(SampleSinkFifo *sampleFifo,
 SDRdaemonSourceUDPHandler::~SDRdaemonSourceUDPHandler()
 {
 	stop();
+	delete m_outputThread;
+	delete m_udpThread;
 	delete[] m_udpBuf;
-	if (m_converterBuffer) { delete[] m_converterBuffer; }
 #ifdef USE_INTERNAL_TIMER
     if (m_timer) {
         delete m_timer;
@@ -89,16 +94,35 @@ void SDRdaemonSourceUDPHandler::start()
 	    return;
 	}
 
-	if (!m_dataSocket)
-	{
-		m_dataSocket = new QUdpSocket(this);
-	}
+    // batched receive on its own thread where available
+    if (m_udpThread && !m_dataConnected && m_udpThread->startReceive(m_dataAddress, m_dataPort))
+    {
+        qDebug("SDRdaemonSourceUDPHandler::start: receive thread bound to %s:%d", m_dataAddress.toString().toStdString().c_str(), m_dataPort);
+        m_dataConnected = true;
+    }
 
     if (!m_dataConnected)
 	{
+        if (!m_dataSocket) {
+            m_dataSocket = new QUdpSocket(this);
+        }
+
         connect(m_dataSocket, SIGNAL(readyRead()), this, SLOT(dataReadyRead())); //, Qt::QueuedConnection);
+        bool bound;
 
-        if (m_dataSocket->bind(m_dataAddress, m_dataPort))
+        if (isMulticast(m_dataAddress))
+        {
+            // several receivers on this host can join the same group
+            QHostAddress anyAddress = m_dataAddress.protocol() == QAbstractSocket::IPv6Protocol ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4;
+            bound = m_dataSocket->bind(anyAddress, m_dataPort, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)
+                && m_dataSocket->joinMulticastGroup(m_dataAddress);
+        }
+        else
+        {
+            bound = m_dataSocket->bind(m_dataAddress, m_dataPort);
+        }
+
+        if (bound)
 		{
 			qDebug("SDRdaemonSourceUDPHandler::start: bind data socket to %s:%d", m_dataAddress.toString().toStdString().c_str(),  m_dataPort);
 			m_dataConnected = true;
@@ -111,7 +135,6 @@ void SDRdaemonSourceUDPHandler::start()
 		}
 	}
 
-    m_elapsedTimer.start();
     m_running = true;
 }
 
@@ -125,6 +148,12 @@ void SDRdaemonSourceUDPHandler::stop()
 
 	disconnectTimer();
 
+    if (m_udpThread && m_udpThread->isReceiving())
+    {
+        m_udpThread->stopReceive();
+        m_dataConnected = false;
+    }
+
     if (m_dataConnected)
     {
 		m_dataConnected = false;
@@ -142,6 +171,18 @@ void SDRdaemonSourceUDPHandler::stop()
 	m_running = false;
 }
 
+bool SDRdaemonSourceUDPHandler::isMulticast(const QHostAddress& address)
+{
+    // QHostAddress::isMulticast needs Qt 5.6
+    if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+        return address.toIPv6Address()[0] == 0xff; // ff00::/8
+    } else if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+        return (address.toIPv4Address() & 0xf0000000) == 0xe0000000; // 224.0.0.0/4
+    } else {
+        return false;
+    }
+}
+
 void SDRdaemonSourceUDPHandler::configureUDPLink(const QString& address, quint16 port)
 {
 	qDebug("SDRdaemonSourceUDPHandler::configureUDPLink: %s:%d", address.toStdString().c_str(), port);
@@ -158,25 +199,36 @@ void SDRdaemonSourceUDPHandler::configureUDPLink(const QString& address, quint16
 	start();
 }
 
+void SDRdaemonSourceUDPHandler::getRemoteAddress(QString& s) const
+{
+    QMutexLocker mutexLocker(&m_bufferMutex);
+    s = m_remoteAddress.toString();
+}
+
 void SDRdaemonSourceUDPHandler::dataReadyRead()
 {
+    QMutexLocker mutexLocker(&m_bufferMutex);
     m_udpReadBytes = 0;
 
 	while (m_dataSocket->hasPendingDatagrams() && m_dataConnected)
 	{
-		qint64 pendingDataSize = m_dataSocket->pendingDatagramSize();
-		m_udpReadBytes += m_dataSocket->readDatagram(&m_udpBuf[m_udpReadBytes], pendingDataSize, &m_remoteAddress, 0);
+		// the datagram size is checked by the buffer (see SDRdaemonSourceBuffer::writeData)
+		m_udpReadBytes = m_dataSocket->readDatagram(m_udpBuf, SDRdaemonSourceBuffer::m_udpSizeMax, &m_remoteAddress, &m_remotePort);
 
-		if (m_udpReadBytes == SDRdaemonSourceBuffer::m_udpPayloadSize) {
+		if (m_udpReadBytes > 0) {
 		    processData();
-		    m_udpReadBytes = 0;
 		}
 	}
 }
 
 void SDRdaemonSourceUDPHandler::processData()
 {
-    m_sdrDaemonBuffer.writeData(m_udpBuf);
+    m_sdrDaemonBuffer.writeData(m_udpBuf, m_udpReadBytes);
+    processMeta();
+}
+
+void SDRdaemonSourceUDPHandler::processMeta()
+{
     const SDRdaemonSourceBuffer::MetaDataFEC& metaData =  m_sdrDaemonBuffer.getCurrentMeta();
     bool change = false;
 
@@ -213,13 +265,30 @@ void SDRdaemonSourceUDPHandler::processData()
             m_outputMessageQueueToGUI->push(report);
         }
 
-        connectTimer();
+        // may be called from the receive thread
+        QMetaObject::invokeMethod(this, "connectTimer", Qt::QueuedConnection);
+    }
+}
+
+void SDRdaemonSourceUDPHandler::sendFECReport()
+{
+    SDRdaemonSourceBuffer::FECReport report;
+
+    if ((m_remotePort == 0) || !m_sdrDaemonBuffer.getFECReport(report)) {
+        return;
+    }
+
+    // from the data socket so that the sender gets it back at its source address
+    if (m_udpThread && m_udpThread->isReceiving()) {
+        m_udpThread->sendDatagram((const char *) &report, sizeof(report), m_remoteAddress, m_remotePort);
+    } else if (m_dataSocket) {
+        m_dataSocket->writeDatagram((const char *) &report, sizeof(report), m_remoteAddress, m_remotePort);
     }
 }
 
 void SDRdaemonSourceUDPHandler::connectTimer()
 {
-    if (!m_masterTimerConnected)
+    if (!m_masterTimerConnected && m_running) // may be queued after a stop
     {
         qDebug() << "SDRdaemonSourceUDPHandler::connectTimer";
 #ifdef USE_INTERNAL_TIMER
@@ -228,6 +297,8 @@ void SDRdaemonSourceUDPHandler::connectTimer()
 #else
         connect(&m_masterTimer, SIGNAL(timeout()), this, SLOT(tick()));
 #endif
+        m_outputThread->setRateCorrection(m_autoCorrBuffer);
+        m_outputThread->startWork();
         m_masterTimerConnected = true;
     }
 }
@@ -243,55 +314,16 @@ void SDRdaemonSourceUDPHandler::disconnectTimer()
 #else
         disconnect(&m_masterTimer, SIGNAL(timeout()), this, SLOT(tick()));
 #endif
+        m_outputThread->stopWork();
         m_masterTimerConnected = false;
     }
 }
 
 void SDRdaemonSourceUDPHandler::tick()
 {
-    // auto throttling
-    int throttlems = m_elapsedTimer.restart();
-
-    if (throttlems != m_throttlems)
-    {
-        m_throttlems = throttlems;
-        m_readLengthSamples = (m_sdrDaemonBuffer.getCurrentMeta().m_sampleRate * (m_throttlems+(m_throttleToggle ? 1 : 0))) / 1000;
-        m_throttleToggle = !m_throttleToggle;
-    }
-
-    if (m_autoCorrBuffer) {
-        m_readLengthSamples += m_sdrDaemonBuffer.getRWBalanceCorrection();
-    }
-
-    m_readLength = m_readLengthSamples * SDRdaemonSourceBuffer::m_iqSampleSize;
-
-    if (SDR_RX_SAMP_SZ == 16)
-    {
-        // read samples directly feeding the SampleFifo (no callback)
-        m_sampleFifo->write(reinterpret_cast<quint8*>(m_sdrDaemonBuffer.readData(m_readLength)), m_readLength);
-        m_samplesCount += m_readLengthSamples;
-    }
-    else if (SDR_RX_SAMP_SZ == 24)
-    {
-        if (m_readLengthSamples > m_converterBufferNbSamples)
-        {
-            if (m_converterBuffer) { delete[] m_converterBuffer; }
-            m_converterBuffer = new int32_t[m_readLengthSamples*2];
-        }
-
-        uint8_t *buf = m_sdrDaemonBuffer.readData(m_readLength);
-
-        for (unsigned int is = 0; is < m_readLengthSamples; is++)
-        {
-            m_converterBuffer[2*is] = ((int16_t*)buf)[2*is];
-            m_converterBuffer[2*is]<<=8;
-            m_converterBuffer[2*is+1] = ((int16_t*)buf)[2*is+1];
-            m_converterBuffer[2*is+1]<<=8;
-        }
-
-        m_sampleFifo->write(reinterpret_cast<quint8*>(m_converterBuffer), m_readLengthSamples*sizeof(Sample));
-    }
+    QMutexLocker mutexLocker(&m_bufferMutex);
 
+    // the samples are moved to the FIFO by the output thread. This only reports status.
 	if (m_tickCount < m_rateDivider)
 	{
 		m_tickCount++;
@@ -299,6 +331,7 @@ void SDRdaemonSourceUDPHandler::tick()
 	else
 	{
 		m_tickCount = 0;
+		sendFECReport();
 
 		if (m_outputMessageQueueToGUI)
 		{
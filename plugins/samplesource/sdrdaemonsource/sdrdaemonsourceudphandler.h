@@ -21,7 +21,6 @@
 #include <QUdpSocket>
 #include <QHostAddress>
 #include <QMutex>
-#include <QElapsedTimer>
 
 #include "sdrdaemonsourcebuffer.h"
 
@@ -31,6 +30,8 @@ class SampleSinkFifo;
 class MessageQueue;
 class QTimer;
 class DeviceSourceAPI;
+class SDRdaemonSourceUDPThread;
+class SDRdaemonSourceOutputThread;
 
 class SDRdaemonSourceUDPHandler : public QObject
 {
@@ -42,16 +43,20 @@ public:
 	void start();
 	void stop();
 	void configureUDPLink(const QString& address, quint16 port);
-	void getRemoteAddress(QString& s) const { s = m_remoteAddress.toString(); }
+	void getRemoteAddress(QString& s) const;
+	void setRemoteAddress(const QHostAddress& address, quint16 port) { m_remoteAddress = address; m_remotePort = port; } //!< with the buffer locked
+	void processMeta(); //!< after data was written to the buffer with the buffer locked
     int getNbOriginalBlocks() const { return SDRdaemonSourceBuffer::m_nbOriginalBlocks; }
     bool isStreaming() const { return m_masterTimerConnected; }
-    int getSampleRate() const { return m_samplerate; }
-    int getCenterFrequency() const { return m_centerFrequency * 1000; }
-    int getBufferGauge() const { return m_sdrDaemonBuffer.getBufferGauge(); }
-    uint32_t getTVSec() const { return m_tv_sec; }
-    uint32_t getTVuSec() const { return m_tv_usec; }
-    int getMinNbBlocks() { return m_sdrDaemonBuffer.getMinNbBlocks(); }
-    int getMaxNbRecovery() { return m_sdrDaemonBuffer.getMaxNbRecovery(); }
+    // the following are written by the receive thread if any with the buffer locked
+    int getSampleRate() const { QMutexLocker mutexLocker(&m_bufferMutex); return m_samplerate; }
+    int getCenterFrequency() const { QMutexLocker mutexLocker(&m_bufferMutex); return m_centerFrequency * 1000; }
+    int getBufferGauge() const { QMutexLocker mutexLocker(&m_bufferMutex); return m_sdrDaemonBuffer.getBufferGauge(); } //!< the output thread moves the read index
+    uint32_t getTVSec() const { QMutexLocker mutexLocker(&m_bufferMutex); return m_tv_sec; }
+    uint32_t getTVuSec() const { QMutexLocker mutexLocker(&m_bufferMutex); return m_tv_usec; }
+    int getMinNbBlocks() { QMutexLocker mutexLocker(&m_bufferMutex); return m_sdrDaemonBuffer.getMinNbBlocks(); }
+    int getMaxNbRecovery() { QMutexLocker mutexLocker(&m_bufferMutex); return m_sdrDaemonBuffer.getMaxNbRecovery(); }
+    static bool isMulticast(const QHostAddress& address); //!< IPv4 or IPv6 multicast group
 public slots:
 	void dataReadyRead();
 
@@ -62,9 +67,13 @@ private:
 	bool m_running;
     uint32_t m_rateDivider;
 	SDRdaemonSourceBuffer m_sdrDaemonBuffer;
+	mutable QMutex m_bufferMutex; //!< the buffer is written by the receive thread if any
+	SDRdaemonSourceUDPThread *m_udpThread;
+	SDRdaemonSourceOutputThread *m_outputThread; //!< feeds the sample FIFO at the stream rate
 	QUdpSocket *m_dataSocket;
 	QHostAddress m_dataAddress;
 	QHostAddress m_remoteAddress;
+	quint16 m_remotePort;
 	quint16 m_dataPort;
 	bool m_dataConnected;
 	char *m_udpBuf;
@@ -76,23 +85,17 @@ private:
 	uint32_t m_tv_usec;
 	MessageQueue *m_outputMessageQueueToGUI;
 	uint32_t m_tickCount;
-	std::size_t m_samplesCount;
     QTimer *m_timer;
 
-	QElapsedTimer m_elapsedTimer;
 	int m_throttlems;
-    uint32_t m_readLengthSamples;
-    uint32_t m_readLength;
-    int32_t *m_converterBuffer;
-    uint32_t m_converterBufferNbSamples;
-    bool m_throttleToggle;
     bool m_autoCorrBuffer;
 
-	void connectTimer();
     void disconnectTimer();
 	void processData();
+	void sendFECReport(); //!< to the sender if it wants loss reports
 
 private slots:
+	void connectTimer();
 	void tick();
 };
 
@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include <QMutex>
+#include <QDebug>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include "sdrdaemonsourceudphandler.h"
+#include "sdrdaemonsourceudpthread.h"
+
+SDRdaemonSourceUDPThread::SDRdaemonSourceUDPThread(SDRdaemonSourceBuffer& buffer, QMutex& bufferMutex, SDRdaemonSourceUDPHandler *handler) :
+    m_buffer(buffer),
+    m_bufferMutex(bufferMutex),
+    m_handler(handler),
+    m_fd(-1),
+    m_running(false),
+    m_blockSize(0)
+{
+    memset(m_expected, 0, sizeof(m_expected));
+}
+
+SDRdaemonSourceUDPThread::~SDRdaemonSourceUDPThread()
+{
+    stopReceive();
+}
+
+bool SDRdaemonSourceUDPThread::startReceive(const QHostAddress& address, quint16 port)
+{
+#ifdef __linux__
+    stopReceive();
+
+    struct sockaddr_storage bindAddress;
+    socklen_t bindAddressSize = fillAddress(address, port, bindAddress);
+
+    m_fd = socket(bindAddress.ss_family, SOCK_DGRAM, 0);
+
+    if (m_fd < 0)
+    {
+        qWarning("SDRdaemonSourceUDPThread::startReceive: cannot create socket: %s", strerror(errno));
+        return false;
+    }
+
+    // a larger socket buffer absorbs the scheduling latency of the thread (capped by net.core.rmem_max)
+    int rcvBufSize = 4<<20;
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvBufSize, sizeof(rcvBufSize));
+    // wake up regularly to check for stop
+    struct timeval timeout = {0, 100000};
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    bool multicast = SDRdaemonSourceUDPHandler::isMulticast(address);
+
+    if (multicast) // several receivers on this host can join the same group
+    {
+        int reuse = 1;
+        setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+
+    // bound to the group address only the datagrams of the group are received
+    if (bind(m_fd, (struct sockaddr *) &bindAddress, bindAddressSize) < 0)
+    {
+        qWarning("SDRdaemonSourceUDPThread::startReceive: cannot bind to %s:%u: %s", qPrintable(address.toString()), port, strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    if (multicast && !joinGroup(bindAddress)) // the group is left when the socket is closed
+    {
+        qWarning("SDRdaemonSourceUDPThread::startReceive: cannot join group %s: %s", qPrintable(address.toString()), strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_batchSize; i++)
+    {
+        m_iovecs[i][0].iov_base = &m_headers[i];
+        m_iovecs[i][0].iov_len = sizeof(SDRdaemonSourceBuffer::Header);
+        memset(&m_messages[i], 0, sizeof(struct mmsghdr));
+        m_messages[i].msg_hdr.msg_iov = m_iovecs[i];
+        m_messages[i].msg_hdr.msg_name = &m_addresses[i];
+    }
+
+    qDebug("SDRdaemonSourceUDPThread::startReceive: bound to %s:%u batches of %u datagrams", qPrintable(address.toString()), port, m_batchSize);
+    m_running = true;
+    start();
+    return true;
+#else
+    (void) address;
+    (void) port;
+    return false;
+#endif
+}
+
+void SDRdaemonSourceUDPThread::stopReceive()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    m_running = false;
+    wait();
+#ifdef __linux__
+    ::close(m_fd);
+#endif
+    m_fd = -1;
+}
+
+void SDRdaemonSourceUDPThread::sendDatagram(const char *data, int size, const QHostAddress& address, quint16 port)
+{
+#ifdef __linux__
+    if (m_fd < 0) {
+        return;
+    }
+
+    struct sockaddr_storage destAddress;
+    socklen_t destAddressSize = fillAddress(address, port, destAddress);
+
+    if (sendto(m_fd, data, size, 0, (struct sockaddr *) &destAddress, destAddressSize) < 0) {
+        qDebug("SDRdaemonSourceUDPThread::sendDatagram: sendto %s:%u: %s", qPrintable(address.toString()), port, strerror(errno));
+    }
+#else
+    (void) data;
+    (void) size;
+    (void) address;
+    (void) port;
+#endif
+}
+
+#ifdef __linux__
+socklen_t SDRdaemonSourceUDPThread::fillAddress(const QHostAddress& address, quint16 port, struct sockaddr_storage& sockAddress)
+{
+    memset(&sockAddress, 0, sizeof(sockAddress));
+
+    if (address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &sockAddress;
+        Q_IPV6ADDR ipv6 = address.toIPv6Address();
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        memcpy(&sin6->sin6_addr, &ipv6, sizeof(sin6->sin6_addr));
+        return sizeof(struct sockaddr_in6);
+    }
+    else
+    {
+        struct sockaddr_in *sin = (struct sockaddr_in *) &sockAddress;
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(address.toIPv4Address());
+        return sizeof(struct sockaddr_in);
+    }
+}
+#endif
+
+#ifdef __linux__
+bool SDRdaemonSourceUDPThread::joinGroup(const struct sockaddr_storage& groupAddress)
+{
+    // on the interface of the default route
+    if (groupAddress.ss_family == AF_INET6)
+    {
+        struct ipv6_mreq request;
+        request.ipv6mr_multiaddr = ((const struct sockaddr_in6 *) &groupAddress)->sin6_addr;
+        request.ipv6mr_interface = 0;
+        return setsockopt(m_fd, IPPROTO_IPV6, IPV6_JOIN_GROUP, &request, sizeof(request)) == 0;
+    }
+    else
+    {
+        struct ip_mreq request;
+        request.imr_multiaddr = ((const struct sockaddr_in *) &groupAddress)->sin_addr;
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+        return setsockopt(m_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) == 0;
+    }
+}
+#endif
+
+void SDRdaemonSourceUDPThread::run()
+{
+#ifdef __linux__
+    while (m_running)
+    {
+        prepareBatch();
+        int nbMessages = recvmmsg(m_fd, m_messages, m_batchSize, MSG_WAITFORONE, 0);
+
+        if (nbMessages < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+                continue;
+            }
+
+            qWarning("SDRdaemonSourceUDPThread::run: recvmmsg: %s", strerror(errno));
+            break;
+        }
+
+        processBatch(nbMessages);
+    }
+#endif
+}
+
+void SDRdaemonSourceUDPThread::prepareBatch()
+{
+#ifdef __linux__
+    QMutexLocker mutexLocker(&m_bufferMutex);
+    m_blockSize = m_buffer.getBlockSize();
+
+    for (unsigned int i = 0; i < m_batchSize; i++)
+    {
+        m_expected[i] = m_buffer.getExpectedBlock(i, m_expectedHeaders[i]);
+
+        if (m_expected[i]) // the rest of a larger datagram goes on in scratch
+        {
+            m_iovecs[i][1].iov_base = m_expected[i];
+            m_iovecs[i][1].iov_len = m_blockSize;
+            m_iovecs[i][2].iov_base = &m_scratch[i][m_blockSize];
+            m_iovecs[i][2].iov_len = m_maxBlockSize - m_blockSize;
+            m_messages[i].msg_hdr.msg_iovlen = 3;
+        }
+        else
+        {
+            m_iovecs[i][1].iov_base = m_scratch[i];
+            m_iovecs[i][1].iov_len = m_maxBlockSize;
+            m_messages[i].msg_hdr.msg_iovlen = 2;
+        }
+
+        m_messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+#endif
+}
+
+void SDRdaemonSourceUDPThread::processBatch(unsigned int nbMessages)
+{
+#ifdef __linux__
+    QMutexLocker mutexLocker(&m_bufferMutex);
+    unsigned int inPlace = 0; // datagrams received in place before the first one that is not
+
+    while ((inPlace < nbMessages)
+        && m_expected[inPlace]
+        && (m_messages[inPlace].msg_len == m_blockSize + sizeof(SDRdaemonSourceBuffer::Header))
+        && (m_headers[inPlace].frameIndex == m_expectedHeaders[inPlace].frameIndex)
+        && (m_headers[inPlace].blockIndex == m_expectedHeaders[inPlace].blockIndex))
+    {
+        inPlace++;
+    }
+
+    // the following payloads may have landed at the place of another block: move them to
+    // scratch before anything is stored and leave the places as if nothing was received
+    for (unsigned int i = inPlace; i < nbMessages; i++)
+    {
+        if (m_expected[i])
+        {
+            memcpy((void *) m_scratch[i], m_expected[i], m_blockSize);
+            memset((void *) m_expected[i], 0, m_blockSize);
+        }
+    }
+
+    for (unsigned int i = 0; i < nbMessages; i++)
+    {
+        if ((m_messages[i].msg_len <= sizeof(SDRdaemonSourceBuffer::Header)) || (m_messages[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+            continue; // not from an SDRdaemon sink
+        }
+
+        // the buffer drops the blocks of unexpected size
+        m_buffer.writeData(m_headers[i], i < inPlace ? m_expected[i] : m_scratch[i], m_messages[i].msg_len - sizeof(SDRdaemonSourceBuffer::Header));
+    }
+
+    if (nbMessages > 0)
+    {
+        const struct sockaddr_storage& remoteAddress = m_addresses[nbMessages - 1];
+        quint16 remotePort = remoteAddress.ss_family == AF_INET6 ?
+            ntohs(((const struct sockaddr_in6 *) &remoteAddress)->sin6_port) :
+            ntohs(((const struct sockaddr_in *) &remoteAddress)->sin_port);
+        m_handler->setRemoteAddress(QHostAddress((const struct sockaddr *) &remoteAddress), remotePort);
+    }
+
+    m_handler->processMeta();
+#else
+    (void) nbMessages;
+#endif
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEUDPTHREAD_H_
+#define PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEUDPTHREAD_H_
+
+#include <QThread>
+#include <QHostAddress>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#include "sdrdaemonsourcebuffer.h"
+
+class QMutex;
+class SDRdaemonSourceUDPHandler;
+
+/**
+ * Receives the datagrams on its own thread with recvmmsg (Linux only) so that a whole batch
+ * of datagrams costs one system call and no event loop round trip.
+ *
+ * The payloads are received directly at their place in the decoder slots when they are the
+ * original blocks that follow the last one received in the current frame (see
+ * SDRdaemonSourceBuffer::getExpectedBlock) which is the case of most datagrams. The other
+ * ones (block zero, recovery blocks, next frame, losses and reordering) are received in a
+ * scratch area and copied by the buffer as before. A datagram larger than the current block
+ * size (the sender changed it) overflows from the expected place to scratch.
+ */
+class SDRdaemonSourceUDPThread : public QThread
+{
+public:
+    SDRdaemonSourceUDPThread(SDRdaemonSourceBuffer& buffer, QMutex& bufferMutex, SDRdaemonSourceUDPHandler *handler);
+    ~SDRdaemonSourceUDPThread();
+
+    /** Bind the socket and start receiving. Returns false if the socket cannot be used. */
+    bool startReceive(const QHostAddress& address, quint16 port);
+    void stopReceive();
+    bool isReceiving() const { return m_fd >= 0; }
+    /** Send a datagram from the receiving socket (e.g. back to the sender) */
+    void sendDatagram(const char *data, int size, const QHostAddress& address, quint16 port);
+
+private:
+    static const unsigned int m_batchSize = 64;
+    static const unsigned int m_maxBlockSize = SDRdaemonSourceBuffer::m_udpSizeMax - sizeof(SDRdaemonSourceBuffer::Header);
+
+    SDRdaemonSourceBuffer& m_buffer;
+    QMutex& m_bufferMutex;
+    SDRdaemonSourceUDPHandler *m_handler;
+    int m_fd;
+    volatile bool m_running;
+
+#ifdef __linux__
+    struct mmsghdr m_messages[m_batchSize];
+    struct iovec m_iovecs[m_batchSize][3];
+    struct sockaddr_storage m_addresses[m_batchSize];
+#endif
+    SDRdaemonSourceBuffer::Header m_headers[m_batchSize];
+    SDRdaemonSourceBuffer::Header m_expectedHeaders[m_batchSize];
+    uint8_t *m_expected[m_batchSize]; //!< where the payloads are received in place (null if not)
+    uint32_t m_blockSize;             //!< block size of the buffer when the batch was prepared
+    uint8_t m_scratch[m_batchSize][m_maxBlockSize];
+
+    void run();
+#ifdef __linux__
+    static socklen_t fillAddress(const QHostAddress& address, quint16 port, struct sockaddr_storage& sockAddress);
+    bool joinGroup(const struct sockaddr_storage& groupAddress);
+#endif
+    void prepareBatch();
+    void processBatch(unsigned int nbMessages);
+};
+
+#endif /* PLUGINS_SAMPLESOURCE_SDRDAEMONSOURCE_SDRDAEMONSOURCEUDPTHREAD_H_ */
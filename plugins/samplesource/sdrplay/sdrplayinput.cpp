@@ -21,6 +21,7 @@
 #include "SWGDeviceSettings.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGSDRPlayReport.h"
 
 #include "util/simpleserializer.h"
@@ -764,6 +765,9 @@ int SDRPlayInput::webapiReportGet(
     response.setSdrPlayReport(new SWGSDRangel::SWGSDRPlayReport());
     response.getSdrPlayReport()->init();
     webapiFormatDeviceReport(response);
+    response.setFileRecordReport(new SWGSDRangel::SWGFileRecordReport());
+    response.getFileRecordReport()->init();
+    m_fileSink->webapiFormatReport(*response.getFileRecordReport());
     return 200;
 }
 
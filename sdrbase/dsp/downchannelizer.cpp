@@ -18,11 +18,14 @@
 #include <dsp/downchannelizer.h>
 #include "dsp/inthalfbandfilter.h"
 #include "dsp/dspcommands.h"
+#include "dsp/filerecord.h"
+#include "util/messagequeue.h"
 
 #include <QString>
 #include <QDebug>
 
 MESSAGE_CLASS_DEFINITION(DownChannelizer::MsgChannelizerNotification, Message)
+MESSAGE_CLASS_DEFINITION(DownChannelizer::MsgRecord, Message)
 
 DownChannelizer::DownChannelizer(BasebandSampleSink* sampleSink) :
 	m_sampleSink(sampleSink),
@@ -30,7 +33,9 @@ DownChannelizer::DownChannelizer(BasebandSampleSink* sampleSink) :
 	m_requestedOutputSampleRate(0),
 	m_requestedCenterFrequency(0),
 	m_currentOutputSampleRate(0),
-	m_currentCenterFrequency(0)
+	m_currentCenterFrequency(0),
+	m_inputCenterFrequency(0),
+	m_fileRecord(0)
 {
 	QString name = "DownChannelizer(" + m_sampleSink->objectName() + ")";
 	setObjectName(name);
@@ -38,6 +43,7 @@ DownChannelizer::DownChannelizer(BasebandSampleSink* sampleSink) :
 
 DownChannelizer::~DownChannelizer()
 {
+	stopRecording();
 	freeFilterChain();
 }
 
@@ -47,6 +53,21 @@ void DownChannelizer::configure(MessageQueue* messageQueue, int sampleRate, int
 	messageQueue->push(cmd);
 }
 
+void DownChannelizer::record(MessageQueue* messageQueue, const QString& fileName)
+{
+	Message* cmd = MsgRecord::create(fileName);
+	messageQueue->push(cmd);
+}
+
+void DownChannelizer::setRecordTrigger(bool trigger)
+{
+	QMutexLocker mutexLocker(&m_mutex);
+
+	if (m_fileRecord) {
+		m_fileRecord->setTrigger(trigger);
+	}
+}
+
 void DownChannelizer::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool positiveOnly)
 {
 	if(m_sampleSink == 0) {
@@ -56,6 +77,14 @@ void DownChannelizer::feed(const SampleVector::const_iterator& begin, const Samp
 
 	if (m_filterStages.size() == 0) // optimization when no downsampling is done anyway
 	{
+		m_mutex.lock();
+
+		if (m_fileRecord) {
+			m_fileRecord->feed(begin, end, positiveOnly);
+		}
+
+		m_mutex.unlock();
+
 		m_sampleSink->feed(begin, end, positiveOnly);
 	}
 	else
@@ -83,6 +112,10 @@ void DownChannelizer::feed(const SampleVector::const_iterator& begin, const Samp
 			}
 		}
 
+		if (m_fileRecord) {
+			m_fileRecord->feed(m_sampleBuffer.begin(), m_sampleBuffer.end(), positiveOnly);
+		}
+
 		m_mutex.unlock();
 
 		m_sampleSink->feed(m_sampleBuffer.begin(), m_sampleBuffer.end(), positiveOnly);
@@ -116,6 +149,7 @@ bool DownChannelizer::handleMessage(const Message& cmd)
 	{
 		DSPSignalNotification& notif = (DSPSignalNotification&) cmd;
 		m_inputSampleRate = notif.getSampleRate();
+		m_inputCenterFrequency = notif.getCenterFrequency();
 		qDebug() << "DownChannelizer::handleMessage: DSPSignalNotification: m_inputSampleRate: " << m_inputSampleRate;
 		applyConfiguration();
 
@@ -140,6 +174,19 @@ bool DownChannelizer::handleMessage(const Message& cmd)
 
 		applyConfiguration();
 
+		return true;
+	}
+	else if (MsgRecord::match(cmd))
+	{
+		MsgRecord& record = (MsgRecord&) cmd;
+		qDebug() << "DownChannelizer::handleMessage: MsgRecord: " << record.getFileName();
+
+		if (record.getFileName().isEmpty()) {
+			stopRecording();
+		} else {
+			startRecording(record.getFileName());
+		}
+
 		return true;
 	}
     else if (BasebandSampleSink::MsgThreadedSink::match(cmd))
@@ -170,12 +217,13 @@ void DownChannelizer::applyConfiguration()
 		m_inputSampleRate / -2, m_inputSampleRate / 2,
 		m_requestedCenterFrequency - m_requestedOutputSampleRate / 2, m_requestedCenterFrequency + m_requestedOutputSampleRate / 2);
 
+	m_currentOutputSampleRate = m_inputSampleRate / (1 << m_filterStages.size());
+	notifyRecord();
+
 	m_mutex.unlock();
 
 	//debugFilterChain();
 
-	m_currentOutputSampleRate = m_inputSampleRate / (1 << m_filterStages.size());
-
 	qDebug() << "DownChannelizer::applyConfiguration in=" << m_inputSampleRate
 			<< ", req=" << m_requestedOutputSampleRate
 			<< ", out=" << m_currentOutputSampleRate
@@ -188,6 +236,51 @@ void DownChannelizer::applyConfiguration()
 	}
 }
 
+void DownChannelizer::startRecording(const QString& fileName)
+{
+	QMutexLocker mutexLocker(&m_mutex);
+
+	if (m_fileRecord)
+	{
+		if (m_fileRecord->getFileName() == fileName) {
+			return;
+		}
+
+		m_fileRecord->stopRecording();
+		delete m_fileRecord;
+	}
+
+	// buffers of about a quarter of a second so that the samples of a narrow channel reach the disk soon enough
+	unsigned int bufferSize = (m_currentOutputSampleRate * sizeof(Sample)) / 4;
+	bufferSize = bufferSize < (1<<16) ? (1<<16) : bufferSize > (1<<20) ? (1<<20) : bufferSize;
+
+	m_fileRecord = new FileRecord(fileName, 16, bufferSize);
+	notifyRecord();
+	m_fileRecord->startRecording();
+}
+
+void DownChannelizer::stopRecording()
+{
+	QMutexLocker mutexLocker(&m_mutex);
+
+	if (m_fileRecord)
+	{
+		m_fileRecord->stopRecording();
+		delete m_fileRecord;
+		m_fileRecord = 0;
+	}
+}
+
+void DownChannelizer::notifyRecord()
+{
+	if (m_fileRecord)
+	{
+		// the channel samples are centered on the actual center of the decimated band
+		DSPSignalNotification notif(m_currentOutputSampleRate, m_inputCenterFrequency + m_currentCenterFrequency);
+		m_fileRecord->handleMessage(notif);
+	}
+}
+
 #ifdef SDR_RX_SAMPLE_24BIT
 DownChannelizer::FilterStage::FilterStage(Mode mode) :
     m_filter(new IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER>),
@@ -21,6 +21,7 @@
 #include <dsp/basebandsamplesink.h>
 #include <list>
 #include <QMutex>
+#include <QString>
 #include "export.h"
 #include "util/message.h"
 #include "dsp/inthalfbandfiltereo.h"
@@ -28,6 +29,7 @@
 #define DOWNCHANNELIZER_HB_FILTER_ORDER 48
 
 class MessageQueue;
+class FileRecord;
 
 class SDRBASE_API DownChannelizer : public BasebandSampleSink {
 	Q_OBJECT
@@ -55,10 +57,34 @@ public:
 		qint64 m_frequencyOffset;
 	};
 
+	/** Start recording the channel I/Q samples to the given file or stop recording if the file name is empty */
+	class MsgRecord : public Message {
+		MESSAGE_CLASS_DECLARATION
+
+	public:
+		const QString& getFileName() const { return m_fileName; }
+
+		static MsgRecord* create(const QString& fileName)
+		{
+			return new MsgRecord(fileName);
+		}
+
+	private:
+		QString m_fileName;
+
+		MsgRecord(const QString& fileName) :
+			Message(),
+			m_fileName(fileName)
+		{ }
+	};
+
 	DownChannelizer(BasebandSampleSink* sampleSink);
 	virtual ~DownChannelizer();
 
 	void configure(MessageQueue* messageQueue, int sampleRate, int centerFrequency);
+	void record(MessageQueue* messageQueue, const QString& fileName);
+	bool isRecording() const { return m_fileRecord != 0; }
+	void setRecordTrigger(bool trigger); //!< trigger of triggered recordings e.g. squelch of the channel
 	int getInputSampleRate() const { return m_inputSampleRate; }
 	int getRequestedCenterFrequency() const { return m_requestedCenterFrequency; }
 
@@ -103,10 +129,15 @@ protected:
 	int m_requestedCenterFrequency;
 	int m_currentOutputSampleRate;
 	int m_currentCenterFrequency;
+	qint64 m_inputCenterFrequency;    //!< device center frequency
 	SampleVector m_sampleBuffer;
 	QMutex m_mutex;
+	FileRecord* m_fileRecord;         //!< records the channel samples at the output rate when not null
 
 	void applyConfiguration();
+	void startRecording(const QString& fileName);
+	void stopRecording();
+	void notifyRecord();
 	bool signalContainsChannel(Real sigStart, Real sigEnd, Real chanStart, Real chanEnd) const;
 	Real createFilterChain(Real sigStart, Real sigEnd, Real chanStart, Real chanEnd);
 	void freeFilterChain();
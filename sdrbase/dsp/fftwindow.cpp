@@ -15,13 +15,33 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <QDebug>
+
 #include "dsp/fftwindow.h"
+#include "dsp/spectrumkernels.h"
+
+QMutex FFTWindow::m_cacheMutex;
+FFTWindow::CachedWindows FFTWindow::m_cache;
+
+FFTWindow::FFTWindow() :
+	m_window(0),
+	m_size(0)
+{
+}
 
 void FFTWindow::create(Function function, int n)
 {
-	Real (*wFunc)(Real n, Real i);
+	QMutexLocker mutexLocker(&m_cacheMutex);
 
-	m_window.clear();
+	for(CachedWindows::const_iterator it = m_cache.begin(); it != m_cache.end(); ++it) {
+		if(((*it)->function == function) && ((*it)->n == n)) {
+			m_window = (*it)->window.data();
+			m_size = n;
+			return;
+		}
+	}
+
+	Real (*wFunc)(Real n, Real i);
 
 	switch(function) {
 		case Flattop:
@@ -50,24 +70,37 @@ void FFTWindow::create(Function function, int n)
 			break;
 	}
 
+	CachedWindow *cachedWindow = new CachedWindow;
+	cachedWindow->function = function;
+	cachedWindow->n = n;
+	cachedWindow->window.reserve(n);
+
 	for(int i = 0; i < n; i++)
-		m_window.push_back(wFunc(n, i));
+		cachedWindow->window.push_back(wFunc(n, i));
+
+	m_cache.push_back(cachedWindow);
+	m_window = cachedWindow->window.data();
+	m_size = n;
+	qDebug("FFTWindow::create: new window function: %d size: %d", (int) function, n);
 }
 
 void FFTWindow::apply(const std::vector<Real>& in, std::vector<Real>* out)
 {
-	for(size_t i = 0; i < m_window.size(); i++)
+	for(int i = 0; i < m_size; i++)
 		(*out)[i] = in[i] * m_window[i];
 }
 
 void FFTWindow::apply(const std::vector<Complex>& in, std::vector<Complex>* out)
 {
-	for(size_t i = 0; i < m_window.size(); i++)
-		(*out)[i] = in[i] * m_window[i];
+	SpectrumKernels::windowComplex(in.data(), m_window, out->data(), m_size);
 }
 
 void FFTWindow::apply(const Complex* in, Complex* out)
 {
-	for(size_t i = 0; i < m_window.size(); i++)
-		out[i] = in[i] * m_window[i];
+	SpectrumKernels::windowComplex(in, m_window, out, m_size);
+}
+
+void FFTWindow::apply(const Sample* in, Complex* out, Real scale)
+{
+	SpectrumKernels::windowSamples(in, m_window, out, m_size, scale);
 }
@@ -19,6 +19,8 @@
 #define INCLUDE_FFTWINDOW_H
 
 #include <vector>
+#include <list>
+#include <QMutex>
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "dsp/dsptypes.h"
@@ -38,13 +40,29 @@ public:
 		Rectangle
 	};
 
+	FFTWindow();
+
 	void create(Function function, int n);
 	void apply(const std::vector<Real>& in, std::vector<Real>* out);
 	void apply(const std::vector<Complex>& in, std::vector<Complex>* out);
 	void apply(const Complex* in, Complex* out);
+	/** Apply window to fixed point samples converted to float and multiplied by scale in the same pass */
+	void apply(const Sample* in, Complex* out, Real scale);
 
 private:
-	std::vector<float> m_window;
+	struct CachedWindow {
+		Function function;
+		int n;
+		std::vector<float> window;
+	};
+	typedef std::list<CachedWindow*> CachedWindows;
+
+	// windows are computed once per (function, size) and shared by all instances for the process lifetime
+	static QMutex m_cacheMutex;
+	static CachedWindows m_cache;
+
+	const float* m_window;
+	int m_size;
 
 	static inline Real flatTop(Real n, Real i)
 	{
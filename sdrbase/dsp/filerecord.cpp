@@ -1,10 +1,22 @@
 #include <dsp/filerecord.h>
 #include "dsp/dspcommands.h"
+#include "dsp/filerecordtrigger.h"
+#include "dsp/iqconverters.h"
 #include "util/simpleserializer.h"
 #include "util/message.h"
 
+#include "SWGFileRecordReport.h"
+
 #include <QDebug>
 #include <QDateTime>
+#include <string.h>
+#include <algorithm>
+
+bool FileRecord::m_directIO = false;
+FileRecordCodec::Codec FileRecord::m_compression = FileRecordCodec::CodecNone;
+FileRecord::TriggerSettings FileRecord::m_triggerDefaults;
+IQFileFormat::Format FileRecord::m_defaultFormat = IQFileFormat::FormatSDRiq;
+const quint32 FileRecord::m_headerSize;
 
 FileRecord::FileRecord() :
 	BasebandSampleSink(),
@@ -13,19 +25,44 @@ FileRecord::FileRecord() :
     m_centerFrequency(0),
 	m_recordOn(false),
     m_recordStart(false),
-    m_byteCount(0)
+    m_byteCount(0),
+    m_sampleCount(0),
+    m_nextIndexSample(0),
+    m_format(IQFileFormat::FormatSDRiq),
+    m_triggered(false),
+    m_externalTrigger(false),
+    m_powerTrigger(0),
+    m_inputCount(0),
+    m_ringStart(0),
+    m_writeStart(0),
+    m_writeEnd(0),
+    m_nextWrite(0),
+    m_postTriggerSamples(0)
 {
 	setObjectName("FileSink");
 }
 
-FileRecord::FileRecord(const QString& filename) :
+FileRecord::FileRecord(const QString& filename, unsigned int nbBuffers, unsigned int bufferSize) :
     BasebandSampleSink(),
     m_fileName(filename),
     m_sampleRate(0),
     m_centerFrequency(0),
     m_recordOn(false),
     m_recordStart(false),
-    m_byteCount(0)
+    m_writer(nbBuffers, bufferSize),
+    m_byteCount(0),
+    m_sampleCount(0),
+    m_nextIndexSample(0),
+    m_format(IQFileFormat::FormatSDRiq),
+    m_triggered(false),
+    m_externalTrigger(false),
+    m_powerTrigger(0),
+    m_inputCount(0),
+    m_ringStart(0),
+    m_writeStart(0),
+    m_writeEnd(0),
+    m_nextWrite(0),
+    m_postTriggerSamples(0)
 {
     setObjectName("FileRecord");
 }
@@ -45,28 +82,163 @@ void FileRecord::setFileName(const QString& filename)
 
 void FileRecord::genUniqueFileName(uint deviceUID)
 {
-    setFileName(QString("rec%1_%2.sdriq").arg(deviceUID).arg(QDateTime::currentDateTimeUtc().toString("yyyy-MM-ddTHH_mm_ss_zzz")));
+    setFileName(QString("rec%1_%2.%3")
+            .arg(deviceUID)
+            .arg(QDateTime::currentDateTimeUtc().toString("yyyy-MM-ddTHH_mm_ss_zzz"))
+            .arg(IQFileFormat::getExtension(m_defaultFormat)));
+}
+
+QString FileRecord::genUniqueFileName(uint deviceUID, int channelIndex)
+{
+    return QString("rec%1_ch%2_%3.%4")
+            .arg(deviceUID)
+            .arg(channelIndex)
+            .arg(QDateTime::currentDateTimeUtc().toString("yyyy-MM-ddTHH_mm_ss_zzz"))
+            .arg(IQFileFormat::getExtension(m_defaultFormat));
 }
 
 void FileRecord::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool positiveOnly __attribute__((unused)))
 {
+    QMutexLocker mutexLocker(&m_mutex);
+
     // if no recording is active, send the samples to /dev/null
     if(!m_recordOn)
         return;
 
     if (begin < end) // if there is something to put out
     {
-        if (m_recordStart)
+        if (m_triggered) {
+            feedTriggered(begin, end);
+        } else {
+            writeSamples(&*begin, end - begin, QDateTime::currentMSecsSinceEpoch(), true);
+        }
+    }
+}
+
+void FileRecord::writeSamples(const Sample *samples, quint64 nbSamples, qint64 timestampMs, bool contiguous)
+{
+    if (m_recordStart)
+    {
+        writeHeader(timestampMs);
+        m_recordStart = false;
+        addIndexEntry(timestampMs);
+    }
+    else if (!contiguous || (m_sampleCount >= m_nextIndexSample))
+    {
+        addIndexEntry(timestampMs);
+    }
+
+    const char *data = reinterpret_cast<const char*>(samples);
+    quint64 sampleBytes = sizeof(Sample);
+
+    if (m_format != IQFileFormat::FormatSDRiq)
+    {
+        // WAV files are 16 bit PCM
+        IQFileFormat::Format format = m_format == IQFileFormat::FormatWAV ? IQFileFormat::FormatCS16 : m_format;
+        sampleBytes = IQFileFormat::getSampleBytes(format);
+        m_convertBuffer.resize(nbSamples * sampleBytes);
+
+        switch (format)
         {
-            writeHeader();
-            m_recordStart = false;
+        case IQFileFormat::FormatCU8:
+            IQConverters::toCU8(samples, (quint8 *) m_convertBuffer.data(), nbSamples);
+            break;
+        case IQFileFormat::FormatCS8:
+            IQConverters::toCS8(samples, (qint8 *) m_convertBuffer.data(), nbSamples);
+            break;
+        case IQFileFormat::FormatCF32:
+            IQConverters::toCF32(samples, (float *) m_convertBuffer.data(), nbSamples);
+            break;
+        default:
+            IQConverters::toCS16(samples, (qint16 *) m_convertBuffer.data(), nbSamples);
+            break;
+        }
+
+        data = m_convertBuffer.data();
+    }
+
+    // samples that cannot be buffered are dropped and counted by the writer
+    quint64 size = nbSamples*sampleBytes;
+    quint64 accepted = m_writer.write(data, size);
+    m_byteCount += accepted;
+    m_sampleCount += accepted / sampleBytes;
+
+    if (accepted < size) { // time of the next sample is not contiguous
+        m_nextIndexSample = m_sampleCount;
+    }
+}
+
+void FileRecord::feedTriggered(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
+{
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    quint64 blockStart = m_inputCount;
+    quint64 ringSize = m_ring.size();
+    bool trigger = m_externalTrigger;
+
+    if (m_powerTrigger)
+    {
+        m_powerTrigger->feed(begin, end, false);
+        trigger = trigger || m_powerTrigger->isTriggered();
+    }
+
+    if (trigger)
+    {
+        quint64 start = blockStart > ringSize ? blockStart - ringSize : 0;
+
+        if (start > m_writeEnd) { // new burst else the current one goes on
+            m_writeStart = start;
+        }
+
+        m_writeEnd = blockStart + (end - begin) + m_postTriggerSamples;
+    }
+
+    // samples go through the delay line and are written when they leave it if they are part of a burst
+    SampleVector::const_iterator it = begin;
+
+    while (it < end)
+    {
+        if (m_inputCount - m_ringStart == ringSize) {
+            popRing(std::min((quint64) (end - it), ringSize), nowMs, blockStart);
         }
 
-        m_sampleFile.write(reinterpret_cast<const char*>(&*(begin)), (end - begin)*sizeof(Sample));
-        m_byteCount += end - begin;
+        quint64 pos = m_inputCount % ringSize;
+        quint64 count = std::min((quint64) (end - it), ringSize - (m_inputCount - m_ringStart));
+        count = std::min(count, ringSize - pos);
+        std::copy(it, it + count, m_ring.begin() + pos);
+        it += count;
+        m_inputCount += count;
     }
 }
 
+void FileRecord::popRing(quint64 nbSamples, qint64 nowMs, quint64 nowIndex)
+{
+    quint64 start = std::max(m_ringStart, m_writeStart);
+    quint64 end = std::min(m_ringStart + nbSamples, m_writeEnd);
+    quint64 ringSize = m_ring.size();
+
+    while (start < end)
+    {
+        quint64 pos = start % ringSize;
+        quint64 count = std::min(end - start, ringSize - pos);
+        // the sample with index nowIndex arrived at nowMs
+        qint64 timestampMs = m_sampleRate > 0 ? nowMs - (((qint64) nowIndex - (qint64) start) * 1000) / m_sampleRate : nowMs;
+        writeSamples(&m_ring[pos], count, timestampMs, start == m_nextWrite);
+        m_nextWrite = start + count;
+        start += count;
+    }
+
+    m_ringStart += nbSamples;
+}
+
+void FileRecord::resetRing()
+{
+    quint64 sampleRate = m_sampleRate > 0 ? m_sampleRate : 1<<20;
+    quint64 ringSize = sampleRate * m_triggerSettings.m_preTrigger;
+    m_ring.resize(ringSize < 1 ? 1 : ringSize);
+    m_ringStart = m_inputCount;
+    m_postTriggerSamples = sampleRate * m_triggerSettings.m_postTrigger;
+}
+
 void FileRecord::start()
 {
 }
@@ -78,34 +250,114 @@ void FileRecord::stop()
 
 void FileRecord::startRecording()
 {
-    if (!m_sampleFile.is_open())
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (!m_writer.isOpen())
     {
     	qDebug() << "FileRecord::startRecording";
-        m_sampleFile.open(m_fileName.toStdString().c_str(), std::ios::binary);
-        m_recordOn = true;
-        m_recordStart = true;
-        m_byteCount = 0;
+        // the header is written through the codec and must be left as is. Only .sdriq records can be compressed.
+        m_format = IQFileFormat::getFormatFromFileName(m_fileName);
+        FileRecordCodec::Codec codec = m_format == IQFileFormat::FormatSDRiq ? m_compression : FileRecordCodec::CodecNone;
+        m_codec.init(codec, sizeof(Sample), m_headerSize);
+        m_writer.setCodec(codec == FileRecordCodec::CodecNone ? 0 : &m_codec);
+
+        if (m_writer.open(m_fileName, m_directIO))
+        {
+            m_recordOn = true;
+            m_recordStart = true;
+            m_byteCount = 0;
+            m_sampleCount = 0;
+            m_index.clear();
+            m_triggerSettings = m_triggerDefaults;
+            m_triggered = m_triggerSettings.m_preTrigger > 0.0f;
+
+            if (m_triggered)
+            {
+                m_inputCount = 0;
+                m_writeStart = 0;
+                m_writeEnd = 0;
+                m_nextWrite = 0;
+                resetRing();
+
+                if (m_triggerSettings.m_powerTrigger)
+                {
+                    m_powerTrigger = new FileRecordPowerTrigger(
+                            m_triggerSettings.m_powerBandOffset,
+                            m_triggerSettings.m_powerBandwidth,
+                            m_triggerSettings.m_powerThreshold);
+                    DSPSignalNotification notif(m_sampleRate, m_centerFrequency);
+                    m_powerTrigger->handleMessage(notif);
+                }
+
+                qDebug("FileRecord::startRecording: triggered: pre-trigger: %f s post-trigger: %f s power trigger: %s",
+                        m_triggerSettings.m_preTrigger, m_triggerSettings.m_postTrigger, m_powerTrigger ? "on" : "off");
+            }
+        }
     }
 }
 
 void FileRecord::stopRecording()
 {
-    if (m_sampleFile.is_open())
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_writer.isOpen())
     {
     	qDebug() << "FileRecord::stopRecording";
-        m_sampleFile.close();
+
+        if (m_triggered) { // write what is due in the delay line
+            popRing(m_inputCount - m_ringStart, QDateTime::currentMSecsSinceEpoch(), m_inputCount);
+        }
+
+        m_writer.close();
+        writeIndex();
         m_recordOn = false;
         m_recordStart = false;
+        m_triggered = false;
+        delete m_powerTrigger;
+        m_powerTrigger = 0;
+        SampleVector().swap(m_ring);
     }
 }
 
+void FileRecord::webapiFormatReport(SWGSDRangel::SWGFileRecordReport& report)
+{
+    FileRecordWriter::Counters counters;
+    m_writer.getCounters(counters);
+    report.setRecording(m_recordOn ? 1 : 0);
+    report.setRecordedBytes(counters.m_writtenBytes);
+    report.setBufferedBytes(counters.m_bufferedBytes);
+    report.setOverruns(counters.m_overruns);
+    report.setDroppedBytes(counters.m_droppedBytes);
+    report.setWriteErrors(counters.m_writeErrors);
+}
+
 bool FileRecord::handleMessage(const Message& message)
 {
 	if (DSPSignalNotification::match(message))
 	{
 		DSPSignalNotification& notif = (DSPSignalNotification&) message;
+		QMutexLocker mutexLocker(&m_mutex);
+		bool changed = (m_sampleRate != notif.getSampleRate()) || (m_centerFrequency != notif.getCenterFrequency());
+
+		if (changed && m_triggered) { // samples in the delay line were received before the change
+		    popRing(m_inputCount - m_ringStart, QDateTime::currentMSecsSinceEpoch(), m_inputCount);
+		}
+
 		m_sampleRate = notif.getSampleRate();
 		m_centerFrequency = notif.getCenterFrequency();
+
+		if (changed && m_recordOn && !m_recordStart) { // record where the change happens
+		    addIndexEntry(QDateTime::currentMSecsSinceEpoch());
+		}
+
+		if (changed && m_triggered) {
+		    resetRing();
+		}
+
+		if (m_powerTrigger) {
+		    m_powerTrigger->handleMessage(notif);
+		}
+
 		qDebug() << "FileRecord::handleMessage: DSPSignalNotification: m_inputSampleRate: " << m_sampleRate
 				<< " m_centerFrequency: " << m_centerFrequency;
 		return true;
@@ -126,14 +378,110 @@ void FileRecord::handleConfigure(const QString& fileName)
 	m_fileName = fileName;
 }
 
-void FileRecord::writeHeader()
+void FileRecord::writeHeader(qint64 timestampMs)
+{
+    if (m_format == IQFileFormat::FormatWAV)
+    {
+        std::vector<char> header;
+        IQFileFormat::makeWavHeader(header, m_sampleRate, m_centerFrequency, timestampMs);
+        m_writer.write(header.data(), header.size());
+        return;
+    }
+    else if (m_format != IQFileFormat::FormatSDRiq) // raw samples. Metadata goes to a SigMF file.
+    {
+        return;
+    }
+
+    m_writer.write((const char *) &m_sampleRate, sizeof(qint32));         // 4 bytes
+    m_writer.write((const char *) &m_centerFrequency, sizeof(quint64));   // 8 bytes
+    std::time_t ts = timestampMs / 1000;
+    m_writer.write((const char *) &ts, sizeof(std::time_t));              // 8 bytes
+    quint32 sampleSize = SDR_RX_SAMP_SZ | (m_codec.getCodec() << 8);
+    m_writer.write((const char *) &sampleSize, sizeof(int));              // 4 bytes
+}
+
+void FileRecord::addIndexEntry(qint64 timestampMs)
+{
+    IndexEntry entry;
+    entry.sampleIndex = m_sampleCount;
+    entry.timestampMs = timestampMs;
+    entry.centerFrequency = m_centerFrequency;
+    entry.sampleRate = m_sampleRate;
+    entry.reserved = 0;
+
+    // a change or a gap can happen before any sample follows the previous entry
+    if (!m_index.empty() && (m_index.back().sampleIndex == m_sampleCount)) {
+        m_index.back() = entry;
+    } else {
+        m_index.push_back(entry);
+    }
+
+    m_nextIndexSample = m_sampleCount + (m_sampleRate > 0 ? m_sampleRate : 1<<20);
+}
+
+void FileRecord::writeIndex()
+{
+    if (m_index.empty()) { // nothing was recorded
+        return;
+    }
+
+    if (m_format != IQFileFormat::FormatSDRiq)
+    {
+        writeMetadata();
+        return;
+    }
+
+    std::ofstream file(qPrintable(m_fileName), std::ios::binary | std::ios::app);
+
+    if (!file.is_open())
+    {
+        qWarning("FileRecord::writeIndex: cannot append index to %s", qPrintable(m_fileName));
+        return;
+    }
+
+    IndexTrailer trailer;
+    trailer.nbEntries = m_index.size();
+    trailer.version = 1;
+    memcpy(trailer.magic, "SIDX", 4);
+
+    file.write((const char *) m_index.data(), m_index.size() * sizeof(IndexEntry));
+    file.write((const char *) &trailer, sizeof(IndexTrailer));
+    qDebug("FileRecord::writeIndex: %s: %u index entries", qPrintable(m_fileName), (unsigned int) m_index.size());
+}
+
+void FileRecord::writeMetadata()
 {
-    m_sampleFile.write((const char *) &m_sampleRate, sizeof(qint32));         // 4 bytes
-    m_sampleFile.write((const char *) &m_centerFrequency, sizeof(quint64));   // 8 bytes
-    std::time_t ts = time(0);
-    m_sampleFile.write((const char *) &ts, sizeof(std::time_t));              // 8 bytes
-    quint32 sampleSize = SDR_RX_SAMP_SZ;
-    m_sampleFile.write((const char *) &sampleSize, sizeof(int));              // 4 bytes
+    if (m_format == IQFileFormat::FormatWAV)
+    {
+        // the header was written with the sizes unknown. m_byteCount counts the samples only.
+        IQFileFormat::finishWavFile(m_fileName, m_byteCount, QDateTime::currentMSecsSinceEpoch());
+        return;
+    }
+
+    // SigMF captures start where the center frequency changes. The sample rate is global.
+    std::vector<IQFileFormat::Capture> captures;
+
+    bool rateChanged = false;
+
+    for (unsigned int i = 0; i < m_index.size(); i++)
+    {
+        rateChanged = rateChanged || (m_index[i].sampleRate != m_index[0].sampleRate);
+
+        if (captures.empty() || (captures.back().m_centerFrequency != m_index[i].centerFrequency))
+        {
+            IQFileFormat::Capture capture;
+            capture.m_sampleIndex = m_index[i].sampleIndex;
+            capture.m_centerFrequency = m_index[i].centerFrequency;
+            capture.m_timestampMs = m_index[i].timestampMs;
+            captures.push_back(capture);
+        }
+    }
+
+    if (rateChanged) {
+        qWarning("FileRecord::writeMetadata: %s: the sample rate changed during the recording. Only the first one is kept.", qPrintable(m_fileName));
+    }
+
+    IQFileFormat::writeSigMF(m_fileName, m_format, m_index[0].sampleRate, captures);
 }
 
 void FileRecord::readHeader(std::ifstream& sampleFile, Header& header)
@@ -142,7 +490,27 @@ void FileRecord::readHeader(std::ifstream& sampleFile, Header& header)
     sampleFile.read((char *) &(header.centerFrequency), sizeof(quint64));
     sampleFile.read((char *) &(header.startTimeStamp), sizeof(std::time_t));
     sampleFile.read((char *) &(header.sampleSize), sizeof(quint32));
-    if ((header.sampleSize != 16) && (header.sampleSize != 24)) { // assume 16 bits if garbage (old I/Q file)
-    	header.sampleSize = 16;
+    decodeSampleSize(header);
+}
+
+void FileRecord::readHeader(const char *data, Header& header)
+{
+    memcpy(&header.sampleRate, data, sizeof(qint32));
+    memcpy(&header.centerFrequency, data + 4, sizeof(quint64));
+    memcpy(&header.startTimeStamp, data + 12, sizeof(std::time_t));
+    memcpy(&header.sampleSize, data + 20, sizeof(quint32));
+    decodeSampleSize(header);
+}
+
+void FileRecord::decodeSampleSize(Header& header)
+{
+    quint32 sampleSize = header.sampleSize;
+    header.sampleSize = sampleSize & 0xff;
+    header.codec = (sampleSize >> 8) & 0xff;
+
+    if (((header.sampleSize != 16) && (header.sampleSize != 24)) || (header.codec >= FileRecordCodec::CodecEnd) || (sampleSize >> 16))
+    { // assume 16 bits if garbage (old I/Q file)
+        header.sampleSize = 16;
+        header.codec = FileRecordCodec::CodecNone;
     }
 }
@@ -7,9 +7,21 @@
 #include <fstream>
 
 #include <ctime>
+#include <vector>
+#include <QMutex>
+
+#include "dsp/filerecordwriter.h"
+#include "dsp/filerecordcodec.h"
+#include "dsp/iqfileformat.h"
 #include "export.h"
 
 class Message;
+class FileRecordPowerTrigger;
+
+namespace SWGSDRangel
+{
+    class SWGFileRecordReport;
+}
 
 class SDRBASE_API FileRecord : public BasebandSampleSink {
 public:
@@ -20,16 +32,71 @@ public:
         quint64     centerFrequency;
         std::time_t startTimeStamp;
         quint32     sampleSize;
+        quint32     codec;       //!< FileRecordCodec::Codec of the samples (stored in the upper bits of the sample size)
+    };
+
+    static const quint32 m_headerSize = 24; //!< size of the header in file (sizeof(Header) includes padding)
+
+    /**
+     * The samples are followed by a time index written when the recording stops: an array of
+     * IndexEntry then an IndexTrailer at the very end of the file. An entry is added every second
+     * of samples, when samples had to be dropped and when the sample rate or center frequency
+     * changes. Readers that ignore the index see a few more samples at the end of the record.
+     */
+    struct IndexEntry
+    {
+        quint64 sampleIndex;     //!< first sample described by this entry
+        qint64  timestampMs;     //!< arrival time of this sample in ms since epoch
+        quint64 centerFrequency;
+        qint32  sampleRate;
+        quint32 reserved;
+    };
+
+    struct IndexTrailer
+    {
+        quint64 nbEntries;
+        quint32 version;
+        char    magic[4];        //!< "SIDX"
+    };
+
+    /**
+     * Triggered recording. The last pre-trigger seconds of samples are kept in memory and only
+     * samples from pre-trigger seconds before the trigger fires to post-trigger seconds after
+     * it is released are written. The output lags the input by the pre-trigger time so that the
+     * disk sees the same rate as in continuous recording. Each burst starts with an index entry.
+     * The trigger is given by setTrigger() (e.g. squelch of a channel) and/or by the power in a
+     * band (offset from the center of the record) measured on a power spectrum.
+     */
+    struct TriggerSettings
+    {
+        float m_preTrigger;      //!< seconds of samples before the trigger (0 for continuous recording)
+        float m_postTrigger;     //!< seconds of samples after the trigger is released
+        bool m_powerTrigger;
+        qint64 m_powerBandOffset;
+        int m_powerBandwidth;
+        float m_powerThreshold;  //!< dB
+
+        TriggerSettings() :
+            m_preTrigger(0.0f),
+            m_postTrigger(1.0f),
+            m_powerTrigger(false),
+            m_powerBandOffset(0),
+            m_powerBandwidth(10000),
+            m_powerThreshold(-50.0f)
+        {}
     };
 
 	FileRecord();
-    FileRecord(const QString& filename);
+    /** Recordings of narrow channels can use fewer and smaller buffers than the default made for wide basebands */
+    FileRecord(const QString& filename, unsigned int nbBuffers = 32, unsigned int bufferSize = 1<<20);
 	virtual ~FileRecord();
 
     quint64 getByteCount() const { return m_byteCount; }
 
     void setFileName(const QString& filename);
+    const QString& getFileName() const { return m_fileName; }
     void genUniqueFileName(uint deviceUID);
+    static QString genUniqueFileName(uint deviceUID, int channelIndex); //!< for the recording of a channel of the device
 
 	virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool positiveOnly);
 	virtual void start();
@@ -38,6 +105,19 @@ public:
     void startRecording();
     void stopRecording();
     static void readHeader(std::ifstream& samplefile, Header& header);
+    static void readHeader(const char *data, Header& header); //!< from m_headerSize bytes in memory
+    /** Open next recordings with O_DIRECT where supported (process wide) */
+    static void setDirectIO(bool directIO) { m_directIO = directIO; }
+    /** Compress next recordings (process wide) */
+    static void setCompression(FileRecordCodec::Codec codec) { m_compression = codec; }
+    /** File format of next recordings named by genUniqueFileName() (process wide). Otherwise the format follows the extension. */
+    static void setFormat(IQFileFormat::Format format) { m_defaultFormat = format; }
+    /** Trigger settings of next recordings (process wide) */
+    static void setTriggerSettings(const TriggerSettings& settings) { m_triggerDefaults = settings; }
+    static const TriggerSettings& getTriggerSettings() { return m_triggerDefaults; }
+    bool isTriggered() const { return m_triggered; } //!< current recording is a triggered one
+    void setTrigger(bool trigger) { m_externalTrigger = trigger; }
+    void webapiFormatReport(SWGSDRangel::SWGFileRecordReport& report);
 
 private:
 	QString m_fileName;
@@ -45,11 +125,41 @@ private:
 	quint64 m_centerFrequency;
 	bool m_recordOn;
     bool m_recordStart;
-    std::ofstream m_sampleFile;
+    FileRecordWriter m_writer; //!< writes to file from its own thread so that feed() never waits for the disk
+    QMutex m_mutex;
     quint64 m_byteCount;
+    quint64 m_sampleCount;     //!< samples actually recorded
+    quint64 m_nextIndexSample; //!< sample count at which the next periodic index entry is due
+    std::vector<IndexEntry> m_index;
+    FileRecordCodec m_codec;   //!< used by the writer thread
+    IQFileFormat::Format m_format;  //!< of the current recording
+    std::vector<char> m_convertBuffer; //!< samples converted to the format of other tools
+    TriggerSettings m_triggerSettings; //!< of the current recording
+    bool m_triggered;
+    bool m_externalTrigger;
+    FileRecordPowerTrigger *m_powerTrigger;
+    SampleVector m_ring;       //!< delay line of the pre-trigger samples
+    quint64 m_inputCount;      //!< samples fed since the start of the triggered recording
+    quint64 m_ringStart;       //!< input index of the oldest sample in the delay line
+    quint64 m_writeStart;      //!< input index of the first sample to write of the current burst
+    quint64 m_writeEnd;        //!< input index past the last sample to write of the current burst
+    quint64 m_nextWrite;       //!< input index following the last sample written
+    quint64 m_postTriggerSamples;
+    static bool m_directIO;
+    static FileRecordCodec::Codec m_compression;
+    static IQFileFormat::Format m_defaultFormat;
+    static TriggerSettings m_triggerDefaults;
 
 	void handleConfigure(const QString& fileName);
-    void writeHeader();
+    void writeHeader(qint64 timestampMs);
+    void addIndexEntry(qint64 timestampMs);
+    void writeSamples(const Sample *samples, quint64 nbSamples, qint64 timestampMs, bool contiguous);
+    void feedTriggered(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+    void popRing(quint64 nbSamples, qint64 nowMs, quint64 nowIndex); //!< nbSamples leave the delay line
+    void resetRing();
+    void writeIndex();
+    void writeMetadata(); //!< for files of other tools
+    static void decodeSampleSize(Header& header);
 };
 
 #endif // INCLUDE_FILESINK_H
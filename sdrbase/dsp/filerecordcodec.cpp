@@ -0,0 +1,521 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <QDebug>
+
+#include "dsp/filerecordcodec.h"
+
+static const unsigned int losslessPartition = 256; //!< samples sharing a predictor order and a Rice parameter
+static const unsigned int losslessEscape = 32;     //!< unary quotients from this value are escaped
+static const unsigned int bfpGroup = 16;           //!< I/Q samples sharing a shift
+
+namespace {
+
+class BitWriter
+{
+public:
+    BitWriter(char *out) : m_out((quint8 *) out), m_start(m_out), m_acc(0), m_nbBits(0) {}
+
+    /** bits <= 32 and value < 2^bits */
+    void put(quint32 value, unsigned int bits)
+    {
+        m_acc = (m_acc << bits) | value;
+        m_nbBits += bits;
+
+        if (m_nbBits >= 32) // output by words
+        {
+            m_nbBits -= 32;
+            quint32 word = m_acc >> m_nbBits;
+            m_out[0] = word >> 24;
+            m_out[1] = word >> 16;
+            m_out[2] = word >> 8;
+            m_out[3] = word;
+            m_out += 4;
+        }
+    }
+
+    /** returns the number of bytes written */
+    unsigned int flush()
+    {
+        while (m_nbBits >= 8)
+        {
+            m_nbBits -= 8;
+            *m_out++ = m_acc >> m_nbBits;
+        }
+
+        if (m_nbBits > 0) {
+            *m_out++ = m_acc << (8 - m_nbBits);
+        }
+
+        m_nbBits = 0;
+        return m_out - m_start;
+    }
+
+private:
+    quint8 *m_out;
+    quint8 *m_start;
+    quint64 m_acc;
+    unsigned int m_nbBits;
+};
+
+class BitReader
+{
+public:
+    BitReader(const char *data, unsigned int size) :
+        m_data((const quint8 *) data), m_size(size), m_index(0), m_window(0), m_nbBits(0) {}
+
+    quint32 get(unsigned int bits)
+    {
+        if (bits == 0) {
+            return 0;
+        }
+
+        refill();
+        quint32 value = m_window >> (64 - bits);
+        skip(bits);
+        return value;
+    }
+
+    unsigned int leadingZeros()
+    {
+        refill();
+        return m_window ? __builtin_clzll(m_window) : 64;
+    }
+
+    void skip(unsigned int bits)
+    {
+        m_window <<= bits;
+        m_nbBits -= bits;
+    }
+
+    /** false if more bits were consumed than available */
+    bool ok() const { return (quint64) m_index * 8 - m_nbBits <= (quint64) m_size * 8; }
+
+private:
+    const quint8 *m_data;
+    unsigned int m_size;
+    unsigned int m_index;
+    quint64 m_window; //!< next bits left aligned
+    unsigned int m_nbBits;
+
+    void refill()
+    {
+        if (m_nbBits > 56) {
+            return;
+        }
+
+        if (m_index + 8 <= m_size) // as many whole bytes as fit at once
+        {
+            const quint8 *p = m_data + m_index;
+            quint64 bits = ((quint64) p[0] << 56) | ((quint64) p[1] << 48) | ((quint64) p[2] << 40) | ((quint64) p[3] << 32)
+                    | ((quint64) p[4] << 24) | ((quint64) p[5] << 16) | ((quint64) p[6] << 8) | (quint64) p[7];
+            m_window |= bits >> m_nbBits; // bits past the whole bytes are loaded again next time
+            unsigned int bytes = (63 - m_nbBits) >> 3;
+            m_index += bytes;
+            m_nbBits += 8 * bytes;
+            return;
+        }
+
+        while (m_nbBits <= 56) // zeros past the end
+        {
+            quint64 byte = m_index < m_size ? m_data[m_index] : 0;
+            m_window |= byte << (56 - m_nbBits);
+            m_nbBits += 8;
+            m_index++;
+        }
+    }
+};
+
+inline quint32 zigzag(qint32 value) {
+    return ((quint32) value << 1) ^ (quint32) (value >> 31);
+}
+
+inline qint32 unzigzag(quint32 value) {
+    return (qint32) ((value >> 1) ^ (0U - (value & 1)));
+}
+
+inline qint32 predict(unsigned int order, qint32 x1, qint32 x2)
+{
+    return order == 0 ? 0 : order == 1 ? x1 : (qint32) (2U * (quint32) x1 - (quint32) x2);
+}
+
+template<typename T>
+bool decodeLossless(const char *data, unsigned int size, unsigned int nbSamples, T *samples)
+{
+    BitReader reader(data, size);
+
+    for (unsigned int channel = 0; channel < 2; channel++)
+    {
+        qint32 x1 = 0, x2 = 0;
+
+        for (unsigned int start = 0; start < nbSamples; start += losslessPartition)
+        {
+            unsigned int end = start + losslessPartition < nbSamples ? start + losslessPartition : nbSamples;
+            unsigned int order = reader.get(2);
+            unsigned int k = reader.get(5);
+
+            if ((order > 2) || !reader.ok()) {
+                return false;
+            }
+
+            for (unsigned int i = start; i < end; i++)
+            {
+                unsigned int zeros = reader.leadingZeros();
+                quint32 u;
+
+                if (zeros >= losslessEscape)
+                {
+                    reader.skip(losslessEscape);
+                    u = reader.get(32);
+                }
+                else
+                {
+                    reader.skip(zeros + 1);
+                    u = ((quint32) zeros << k) | reader.get(k);
+                }
+
+                qint32 x = (qint32) ((quint32) unzigzag(u) + (quint32) predict(order, x1, x2));
+                samples[2*i + channel] = (T) x;
+                x2 = x1;
+                x1 = x;
+            }
+        }
+    }
+
+    return reader.ok();
+}
+
+template<typename T>
+bool decodeBFP(const char *data, unsigned int size, unsigned int nbSamples, unsigned int bits, T *samples)
+{
+    unsigned int nbGroups = (nbSamples + bfpGroup - 1) / bfpGroup;
+
+    if (size != nbGroups + (nbSamples * 2 * bits) / 8) {
+        return false;
+    }
+
+    const quint8 *p = (const quint8 *) data;
+
+    for (unsigned int start = 0; start < nbSamples; start += bfpGroup)
+    {
+        unsigned int nbValues = 2 * (start + bfpGroup < nbSamples ? bfpGroup : nbSamples - start);
+        unsigned int shift = *p++;
+        T *out = samples + 2*start;
+
+        if (shift > 31) {
+            return false;
+        }
+
+        if (bits == 8)
+        {
+            for (unsigned int i = 0; i < nbValues; i++) {
+                out[i] = (T) (qint32) ((quint32) (qint32) (qint8) p[i] << shift);
+            }
+
+            p += nbValues;
+        }
+        else // 12 bits: I and Q packed in 3 bytes
+        {
+            for (unsigned int i = 0; i < nbValues; i += 2, p += 3)
+            {
+                qint32 a = (qint32) ((quint32) (p[0] | ((p[1] & 0x0f) << 8)) << 20) >> 20;
+                qint32 b = (qint32) ((quint32) ((p[1] >> 4) | (p[2] << 4)) << 20) >> 20;
+                out[i]   = (T) (qint32) ((quint32) a << shift);
+                out[i+1] = (T) (qint32) ((quint32) b << shift);
+            }
+        }
+    }
+
+    return true;
+}
+
+template<typename T>
+bool decodeBlock(const FileRecordCodec::BlockHeader& header, const char *data, T *samples)
+{
+    switch (header.codec)
+    {
+    case FileRecordCodec::CodecNone:
+        if (header.size != header.nbSamples * 2 * sizeof(T)) {
+            return false;
+        }
+        memcpy(samples, data, header.size);
+        return true;
+    case FileRecordCodec::CodecLossless:
+        return decodeLossless(data, header.size, header.nbSamples, samples);
+    case FileRecordCodec::CodecBFP8:
+        return decodeBFP(data, header.size, header.nbSamples, 8, samples);
+    case FileRecordCodec::CodecBFP12:
+        return decodeBFP(data, header.size, header.nbSamples, 12, samples);
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+FileRecordCodec::FileRecordCodec() :
+    m_codec(CodecNone),
+    m_sampleBytes(4),
+    m_rawBytes(0)
+{
+}
+
+void FileRecordCodec::init(Codec codec, unsigned int sampleBytes, unsigned int rawBytes)
+{
+    m_codec = codec;
+    m_sampleBytes = sampleBytes;
+    m_rawBytes = rawBytes;
+}
+
+void FileRecordCodec::encode(const char *data, unsigned int size, std::vector<char>& encoded)
+{
+    encoded.clear();
+
+    if (m_rawBytes > 0)
+    {
+        unsigned int count = size < m_rawBytes ? size : m_rawBytes;
+        encoded.insert(encoded.end(), data, data + count);
+        m_rawBytes -= count;
+        data += count;
+        size -= count;
+    }
+
+    unsigned int nbSamples = size / m_sampleBytes;
+
+    if (nbSamples * m_sampleBytes != size) {
+        qWarning("FileRecordCodec::encode: %u bytes of partial sample dropped", size - nbSamples * m_sampleBytes);
+    }
+
+    if (nbSamples == 0) {
+        return;
+    }
+
+    m_values.resize(2 * nbSamples);
+
+    if (m_sampleBytes == 2 * sizeof(qint16))
+    {
+        const qint16 *samples = (const qint16 *) data;
+
+        for (unsigned int i = 0; i < 2 * nbSamples; i++) {
+            m_values[i] = samples[i];
+        }
+    }
+    else
+    {
+        memcpy(m_values.data(), data, 2 * nbSamples * sizeof(qint32));
+    }
+
+    unsigned int headerPos = encoded.size();
+    encoded.resize(headerPos + sizeof(BlockHeader));
+    BlockHeader header;
+    header.nbSamples = nbSamples;
+    header.codec = m_codec;
+    header.reserved = 0;
+
+    switch (m_codec)
+    {
+    case CodecLossless:
+        encodeLossless(nbSamples, encoded);
+        break;
+    case CodecBFP8:
+        encodeBFP(nbSamples, 8, encoded);
+        break;
+    case CodecBFP12:
+        encodeBFP(nbSamples, 12, encoded);
+        break;
+    default:
+        break;
+    }
+
+    header.size = encoded.size() - headerPos - sizeof(BlockHeader);
+
+    if ((header.codec == CodecNone) || (header.size >= size)) // no gain: store as is
+    {
+        encoded.resize(headerPos + sizeof(BlockHeader));
+        encoded.insert(encoded.end(), data, data + size);
+        header.codec = CodecNone;
+        header.size = nbSamples * m_sampleBytes;
+    }
+
+    memcpy(&encoded[headerPos], &header, sizeof(BlockHeader));
+}
+
+void FileRecordCodec::encodeLossless(unsigned int nbSamples, std::vector<char>& encoded)
+{
+    // worst case is escaped values of 64 bits
+    unsigned int pos = encoded.size();
+    encoded.resize(pos + nbSamples * 2 * 8 + (nbSamples / losslessPartition + 1) * 2 + 4);
+    BitWriter writer(&encoded[pos]);
+
+    for (unsigned int channel = 0; channel < 2; channel++)
+    {
+        const qint32 *x = m_values.data() + channel; // stride 2
+        qint32 x1 = 0, x2 = 0;
+
+        for (unsigned int start = 0; start < nbSamples; start += losslessPartition)
+        {
+            unsigned int end = start + losslessPartition < nbSamples ? start + losslessPartition : nbSamples;
+            quint64 sums[3] = {0, 0, 0};
+            qint32 p1 = x1, p2 = x2;
+
+            // pick the predictor with the smallest residuals
+            for (unsigned int i = start; i < end; i++)
+            {
+                qint32 v = x[2*i];
+                sums[0] += zigzag(v);
+                sums[1] += zigzag(v - p1);
+                sums[2] += zigzag(v - 2*p1 + p2);
+                p2 = p1;
+                p1 = v;
+            }
+
+            unsigned int order = sums[1] < sums[0] ? 1 : 0;
+            order = sums[2] < sums[order] ? 2 : order;
+
+            // Rice parameter from the mean of the residuals
+            quint64 n = end - start;
+            unsigned int k = 0;
+
+            while ((k < 30) && ((n << (k + 1)) <= sums[order])) {
+                k++;
+            }
+
+            writer.put(order, 2);
+            writer.put(k, 5);
+
+            for (unsigned int i = start; i < end; i++)
+            {
+                qint32 v = x[2*i];
+                quint32 u = zigzag(v - predict(order, x1, x2));
+                quint32 q = u >> k;
+
+                if (q + 1 + k <= 32) // unary quotient and remainder at once
+                {
+                    writer.put((1U << k) | (u & ((1U << k) - 1)), q + 1 + k);
+                }
+                else if (q < losslessEscape)
+                {
+                    writer.put(1, q + 1);
+                    writer.put(u & ((1U << k) - 1), k);
+                }
+                else
+                {
+                    writer.put(0, losslessEscape);
+                    writer.put(u, 32);
+                }
+
+                x2 = x1;
+                x1 = v;
+            }
+        }
+    }
+
+    encoded.resize(pos + writer.flush());
+}
+
+void FileRecordCodec::encodeBFP(unsigned int nbSamples, unsigned int bits, std::vector<char>& encoded)
+{
+    const qint32 limit = (1 << (bits - 1)) - 1;
+    unsigned int pos = encoded.size();
+    encoded.resize(pos + (nbSamples + bfpGroup - 1) / bfpGroup + (nbSamples * 2 * bits) / 8);
+    quint8 *p = (quint8 *) &encoded[pos];
+    qint32 q[2*bfpGroup];
+
+    for (unsigned int start = 0; start < nbSamples; start += bfpGroup)
+    {
+        unsigned int nbValues = 2 * (start + bfpGroup < nbSamples ? bfpGroup : nbSamples - start);
+        const qint32 *v = m_values.data() + 2*start;
+        qint32 magnitude = 0;
+
+        for (unsigned int i = 0; i < nbValues; i++) {
+            magnitude |= v[i] < 0 ? ~v[i] : v[i];
+        }
+
+        unsigned int shift = 0;
+
+        while ((magnitude >> shift) > limit) {
+            shift++;
+        }
+
+        qint32 round = shift > 0 ? 1 << (shift - 1) : 0;
+
+        for (unsigned int i = 0; i < nbValues; i++)
+        {
+            qint32 value = (v[i] + round) >> shift;
+            q[i] = value > limit ? limit : value;
+        }
+
+        *p++ = shift;
+
+        if (bits == 8)
+        {
+            for (unsigned int i = 0; i < nbValues; i++) {
+                p[i] = (quint8) q[i];
+            }
+
+            p += nbValues;
+        }
+        else
+        {
+            for (unsigned int i = 0; i < nbValues; i += 2, p += 3)
+            {
+                p[0] = q[i] & 0xff;
+                p[1] = ((q[i] >> 8) & 0x0f) | ((q[i+1] & 0x0f) << 4);
+                p[2] = (q[i+1] >> 4) & 0xff;
+            }
+        }
+    }
+}
+
+bool FileRecordCodec::decode(const BlockHeader& header, const char *data, unsigned int sampleBytes, char *samples)
+{
+    if (sampleBytes == 2 * sizeof(qint16)) {
+        return decodeBlock(header, data, (qint16 *) samples);
+    } else {
+        return decodeBlock(header, data, (qint32 *) samples);
+    }
+}
+
+const char *FileRecordCodec::getName(Codec codec)
+{
+    switch (codec)
+    {
+    case CodecLossless:
+        return "lossless";
+    case CodecBFP8:
+        return "bfp8";
+    case CodecBFP12:
+        return "bfp12";
+    default:
+        return "none";
+    }
+}
+
+bool FileRecordCodec::getCodec(const QString& name, Codec& codec)
+{
+    for (int i = 0; i < CodecEnd; i++)
+    {
+        if (name == getName((Codec) i))
+        {
+            codec = (Codec) i;
+            return true;
+        }
+    }
+
+    return false;
+}
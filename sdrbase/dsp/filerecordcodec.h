@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_FILERECORDCODEC_H_
+#define SDRBASE_DSP_FILERECORDCODEC_H_
+
+#include <QtGlobal>
+#include <QString>
+#include <vector>
+
+#include "export.h"
+
+/**
+ * Compression of the I/Q samples of a record. The samples are cut in blocks that can be
+ * decoded independently so that a reader can still seek anywhere in the record. Each block
+ * starts with a BlockHeader followed by the coded samples.
+ *
+ * - Lossless: each of I and Q is predicted from the previous samples (order 0, 1 or 2 chosen
+ *   for each partition of 256 samples) and the residuals are Rice coded.
+ * - BFP8 and BFP12: block floating point. Groups of 16 I/Q samples share a shift so that the
+ *   largest value fits in 8 or 12 bits. Low order bits are lost on strong signals only.
+ *
+ * Blocks that do not get smaller are stored as is.
+ */
+class SDRBASE_API FileRecordCodec
+{
+public:
+    enum Codec
+    {
+        CodecNone,
+        CodecLossless,
+        CodecBFP8,
+        CodecBFP12,
+        CodecEnd
+    };
+
+    struct BlockHeader
+    {
+        quint32 size;      //!< bytes of coded samples following this header
+        quint32 nbSamples; //!< I/Q samples in the block
+        quint32 codec;     //!< Codec actually used for this block (CodecNone if stored as is)
+        quint32 reserved;
+    };
+
+    FileRecordCodec();
+
+    /** Start a new stream. The first rawBytes of the stream (the record header) are copied as is. */
+    void init(Codec codec, unsigned int sampleBytes, unsigned int rawBytes);
+    Codec getCodec() const { return m_codec; }
+
+    /**
+     * Encode the next piece of the stream in a new block (replaces the content of encoded).
+     * Apart from the raw bytes at the start of the stream pieces must hold whole I/Q samples.
+     */
+    void encode(const char *data, unsigned int size, std::vector<char>& encoded);
+
+    /** Decode the samples of a block. Returns false if the block is corrupt. */
+    static bool decode(const BlockHeader& header, const char *data, unsigned int sampleBytes, char *samples);
+
+    static const char *getName(Codec codec);
+    static bool getCodec(const QString& name, Codec& codec);
+
+private:
+    Codec m_codec;
+    unsigned int m_sampleBytes; //!< bytes per I/Q sample: 4 (16 bit) or 8 (24 bit in 32 bit words)
+    unsigned int m_rawBytes;    //!< bytes still to copy as is
+    std::vector<qint32> m_values;  //!< samples of the block being encoded (I then Q interleaved)
+
+    void encodeLossless(unsigned int nbSamples, std::vector<char>& encoded);
+    void encodeBFP(unsigned int nbSamples, unsigned int bits, std::vector<char>& encoded);
+};
+
+#endif /* SDRBASE_DSP_FILERECORDCODEC_H_ */
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include "dsp/filerecordtrigger.h"
+
+const int FileRecordPowerTrigger::m_fftSize;
+
+FileRecordPowerTrigger::FileRecordPowerTrigger(qint64 bandOffset, int bandwidth, float thresholdDb) :
+    SpectrumEngine(SDR_RX_SCALEF),
+    m_bandOffset(bandOffset),
+    m_bandwidth(bandwidth),
+    m_thresholdDb(thresholdDb),
+    m_triggered(false),
+    m_peakDb(-200.0f)
+{
+    setObjectName("FileRecordPowerTrigger");
+
+    Settings settings;
+    settings.m_fftSize = m_fftSize;
+    MsgConfigureSpectrumEngine *msg = MsgConfigureSpectrumEngine::create(settings);
+    handleMessage(*msg);
+    delete msg;
+}
+
+FileRecordPowerTrigger::~FileRecordPowerTrigger()
+{
+}
+
+void FileRecordPowerTrigger::newSpectrum(const std::vector<Real>& spectrum, int fftSize)
+{
+    int sampleRate = getSpectrumSampleRate();
+
+    if (sampleRate <= 0) {
+        return;
+    }
+
+    // bins are ordered from -sampleRate/2 to +sampleRate/2 and the band covers at least one bin
+    double binsPerHz = (double) fftSize / sampleRate;
+    int startBin = (fftSize / 2) + (int) floor((m_bandOffset - m_bandwidth / 2) * binsPerHz);
+    int endBin = (fftSize / 2) + (int) ceil((m_bandOffset + m_bandwidth / 2) * binsPerHz);
+    startBin = startBin < 0 ? 0 : startBin > fftSize - 1 ? fftSize - 1 : startBin;
+    endBin = endBin <= startBin ? startBin + 1 : endBin > fftSize ? fftSize : endBin;
+
+    m_peakDb = *std::max_element(spectrum.begin() + startBin, spectrum.begin() + endBin);
+    m_triggered = m_peakDb >= m_thresholdDb;
+}
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_FILERECORDTRIGGER_H_
+#define SDRBASE_DSP_FILERECORDTRIGGER_H_
+
+#include "dsp/spectrumengine.h"
+#include "export.h"
+
+/**
+ * Power trigger of triggered recordings. The recorded samples go through a spectrum engine
+ * and the trigger is on as long as the peak of a power spectrum line in the given band is
+ * at or above the threshold. Levels are in dB like in the spectrum display.
+ */
+class SDRBASE_API FileRecordPowerTrigger : public SpectrumEngine
+{
+public:
+    /** The band is given by its center relative to the center frequency of the record and its width in Hz */
+    FileRecordPowerTrigger(qint64 bandOffset, int bandwidth, float thresholdDb);
+    virtual ~FileRecordPowerTrigger();
+
+    bool isTriggered() const { return m_triggered; }
+    float getPeakDb() const { return m_peakDb; } //!< peak of the last line in the band
+
+    static const int m_fftSize = 1024;
+
+protected:
+    virtual void newSpectrum(const std::vector<Real>& spectrum, int fftSize);
+
+private:
+    qint64 m_bandOffset;
+    int m_bandwidth;
+    float m_thresholdDb;
+    bool m_triggered;
+    float m_peakDb;
+};
+
+#endif /* SDRBASE_DSP_FILERECORDTRIGGER_H_ */
@@ -0,0 +1,378 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <malloc.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <QDebug>
+
+#include "dsp/filerecordwriter.h"
+#include "dsp/filerecordcodec.h"
+
+// alignment required by O_DIRECT for buffer addresses, sizes and file offsets
+static const unsigned int directIOAlignment = 4096;
+
+FileRecordWriter::FileRecordWriter(unsigned int nbBuffers, unsigned int bufferSize) :
+    m_bufferSize(((bufferSize + directIOAlignment - 1) / directIOAlignment) * directIOAlignment),
+    m_fillIndex(0),
+    m_writeIndex(0),
+    m_nbFull(0),
+    m_running(false),
+    m_blocking(false),
+    m_fd(-1),
+    m_directIO(false),
+    m_fileOffset(0),
+    m_codec(0)
+{
+    m_buffers.resize(nbBuffers < 2 ? 2 : nbBuffers);
+
+    for (unsigned int i = 0; i < m_buffers.size(); i++) // allocated when a file is open
+    {
+        m_buffers[i].m_data = 0;
+        m_buffers[i].m_size = 0;
+    }
+
+    memset(&m_counters, 0, sizeof(Counters));
+}
+
+FileRecordWriter::~FileRecordWriter()
+{
+    close();
+}
+
+bool FileRecordWriter::open(const QString& fileName, bool directIO, bool append)
+{
+    close();
+
+    int flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+#ifdef _WIN32
+    flags |= O_BINARY;
+#endif
+    m_directIO = false;
+    directIO = directIO && !append; // the end of an existing file is generally not aligned
+
+#ifdef __linux__
+    if (directIO && m_codec) {
+        qWarning("FileRecordWriter::open: direct I/O is not used with compression");
+    }
+
+    if (directIO && !m_codec)
+    {
+        m_fd = ::open(qPrintable(fileName), flags | O_DIRECT, 0644);
+
+        if (m_fd < 0) { // not supported by all file systems (e.g. tmpfs)
+            qWarning("FileRecordWriter::open: cannot use direct I/O for %s: %s", qPrintable(fileName), strerror(errno));
+        } else {
+            m_directIO = true;
+        }
+    }
+#else
+    (void) directIO;
+#endif
+
+    if (m_fd < 0) {
+        m_fd = ::open(qPrintable(fileName), flags, 0644);
+    }
+
+    if (m_fd < 0)
+    {
+        qCritical("FileRecordWriter::open: cannot open %s: %s", qPrintable(fileName), strerror(errno));
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_buffers.size(); i++)
+    {
+        m_buffers[i].m_data = allocateBuffer(m_bufferSize);
+
+        if (m_buffers[i].m_data == 0)
+        {
+            qCritical("FileRecordWriter::open: cannot allocate %u buffers of %u bytes", (unsigned int) m_buffers.size(), m_bufferSize);
+            ::close(m_fd);
+            m_fd = -1;
+            freeBuffers();
+            return false;
+        }
+    }
+
+#ifdef __linux__
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    m_fileName = fileName;
+    m_fillIndex = 0;
+    m_writeIndex = 0;
+    m_nbFull = 0;
+    m_buffers[0].m_size = 0;
+    m_fileOffset = 0;
+
+    if (append)
+    {
+        off_t fileEnd = lseek(m_fd, 0, SEEK_END);
+        m_fileOffset = fileEnd < 0 ? 0 : fileEnd;
+    }
+
+    memset(&m_counters, 0, sizeof(Counters));
+    m_running = true;
+    start();
+
+    qDebug("FileRecordWriter::open: %s direct I/O: %s compression: %s buffers: %u x %u bytes",
+            qPrintable(fileName), m_directIO ? "on" : "off", m_codec ? FileRecordCodec::getName(m_codec->getCodec()) : "none",
+            (unsigned int) m_buffers.size(), m_bufferSize);
+    return true;
+}
+
+void FileRecordWriter::close()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    m_mutex.lock();
+    m_running = false;
+    m_fullCondition.wakeAll();
+    m_mutex.unlock();
+    wait(); // the writer thread exits once all full buffers are written
+
+    // the last buffer is generally partial and cannot be written with direct I/O
+    if (m_buffers[m_fillIndex].m_size > 0)
+    {
+#ifdef __linux__
+        if (m_directIO) {
+            fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+        }
+#endif
+        writeBuffer(m_buffers[m_fillIndex]);
+        m_buffers[m_fillIndex].m_size = 0;
+    }
+
+    ::close(m_fd);
+    m_fd = -1;
+    freeBuffers();
+
+    qDebug("FileRecordWriter::close: %s input: %llu bytes written: %llu bytes overruns: %u dropped: %llu bytes write errors: %u",
+            qPrintable(m_fileName),
+            m_counters.m_inputBytes,
+            m_counters.m_writtenBytes,
+            m_counters.m_overruns,
+            m_counters.m_droppedBytes,
+            m_counters.m_writeErrors);
+}
+
+quint64 FileRecordWriter::write(const char *data, quint64 size)
+{
+    quint64 accepted = 0;
+
+    if (m_fd < 0) { // no buffers
+        return 0;
+    }
+
+    while (size > 0)
+    {
+        Buffer *buffer = &m_buffers[m_fillIndex];
+
+        if (buffer->m_size == m_bufferSize)
+        {
+            // hand the full buffer over to the writer thread if another buffer is free
+            QMutexLocker mutexLocker(&m_mutex);
+
+            while (m_blocking && m_running && (m_nbFull == m_buffers.size() - 1)) {
+                m_freeCondition.wait(&m_mutex);
+            }
+
+            if (m_nbFull < m_buffers.size() - 1)
+            {
+                m_nbFull++;
+                m_fullCondition.wakeOne();
+                m_fillIndex = (m_fillIndex + 1) % m_buffers.size();
+                buffer = &m_buffers[m_fillIndex];
+                buffer->m_size = 0;
+            }
+            else
+            {
+                m_counters.m_overruns++;
+                m_counters.m_droppedBytes += size;
+                break;
+            }
+        }
+
+        unsigned int count = m_bufferSize - buffer->m_size;
+        count = size < count ? size : count;
+        memcpy(buffer->m_data + buffer->m_size, data, count);
+        buffer->m_size += count;
+        data += count;
+        size -= count;
+        accepted += count;
+    }
+
+    return accepted;
+}
+
+void FileRecordWriter::flush()
+{
+    if ((m_fd < 0) || m_directIO || (m_buffers[m_fillIndex].m_size == 0)) {
+        return;
+    }
+
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_nbFull < m_buffers.size() - 1) // else it goes with the next buffer
+    {
+        m_nbFull++;
+        m_fullCondition.wakeOne();
+        m_fillIndex = (m_fillIndex + 1) % m_buffers.size();
+        m_buffers[m_fillIndex].m_size = 0;
+    }
+}
+
+void FileRecordWriter::getCounters(Counters& counters)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    counters = m_counters;
+    counters.m_bufferedBytes = (quint64) m_nbFull * m_bufferSize;
+}
+
+void FileRecordWriter::run()
+{
+    while (true)
+    {
+        m_mutex.lock();
+
+        while ((m_nbFull == 0) && m_running) {
+            m_fullCondition.wait(&m_mutex);
+        }
+
+        if (m_nbFull == 0) // stopped and everything written
+        {
+            m_mutex.unlock();
+            break;
+        }
+
+        Buffer& buffer = m_buffers[m_writeIndex];
+        m_mutex.unlock();
+
+        writeBuffer(buffer);
+
+        m_mutex.lock();
+        m_writeIndex = (m_writeIndex + 1) % m_buffers.size();
+        m_nbFull--;
+        m_freeCondition.wakeAll();
+        m_mutex.unlock();
+    }
+}
+
+void FileRecordWriter::writeBuffer(const Buffer& buffer)
+{
+    if (m_codec)
+    {
+        m_codec->encode(buffer.m_data, buffer.m_size, m_encoded);
+        writeToFile(m_encoded.data(), m_encoded.size());
+    }
+    else
+    {
+        writeToFile(buffer.m_data, buffer.m_size);
+    }
+
+    QMutexLocker mutexLocker(&m_mutex);
+    m_counters.m_inputBytes += buffer.m_size;
+}
+
+bool FileRecordWriter::writeToFile(const char *data, unsigned int size)
+{
+    unsigned int remainder = size;
+
+    while (remainder > 0)
+    {
+        int written = ::write(m_fd, data, remainder);
+
+        if (written < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            qWarning("FileRecordWriter::writeToFile: %s: %s", qPrintable(m_fileName), strerror(errno));
+            QMutexLocker mutexLocker(&m_mutex);
+            m_counters.m_writeErrors++;
+            return false;
+        }
+
+        data += written;
+        remainder -= written;
+    }
+
+#ifdef __linux__
+    if (!m_directIO)
+    {
+        // start write back of this buffer and release pages of the previous one that should be on disk by now
+        sync_file_range(m_fd, m_fileOffset, size, SYNC_FILE_RANGE_WRITE);
+
+        if (m_fileOffset >= m_bufferSize) {
+            posix_fadvise(m_fd, m_fileOffset - m_bufferSize, m_bufferSize, POSIX_FADV_DONTNEED);
+        }
+    }
+#endif
+
+    m_fileOffset += size;
+    QMutexLocker mutexLocker(&m_mutex);
+    m_counters.m_writtenBytes += size;
+    return true;
+}
+
+char *FileRecordWriter::allocateBuffer(unsigned int size)
+{
+#ifdef _WIN32
+    return (char *) _aligned_malloc(size, directIOAlignment);
+#else
+    void *buffer;
+
+    if (posix_memalign(&buffer, directIOAlignment, size) != 0) {
+        return 0;
+    }
+
+    return (char *) buffer;
+#endif
+}
+
+void FileRecordWriter::freeBuffers()
+{
+    for (unsigned int i = 0; i < m_buffers.size(); i++)
+    {
+        if (m_buffers[i].m_data)
+        {
+            freeBuffer(m_buffers[i].m_data);
+            m_buffers[i].m_data = 0;
+        }
+    }
+}
+
+void FileRecordWriter::freeBuffer(char *buffer)
+{
+#ifdef _WIN32
+    _aligned_free(buffer);
+#else
+    free(buffer);
+#endif
+}
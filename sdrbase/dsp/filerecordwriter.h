@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_FILERECORDWRITER_H_
+#define SDRBASE_DSP_FILERECORDWRITER_H_
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <vector>
+
+#include "export.h"
+
+class FileRecordCodec;
+
+/**
+ * Writes a byte stream to file from a dedicated thread so that the producer (typically the
+ * DSP engine thread) never waits for the disk. Data is copied in a ring of buffers, allocated
+ * while a file is open, that are handed to the writer thread as soon as they are full. When
+ * all buffers are waiting to be written the incoming data is dropped and the overrun is counted.
+ * In blocking mode the producer waits for a free buffer instead (offline rendering).
+ *
+ * On Linux the file can be opened with O_DIRECT to bypass the page cache. Otherwise pages
+ * already written are released from the cache with posix_fadvise so that long recordings
+ * do not evict everything else.
+ *
+ * An optional codec compresses each buffer on the writer thread before it is written.
+ * Compressed data has no fixed size so direct I/O is not used in this case.
+ */
+class SDRBASE_API FileRecordWriter : public QThread
+{
+    Q_OBJECT
+public:
+    struct Counters
+    {
+        quint64 m_inputBytes;    //!< bytes handed to the writer thread (before compression)
+        quint64 m_writtenBytes;  //!< bytes actually written to file
+        quint64 m_bufferedBytes; //!< bytes waiting in memory
+        quint32 m_overruns;      //!< number of writes that had to drop data
+        quint64 m_droppedBytes;  //!< bytes dropped because of overruns
+        quint32 m_writeErrors;   //!< failed writes to file
+    };
+
+    FileRecordWriter(unsigned int nbBuffers = 32, unsigned int bufferSize = 1<<20);
+    ~FileRecordWriter();
+
+    /** Compress the following files with this codec (null for none). Buffers hold whole samples. */
+    void setCodec(FileRecordCodec *codec) { m_codec = codec; }
+    /** Wait for the disk when all buffers are full instead of dropping data */
+    void setBlocking(bool blocking) { m_blocking = blocking; }
+    /** Create (truncate) the file or append to it and start the writer thread. Direct I/O is not used to append. */
+    bool open(const QString& fileName, bool directIO, bool append = false);
+    /** Write remaining data, stop the writer thread and close the file */
+    void close();
+    bool isOpen() const { return m_fd >= 0; }
+
+    /** Queue data for writing. Never blocks unless in blocking mode. Returns the number of bytes accepted (none if not open). */
+    quint64 write(const char *data, quint64 size);
+    /** Hand the data queued so far to the writer thread without waiting for a full buffer (not with direct I/O) */
+    void flush();
+
+    void getCounters(Counters& counters);
+
+private:
+    struct Buffer
+    {
+        char *m_data;
+        unsigned int m_size;
+    };
+
+    std::vector<Buffer> m_buffers;
+    unsigned int m_bufferSize;
+    unsigned int m_fillIndex;    //!< buffer being filled by the producer
+    unsigned int m_writeIndex;   //!< next buffer to be written by the writer thread
+    unsigned int m_nbFull;       //!< buffers handed to the writer thread
+    bool m_running;
+    bool m_blocking;
+    QMutex m_mutex;
+    QWaitCondition m_fullCondition;
+    QWaitCondition m_freeCondition; //!< a buffer was written (blocking mode)
+
+    int m_fd;
+    bool m_directIO;
+    QString m_fileName;
+    Counters m_counters;
+    quint64 m_fileOffset;        //!< writer thread only
+    FileRecordCodec *m_codec;
+    std::vector<char> m_encoded; //!< writer thread only
+
+    void run();
+    void writeBuffer(const Buffer& buffer);
+    bool writeToFile(const char *data, unsigned int size);
+    void freeBuffers();
+    static char *allocateBuffer(unsigned int size);
+    static void freeBuffer(char *buffer);
+};
+
+#endif /* SDRBASE_DSP_FILERECORDWRITER_H_ */
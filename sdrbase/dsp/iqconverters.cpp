@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <math.h>
+
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "dsp/iqconverters.h"
+
+#ifdef USE_SSE2
+// store 8 values of 16 bits in the most significant bits of baseband sample values
+static inline void store16(FixReal *out, __m128i v)
+{
+#if SDR_RX_SAMP_SZ == 24
+    // sign extend to 32 bits by placing each value in the upper half and shifting back to 24 bits
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i*) out, _mm_srai_epi32(_mm_unpacklo_epi16(zero, v), 8));
+    _mm_storeu_si128((__m128i*) (out + 4), _mm_srai_epi32(_mm_unpackhi_epi16(zero, v), 8));
+#else
+    _mm_storeu_si128((__m128i*) out, v);
+#endif
+}
+
+// load 8 baseband sample values as their 16 most significant bits
+static inline __m128i load16(const FixReal *in)
+{
+#if SDR_RX_SAMP_SZ == 24
+    __m128i lo = _mm_srai_epi32(_mm_loadu_si128((const __m128i*) in), 8);
+    __m128i hi = _mm_srai_epi32(_mm_loadu_si128((const __m128i*) (in + 4)), 8);
+    return _mm_packs_epi32(lo, hi);
+#else
+    return _mm_loadu_si128((const __m128i*) in);
+#endif
+}
+#endif
+
+void IQConverters::fromCU8(const uint8_t *in, Sample *out, unsigned int n)
+{
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi8((char) 0x80);
+
+    for (; i + 16 <= nbValues; i += 16)
+    {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*) &in[i]), bias); // u8 - 128 as s8
+        store16(&pout[i], _mm_unpacklo_epi8(zero, v)); // s8 << 8
+        store16(&pout[i + 8], _mm_unpackhi_epi8(zero, v));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = ((int) in[i] - 128) << (SDR_RX_SAMP_SZ - 8);
+    }
+}
+
+void IQConverters::fromCS8(const int8_t *in, Sample *out, unsigned int n)
+{
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= nbValues; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) &in[i]);
+        store16(&pout[i], _mm_unpacklo_epi8(zero, v)); // s8 << 8
+        store16(&pout[i + 8], _mm_unpackhi_epi8(zero, v));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = in[i] << (SDR_RX_SAMP_SZ - 8);
+    }
+}
+
+void IQConverters::fromCS16(const int16_t *in, Sample *out, unsigned int n)
+{
+#if SDR_RX_SAMP_SZ == 16
+    memcpy((void *) out, in, n * sizeof(Sample));
+#else
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 8 <= nbValues; i += 8) {
+        store16(&pout[i], _mm_loadu_si128((const __m128i*) &in[i]));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = in[i] << (SDR_RX_SAMP_SZ - 16);
+    }
+#endif
+}
+
+void IQConverters::fromCF32(const float *in, Sample *out, unsigned int n)
+{
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+    const float maxValue = SDR_RX_SCALEF - 1.0f;
+    const float minValue = -SDR_RX_SCALEF;
+
+#ifdef USE_SSE2
+    const __m128 vscale = _mm_set1_ps(SDR_RX_SCALEF);
+    const __m128 vmax = _mm_set1_ps(maxValue);
+    const __m128 vmin = _mm_set1_ps(minValue);
+
+    for (; i + 8 <= nbValues; i += 8)
+    {
+        // saturate before conversion as out of range floats convert to the integer indefinite value
+        __m128i a = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(&in[i]), vscale), vmax), vmin));
+        __m128i b = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(&in[i + 4]), vscale), vmax), vmin));
+#if SDR_RX_SAMP_SZ == 24
+        _mm_storeu_si128((__m128i*) &pout[i], a);
+        _mm_storeu_si128((__m128i*) &pout[i + 4], b);
+#else
+        _mm_storeu_si128((__m128i*) &pout[i], _mm_packs_epi32(a, b));
+#endif
+    }
+#endif
+
+    for (; i < nbValues; i++)
+    {
+        float v = in[i] * SDR_RX_SCALEF;
+        v = v > maxValue ? maxValue : v < minValue ? minValue : v;
+        pout[i] = (FixReal) lrintf(v);
+    }
+}
+
+void IQConverters::toCU8(const Sample *in, uint8_t *out, unsigned int n)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i bias = _mm_set1_epi8((char) 0x80);
+
+    for (; i + 16 <= nbValues; i += 16)
+    {
+        __m128i a = _mm_srai_epi16(load16(&pin[i]), 8);
+        __m128i b = _mm_srai_epi16(load16(&pin[i + 8]), 8);
+        _mm_storeu_si128((__m128i*) &out[i], _mm_xor_si128(_mm_packs_epi16(a, b), bias));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        out[i] = (pin[i] >> (SDR_RX_SAMP_SZ - 8)) + 128;
+    }
+}
+
+void IQConverters::toCS8(const Sample *in, int8_t *out, unsigned int n)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 16 <= nbValues; i += 16)
+    {
+        __m128i a = _mm_srai_epi16(load16(&pin[i]), 8);
+        __m128i b = _mm_srai_epi16(load16(&pin[i + 8]), 8);
+        _mm_storeu_si128((__m128i*) &out[i], _mm_packs_epi16(a, b));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        out[i] = pin[i] >> (SDR_RX_SAMP_SZ - 8);
+    }
+}
+
+void IQConverters::toCS16(const Sample *in, int16_t *out, unsigned int n)
+{
+#if SDR_RX_SAMP_SZ == 16
+    memcpy((void *) out, in, n * sizeof(Sample));
+#else
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 8 <= nbValues; i += 8) {
+        _mm_storeu_si128((__m128i*) &out[i], load16(&pin[i]));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        out[i] = pin[i] >> (SDR_RX_SAMP_SZ - 16);
+    }
+#endif
+}
+
+void IQConverters::toCF32(const Sample *in, float *out, unsigned int n)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+    const float scale = 1.0f / SDR_RX_SCALEF;
+
+#ifdef USE_SSE2
+    const __m128 vscale = _mm_set1_ps(scale);
+
+    for (; i + 8 <= nbValues; i += 8)
+    {
+#if SDR_RX_SAMP_SZ == 24
+        __m128 a = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) &pin[i]));
+        __m128 b = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) &pin[i + 4]));
+#else
+        __m128i s = _mm_loadu_si128((const __m128i*) &pin[i]);
+        __m128 a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 b = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+#endif
+        _mm_storeu_ps(&out[i], _mm_mul_ps(a, vscale));
+        _mm_storeu_ps(&out[i + 4], _mm_mul_ps(b, vscale));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        out[i] = pin[i] * scale;
+    }
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_IQCONVERTERS_H_
+#define SDRBASE_DSP_IQCONVERTERS_H_
+
+#include <stdint.h>
+
+#include "dsp/dsptypes.h"
+#include "export.h"
+
+/**
+ * Conversions between the I/Q sample formats of other tools and the baseband Sample type.
+ * Sizes are in I/Q samples. 8 and 16 bit integers are aligned on the most significant bits
+ * of the baseband samples and floats are full scale at +/-1.0 (saturated when converted to
+ * integers). With SSE2 16 values are processed at a time.
+ *
+ * - CU8: unsigned 8 bit with 128 offset (rtl_sdr)
+ * - CS8: signed 8 bit (HackRF)
+ * - CS16: signed 16 bit little endian (16 bit PCM WAV)
+ * - CF32: 32 bit float (GNU Radio complex)
+ */
+class SDRBASE_API IQConverters
+{
+public:
+    static void fromCU8(const uint8_t *in, Sample *out, unsigned int n);
+    static void fromCS8(const int8_t *in, Sample *out, unsigned int n);
+    static void fromCS16(const int16_t *in, Sample *out, unsigned int n);
+    static void fromCF32(const float *in, Sample *out, unsigned int n);
+
+    static void toCU8(const Sample *in, uint8_t *out, unsigned int n);
+    static void toCS8(const Sample *in, int8_t *out, unsigned int n);
+    static void toCS16(const Sample *in, int16_t *out, unsigned int n);
+    static void toCF32(const Sample *in, float *out, unsigned int n);
+};
+
+#endif /* SDRBASE_DSP_IQCONVERTERS_H_ */
@@ -0,0 +1,391 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QRegExp>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+#include "dsp/iqfileformat.h"
+
+// layout of the WAV files written by FileRecord
+static const unsigned int wavAuxiSize = 164;                       //!< HDSDR auxi chunk
+static const unsigned int wavRiffSizeOffset = 4;
+static const unsigned int wavAuxiOffset = 12 + 8 + 16 + 8;         //!< after RIFF header, fmt chunk and auxi chunk header
+static const unsigned int wavDataSizeOffset = wavAuxiOffset + wavAuxiSize + 4;
+static const unsigned int wavHeaderSize = wavDataSizeOffset + 4;
+
+static const char *formatNames[] = {"sdriq", "cu8", "cs8", "cs16", "cf32", "wav"};
+static const char *sigMFDatatypes[] = {"", "cu8", "ci8", "ci16_le", "cf32_le", ""};
+
+template<typename T> static T readLE(const quint8 *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T)); // little endian host
+    return value;
+}
+
+template<typename T> static void writeLE(std::vector<char>& data, unsigned int offset, T value)
+{
+    memcpy(&data[offset], &value, sizeof(T));
+}
+
+// Windows SYSTEMTIME as found in the auxi chunk
+static qint64 readSystemTime(const quint8 *data)
+{
+    QDate date(readLE<quint16>(data), readLE<quint16>(data + 2), readLE<quint16>(data + 6));
+    QTime time(readLE<quint16>(data + 8), readLE<quint16>(data + 10), readLE<quint16>(data + 12), readLE<quint16>(data + 14));
+
+    if (!date.isValid() || !time.isValid()) {
+        return 0;
+    }
+
+    return QDateTime(date, time, Qt::UTC).toMSecsSinceEpoch();
+}
+
+static void writeSystemTime(std::vector<char>& data, unsigned int offset, qint64 timeMs)
+{
+    QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(timeMs, Qt::UTC);
+    writeLE<quint16>(data, offset, dateTime.date().year());
+    writeLE<quint16>(data, offset + 2, dateTime.date().month());
+    writeLE<quint16>(data, offset + 4, dateTime.date().dayOfWeek() % 7); // Sunday is 0
+    writeLE<quint16>(data, offset + 6, dateTime.date().day());
+    writeLE<quint16>(data, offset + 8, dateTime.time().hour());
+    writeLE<quint16>(data, offset + 10, dateTime.time().minute());
+    writeLE<quint16>(data, offset + 12, dateTime.time().second());
+    writeLE<quint16>(data, offset + 14, dateTime.time().msec());
+}
+
+const char *IQFileFormat::getName(Format format)
+{
+    return format < FormatEnd ? formatNames[format] : "unknown";
+}
+
+bool IQFileFormat::getFormat(const QString& name, Format& format)
+{
+    for (int i = 0; i < FormatEnd; i++)
+    {
+        if (name.compare(formatNames[i], Qt::CaseInsensitive) == 0)
+        {
+            format = (Format) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char *IQFileFormat::getExtension(Format format)
+{
+    return getName(format);
+}
+
+IQFileFormat::Format IQFileFormat::getFormatFromFileName(const QString& fileName)
+{
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+
+    if ((suffix == "cu8") || (suffix == "u8")) {
+        return FormatCU8;
+    } else if ((suffix == "cs8") || (suffix == "s8") || (suffix == "ci8")) {
+        return FormatCS8;
+    } else if ((suffix == "cs16") || (suffix == "s16") || (suffix == "ci16")) {
+        return FormatCS16;
+    } else if ((suffix == "cf32") || (suffix == "fc32") || (suffix == "cfile") || (suffix == "raw") || (suffix == "sigmf-data")) {
+        return FormatCF32; // gqrx .raw files are cf32. SigMF metadata gives the actual type.
+    } else if (suffix == "wav") {
+        return FormatWAV;
+    } else {
+        return FormatSDRiq;
+    }
+}
+
+unsigned int IQFileFormat::getSampleBytes(Format format)
+{
+    switch (format)
+    {
+    case FormatCU8:
+    case FormatCS8:
+        return 2;
+    case FormatCS16:
+        return 4;
+    case FormatCF32:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+bool IQFileFormat::readWavHeader(const quint8 *data, quint64 size, Info& info)
+{
+    if ((size < 12) || (memcmp(data, "RIFF", 4) != 0) || (memcmp(data + 8, "WAVE", 4) != 0)) {
+        return false;
+    }
+
+    quint64 offset = 12;
+    unsigned int audioFormat = 0, channels = 0, bitsPerSample = 0;
+
+    while (offset + 8 <= size)
+    {
+        const quint8 *chunk = data + offset;
+        quint64 chunkSize = readLE<quint32>(chunk + 4);
+
+        if ((memcmp(chunk, "fmt ", 4) == 0) && (chunkSize >= 16) && (offset + 8 + chunkSize <= size))
+        {
+            audioFormat = readLE<quint16>(chunk + 8);
+            channels = readLE<quint16>(chunk + 10);
+            info.m_sampleRate = readLE<quint32>(chunk + 12);
+            bitsPerSample = readLE<quint16>(chunk + 22);
+
+            if ((audioFormat == 0xFFFE) && (chunkSize >= 40)) { // WAVE_FORMAT_EXTENSIBLE: format is at the start of the sub format GUID
+                audioFormat = readLE<quint16>(chunk + 32);
+            }
+        }
+        else if ((memcmp(chunk, "auxi", 4) == 0) && (chunkSize >= 36) && (offset + 8 + chunkSize <= size))
+        {
+            info.m_startTimeMs = readSystemTime(chunk + 8);
+            info.m_centerFrequency = readLE<quint32>(chunk + 8 + 32);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            info.m_dataOffset = offset + 8;
+            // the size of a file that was not closed properly may be 0 or larger than the file
+            quint64 available = size - info.m_dataOffset;
+            info.m_dataSize = (chunkSize == 0) || (chunkSize == 0xFFFFFFFF) || (chunkSize > available) ? available : chunkSize;
+            break;
+        }
+
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if ((info.m_dataOffset == 0) || (channels != 2))
+    {
+        qWarning("IQFileFormat::readWavHeader: not a 2 channel (I/Q) WAV file");
+        return false;
+    }
+
+    if ((audioFormat == 1) && (bitsPerSample == 8)) {
+        info.m_format = FormatCU8;
+    } else if ((audioFormat == 1) && (bitsPerSample == 16)) {
+        info.m_format = FormatCS16;
+    } else if ((audioFormat == 3) && (bitsPerSample == 32)) {
+        info.m_format = FormatCF32;
+    }
+    else
+    {
+        qWarning("IQFileFormat::readWavHeader: unsupported WAV format %u with %u bits per sample", audioFormat, bitsPerSample);
+        return false;
+    }
+
+    return true;
+}
+
+void IQFileFormat::makeWavHeader(std::vector<char>& header, qint32 sampleRate, quint64 centerFrequency, qint64 startTimeMs)
+{
+    header.assign(wavHeaderSize, 0);
+    memcpy(&header[0], "RIFF", 4);
+    memcpy(&header[8], "WAVE", 4);
+    memcpy(&header[12], "fmt ", 4);
+    writeLE<quint32>(header, 16, 16);
+    writeLE<quint16>(header, 20, 1);              // PCM
+    writeLE<quint16>(header, 22, 2);              // I and Q
+    writeLE<quint32>(header, 24, sampleRate);
+    writeLE<quint32>(header, 28, sampleRate * 4); // bytes per second
+    writeLE<quint16>(header, 32, 4);              // bytes per I/Q sample
+    writeLE<quint16>(header, 34, 16);
+    memcpy(&header[36], "auxi", 4);
+    writeLE<quint32>(header, 40, wavAuxiSize);
+    writeSystemTime(header, wavAuxiOffset, startTimeMs);
+    writeSystemTime(header, wavAuxiOffset + 16, startTimeMs);
+    writeLE<quint32>(header, wavAuxiOffset + 32, centerFrequency > 0xFFFFFFFFULL ? 0 : centerFrequency);
+    writeLE<quint32>(header, wavAuxiOffset + 36, sampleRate);
+    memcpy(&header[wavDataSizeOffset - 4], "data", 4);
+}
+
+bool IQFileFormat::finishWavFile(const QString& fileName, quint64 dataSize, qint64 stopTimeMs)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        qWarning("IQFileFormat::finishWavFile: cannot update %s", qPrintable(fileName));
+        return false;
+    }
+
+    // sizes are saturated for files over 4 GB. Readers then take the rest of the file.
+    std::vector<char> field(16);
+    writeLE<quint32>(field, 0, std::min(dataSize + wavHeaderSize - 8, (quint64) 0xFFFFFFFFULL));
+    file.seek(wavRiffSizeOffset);
+    file.write(field.data(), 4);
+    writeLE<quint32>(field, 0, std::min(dataSize, (quint64) 0xFFFFFFFFULL));
+    file.seek(wavDataSizeOffset);
+    file.write(field.data(), 4);
+    writeSystemTime(field, 0, stopTimeMs);
+    file.seek(wavAuxiOffset + 16);
+    file.write(field.data(), 16);
+    return true;
+}
+
+QString IQFileFormat::getSigMFFileName(const QString& fileName)
+{
+    QFileInfo fileInfo(fileName);
+    QString baseName = fileInfo.fileName();
+    int dot = baseName.lastIndexOf('.');
+    baseName = dot > 0 ? baseName.left(dot) : baseName;
+    return fileInfo.dir().filePath(baseName + ".sigmf-meta");
+}
+
+bool IQFileFormat::readSigMF(const QString& fileName, Info& info)
+{
+    QFile metaFile(getSigMFFileName(fileName));
+
+    if (!metaFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(metaFile.readAll());
+
+    if (!doc.isObject())
+    {
+        qWarning("IQFileFormat::readSigMF: %s is not valid JSON", qPrintable(metaFile.fileName()));
+        return false;
+    }
+
+    QJsonObject global = doc.object().value("global").toObject();
+    QString datatype = global.value("core:datatype").toString();
+    bool found = false;
+
+    for (int i = FormatCU8; i <= FormatCF32; i++)
+    {
+        if (datatype == sigMFDatatypes[i])
+        {
+            info.m_format = (Format) i;
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        qWarning("IQFileFormat::readSigMF: %s: unsupported datatype %s", qPrintable(metaFile.fileName()), qPrintable(datatype));
+        return false;
+    }
+
+    info.m_sampleRate = global.value("core:sample_rate").toDouble();
+    QJsonArray captures = doc.object().value("captures").toArray();
+    info.m_captures.clear();
+
+    for (int i = 0; i < captures.size(); i++)
+    {
+        QJsonObject captureObject = captures[i].toObject();
+        Capture capture;
+        capture.m_sampleIndex = captureObject.value("core:sample_start").toDouble();
+        capture.m_centerFrequency = captureObject.value("core:frequency").toDouble();
+        QDateTime dateTime = QDateTime::fromString(captureObject.value("core:datetime").toString(), Qt::ISODate);
+        capture.m_timestampMs = dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+        info.m_captures.push_back(capture);
+    }
+
+    if (info.m_captures.size() > 0)
+    {
+        info.m_centerFrequency = info.m_captures[0].m_centerFrequency;
+        info.m_startTimeMs = info.m_captures[0].m_timestampMs;
+    }
+
+    return true;
+}
+
+bool IQFileFormat::writeSigMF(const QString& fileName, Format format, qint32 sampleRate, const std::vector<Capture>& captures)
+{
+    QJsonObject global;
+    global.insert("core:datatype", QString(sigMFDatatypes[format]));
+    global.insert("core:sample_rate", sampleRate);
+    global.insert("core:version", QString("1.0.0"));
+    global.insert("core:recorder", QString("SDRangel"));
+
+    QJsonArray captureArray;
+
+    for (unsigned int i = 0; i < captures.size(); i++)
+    {
+        QJsonObject capture;
+        capture.insert("core:sample_start", (double) captures[i].m_sampleIndex);
+        capture.insert("core:frequency", (double) captures[i].m_centerFrequency);
+        capture.insert("core:datetime", QDateTime::fromMSecsSinceEpoch(captures[i].m_timestampMs, Qt::UTC).toString("yyyy-MM-ddTHH:mm:ss.zzzZ"));
+        captureArray.append(capture);
+    }
+
+    QJsonObject root;
+    root.insert("global", global);
+    root.insert("captures", captureArray);
+    root.insert("annotations", QJsonArray());
+
+    QFile metaFile(getSigMFFileName(fileName));
+
+    if (!metaFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("IQFileFormat::writeSigMF: cannot write %s", qPrintable(metaFile.fileName()));
+        return false;
+    }
+
+    metaFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+bool IQFileFormat::parseFileName(const QString& fileName, Info& info)
+{
+    QString baseName = QFileInfo(fileName).fileName();
+    bool found = false;
+    QRegExp gqrx("gqrx_(\\d{8})_(\\d{6})_(\\d+)_(\\d+)_fc");
+
+    if (gqrx.indexIn(baseName) >= 0)
+    {
+        QDateTime dateTime = QDateTime::fromString(gqrx.cap(1) + gqrx.cap(2), "yyyyMMddHHmmss");
+        dateTime.setTimeSpec(Qt::UTC);
+        info.m_startTimeMs = info.m_startTimeMs == 0 ? dateTime.toMSecsSinceEpoch() : info.m_startTimeMs;
+        info.m_centerFrequency = info.m_centerFrequency == 0 ? gqrx.cap(3).toULongLong() : info.m_centerFrequency;
+        info.m_sampleRate = info.m_sampleRate == 0 ? gqrx.cap(4).toInt() : info.m_sampleRate;
+        return true;
+    }
+
+    // tokens like 100.5MHz and 2.4Msps separated by _ - or .
+    QRegExp frequencyToken("(?:^|[_.-])(\\d+(?:\\.\\d+)?)([kMG]?)Hz(?=[_.-]|$)");
+    QRegExp rateToken("(?:^|[_.-])(\\d+(?:\\.\\d+)?)([kM]?)sps(?=[_.-]|$)", Qt::CaseInsensitive);
+    const QString multipliers = " kMG";
+
+    if ((info.m_centerFrequency == 0) && (frequencyToken.indexIn(baseName) >= 0))
+    {
+        double multiplier = frequencyToken.cap(2).isEmpty() ? 1.0 : pow(1000.0, multipliers.indexOf(frequencyToken.cap(2)));
+        info.m_centerFrequency = frequencyToken.cap(1).toDouble() * multiplier + 0.5;
+        found = true;
+    }
+
+    if ((info.m_sampleRate == 0) && (rateToken.indexIn(baseName) >= 0))
+    {
+        QString prefix = rateToken.cap(2).isEmpty() ? QString(" ") : rateToken.cap(2).toLower() == "k" ? "k" : "M";
+        info.m_sampleRate = rateToken.cap(1).toDouble() * pow(1000.0, multipliers.indexOf(prefix)) + 0.5;
+        found = true;
+    }
+
+    return found;
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_IQFILEFORMAT_H_
+#define SDRBASE_DSP_IQFILEFORMAT_H_
+
+#include <QtGlobal>
+#include <QString>
+#include <vector>
+
+#include "export.h"
+
+/**
+ * I/Q file formats of other tools that can be replayed by the file source and written by
+ * FileRecord in place of the native .sdriq records.
+ *
+ * - Raw files (cu8, cs8, cs16, cf32) are identified by their extension. Sample rate, center
+ *   frequency and start time are taken from a SigMF metadata file with the same base name
+ *   (name.sigmf-meta) or else from the file name: gqrx names (gqrx_date_time_frequency_rate_fc.raw)
+ *   or tokens like _100.5MHz_ and _2.4Msps_.
+ * - WAV files are 2 channel PCM 8 or 16 bit or 32 bit float. The center frequency and start
+ *   time are read from the "auxi" chunk written by SDR# and HDSDR when present. FileRecord
+ *   writes 16 bit PCM with such a chunk.
+ */
+class SDRBASE_API IQFileFormat
+{
+public:
+    enum Format
+    {
+        FormatSDRiq,
+        FormatCU8,
+        FormatCS8,
+        FormatCS16,
+        FormatCF32,
+        FormatWAV,
+        FormatEnd
+    };
+
+    struct Capture
+    {
+        quint64 m_sampleIndex;     //!< first sample of the capture
+        quint64 m_centerFrequency;
+        qint64  m_timestampMs;     //!< time of the first sample in ms since epoch (0 if unknown)
+    };
+
+    /** Where the samples are and what is known about them */
+    struct Info
+    {
+        Format  m_format;          //!< of the samples (CU8, CS16 or CF32 for WAV files)
+        qint32  m_sampleRate;      //!< 0 if unknown
+        quint64 m_centerFrequency; //!< 0 if unknown
+        qint64  m_startTimeMs;     //!< 0 if unknown
+        quint64 m_dataOffset;      //!< of the first sample in file
+        quint64 m_dataSize;        //!< bytes of samples
+        std::vector<Capture> m_captures; //!< center frequency changes along the file (SigMF)
+
+        Info() :
+            m_format(FormatSDRiq),
+            m_sampleRate(0),
+            m_centerFrequency(0),
+            m_startTimeMs(0),
+            m_dataOffset(0),
+            m_dataSize(0)
+        {}
+    };
+
+    static const char *getName(Format format);
+    static bool getFormat(const QString& name, Format& format);
+    static const char *getExtension(Format format);
+    /** From the file extension. Unknown extensions are .sdriq records. */
+    static Format getFormatFromFileName(const QString& fileName);
+    /** Bytes per I/Q sample of raw formats (0 for the containers) */
+    static unsigned int getSampleBytes(Format format);
+
+    /** Parse the header of a WAV file in memory. Returns false if this is not a supported WAV file. */
+    static bool readWavHeader(const quint8 *data, quint64 size, Info& info);
+    /** Header of a 16 bit PCM WAV file with an auxi chunk. Sizes are set by finishWavFile(). */
+    static void makeWavHeader(std::vector<char>& header, qint32 sampleRate, quint64 centerFrequency, qint64 startTimeMs);
+    static bool finishWavFile(const QString& fileName, quint64 dataSize, qint64 stopTimeMs);
+
+    /** Complete info with the SigMF metadata file of a raw file if any */
+    static bool readSigMF(const QString& fileName, Info& info);
+    static bool writeSigMF(const QString& fileName, Format format, qint32 sampleRate, const std::vector<Capture>& captures);
+    /** Complete info with the sample rate, center frequency and time found in the file name */
+    static bool parseFileName(const QString& fileName, Info& info);
+
+private:
+    static QString getSigMFFileName(const QString& fileName);
+};
+
+#endif /* SDRBASE_DSP_IQFILEFORMAT_H_ */
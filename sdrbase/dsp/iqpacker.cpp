@@ -0,0 +1,518 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "dsp/iqpacker.h"
+
+#ifdef USE_SSE2
+// load 8 sample values shifted right as 16 bit integers
+static inline __m128i load16(const FixReal *in, __m128i shift)
+{
+#if SDR_RX_SAMP_SZ == 24
+    __m128i lo = _mm_sra_epi32(_mm_loadu_si128((const __m128i*) in), shift);
+    __m128i hi = _mm_sra_epi32(_mm_loadu_si128((const __m128i*) (in + 4)), shift);
+    return _mm_packs_epi32(lo, hi);
+#else
+    return _mm_sra_epi16(_mm_loadu_si128((const __m128i*) in), shift);
+#endif
+}
+
+// store 8 values of 16 bits as sample values. In 24 bit builds the values are placed in the upper half
+// and shifted right by the given amount (16 - left shift). 16 bit builds store them as they are.
+static inline void store16(FixReal *out, __m128i v, __m128i shift)
+{
+#if SDR_RX_SAMP_SZ == 24
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i*) out, _mm_sra_epi32(_mm_unpacklo_epi16(zero, v), shift));
+    _mm_storeu_si128((__m128i*) (out + 4), _mm_sra_epi32(_mm_unpackhi_epi16(zero, v), shift));
+#else
+    (void) shift;
+    _mm_storeu_si128((__m128i*) out, v);
+#endif
+}
+#endif
+
+static inline int bfpShift(int32_t mag)
+{
+    int shift = 0;
+
+    while ((mag >> shift) > 127) {
+        shift++;
+    }
+
+    return shift;
+}
+
+#ifdef USE_SSE2
+// pack a whole group of block floating point values
+static inline void packBFP8Group(const FixReal *in, uint8_t *out, int inBits)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i w[8]; // the 32 values at the 24 bit scale
+
+#if SDR_RX_SAMP_SZ == 24
+    const __m128i lshift = _mm_cvtsi32_si128(24 - inBits);
+
+    for (int k = 0; k < 8; k++) {
+        w[k] = _mm_sll_epi32(_mm_loadu_si128((const __m128i*) &in[4*k]), lshift);
+    }
+#else
+    (void) inBits; // always 16
+
+    for (int k = 0; k < 4; k++)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) &in[8*k]);
+        w[2*k] = _mm_srai_epi32(_mm_unpacklo_epi16(zero, v), 8);
+        w[2*k+1] = _mm_srai_epi32(_mm_unpackhi_epi16(zero, v), 8);
+    }
+#endif
+
+    __m128i mag = zero;
+
+    for (int k = 0; k < 8; k++) {
+        mag = _mm_or_si128(mag, _mm_xor_si128(w[k], _mm_srai_epi32(w[k], 31))); // ~v for negative values
+    }
+
+    mag = _mm_or_si128(mag, _mm_shuffle_epi32(mag, _MM_SHUFFLE(1, 0, 3, 2)));
+    mag = _mm_or_si128(mag, _mm_shuffle_epi32(mag, _MM_SHUFFLE(2, 3, 0, 1)));
+    int shift = bfpShift(_mm_cvtsi128_si32(mag));
+    const __m128i round = _mm_set1_epi32(shift ? 1 << (shift - 1) : 0);
+    const __m128i vshift = _mm_cvtsi32_si128(shift);
+
+    for (int k = 0; k < 8; k++) {
+        w[k] = _mm_sra_epi32(_mm_add_epi32(w[k], round), vshift);
+    }
+
+    out[0] = shift;
+    // saturation clamps the values rounded up to 128
+    _mm_storeu_si128((__m128i*) &out[1], _mm_packs_epi16(_mm_packs_epi32(w[0], w[1]), _mm_packs_epi32(w[2], w[3])));
+    _mm_storeu_si128((__m128i*) &out[17], _mm_packs_epi16(_mm_packs_epi32(w[4], w[5]), _mm_packs_epi32(w[6], w[7])));
+}
+
+// unpack a whole group of block floating point values
+static inline void unpackBFP8Group(const uint8_t *in, FixReal *out, int outBits)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int shift = in[0] > 16 ? 16 : in[0];
+#if SDR_RX_SAMP_SZ == 24
+    const __m128i vshift = _mm_cvtsi32_si128(48 - shift - outBits); // from mantissa << 24 to (mantissa << shift) >> (24 - outBits)
+#else
+    (void) outBits; // always 16
+    const __m128i vshift = _mm_cvtsi32_si128(16 - shift); // from mantissa << 8 to (mantissa << shift) >> 8
+#endif
+
+    for (int k = 0; k < 2; k++)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) &in[1 + 16*k]);
+        __m128i lo = _mm_unpacklo_epi8(zero, v); // mantissa << 8
+        __m128i hi = _mm_unpackhi_epi8(zero, v);
+        FixReal *pout = &out[16*k];
+#if SDR_RX_SAMP_SZ == 24
+        _mm_storeu_si128((__m128i*) pout, _mm_sra_epi32(_mm_unpacklo_epi16(zero, lo), vshift));
+        _mm_storeu_si128((__m128i*) (pout + 4), _mm_sra_epi32(_mm_unpackhi_epi16(zero, lo), vshift));
+        _mm_storeu_si128((__m128i*) (pout + 8), _mm_sra_epi32(_mm_unpacklo_epi16(zero, hi), vshift));
+        _mm_storeu_si128((__m128i*) (pout + 12), _mm_sra_epi32(_mm_unpackhi_epi16(zero, hi), vshift));
+#else
+        _mm_storeu_si128((__m128i*) pout, _mm_sra_epi16(lo, vshift));
+        _mm_storeu_si128((__m128i*) (pout + 8), _mm_sra_epi16(hi, vshift));
+#endif
+    }
+}
+#endif
+
+unsigned int IQPacker::getSamplesPerBlock(Encoding encoding, unsigned int blockSize)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+        return blockSize / 2;
+    case Encoding12:
+        return blockSize / 3;
+    case Encoding24:
+        return blockSize / 6;
+    case EncodingBFP8:
+        return (blockSize / (1 + 2*m_bfpGroupSize)) * m_bfpGroupSize;
+    case Encoding16:
+    default:
+        return blockSize / 4;
+    }
+}
+
+unsigned int IQPacker::getPackedSize(Encoding encoding, unsigned int nbSamples)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+        return nbSamples * 2;
+    case Encoding12:
+        return nbSamples * 3;
+    case Encoding24:
+        return nbSamples * 6;
+    case EncodingBFP8:
+        return ((nbSamples + m_bfpGroupSize - 1) / m_bfpGroupSize) * (1 + 2*m_bfpGroupSize);
+    case Encoding16:
+    default:
+        return nbSamples * 4;
+    }
+}
+
+uint8_t IQPacker::getSampleBytes(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+        return 0x81;
+    case Encoding12:
+        return 0xC2; // 0x40: packed 12 bits
+    case Encoding24:
+        return 0x83;
+    case EncodingBFP8:
+        return 0xA1; // 0x20: block floating point
+    case Encoding16:
+    default:
+        return 0x02; // no indicator so that older receivers are not confused
+    }
+}
+
+uint8_t IQPacker::getSampleBits(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+    case EncodingBFP8:
+        return 8;
+    case Encoding12:
+        return 12;
+    case Encoding24:
+        return 24;
+    case Encoding16:
+    default:
+        return 16;
+    }
+}
+
+IQPacker::Encoding IQPacker::getEncoding(uint8_t sampleBytes)
+{
+    if ((sampleBytes & 0x80) == 0) { // legacy
+        return Encoding16;
+    } else if (sampleBytes & 0x20) {
+        return EncodingBFP8;
+    } else if (sampleBytes & 0x40) {
+        return Encoding12;
+    }
+
+    switch (sampleBytes & 0x0F)
+    {
+    case 1:
+        return Encoding8;
+    case 3:
+        return Encoding24;
+    default:
+        return Encoding16;
+    }
+}
+
+const char *IQPacker::getName(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+        return "8 bits";
+    case Encoding12:
+        return "12 bits";
+    case Encoding24:
+        return "24 bits";
+    case EncodingBFP8:
+        return "BFP 8";
+    case Encoding16:
+    default:
+        return "16 bits";
+    }
+}
+
+unsigned int IQPacker::pack(Encoding encoding, const Sample *in, uint8_t *out, unsigned int n, int inBits)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+        pack8(in, out, n, inBits);
+        break;
+    case Encoding12:
+        pack12(in, out, n, inBits);
+        break;
+    case Encoding24:
+        pack24(in, out, n, inBits);
+        break;
+    case EncodingBFP8:
+        packBFP8(in, out, n, inBits);
+        break;
+    case Encoding16:
+    default:
+        pack16(in, out, n, inBits);
+        break;
+    }
+
+    return getPackedSize(encoding, n);
+}
+
+void IQPacker::unpack(Encoding encoding, const uint8_t *in, Sample *out, unsigned int n, int outBits)
+{
+    switch (encoding)
+    {
+    case Encoding8:
+        unpack8(in, out, n, outBits);
+        break;
+    case Encoding12:
+        unpack12(in, out, n, outBits);
+        break;
+    case Encoding24:
+        unpack24(in, out, n, outBits);
+        break;
+    case EncodingBFP8:
+        unpackBFP8(in, out, n, outBits);
+        break;
+    case Encoding16:
+    default:
+        unpack16(in, out, n, outBits);
+        break;
+    }
+}
+
+void IQPacker::pack8(const Sample *in, uint8_t *out, unsigned int n, int inBits)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    int8_t *pout = reinterpret_cast<int8_t*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i shift = _mm_cvtsi32_si128(inBits - 16);
+
+    for (; i + 16 <= nbValues; i += 16)
+    {
+        __m128i a = _mm_srai_epi16(load16(&pin[i], shift), 8);
+        __m128i b = _mm_srai_epi16(load16(&pin[i + 8], shift), 8);
+        _mm_storeu_si128((__m128i*) &pout[i], _mm_packs_epi16(a, b));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = pin[i] >> (inBits - 8);
+    }
+}
+
+void IQPacker::unpack8(const uint8_t *in, Sample *out, unsigned int n, int outBits)
+{
+    const int8_t *pin = reinterpret_cast<const int8_t*>(in);
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i shift = _mm_cvtsi32_si128(32 - outBits);
+
+    for (; i + 16 <= nbValues; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) &pin[i]);
+        store16(&pout[i], _mm_unpacklo_epi8(zero, v), shift); // s8 << 8
+        store16(&pout[i + 8], _mm_unpackhi_epi8(zero, v), shift);
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = pin[i] << (outBits - 8);
+    }
+}
+
+void IQPacker::pack12(const Sample *in, uint8_t *out, unsigned int n, int inBits)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    int shift = inBits - 12;
+
+    for (unsigned int is = 0; is < n; is++, pin += 2, out += 3)
+    {
+        int32_t a = pin[0] >> shift;
+        int32_t b = pin[1] >> shift;
+        out[0] = a & 0xff;
+        out[1] = ((a >> 8) & 0x0f) | ((b & 0x0f) << 4);
+        out[2] = (b >> 4) & 0xff;
+    }
+}
+
+void IQPacker::unpack12(const uint8_t *in, Sample *out, unsigned int n, int outBits)
+{
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    int shift = outBits - 12;
+
+    for (unsigned int is = 0; is < n; is++, in += 3, pout += 2)
+    {
+        int32_t a = (int32_t) ((uint32_t) (in[0] | ((in[1] & 0x0f) << 8)) << 20);
+        int32_t b = (int32_t) ((uint32_t) ((in[1] >> 4) | (in[2] << 4)) << 20);
+        pout[0] = (a >> 20) << shift; // sign extended
+        pout[1] = (b >> 20) << shift;
+    }
+}
+
+void IQPacker::pack16(const Sample *in, uint8_t *out, unsigned int n, int inBits)
+{
+#if SDR_RX_SAMP_SZ == 16
+    (void) inBits; // always 16
+    memcpy((void *) out, in, n * sizeof(Sample));
+#else
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    int16_t *pout = reinterpret_cast<int16_t*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i shift = _mm_cvtsi32_si128(inBits - 16);
+
+    for (; i + 8 <= nbValues; i += 8) {
+        _mm_storeu_si128((__m128i*) &pout[i], load16(&pin[i], shift));
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = pin[i] >> (inBits - 16);
+    }
+#endif
+}
+
+void IQPacker::unpack16(const uint8_t *in, Sample *out, unsigned int n, int outBits)
+{
+#if SDR_RX_SAMP_SZ == 16
+    (void) outBits; // always 16
+    memcpy((void *) out, in, n * sizeof(Sample));
+#else
+    const int16_t *pin = reinterpret_cast<const int16_t*>(in);
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128i shift = _mm_cvtsi32_si128(32 - outBits);
+
+    for (; i + 8 <= nbValues; i += 8) {
+        store16(&pout[i], _mm_loadu_si128((const __m128i*) &pin[i]), shift);
+    }
+#endif
+
+    for (; i < nbValues; i++) {
+        pout[i] = pin[i] << (outBits - 16);
+    }
+#endif
+}
+
+void IQPacker::pack24(const Sample *in, uint8_t *out, unsigned int n, int inBits)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    unsigned int nbValues = 2*n;
+    int shift = 24 - inBits;
+
+    for (unsigned int i = 0; i < nbValues; i++, out += 3)
+    {
+        int32_t w = pin[i] << shift;
+        out[0] = w & 0xff;
+        out[1] = (w >> 8) & 0xff;
+        out[2] = (w >> 16) & 0xff;
+    }
+}
+
+void IQPacker::unpack24(const uint8_t *in, Sample *out, unsigned int n, int outBits)
+{
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    unsigned int nbValues = 2*n;
+    int shift = 24 - outBits;
+
+    for (unsigned int i = 0; i < nbValues; i++, in += 3)
+    {
+        int32_t w = (int32_t) (((uint32_t) in[0] << 8) | ((uint32_t) in[1] << 16) | ((uint32_t) in[2] << 24));
+        pout[i] = w >> (8 + shift); // sign extended
+    }
+}
+
+void IQPacker::packBFP8(const Sample *in, uint8_t *out, unsigned int n, int inBits)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    int lshift = 24 - inBits;
+
+    for (unsigned int is = 0; is < n; is += m_bfpGroupSize, pin += 2*m_bfpGroupSize, out += 1 + 2*m_bfpGroupSize)
+    {
+        unsigned int nbValues = 2 * (n - is < m_bfpGroupSize ? n - is : m_bfpGroupSize);
+
+#ifdef USE_SSE2
+        if (nbValues == 2*m_bfpGroupSize)
+        {
+            packBFP8Group(pin, out, inBits);
+            continue;
+        }
+#endif
+        int32_t mag = 0;
+
+        for (unsigned int i = 0; i < nbValues; i++)
+        {
+            int32_t w = pin[i] << lshift;
+            mag |= w < 0 ? ~w : w;
+        }
+
+        int shift = bfpShift(mag);
+        int32_t round = shift ? 1 << (shift - 1) : 0;
+        int8_t *mantissas = reinterpret_cast<int8_t*>(&out[1]);
+        out[0] = shift;
+
+        for (unsigned int i = 0; i < nbValues; i++)
+        {
+            int32_t m = ((pin[i] << lshift) + round) >> shift;
+            mantissas[i] = m > 127 ? 127 : m;
+        }
+
+        for (unsigned int i = nbValues; i < 2*m_bfpGroupSize; i++) { // partial group
+            mantissas[i] = 0;
+        }
+    }
+}
+
+void IQPacker::unpackBFP8(const uint8_t *in, Sample *out, unsigned int n, int outBits)
+{
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    int rshift = 24 - outBits;
+
+    for (unsigned int is = 0; is < n; is += m_bfpGroupSize, pout += 2*m_bfpGroupSize, in += 1 + 2*m_bfpGroupSize)
+    {
+        unsigned int nbValues = 2 * (n - is < m_bfpGroupSize ? n - is : m_bfpGroupSize);
+
+#ifdef USE_SSE2
+        if (nbValues == 2*m_bfpGroupSize)
+        {
+            unpackBFP8Group(in, pout, outBits);
+            continue;
+        }
+#endif
+        int shift = in[0] > 16 ? 16 : in[0];
+        const int8_t *mantissas = reinterpret_cast<const int8_t*>(&in[1]);
+
+        for (unsigned int i = 0; i < nbValues; i++) {
+            pout[i] = (mantissas[i] << shift) >> rshift;
+        }
+    }
+}
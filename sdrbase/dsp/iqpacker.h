@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_IQPACKER_H_
+#define SDRBASE_DSP_IQPACKER_H_
+
+#include <stdint.h>
+
+#include "dsp/dsptypes.h"
+#include "export.h"
+
+/**
+ * Packing of I/Q samples in the payload of network blocks (SDRdaemon). A block holds a whole
+ * number of samples from its start and the remaining bytes are zero. Samples are given with the
+ * number of bits of their scale (SDR_RX_SAMP_SZ or SDR_TX_SAMP_SZ) and are aligned on the most
+ * significant bits of the encoding. With SSE2 the 8 and 16 bit and block floating point encodings
+ * process 16 values at a time.
+ *
+ * - 8 bit: signed 8 bit values
+ * - 12 bit: two signed 12 bit values (I and Q) packed in 3 bytes
+ * - 16 bit: signed 16 bit little endian values (the legacy format)
+ * - 24 bit: signed 24 bit little endian values
+ * - BFP8: groups of 16 samples made of a shift byte followed by 32 signed 8 bit mantissas.
+ *   The values are the mantissas shifted left by this amount at the 24 bit scale.
+ *
+ * The encoding is signalled in the sample bytes field of the meta data. The 0x80 indicator
+ * flags an explicit encoding. Without it the payload is 16 bit whatever the rest of the byte
+ * as older senders put the number of bytes of the device samples there.
+ */
+class SDRBASE_API IQPacker
+{
+public:
+    enum Encoding
+    {
+        Encoding8,
+        Encoding12,
+        Encoding16,
+        Encoding24,
+        EncodingBFP8,
+        EncodingEnd
+    };
+
+    static const unsigned int m_bfpGroupSize = 16; //!< samples per group in block floating point
+
+    static unsigned int getSamplesPerBlock(Encoding encoding, unsigned int blockSize);
+    static unsigned int getPackedSize(Encoding encoding, unsigned int nbSamples); //!< in bytes
+    static uint8_t getSampleBytes(Encoding encoding); //!< meta data sample bytes field
+    static uint8_t getSampleBits(Encoding encoding);  //!< meta data effective bits per sample
+    static Encoding getEncoding(uint8_t sampleBytes); //!< from meta data sample bytes field
+    static const char *getName(Encoding encoding);
+
+    /** Pack n samples of the given scale in bits (16 or 24). Returns the number of bytes written. */
+    static unsigned int pack(Encoding encoding, const Sample *in, uint8_t *out, unsigned int n, int inBits);
+    /** Unpack n samples to the given scale in bits (16 or 24) */
+    static void unpack(Encoding encoding, const uint8_t *in, Sample *out, unsigned int n, int outBits);
+
+private:
+    static void pack8(const Sample *in, uint8_t *out, unsigned int n, int inBits);
+    static void pack12(const Sample *in, uint8_t *out, unsigned int n, int inBits);
+    static void pack16(const Sample *in, uint8_t *out, unsigned int n, int inBits);
+    static void pack24(const Sample *in, uint8_t *out, unsigned int n, int inBits);
+    static void packBFP8(const Sample *in, uint8_t *out, unsigned int n, int inBits);
+    static void unpack8(const uint8_t *in, Sample *out, unsigned int n, int outBits);
+    static void unpack12(const uint8_t *in, Sample *out, unsigned int n, int outBits);
+    static void unpack16(const uint8_t *in, Sample *out, unsigned int n, int outBits);
+    static void unpack24(const uint8_t *in, Sample *out, unsigned int n, int outBits);
+    static void unpackBFP8(const uint8_t *in, Sample *out, unsigned int n, int outBits);
+};
+
+#endif /* SDRBASE_DSP_IQPACKER_H_ */
@@ -55,6 +55,12 @@ public:
         return delta / (float) m_size;
     }
 
+    /** returns the number of samples written ahead of the read pointer i.e. that can be read without underrun (at most half the buffer) */
+    uint32_t getWriteLead() const
+    {
+        return (m_iw + m_size - m_ir) % m_size;
+    }
+
 private:
     uint32_t m_size;
     SampleVector m_data;
@@ -0,0 +1,524 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDateTime>
+#include <QDebug>
+#include <string.h>
+
+#include "dsp/dspcommands.h"
+#include "dsp/spectrumkernels.h"
+#include "dsp/spectrumengine.h"
+
+MESSAGE_CLASS_DEFINITION(SpectrumEngine::MsgConfigureSpectrumEngine, Message)
+
+const Real SpectrumEngine::m_mult = (10.0f * log10f(2.0f));
+
+SpectrumEngine::SpectrumEngine(Real scalef) :
+    BasebandSampleSink(),
+    m_mutex(QMutex::Recursive),
+    m_fft(FFTEngine::create()),
+    m_fftSize(0),
+    m_overlapPercent(0),
+    m_overlapSize(0),
+    m_refillSize(0),
+    m_fftBufferFill(0),
+    m_needMoreSamples(false),
+    m_scalef(scalef),
+    m_integrationNbLines(1),
+    m_snapshotNbLines(0),
+    m_publishNbLines(1),
+    m_ofs(0),
+    m_powFFTDiv(1.0),
+    m_sampleRate(0),
+    m_centerFrequency(0),
+    m_zoomLog2Decim(0),
+    m_spectrumSampleRate(0),
+    m_spectrumCenterFrequency(0),
+    m_lastSpectrumSeq(0),
+    m_lastSpectrumTimestampMs(0),
+    m_lastSpectrumLinear(false),
+    m_lastSpectrumSampleRate(0),
+    m_lastSpectrumCenterFrequency(0)
+{
+    setObjectName("SpectrumEngine");
+    handleConfigure(m_settings);
+}
+
+SpectrumEngine::~SpectrumEngine()
+{
+    delete m_fft;
+}
+
+void SpectrumEngine::feed(const SampleVector::const_iterator& cbegin, const SampleVector::const_iterator& end, bool positiveOnly)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_zoomLog2Decim != 0)
+    {
+        feedZoom(cbegin, end);
+        return;
+    }
+
+    SampleVector::const_iterator begin(cbegin);
+    Real scale = 1.0f / m_scalef;
+
+    while (begin < end)
+    {
+        std::size_t todo = end - begin;
+
+        if ((m_fftBufferFill == 0) && (todo >= m_fftSize))
+        {
+            // a whole FFT span is available in the input: window and scale it straight into the FFT input
+            m_window.apply(&(*begin), m_fft->in(), scale);
+            processFFT(positiveOnly);
+            begin += m_refillSize;
+        }
+        else
+        {
+            // FFT span straddles input blocks: keep samples until it is complete
+            std::size_t samplesNeeded = m_fftSize - m_fftBufferFill;
+            std::size_t count = todo < samplesNeeded ? todo : samplesNeeded;
+            std::copy(begin, begin + count, m_sampleBuffer.begin() + m_fftBufferFill);
+            begin += count;
+            m_fftBufferFill += count;
+
+            if (m_fftBufferFill < m_fftSize)
+            {
+                m_needMoreSamples = true;
+                continue;
+            }
+
+            m_window.apply(&m_sampleBuffer[0], m_fft->in(), scale);
+            processFFT(positiveOnly);
+
+            if (count >= m_overlapSize)
+            {
+                // overlapping samples are still in the input: resume from there
+                begin -= m_overlapSize;
+                m_fftBufferFill = 0;
+            }
+            else
+            {
+                // advance buffer respecting the fft overlap factor
+                std::copy(m_sampleBuffer.begin() + m_refillSize, m_sampleBuffer.end(), m_sampleBuffer.begin());
+                m_fftBufferFill = m_overlapSize;
+            }
+        }
+    }
+}
+
+void SpectrumEngine::feedZoom(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
+{
+    for (SampleVector::const_iterator it = begin; it < end; ++it)
+    {
+        // bring the zoomed sub-band to zero frequency
+        Complex c(it->real() / m_scalef, it->imag() / m_scalef);
+        c *= m_zoomNCO.nextIQ();
+        float x = c.real();
+        float y = c.imag();
+        int stage = 0;
+
+        // half-band decimation by 2 at each stage. A stage that does not produce a sample stops the chain.
+        for (; stage < m_zoomLog2Decim; stage++)
+        {
+            if (!m_zoomFilters[stage].workDecimateCenter(&x, &y)) {
+                break;
+            }
+        }
+
+        if (stage < m_zoomLog2Decim) {
+            continue;
+        }
+
+        m_zoomBuffer[m_fftBufferFill++] = Complex(x, y);
+
+        if (m_fftBufferFill < m_fftSize)
+        {
+            m_needMoreSamples = true;
+            continue;
+        }
+
+        m_window.apply(&m_zoomBuffer[0], m_fft->in());
+        processFFT(false); // the zoomed signal is complex
+
+        // advance buffer respecting the fft overlap factor
+        std::copy(m_zoomBuffer.begin() + m_refillSize, m_zoomBuffer.end(), m_zoomBuffer.begin());
+        m_fftBufferFill = m_overlapSize;
+    }
+}
+
+void SpectrumEngine::processFFT(bool positiveOnly)
+{
+    // calculate FFT of the windowed input
+    m_fft->transform();
+
+    // extract power spectrum and reorder buckets
+    const Complex* fftOut = m_fft->out();
+    std::size_t halfSize = m_fftSize / 2;
+    std::size_t width;
+    Real *magSq = &m_magSqLine[0];
+
+    if (positiveOnly)
+    {
+        SpectrumKernels::magSq(fftOut, magSq, halfSize);
+        width = halfSize;
+    }
+    else
+    {
+        SpectrumKernels::magSq(fftOut + halfSize, magSq, halfSize);
+        SpectrumKernels::magSq(fftOut, magSq + halfSize, halfSize);
+        width = m_fftSize;
+    }
+
+    bool resultAvailable = true;
+
+    if (m_settings.m_averagingMode == AvgModeIntegration)
+    {
+        integrate(magSq, width, positiveOnly);
+        resultAvailable = false; // published by integrate()
+    }
+    else if (m_settings.m_averagingMode == AvgModeMoving)
+    {
+        m_movingAverage.storeAndGetAvg(magSq, width);
+        m_movingAverage.nextAverage();
+    }
+    else if (m_settings.m_averagingMode == AvgModeFixed)
+    {
+        resultAvailable = m_fixedAverage.storeAndGetAvg(magSq, magSq, width);
+        m_fixedAverage.nextAverage();
+    }
+
+    if (resultAvailable)
+    {
+        if (m_settings.m_linear) {
+            SpectrumKernels::linearScale(magSq, &m_powerSpectrum[0], width, 1.0f / m_powFFTDiv);
+        } else {
+            SpectrumKernels::log2Scale(magSq, &m_powerSpectrum[0], width, m_mult, m_ofs);
+        }
+
+        if (positiveOnly) {
+            SpectrumKernels::duplicate(&m_powerSpectrum[0], halfSize);
+        }
+
+        newSpectrum(m_powerSpectrum, m_fftSize);
+    }
+
+    m_needMoreSamples = false;
+}
+
+void SpectrumEngine::integrate(Real *magSq, std::size_t width, bool positiveOnly)
+{
+    if (m_integrator.getNbBins() != width) {
+        m_integrator.resize(width);
+    }
+
+    if (m_integrator.getNbLines() == 0) {
+        m_integrator.reset(QDateTime::currentMSecsSinceEpoch());
+    }
+
+    m_integrator.accumulate(magSq);
+    quint64 nbLines = m_integrator.getNbLines();
+    bool complete = nbLines >= m_integrationNbLines;
+
+    if (complete || ((m_snapshotNbLines != 0) && (nbLines % m_snapshotNbLines == 0))) {
+        m_integrator.writeSnapshot(m_spectrumSampleRate, m_spectrumCenterFrequency, QDateTime::currentMSecsSinceEpoch(), complete, 1.0 / m_powFFTDiv);
+    }
+
+    // the running average is converted for display at a limited rate only
+    if (complete || (nbLines % m_publishNbLines == 0))
+    {
+        Real *powerSpectrum = &m_powerSpectrum[0];
+
+        if (m_settings.m_linear)
+        {
+            m_integrator.getAverage(powerSpectrum, 1.0 / m_powFFTDiv);
+        }
+        else
+        {
+            m_integrator.getAverage(powerSpectrum, 1.0);
+            SpectrumKernels::log2Scale(powerSpectrum, powerSpectrum, width, m_mult, m_ofs);
+        }
+
+        if (positiveOnly) {
+            SpectrumKernels::duplicate(powerSpectrum, width);
+        }
+
+        newSpectrum(m_powerSpectrum, m_fftSize);
+    }
+
+    if (complete) {
+        m_integrator.reset(0); // next line starts a new integration
+    }
+}
+
+void SpectrumEngine::applyZoom()
+{
+    if (m_settings.m_zoomLog2Decim != m_zoomLog2Decim)
+    {
+        // start from clean filters
+        for (int i = 0; i < m_maxZoomLog2Decim; i++) {
+            m_zoomFilters[i] = IntHalfbandFilterEOF<SPECTRUMENGINE_HB_FILTER_ORDER>();
+        }
+
+        m_zoomLog2Decim = m_settings.m_zoomLog2Decim;
+    }
+
+    if (m_zoomLog2Decim == 0)
+    {
+        m_spectrumSampleRate = m_sampleRate;
+        m_spectrumCenterFrequency = m_centerFrequency;
+    }
+    else
+    {
+        // the sub-band center must be within the device band: clamp with the current sample rate
+        qint64 maxOffset = m_sampleRate / 2;
+        qint64 zoomFrequencyOffset = m_settings.m_zoomFrequencyOffset > maxOffset ? maxOffset :
+            m_settings.m_zoomFrequencyOffset < -maxOffset ? -maxOffset : m_settings.m_zoomFrequencyOffset;
+        m_spectrumSampleRate = m_sampleRate / (1<<m_zoomLog2Decim);
+        m_spectrumCenterFrequency = m_centerFrequency + zoomFrequencyOffset;
+
+        if (m_sampleRate != 0) {
+            m_zoomNCO.setFreq(-zoomFrequencyOffset, m_sampleRate);
+        }
+    }
+}
+
+void SpectrumEngine::updateIntegrationCounts()
+{
+    // FFT lines per second with the current overlap
+    double lineRate = m_refillSize == 0 ? 0.0 : (double) m_spectrumSampleRate / m_refillSize;
+    quint64 integrationNbLines = (quint64) (m_settings.m_integrationTime * lineRate + 0.5);
+    quint64 snapshotNbLines = (quint64) (m_settings.m_snapshotPeriod * lineRate + 0.5);
+    quint64 publishNbLines = (quint64) (lineRate / 10.0 + 0.5); // about 10 display updates per second
+    m_integrationNbLines = integrationNbLines == 0 ? 1 : integrationNbLines;
+    m_snapshotNbLines = (m_settings.m_snapshotPeriod > 0.0) && (snapshotNbLines == 0) ? 1 : snapshotNbLines;
+    m_publishNbLines = publishNbLines == 0 ? 1 : publishNbLines;
+}
+
+void SpectrumEngine::newSpectrum(const std::vector<Real>& spectrum, int fftSize)
+{
+    QMutexLocker mutexLocker(&m_lastSpectrumMutex);
+    m_lastSpectrum.assign(spectrum.begin(), spectrum.begin() + fftSize);
+    m_lastSpectrumSeq++;
+    m_lastSpectrumTimestampMs = QDateTime::currentMSecsSinceEpoch();
+    m_lastSpectrumLinear = m_settings.m_linear;
+    m_lastSpectrumSampleRate = m_spectrumSampleRate;
+    m_lastSpectrumCenterFrequency = m_spectrumCenterFrequency;
+}
+
+quint64 SpectrumEngine::getSpectrum(std::vector<Real>& spectrum, qint64& timestampMs)
+{
+    QMutexLocker mutexLocker(&m_lastSpectrumMutex);
+    spectrum = m_lastSpectrum;
+    timestampMs = m_lastSpectrumTimestampMs;
+    return m_lastSpectrumSeq;
+}
+
+quint64 SpectrumEngine::getSpectrumSequence()
+{
+    QMutexLocker mutexLocker(&m_lastSpectrumMutex);
+    return m_lastSpectrumSeq;
+}
+
+QByteArray SpectrumEngine::serializeSpectrum(
+        SpectrumFormat format,
+        bool autoRange,
+        float minValue,
+        float maxValue,
+        unsigned int nbBins,
+        DecimationMode decimation)
+{
+    QMutexLocker mutexLocker(&m_lastSpectrumMutex);
+    QByteArray blob;
+
+    if (m_lastSpectrumSeq == 0) {
+        return blob;
+    }
+
+    unsigned int lineSize = m_lastSpectrum.size();
+    const float *line = &m_lastSpectrum[0];
+    std::vector<float> decimated;
+
+    if ((nbBins == 0) || (nbBins >= lineSize))
+    {
+        nbBins = lineSize;
+    }
+    else
+    {
+        // smallest factor dividing the line size that yields no more than nbBins values
+        unsigned int factor = (lineSize + nbBins - 1) / nbBins;
+
+        while (lineSize % factor != 0) {
+            factor++;
+        }
+
+        nbBins = lineSize / factor;
+        decimated.resize(nbBins);
+
+        if (decimation == DecimationMean) {
+            SpectrumKernels::decimateMean(line, &decimated[0], lineSize, nbBins);
+        } else {
+            SpectrumKernels::decimateMax(line, &decimated[0], lineSize, nbBins);
+        }
+
+        line = &decimated[0];
+    }
+
+    if (autoRange) {
+        SpectrumKernels::minMax(line, nbBins, minValue, maxValue);
+    }
+
+    SpectrumHeader header;
+    memcpy(header.m_magic, "SPEC", 4);
+    header.m_version = 1;
+    header.m_format = (quint8) format;
+    header.m_linear = m_lastSpectrumLinear ? 1 : 0;
+    header.m_reserved = 0;
+    header.m_nbBins = nbBins;
+    header.m_sampleRate = m_lastSpectrumSampleRate;
+    header.m_centerFrequency = m_lastSpectrumCenterFrequency;
+    header.m_sequence = m_lastSpectrumSeq;
+    header.m_timestampMs = m_lastSpectrumTimestampMs;
+    header.m_minValue = minValue;
+    header.m_maxValue = maxValue;
+
+    int valueSize = format == FormatUInt8 ? sizeof(quint8) : sizeof(float);
+    blob.resize(sizeof(SpectrumHeader) + nbBins*valueSize);
+    memcpy(blob.data(), &header, sizeof(SpectrumHeader));
+    char *values = blob.data() + sizeof(SpectrumHeader);
+
+    if (format == FormatUInt8) {
+        SpectrumKernels::quantize(line, (uint8_t*) values, nbBins, minValue, maxValue);
+    } else {
+        memcpy(values, line, nbBins*sizeof(float));
+    }
+
+    return blob;
+}
+
+SpectrumEngine::Settings SpectrumEngine::getSettings()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    return m_settings;
+}
+
+void SpectrumEngine::start()
+{
+}
+
+void SpectrumEngine::stop()
+{
+}
+
+bool SpectrumEngine::handleMessage(const Message& message)
+{
+    if (MsgConfigureSpectrumEngine::match(message))
+    {
+        MsgConfigureSpectrumEngine& conf = (MsgConfigureSpectrumEngine&) message;
+        handleConfigure(conf.getSettings());
+        return true;
+    }
+    else if (DSPSignalNotification::match(message))
+    {
+        DSPSignalNotification& notif = (DSPSignalNotification&) message;
+        QMutexLocker mutexLocker(&m_mutex);
+
+        if ((notif.getSampleRate() != m_sampleRate) || (notif.getCenterFrequency() != m_centerFrequency))
+        {
+            // do not mix different frequencies in the same integration: keep what was done so far
+            m_integrator.writeSnapshot(m_spectrumSampleRate, m_spectrumCenterFrequency, QDateTime::currentMSecsSinceEpoch(), false, 1.0 / m_powFFTDiv);
+            m_integrator.reset(0);
+        }
+
+        m_sampleRate = notif.getSampleRate();
+        m_centerFrequency = notif.getCenterFrequency();
+        applyZoom();
+        updateIntegrationCounts();
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+void SpectrumEngine::clampSettings(Settings& settings)
+{
+    if (settings.m_fftSize > m_maxFFTSize) {
+        settings.m_fftSize = m_maxFFTSize;
+    } else if (settings.m_fftSize < 64) {
+        settings.m_fftSize = 64;
+    }
+
+    while ((settings.m_fftSize & (settings.m_fftSize - 1)) != 0) { // round down to a power of two
+        settings.m_fftSize &= settings.m_fftSize - 1;
+    }
+
+    if (settings.m_overlapPercent > 99) { // at least one new sample per FFT
+        settings.m_overlapPercent = 99;
+    } else if (settings.m_overlapPercent < 0) {
+        settings.m_overlapPercent = 0;
+    }
+
+    if (settings.m_zoomLog2Decim > m_maxZoomLog2Decim) {
+        settings.m_zoomLog2Decim = m_maxZoomLog2Decim;
+    } else if (settings.m_zoomLog2Decim < 0) {
+        settings.m_zoomLog2Decim = 0;
+    }
+}
+
+void SpectrumEngine::handleConfigure(const Settings& settings)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    qDebug() << "SpectrumEngine::handleConfigure:"
+            << " fftSize: " << settings.m_fftSize
+            << " overlapPercent: " << settings.m_overlapPercent
+            << " averageNb: " << settings.m_averageNb
+            << " averagingMode: " << (int) settings.m_averagingMode
+            << " window: " << (int) settings.m_window
+            << " linear: " << settings.m_linear
+            << " integrationTime: " << settings.m_integrationTime
+            << " snapshotPeriod: " << settings.m_snapshotPeriod
+            << " snapshotFileName: " << settings.m_snapshotFileName
+            << " zoomLog2Decim: " << settings.m_zoomLog2Decim
+            << " zoomFrequencyOffset: " << settings.m_zoomFrequencyOffset;
+
+    m_settings = settings;
+    clampSettings(m_settings);
+
+    m_fftSize = m_settings.m_fftSize;
+    m_overlapPercent = m_settings.m_overlapPercent;
+    m_sampleBuffer.resize(m_fftSize);
+    m_zoomBuffer.resize(m_fftSize);
+    m_powerSpectrum.resize(m_fftSize);
+    m_magSqLine.resize(m_fftSize);
+    m_fft->configure(m_fftSize, false);
+    m_window.create(m_settings.m_window, m_fftSize);
+    m_overlapSize = (m_fftSize * m_overlapPercent) / 100;
+    m_refillSize = m_fftSize - m_overlapSize;
+    m_fftBufferFill = 0;
+    m_movingAverage.resize(m_fftSize, m_settings.m_averageNb);
+    m_fixedAverage.resize(m_fftSize, m_settings.m_averageNb);
+    m_ofs = 20.0f * log10f(1.0f / m_fftSize);
+    m_powFFTDiv = m_fftSize*m_fftSize;
+    m_integrator.resize(m_fftSize);
+
+    applyZoom();
+    m_integrator.setSnapshotFile(m_settings.m_averagingMode == AvgModeIntegration ? m_settings.m_snapshotFileName : QString());
+    updateIntegrationCounts();
+}
@@ -0,0 +1,238 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SPECTRUMENGINE_H_
+#define SDRBASE_DSP_SPECTRUMENGINE_H_
+
+#include <QMutex>
+#include <QByteArray>
+#include <QString>
+
+#include "dsp/basebandsamplesink.h"
+#include "dsp/fftengine.h"
+#include "dsp/fftwindow.h"
+#include "dsp/spectrumintegrator.h"
+#include "dsp/ncof.h"
+#include "dsp/inthalfbandfiltereof.h"
+#include "util/message.h"
+#include "util/movingaverage2d.h"
+#include "util/fixedaverage2d.h"
+#include "export.h"
+
+#define SPECTRUMENGINE_HB_FILTER_ORDER 64
+
+/**
+ * GUI independent power spectrum computation. It is a baseband sample sink that
+ * can be attached to any device engine. Each completed (possibly averaged) line
+ * is passed to newSpectrum() which by default keeps a copy of the latest line
+ * that can be retrieved from any thread with getSpectrum(). Visualisation classes
+ * derive from it and override newSpectrum() to push lines to their display.
+ */
+class SDRBASE_API SpectrumEngine : public BasebandSampleSink {
+public:
+    enum AveragingMode
+    {
+        AvgModeNone,
+        AvgModeMoving,
+        AvgModeFixed,
+        AvgModeIntegration //!< long integration in double precision with optional snapshots to file
+    };
+
+    struct Settings
+    {
+        int m_fftSize;
+        int m_overlapPercent;
+        unsigned int m_averageNb;
+        AveragingMode m_averagingMode;
+        FFTWindow::Function m_window;
+        bool m_linear;
+        double m_integrationTime;   //!< integration time in seconds (AvgModeIntegration)
+        double m_snapshotPeriod;    //!< period of snapshots in seconds, 0 for snapshots at the end of integration only
+        QString m_snapshotFileName; //!< file where snapshots are appended, empty for none
+        int m_zoomLog2Decim;        //!< zoom FFT: log2 of the decimation of the sub-band analysed (0: no zoom)
+        qint64 m_zoomFrequencyOffset; //!< zoom FFT: sub-band center frequency relative to the device center frequency (within +/- half the sample rate)
+
+        Settings() :
+            m_fftSize(1024),
+            m_overlapPercent(0),
+            m_averageNb(0),
+            m_averagingMode(AvgModeNone),
+            m_window(FFTWindow::BlackmanHarris),
+            m_linear(false),
+            m_integrationTime(60.0),
+            m_snapshotPeriod(0.0),
+            m_zoomLog2Decim(0),
+            m_zoomFrequencyOffset(0)
+        {}
+    };
+
+    enum SpectrumFormat
+    {
+        FormatFloat32,
+        FormatUInt8
+    };
+
+    enum DecimationMode
+    {
+        DecimationMax,  //!< keep the maximum of bins merged together
+        DecimationMean  //!< average bins merged together
+    };
+
+#pragma pack(push, 1)
+    /** Header of the compact binary spectrum representation. Values follow in host (little endian) order. */
+    struct SpectrumHeader
+    {
+        char m_magic[4];           //!< "SPEC"
+        quint8 m_version;
+        quint8 m_format;           //!< SpectrumFormat
+        quint8 m_linear;           //!< 1 if values are linear power else dB
+        quint8 m_reserved;
+        quint32 m_nbBins;
+        qint32 m_sampleRate;
+        qint64 m_centerFrequency;
+        quint64 m_sequence;        //!< line sequence number
+        qint64 m_timestampMs;      //!< line time in ms since epoch
+        float m_minValue;          //!< for FormatUInt8: value of quantisation step 0
+        float m_maxValue;          //!< for FormatUInt8: value of quantisation step 255
+    };
+#pragma pack(pop)
+
+    class MsgConfigureSpectrumEngine : public Message {
+        MESSAGE_CLASS_DECLARATION
+
+    public:
+        const Settings& getSettings() const { return m_settings; }
+
+        static MsgConfigureSpectrumEngine* create(const Settings& settings) {
+            return new MsgConfigureSpectrumEngine(settings);
+        }
+
+    private:
+        Settings m_settings;
+
+        MsgConfigureSpectrumEngine(const Settings& settings) :
+            Message(),
+            m_settings(settings)
+        { }
+    };
+
+    SpectrumEngine(Real scalef);
+    virtual ~SpectrumEngine();
+
+    virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool positiveOnly);
+    virtual void start();
+    virtual void stop();
+    virtual bool handleMessage(const Message& message);
+
+    Settings getSettings();
+    int getSampleRate() const { return m_sampleRate; }
+    qint64 getCenterFrequency() const { return m_centerFrequency; }
+    /** Sample rate of the analysed signal i.e. the device sample rate divided by the zoom decimation */
+    int getSpectrumSampleRate() const { return m_spectrumSampleRate; }
+    /** Center frequency of the analysed signal i.e. the device center frequency plus the zoom offset */
+    qint64 getSpectrumCenterFrequency() const { return m_spectrumCenterFrequency; }
+
+    /**
+     * Copy the latest power spectrum line (dB or linear depending on settings)
+     * Returns the line sequence number starting at 1 or 0 if no line has been produced yet.
+     */
+    quint64 getSpectrum(std::vector<Real>& spectrum, qint64& timestampMs);
+
+    /** Sequence number of the latest line or 0 if no line has been produced yet */
+    quint64 getSpectrumSequence();
+
+    /**
+     * Serialize the latest line as a SpectrumHeader followed by the bin values as float32 or
+     * uint8 quantised between minValue and maxValue. With autoRange the line minimum and maximum
+     * are used. When nbBins is not zero and smaller than the line size bins are merged by groups
+     * so that at most nbBins values are sent. Returns an empty array if no line has been produced yet.
+     */
+    QByteArray serializeSpectrum(
+            SpectrumFormat format,
+            bool autoRange,
+            float minValue,
+            float maxValue,
+            unsigned int nbBins = 0,
+            DecimationMode decimation = DecimationMax);
+
+    /** Bring the settings within the limits used by the engine */
+    static void clampSettings(Settings& settings);
+
+    static const int m_maxFFTSize = 65536;
+    static const int m_maxZoomLog2Decim = 10;
+
+protected:
+    /** Called on the DSP thread each time a new line is available */
+    virtual void newSpectrum(const std::vector<Real>& spectrum, int fftSize);
+
+    QMutex m_mutex;
+
+private:
+    FFTEngine* m_fft;
+    FFTWindow m_window;
+
+    std::vector<Sample> m_sampleBuffer; //!< samples of an FFT span straddling input blocks
+    std::vector<Complex> m_zoomBuffer;  //!< decimated samples in zoom mode
+    std::vector<Real> m_powerSpectrum;
+    std::vector<Real> m_magSqLine;
+
+    std::size_t m_fftSize;
+    std::size_t m_overlapPercent;
+    std::size_t m_overlapSize;
+    std::size_t m_refillSize;
+    std::size_t m_fftBufferFill;
+    bool m_needMoreSamples;
+
+    Real m_scalef;
+    MovingAverage2D<Real> m_movingAverage;
+    FixedAverage2D<Real> m_fixedAverage;
+    SpectrumIntegrator m_integrator;
+    quint64 m_integrationNbLines; //!< lines per integration
+    quint64 m_snapshotNbLines;    //!< lines between snapshots (0 for none)
+    quint64 m_publishNbLines;     //!< lines between display updates of the running integration
+    Settings m_settings;
+
+    Real m_ofs;
+    Real m_powFFTDiv;
+    static const Real m_mult;
+
+    int m_sampleRate;
+    qint64 m_centerFrequency;
+
+    NCOF m_zoomNCO;
+    IntHalfbandFilterEOF<SPECTRUMENGINE_HB_FILTER_ORDER> m_zoomFilters[m_maxZoomLog2Decim];
+    int m_zoomLog2Decim;
+    int m_spectrumSampleRate;
+    qint64 m_spectrumCenterFrequency;
+
+    QMutex m_lastSpectrumMutex;
+    std::vector<Real> m_lastSpectrum;
+    quint64 m_lastSpectrumSeq;
+    qint64 m_lastSpectrumTimestampMs;
+    bool m_lastSpectrumLinear;
+    int m_lastSpectrumSampleRate;
+    qint64 m_lastSpectrumCenterFrequency;
+
+    void handleConfigure(const Settings& settings);
+    void feedZoom(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+    void processFFT(bool positiveOnly);
+    void applyZoom();
+    void integrate(Real *magSq, std::size_t width, bool positiveOnly);
+    void updateIntegrationCounts();
+};
+
+#endif /* SDRBASE_DSP_SPECTRUMENGINE_H_ */
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+#include <string.h>
+
+#include "dsp/spectrumkernels.h"
+#include "dsp/spectrumintegrator.h"
+
+QString SpectrumIntegrator::m_snapshotDirectory;
+
+SpectrumIntegrator::SpectrumIntegrator() :
+    m_nbLines(0),
+    m_startTimestampMs(0),
+    m_snapshotWriter(4, 1<<19) // each buffer holds a snapshot of the largest FFT
+{
+}
+
+SpectrumIntegrator::~SpectrumIntegrator()
+{
+    m_snapshotWriter.close();
+}
+
+void SpectrumIntegrator::resize(unsigned int nbBins)
+{
+    m_accumulator.resize(nbBins);
+    m_snapshotLine.resize(nbBins);
+    reset(m_startTimestampMs);
+}
+
+void SpectrumIntegrator::reset(qint64 startTimestampMs)
+{
+    std::fill(m_accumulator.begin(), m_accumulator.end(), 0.0);
+    m_nbLines = 0;
+    m_startTimestampMs = startTimestampMs;
+}
+
+void SpectrumIntegrator::accumulate(const float *line)
+{
+    SpectrumKernels::accumulate(line, m_accumulator.data(), m_accumulator.size());
+    m_nbLines++;
+}
+
+void SpectrumIntegrator::getAverage(float *average, double factor) const
+{
+    double norm = m_nbLines == 0 ? 0.0 : factor / m_nbLines;
+    SpectrumKernels::scaleAccumulator(m_accumulator.data(), average, m_accumulator.size(), norm);
+}
+
+bool SpectrumIntegrator::isValidSnapshotFileName(const QString& fileName)
+{
+    return !m_snapshotDirectory.isEmpty()
+        && !fileName.isEmpty()
+        && (fileName != ".")
+        && (fileName != "..")
+        && !fileName.contains('/')
+        && !fileName.contains('\\');
+}
+
+bool SpectrumIntegrator::setSnapshotFile(const QString& fileName)
+{
+    if (fileName == m_snapshotFileName) {
+        return m_snapshotWriter.isOpen() || fileName.isEmpty();
+    }
+
+    m_snapshotWriter.close();
+    m_snapshotFileName = fileName;
+
+    if (fileName.isEmpty()) {
+        return true;
+    }
+
+    if (!isValidSnapshotFileName(fileName))
+    {
+        qWarning("SpectrumIntegrator::setSnapshotFile: %s is not a file name in the snapshot directory \"%s\"",
+                qPrintable(fileName), qPrintable(m_snapshotDirectory));
+        return false;
+    }
+
+    QString filePath = QDir(m_snapshotDirectory).filePath(fileName);
+
+    if (!m_snapshotWriter.open(filePath, false, true))
+    {
+        qWarning("SpectrumIntegrator::setSnapshotFile: cannot open %s", qPrintable(filePath));
+        return false;
+    }
+
+    qDebug("SpectrumIntegrator::setSnapshotFile: appending snapshots to %s", qPrintable(filePath));
+    return true;
+}
+
+void SpectrumIntegrator::writeSnapshot(int sampleRate, qint64 centerFrequency, qint64 timestampMs, bool final, double factor)
+{
+    if (!m_snapshotWriter.isOpen() || (m_nbLines == 0)) {
+        return;
+    }
+
+    SnapshotHeader header;
+    memcpy(header.m_magic, "SINT", 4);
+    header.m_version = 1;
+    header.m_final = final ? 1 : 0;
+    header.m_reserved = 0;
+    header.m_nbBins = m_accumulator.size();
+    header.m_sampleRate = sampleRate;
+    header.m_centerFrequency = centerFrequency;
+    header.m_startTimestampMs = m_startTimestampMs;
+    header.m_timestampMs = timestampMs;
+    header.m_nbLines = m_nbLines;
+
+    getAverage(m_snapshotLine.data(), factor);
+    // the writer thread does the file I/O: the DSP thread only copies the record
+    m_snapshotWriter.write((const char *) &header, sizeof(SnapshotHeader));
+    m_snapshotWriter.write((const char *) m_snapshotLine.data(), m_snapshotLine.size() * sizeof(float));
+    m_snapshotWriter.flush();
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SPECTRUMINTEGRATOR_H_
+#define SDRBASE_DSP_SPECTRUMINTEGRATOR_H_
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+#include "export.h"
+#include "dsp/filerecordwriter.h"
+
+/**
+ * Integrates power spectrum lines over an arbitrary number of FFTs for weak signal work
+ * (e.g. hydrogen line). Lines of linear power are summed in double precision so that
+ * hours of integration at full device rate do not lose the small contributions of late
+ * lines. Snapshots of the running average can be appended to a file as records made of a
+ * SnapshotHeader followed by nbBins float32 values of average linear power. Snapshot files
+ * are plain file names in the snapshot directory and are written by a FileRecordWriter thread.
+ */
+class SDRBASE_API SpectrumIntegrator
+{
+public:
+#pragma pack(push, 1)
+    struct SnapshotHeader
+    {
+        char m_magic[4];           //!< "SINT"
+        quint8 m_version;
+        quint8 m_final;            //!< 1 if this is the end of an integration else a partial result
+        quint16 m_reserved;
+        quint32 m_nbBins;
+        qint32 m_sampleRate;
+        qint64 m_centerFrequency;
+        qint64 m_startTimestampMs; //!< start of integration in ms since epoch
+        qint64 m_timestampMs;      //!< time of the snapshot in ms since epoch
+        quint64 m_nbLines;         //!< number of FFT lines integrated
+    };
+#pragma pack(pop)
+
+    SpectrumIntegrator();
+    ~SpectrumIntegrator();
+
+    void resize(unsigned int nbBins);
+    void reset(qint64 startTimestampMs);
+    /** Add a line of nbBins linear power values */
+    void accumulate(const float *line);
+    /** Average linear power of the lines integrated so far multiplied by factor */
+    void getAverage(float *average, double factor) const;
+    unsigned int getNbBins() const { return m_accumulator.size(); }
+    quint64 getNbLines() const { return m_nbLines; }
+    qint64 getStartTimestampMs() const { return m_startTimestampMs; }
+
+    /** Snapshots are appended to this file of the snapshot directory. An empty file name stops snapshots. */
+    bool setSnapshotFile(const QString& fileName);
+    /** Append the current average (times factor) to the snapshot file if any */
+    void writeSnapshot(int sampleRate, qint64 centerFrequency, qint64 timestampMs, bool final, double factor);
+
+    /** Directory of all snapshot files. Snapshots are disabled when empty. */
+    static void setSnapshotDirectory(const QString& directory) { m_snapshotDirectory = directory; }
+    static const QString& getSnapshotDirectory() { return m_snapshotDirectory; }
+    /** True if snapshots are enabled and fileName is a plain file name (no directory part) */
+    static bool isValidSnapshotFileName(const QString& fileName);
+
+private:
+    std::vector<double> m_accumulator;
+    std::vector<float> m_snapshotLine;
+    quint64 m_nbLines;
+    qint64 m_startTimestampMs;
+    QString m_snapshotFileName;
+    FileRecordWriter m_snapshotWriter;
+
+    static QString m_snapshotDirectory;
+};
+
+#endif /* SDRBASE_DSP_SPECTRUMINTEGRATOR_H_ */
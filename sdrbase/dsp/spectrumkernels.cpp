@@ -0,0 +1,353 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifdef USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "dsp/spectrumkernels.h"
+
+void SpectrumKernels::windowComplex(const Complex *in, const float *window, Complex *out, unsigned int n)
+{
+    const float *pin = reinterpret_cast<const float*>(in);
+    float *pout = reinterpret_cast<float*>(out);
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 w = _mm_loadu_ps(&window[i]);
+        __m128 wlo = _mm_unpacklo_ps(w, w); // w0 w0 w1 w1
+        __m128 whi = _mm_unpackhi_ps(w, w); // w2 w2 w3 w3
+        _mm_storeu_ps(&pout[2*i], _mm_mul_ps(_mm_loadu_ps(&pin[2*i]), wlo));
+        _mm_storeu_ps(&pout[2*i + 4], _mm_mul_ps(_mm_loadu_ps(&pin[2*i + 4]), whi));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        pout[2*i] = pin[2*i] * window[i];
+        pout[2*i+1] = pin[2*i+1] * window[i];
+    }
+}
+
+void SpectrumKernels::windowSamples(const Sample *in, const float *window, Complex *out, unsigned int n, float scale)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    float *pout = reinterpret_cast<float*>(out);
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128 vscale = _mm_set1_ps(scale);
+
+    for (; i + 4 <= n; i += 4)
+    {
+#if SDR_RX_SAMP_SZ == 24
+        __m128 lo = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) &pin[2*i]));     // re0 im0 re1 im1
+        __m128 hi = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) &pin[2*i + 4])); // re2 im2 re3 im3
+#else
+        __m128i s = _mm_loadu_si128((const __m128i*) &pin[2*i]); // 4 samples of 2 x int16
+        // sign extend to int32 by placing each value in the upper half and shifting back
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+#endif
+        __m128 w = _mm_mul_ps(_mm_loadu_ps(&window[i]), vscale);
+        _mm_storeu_ps(&pout[2*i], _mm_mul_ps(lo, _mm_unpacklo_ps(w, w)));
+        _mm_storeu_ps(&pout[2*i + 4], _mm_mul_ps(hi, _mm_unpackhi_ps(w, w)));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        float w = window[i] * scale;
+        pout[2*i] = pin[2*i] * w;
+        pout[2*i+1] = pin[2*i+1] * w;
+    }
+}
+
+void SpectrumKernels::magSq(const Complex *in, float *out, unsigned int n)
+{
+    const float *pin = reinterpret_cast<const float*>(in);
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(&pin[2*i]);     // re0 im0 re1 im1
+        __m128 b = _mm_loadu_ps(&pin[2*i + 4]); // re2 im2 re3 im3
+        a = _mm_mul_ps(a, a);
+        b = _mm_mul_ps(b, b);
+        __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(&out[i], _mm_add_ps(re, im));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = pin[2*i]*pin[2*i] + pin[2*i+1]*pin[2*i+1];
+    }
+}
+
+void SpectrumKernels::log2Scale(const float *in, float *out, unsigned int n, float mult, float ofs)
+{
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128 minValue = _mm_set1_ps(1.17549435e-38f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sqrt2 = _mm_set1_ps(1.41421356f);
+    const __m128 c1 = _mm_set1_ps(2.88539008f);
+    const __m128 c3 = _mm_set1_ps(0.96179669f);
+    const __m128 c5 = _mm_set1_ps(0.57707802f);
+    const __m128 c7 = _mm_set1_ps(0.41219858f);
+    const __m128 vmult = _mm_set1_ps(mult);
+    const __m128 vofs = _mm_set1_ps(ofs);
+    const __m128i expMask = _mm_set1_epi32(0xff);
+    const __m128i expBias = _mm_set1_epi32(127);
+    const __m128i mantMask = _mm_set1_epi32(0x007fffff);
+    const __m128i oneBits = _mm_set1_epi32(0x3f800000);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 x = _mm_max_ps(_mm_loadu_ps(&in[i]), minValue);
+        __m128i xi = _mm_castps_si128(x);
+        __m128i e = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(xi, 23), expMask), expBias);
+        __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(xi, mantMask), oneBits));
+        // bring mantissa into [sqrt(1/2), sqrt(2))
+        __m128 gt = _mm_cmpgt_ps(m, sqrt2);
+        m = _mm_or_ps(_mm_and_ps(gt, _mm_mul_ps(m, half)), _mm_andnot_ps(gt, m));
+        e = _mm_sub_epi32(e, _mm_castps_si128(gt)); // mask is -1 where true
+        __m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+        __m128 t2 = _mm_mul_ps(t, t);
+        __m128 p = _mm_add_ps(c5, _mm_mul_ps(t2, c7));
+        p = _mm_add_ps(c3, _mm_mul_ps(t2, p));
+        p = _mm_add_ps(c1, _mm_mul_ps(t2, p));
+        p = _mm_add_ps(_mm_cvtepi32_ps(e), _mm_mul_ps(t, p));
+        _mm_storeu_ps(&out[i], _mm_add_ps(_mm_mul_ps(p, vmult), vofs));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = mult * fastLog2(in[i]) + ofs;
+    }
+}
+
+void SpectrumKernels::linearScale(const float *in, float *out, unsigned int n, float factor)
+{
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128 vfactor = _mm_set1_ps(factor);
+
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(&out[i], _mm_mul_ps(_mm_loadu_ps(&in[i]), vfactor));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = in[i] * factor;
+    }
+}
+
+void SpectrumKernels::quantize(const float *in, uint8_t *out, unsigned int n, float minValue, float maxValue)
+{
+    float range = maxValue - minValue;
+    float scale = range > 0.0f ? 255.0f / range : 0.0f;
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128 vmin = _mm_set1_ps(minValue);
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        // float to int32 with rounding then saturating packs down to uint8
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&in[i]), vmin), vscale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&in[i+4]), vmin), vscale));
+        __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&in[i+8]), vmin), vscale));
+        __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&in[i+12]), vmin), vscale));
+        __m128i ab = _mm_packs_epi32(a, b);
+        __m128i cd = _mm_packs_epi32(c, d);
+        ab = _mm_max_epi16(ab, zero);
+        cd = _mm_max_epi16(cd, zero);
+        _mm_storeu_si128((__m128i*) &out[i], _mm_packus_epi16(ab, cd));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        float v = (in[i] - minValue) * scale + 0.5f;
+        out[i] = v < 0.0f ? 0 : v > 255.0f ? 255 : (uint8_t) v;
+    }
+}
+
+void SpectrumKernels::minMax(const float *in, unsigned int n, float& minValue, float& maxValue)
+{
+    minValue = in[0];
+    maxValue = in[0];
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    if (n >= 4)
+    {
+        __m128 vmin = _mm_loadu_ps(in);
+        __m128 vmax = vmin;
+
+        for (i = 4; i + 4 <= n; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(&in[i]);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+
+        float mins[4], maxs[4];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+
+        for (int j = 0; j < 4; j++)
+        {
+            minValue = mins[j] < minValue ? mins[j] : minValue;
+            maxValue = maxs[j] > maxValue ? maxs[j] : maxValue;
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        minValue = in[i] < minValue ? in[i] : minValue;
+        maxValue = in[i] > maxValue ? in[i] : maxValue;
+    }
+}
+
+void SpectrumKernels::accumulate(const float *in, double *acc, unsigned int n)
+{
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(&in[i]);
+        __m128d lo = _mm_cvtps_pd(v);
+        __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        _mm_storeu_pd(&acc[i], _mm_add_pd(_mm_loadu_pd(&acc[i]), lo));
+        _mm_storeu_pd(&acc[i+2], _mm_add_pd(_mm_loadu_pd(&acc[i+2]), hi));
+    }
+#endif
+
+    for (; i < n; i++) {
+        acc[i] += in[i];
+    }
+}
+
+void SpectrumKernels::scaleAccumulator(const double *acc, float *out, unsigned int n, double factor)
+{
+    unsigned int i = 0;
+
+#ifdef USE_SSE2
+    const __m128d vfactor = _mm_set1_pd(factor);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(&acc[i]), vfactor));
+        __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(&acc[i+2]), vfactor));
+        _mm_storeu_ps(&out[i], _mm_movelh_ps(lo, hi));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = acc[i] * factor;
+    }
+}
+
+void SpectrumKernels::decimateMax(const float *in, float *out, unsigned int nIn, unsigned int nOut)
+{
+    unsigned int factor = nIn / nOut;
+
+    for (unsigned int j = 0; j < nOut; j++, in += factor)
+    {
+        unsigned int i = 0;
+        float maxValue = in[0];
+
+#ifdef USE_SSE2
+        if (factor >= 4)
+        {
+            __m128 vmax = _mm_loadu_ps(in);
+
+            for (i = 4; i + 4 <= factor; i += 4) {
+                vmax = _mm_max_ps(vmax, _mm_loadu_ps(&in[i]));
+            }
+
+            // horizontal maximum
+            vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+            vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+            maxValue = _mm_cvtss_f32(vmax);
+        }
+#endif
+
+        for (; i < factor; i++) {
+            maxValue = in[i] > maxValue ? in[i] : maxValue;
+        }
+
+        out[j] = maxValue;
+    }
+}
+
+void SpectrumKernels::decimateMean(const float *in, float *out, unsigned int nIn, unsigned int nOut)
+{
+    unsigned int factor = nIn / nOut;
+    float norm = 1.0f / factor;
+
+    for (unsigned int j = 0; j < nOut; j++, in += factor)
+    {
+        unsigned int i = 0;
+        float sum = 0.0f;
+
+#ifdef USE_SSE2
+        if (factor >= 4)
+        {
+            __m128 vsum = _mm_setzero_ps();
+
+            for (; i + 4 <= factor; i += 4) {
+                vsum = _mm_add_ps(vsum, _mm_loadu_ps(&in[i]));
+            }
+
+            // horizontal sum
+            vsum = _mm_add_ps(vsum, _mm_shuffle_ps(vsum, vsum, _MM_SHUFFLE(1, 0, 3, 2)));
+            vsum = _mm_add_ps(vsum, _mm_shuffle_ps(vsum, vsum, _MM_SHUFFLE(2, 3, 0, 1)));
+            sum = _mm_cvtss_f32(vsum);
+        }
+#endif
+
+        for (; i < factor; i++) {
+            sum += in[i];
+        }
+
+        out[j] = sum * norm;
+    }
+}
+
+void SpectrumKernels::duplicate(float *inout, unsigned int n)
+{
+    // go backwards so that a value is read before its slot is overwritten
+    for (unsigned int i = n; i > 0; i--)
+    {
+        inout[2*i - 1] = inout[i - 1];
+        inout[2*i - 2] = inout[i - 1];
+    }
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SPECTRUMKERNELS_H_
+#define SDRBASE_DSP_SPECTRUMKERNELS_H_
+
+#include <stdint.h>
+
+#include "dsp/dsptypes.h"
+#include "export.h"
+
+/**
+ * Block kernels used to window FFT input and turn FFT output into a displayable power spectrum.
+ * They work on whole lines of bins so that the inner loops carry no branches
+ * and can be processed 4 bins at a time with SSE2 when available.
+ */
+class SDRBASE_API SpectrumKernels
+{
+public:
+    /** out = in * window for n complex values and n real window coefficients */
+    static void windowComplex(const Complex *in, const float *window, Complex *out, unsigned int n);
+    /** out = in * scale * window converting n fixed point samples to complex float */
+    static void windowSamples(const Sample *in, const float *window, Complex *out, unsigned int n, float scale);
+    /** Squared magnitude of n complex bins */
+    static void magSq(const Complex *in, float *out, unsigned int n);
+    /** out = mult * log2(in) + ofs using fastLog2. Input is floored to FLT_MIN. */
+    static void log2Scale(const float *in, float *out, unsigned int n, float mult, float ofs);
+    /** out = in * factor */
+    static void linearScale(const float *in, float *out, unsigned int n, float factor);
+    /** Linear quantisation of [minValue, maxValue] to [0, 255] with saturation */
+    static void quantize(const float *in, uint8_t *out, unsigned int n, float minValue, float maxValue);
+    /** Minimum and maximum of n values (n > 0) */
+    static void minMax(const float *in, unsigned int n, float& minValue, float& maxValue);
+    /** acc += in with double precision accumulators for long integrations */
+    static void accumulate(const float *in, double *acc, unsigned int n);
+    /** out = acc * factor converted back to single precision */
+    static void scaleAccumulator(const double *acc, float *out, unsigned int n, double factor);
+    /**
+     * Reduce nIn values to nOut values (nIn multiple of nOut) keeping the maximum of each
+     * group of nIn/nOut consecutive values. This keeps narrow peaks visible.
+     */
+    static void decimateMax(const float *in, float *out, unsigned int nIn, unsigned int nOut);
+    /** Same as decimateMax but averages each group of values */
+    static void decimateMean(const float *in, float *out, unsigned int nIn, unsigned int nOut);
+    /** Expand n values to 2n by doubling each value in place (buffer must hold 2n values) */
+    static void duplicate(float *inout, unsigned int n);
+
+    /**
+     * Fast log2 approximation. The argument is split into exponent and mantissa
+     * in [sqrt(1/2), sqrt(2)) and log of the mantissa is evaluated with the
+     * atanh series up to the 7th power. Absolute error is below 5e-6 which is
+     * less than 2e-5 dB after scaling.
+     */
+    static inline float fastLog2(float x)
+    {
+        union { float f; uint32_t i; } u;
+        u.f = x < 1.17549435e-38f ? 1.17549435e-38f : x; // FLT_MIN
+        int e = (int) ((u.i >> 23) & 0xff) - 127;
+        u.i = (u.i & 0x007fffff) | 0x3f800000; // mantissa in [1,2)
+
+        if (u.f > 1.41421356f)
+        {
+            u.f *= 0.5f;
+            e++;
+        }
+
+        // log2(m) = 2/ln(2) * (t + t^3/3 + t^5/5 + t^7/7) with t = (m-1)/(m+1)
+        float t = (u.f - 1.0f) / (u.f + 1.0f);
+        float t2 = t*t;
+        float p = t * (2.88539008f + t2 * (0.96179669f + t2 * (0.57707802f + t2 * 0.41219858f)));
+        return e + p;
+    }
+};
+
+#endif /* SDRBASE_DSP_SPECTRUMKERNELS_H_ */
@@ -17,6 +17,7 @@
 
 #include <QCommandLineOption>
 #include <QRegExpValidator>
+#include <QFileInfo>
 #include <QDebug>
 
 #include "mainparser.h"
@@ -29,10 +30,42 @@ MainParser::MainParser() :
     m_serverPortOption(QStringList() << "p" << "api-port",
         "Web API server port.",
         "port",
-        "8091")
+        "8091"),
+    m_streamPortOption(QStringList() << "s" << "stream-port",
+        "Spectrum stream server port (0 to disable).",
+        "port",
+        "8092"),
+    m_recordDirectIOOption(QStringList() << "record-direct-io",
+        "Write I/Q recordings with direct I/O bypassing the page cache (Linux only)."),
+    m_recordCompressionOption(QStringList() << "record-compression",
+        "Compression of I/Q recordings: none, lossless, bfp8 or bfp12.",
+        "codec",
+        "none"),
+    m_recordFormatOption(QStringList() << "record-format",
+        "File format of I/Q recordings: sdriq, cu8, cs8, cs16, cf32 or wav.",
+        "format",
+        "sdriq"),
+    m_recordPreTriggerOption(QStringList() << "record-pre-trigger",
+        "Triggered I/Q recordings: seconds of samples kept before the trigger (0 for continuous recordings).",
+        "seconds",
+        "0"),
+    m_recordPostTriggerOption(QStringList() << "record-post-trigger",
+        "Triggered I/Q recordings: seconds of samples recorded after the trigger is released.",
+        "seconds",
+        "1"),
+    m_recordTriggerPowerOption(QStringList() << "record-trigger-power",
+        "Triggered I/Q recordings: trigger when the spectrum peak in the band exceeds the threshold. Band offset from the center of the record (Hz), band width (Hz) and threshold (dB) separated by commas.",
+        "offset,bandwidth,threshold"),
+    m_snapshotDirectoryOption(QStringList() << "snapshot-dir",
+        "Directory of the spectrum integration snapshot files. Snapshots are disabled when not given.",
+        "directory")
 {
     m_serverAddress = "127.0.0.1";
     m_serverPort = 8091;
+    m_streamPort = 8092;
+    m_recordDirectIO = false;
+    m_recordCompression = FileRecordCodec::CodecNone;
+    m_recordFormat = IQFileFormat::FormatSDRiq;
 
     m_parser.setApplicationDescription("Software Defined Radio application");
     m_parser.addHelpOption();
@@ -40,6 +73,14 @@ MainParser::MainParser() :
 
     m_parser.addOption(m_serverAddressOption);
     m_parser.addOption(m_serverPortOption);
+    m_parser.addOption(m_streamPortOption);
+    m_parser.addOption(m_recordDirectIOOption);
+    m_parser.addOption(m_recordCompressionOption);
+    m_parser.addOption(m_recordFormatOption);
+    m_parser.addOption(m_recordPreTriggerOption);
+    m_parser.addOption(m_recordPostTriggerOption);
+    m_parser.addOption(m_recordTriggerPowerOption);
+    m_parser.addOption(m_snapshotDirectoryOption);
 }
 
 MainParser::~MainParser()
@@ -79,4 +120,82 @@ void MainParser::parse(const QCoreApplication& app)
     } else {
         qWarning() << "MainParser::parse: server port invalid. Defaulting to " << m_serverPort;
     }
+
+    // spectrum stream port
+
+    QString streamPortStr = m_parser.value(m_streamPortOption);
+    int streamPort = streamPortStr.toInt(&ok);
+
+    if (ok && ((streamPort == 0) || ((streamPort > 1023) && (streamPort < 65536)))) {
+        m_streamPort = streamPort;
+    } else {
+        qWarning() << "MainParser::parse: stream port invalid. Defaulting to " << m_streamPort;
+    }
+
+    m_recordDirectIO = m_parser.isSet(m_recordDirectIOOption);
+
+    // recording compression
+
+    QString recordCompression = m_parser.value(m_recordCompressionOption);
+
+    if (!FileRecordCodec::getCodec(recordCompression, m_recordCompression)) {
+        qWarning() << "MainParser::parse: record compression invalid. Defaulting to " << FileRecordCodec::getName(m_recordCompression);
+    }
+
+    // recording file format
+
+    QString recordFormat = m_parser.value(m_recordFormatOption);
+
+    if (!IQFileFormat::getFormat(recordFormat, m_recordFormat)) {
+        qWarning() << "MainParser::parse: record format invalid. Defaulting to " << IQFileFormat::getName(m_recordFormat);
+    }
+
+    // triggered recordings
+
+    float preTrigger = m_parser.value(m_recordPreTriggerOption).toFloat(&ok);
+
+    if (ok && (preTrigger >= 0.0f) && (preTrigger <= 3600.0f)) {
+        m_recordTrigger.m_preTrigger = preTrigger;
+    } else {
+        qWarning() << "MainParser::parse: record pre-trigger invalid. Defaulting to " << m_recordTrigger.m_preTrigger;
+    }
+
+    float postTrigger = m_parser.value(m_recordPostTriggerOption).toFloat(&ok);
+
+    if (ok && (postTrigger >= 0.0f) && (postTrigger <= 3600.0f)) {
+        m_recordTrigger.m_postTrigger = postTrigger;
+    } else {
+        qWarning() << "MainParser::parse: record post-trigger invalid. Defaulting to " << m_recordTrigger.m_postTrigger;
+    }
+
+    if (m_parser.isSet(m_recordTriggerPowerOption))
+    {
+        QStringList powerTrigger = m_parser.value(m_recordTriggerPowerOption).split(',');
+        bool okOffset, okBandwidth, okThreshold;
+
+        if (powerTrigger.size() == 3)
+        {
+            m_recordTrigger.m_powerBandOffset = powerTrigger[0].toLongLong(&okOffset);
+            m_recordTrigger.m_powerBandwidth = powerTrigger[1].toInt(&okBandwidth);
+            m_recordTrigger.m_powerThreshold = powerTrigger[2].toFloat(&okThreshold);
+            m_recordTrigger.m_powerTrigger = okOffset && okBandwidth && okThreshold && (m_recordTrigger.m_powerBandwidth > 0);
+        }
+
+        if (!m_recordTrigger.m_powerTrigger) {
+            qWarning() << "MainParser::parse: record power trigger invalid. No power trigger";
+        }
+    }
+
+    // spectrum integration snapshots
+
+    if (m_parser.isSet(m_snapshotDirectoryOption))
+    {
+        QFileInfo snapshotDirectory(m_parser.value(m_snapshotDirectoryOption));
+
+        if (snapshotDirectory.isDir() && snapshotDirectory.isWritable()) {
+            m_snapshotDirectory = snapshotDirectory.absoluteFilePath();
+        } else {
+            qWarning() << "MainParser::parse: snapshot directory invalid. No snapshots";
+        }
+    }
 }
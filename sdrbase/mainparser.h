@@ -22,6 +22,9 @@
 #include <stdint.h>
 
 #include "export.h"
+#include "dsp/filerecordcodec.h"
+#include "dsp/filerecord.h"
+#include "dsp/iqfileformat.h"
 
 class SDRBASE_API MainParser
 {
@@ -33,14 +36,34 @@ public:
 
     const QString& getServerAddress() const { return m_serverAddress; }
     uint16_t getServerPort() const { return m_serverPort; }
+    uint16_t getStreamPort() const { return m_streamPort; }
+    bool getRecordDirectIO() const { return m_recordDirectIO; }
+    FileRecordCodec::Codec getRecordCompression() const { return m_recordCompression; }
+    IQFileFormat::Format getRecordFormat() const { return m_recordFormat; }
+    const FileRecord::TriggerSettings& getRecordTrigger() const { return m_recordTrigger; }
+    const QString& getSnapshotDirectory() const { return m_snapshotDirectory; }
 
 private:
     QString  m_serverAddress;
     uint16_t m_serverPort;
+    uint16_t m_streamPort;
+    bool     m_recordDirectIO;
+    FileRecordCodec::Codec m_recordCompression;
+    IQFileFormat::Format m_recordFormat;
+    FileRecord::TriggerSettings m_recordTrigger;
+    QString  m_snapshotDirectory;
 
     QCommandLineParser m_parser;
     QCommandLineOption m_serverAddressOption;
     QCommandLineOption m_serverPortOption;
+    QCommandLineOption m_streamPortOption;
+    QCommandLineOption m_recordDirectIOOption;
+    QCommandLineOption m_recordCompressionOption;
+    QCommandLineOption m_recordFormatOption;
+    QCommandLineOption m_recordPreTriggerOption;
+    QCommandLineOption m_recordPostTriggerOption;
+    QCommandLineOption m_recordTriggerPowerOption;
+    QCommandLineOption m_snapshotDirectoryOption;
 };
 
 
@@ -4,7 +4,7 @@
 #
 #--------------------------------------------------------
 
-QT += core multimedia
+QT += core network multimedia
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TEMPLATE = lib
@@ -82,8 +82,14 @@ SOURCES += audio/audiodevicemanager.cpp\
         dsp/filterrc.cpp\
         dsp/filtermbe.cpp\
         dsp/filerecord.cpp\
+        dsp/filerecordcodec.cpp\
+        dsp/filerecordtrigger.cpp\
+        dsp/filerecordwriter.cpp\
         dsp/freqlockcomplex.cpp\
         dsp/interpolator.cpp\
+        dsp/iqconverters.cpp\
+        dsp/iqfileformat.cpp\
+        dsp/iqpacker.cpp\
         dsp/hbfiltertraits.cpp\
         dsp/lowpass.cpp\
         dsp/nco.cpp\
@@ -95,6 +101,9 @@ SOURCES += audio/audiodevicemanager.cpp\
         dsp/samplesinkfifo.cpp\
         dsp/samplesourcefifo.cpp\
         dsp/samplesinkfifodoublebuffered.cpp\
+        dsp/spectrumengine.cpp\
+        dsp/spectrumintegrator.cpp\
+        dsp/spectrumkernels.cpp\
         dsp/basebandsamplesink.cpp\
         dsp/basebandsamplesource.cpp\
         dsp/nullsink.cpp\
@@ -116,12 +125,16 @@ SOURCES += audio/audiodevicemanager.cpp\
         util/samplesourceserializer.cpp\
         util/simpleserializer.cpp\
         util/uid.cpp\
+        util/udpsinksender.cpp\
         plugin/plugininterface.cpp\
         plugin/pluginapi.cpp\        
         plugin/pluginmanager.cpp\
         webapi/webapiadapterinterface.cpp\
         webapi/webapirequestmapper.cpp\
         webapi/webapiserver.cpp\
+        webapi/spectrumstreamserver.cpp\
+        webapi/spectrumstreamconnection.cpp\
+        webapi/spectrumstreamprovider.cpp\
         mainparser.cpp
 
 HEADERS  += audio/audiodevicemanager.h\
@@ -159,11 +172,17 @@ HEADERS  += audio/audiodevicemanager.h\
         dsp/filterrc.h\
         dsp/filtermbe.h\
         dsp/filerecord.h\
+        dsp/filerecordcodec.h\
+        dsp/filerecordtrigger.h\
+        dsp/filerecordwriter.h\
         dsp/freqlockcomplex.h\
         dsp/gfft.h\
         dsp/hbfiltertraits.h\
         dsp/iirfilter.h\
         dsp/interpolator.h\
+        dsp/iqconverters.h\
+        dsp/iqfileformat.h\
+        dsp/iqpacker.h\
         dsp/inthalfbandfilter.h\
         dsp/inthalfbandfilterdb.h\
         dsp/inthalfbandfiltereo1.h\
@@ -186,6 +205,9 @@ HEADERS  += audio/audiodevicemanager.h\
         dsp/samplesourcefifo.h\
         dsp/samplesinkfifodoublebuffered.h\
         dsp/samplesinkfifodecimator.h\
+        dsp/spectrumengine.h\
+        dsp/spectrumintegrator.h\
+        dsp/spectrumkernels.h\
         dsp/basebandsamplesink.h\
         dsp/basebandsamplesource.h\
         dsp/nullsink.h\
@@ -211,9 +233,13 @@ HEADERS  += audio/audiodevicemanager.h\
         util/samplesourceserializer.h\
         util/simpleserializer.h\
         util/uid.h\
+        util/udpsinksender.h\
         webapi/webapiadapterinterface.h\
         webapi/webapirequestmapper.h\
         webapi/webapiserver.h\
+        webapi/spectrumstreamserver.h\
+        webapi/spectrumstreamconnection.h\
+        webapi/spectrumstreamprovider.h\
         mainparser.h
 
 !macx:LIBS += -L../serialdv/$${build_subdir} -lserialdv
@@ -72,6 +72,37 @@ public:
         }
     }
 
+    /** Accumulate a whole line of n values. When the average is complete avg receives it and true is returned. */
+    bool storeAndGetAvg(T *avg, const T *v, unsigned int n)
+    {
+        if (m_size <= 1)
+        {
+            std::copy(v, v+n, avg);
+            return true;
+        }
+
+        n = n < m_width ? n : m_width;
+
+        for (unsigned int i = 0; i < n; i++) {
+            m_sum[i] += v[i];
+        }
+
+        if (m_avgIndex == m_size - 1)
+        {
+            T inv = 1 / (T) m_size;
+
+            for (unsigned int i = 0; i < n; i++) {
+                avg[i] = m_sum[i] * inv;
+            }
+
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
     bool storeAndGetSum(T& sum, T v, unsigned int index)
     {
         if (m_size <= 1)
@@ -104,11 +104,57 @@ public:
         }
     }
 
-    void nextAverage() {
-        m_avgIndex = m_avgIndex == m_depth-1 ? 0 : m_avgIndex+1;
+    /** Process a whole line of n values in place. v receives the averages. */
+    void storeAndGetAvg(T *v, unsigned int n)
+    {
+        if (m_depth <= 1) {
+            return;
+        }
+
+        n = n < m_width ? n : m_width;
+        T *data = &m_data[m_avgIndex*m_width];
+        T inv = 1 / (T) m_depth;
+
+        for (unsigned int i = 0; i < n; i++)
+        {
+            m_sum[i] += v[i] - data[i];
+            data[i] = v[i];
+            v[i] = m_sum[i] * inv;
+        }
+    }
+
+    void nextAverage()
+    {
+        if (m_avgIndex == m_depth-1)
+        {
+            m_avgIndex = 0;
+            resum(); // prevent rounding errors from accumulating in running sums
+        }
+        else
+        {
+            m_avgIndex++;
+        }
     }
 
 private:
+    void resum()
+    {
+        if (m_depth <= 1) {
+            return;
+        }
+
+        std::fill(m_sum, m_sum+m_width, 0);
+
+        for (unsigned int d = 0; d < m_depth; d++)
+        {
+            T *data = &m_data[d*m_width];
+
+            for (unsigned int i = 0; i < m_width; i++) {
+                m_sum[i] += data[i];
+            }
+        }
+    }
+
     T *m_data;
     T *m_sum;
     unsigned int m_dataSize;
@@ -19,18 +19,23 @@
 #define INCLUDE_UTIL_UDPSINK_H_
 
 #include <stdint.h>
-#include <QObject>
-#include <QUdpSocket>
+#include <string.h>
 #include <QHostAddress>
 
 #include <cassert>
 
+#include "util/udpsinksender.h"
+
+/**
+ * Gathers the samples in blocks of udpSize bytes. The full blocks are queued to a sender
+ * thread (UDPSinkSender) and sent when sendQueued is called e.g. at the end of each feed
+ * so that several datagrams are sent at once.
+ */
 template<typename T>
 class UDPSink
 {
 public:
-	UDPSink(QObject *parent, unsigned int udpSize) :
-		m_udpSize(udpSize),
+	UDPSink(unsigned int udpSize) :
 		m_udpSamples(udpSize/sizeof(T)),
 		m_address(QHostAddress::LocalHost),
 		m_port(9999),
@@ -38,11 +43,10 @@ public:
 	{
         assert(m_udpSamples > 0);
 		m_sampleBuffer = new T[m_udpSamples];
-		m_socket = new QUdpSocket(parent);
+		m_sender = new UDPSinkSender(m_udpSamples*sizeof(T), m_address, m_port);
 	}
 
-    UDPSink(QObject *parent, unsigned int udpSize, unsigned int port) :
-        m_udpSize(udpSize),
+    UDPSink(unsigned int udpSize, unsigned int port) :
         m_udpSamples(udpSize/sizeof(T)),
         m_address(QHostAddress::LocalHost),
         m_port(port),
@@ -50,11 +54,10 @@ public:
     {
         assert(m_udpSamples > 0);
         m_sampleBuffer = new T[m_udpSamples];
-        m_socket = new QUdpSocket(parent);
+        m_sender = new UDPSinkSender(m_udpSamples*sizeof(T), m_address, m_port);
     }
 
-	UDPSink (QObject *parent, unsigned int udpSize, QHostAddress& address, unsigned int port) :
-		m_udpSize(udpSize),
+	UDPSink (unsigned int udpSize, QHostAddress& address, unsigned int port) :
         m_udpSamples(udpSize/sizeof(T)),
 		m_address(address),
 		m_port(port),
@@ -62,27 +65,32 @@ public:
 	{
 		assert(m_udpSamples > 0);
 		m_sampleBuffer = new T[m_udpSamples];
-		m_socket = new QUdpSocket(parent);
+		m_sender = new UDPSinkSender(m_udpSamples*sizeof(T), m_address, m_port);
 	}
 
 	~UDPSink()
 	{
+		delete m_sender;
 		delete[] m_sampleBuffer;
-		delete m_socket;
 	}
 
-	void moveToThread(QThread *thread)
+	void setAddress(QString& address)
 	{
-	    m_socket->moveToThread(thread);
+	    m_address.setAddress(address);
+	    m_sender->setDestination(m_address, m_port);
 	}
 
-	void setAddress(QString& address) { m_address.setAddress(address); }
-	void setPort(unsigned int port) { m_port = port; }
+	void setPort(unsigned int port)
+	{
+	    m_port = port;
+	    m_sender->setDestination(m_address, m_port);
+	}
 
 	void setDestination(const QString& address, int port)
 	{
 	    m_address.setAddress(const_cast<QString&>(address));
 	    m_port = port;
+	    m_sender->setDestination(m_address, m_port);
 	}
 
 	/**
@@ -97,7 +105,7 @@ public:
 		}
 		else
 		{
-			m_socket->writeDatagram((const char*)&m_sampleBuffer[0], (qint64 ) m_udpSize, m_address, m_port);
+			m_sender->push((const char*)&m_sampleBuffer[0]);
 			m_sampleBuffer[0] = sample;
 			m_sampleBufferIndex = 1;
 		}
@@ -106,14 +114,14 @@ public:
 	/**
 	 * Write a bunch of samples
 	 */
-	void write(T *samples, int nbSamples)
+	void write(const T *samples, int nbSamples)
 	{
 	    int samplesIndex = 0;
 
 	    if (m_sampleBufferIndex + nbSamples > m_udpSamples) // fill remainder of buffer and send it
 	    {
 	        memcpy(&m_sampleBuffer[m_sampleBufferIndex], &samples[samplesIndex], (m_udpSamples - m_sampleBufferIndex)*sizeof(T)); // fill remainder of buffer
-	        m_socket->writeDatagram((const char*)&m_sampleBuffer[0], (qint64 ) m_udpSize, m_address, m_port); // send buffer
+	        m_sender->push((const char*)&m_sampleBuffer[0]); // send buffer
             samplesIndex += (m_udpSamples - m_sampleBufferIndex);
             nbSamples -= (m_udpSamples - m_sampleBufferIndex);
 	        m_sampleBufferIndex = 0;
@@ -121,21 +129,29 @@ public:
 
 	    while (nbSamples > m_udpSamples) // send directly from input without buffering
 	    {
-	        m_socket->writeDatagram((const char*)&samples[samplesIndex], (qint64 ) m_udpSize, m_address, m_port);
+	        m_sender->push((const char*)&samples[samplesIndex]);
 	        samplesIndex += m_udpSamples;
 	        nbSamples -= m_udpSamples;
 	    }
 
 	    memcpy(&m_sampleBuffer[m_sampleBufferIndex], &samples[samplesIndex], nbSamples*sizeof(T)); // copy remainder of input to buffer
+	    m_sampleBufferIndex += nbSamples;
+	}
+
+	/**
+	 * Send the full blocks written so far
+	 */
+	void sendQueued()
+	{
+	    m_sender->wakeUp();
 	}
 
 private:
-	int m_udpSize;
     int m_udpSamples;
 	QHostAddress m_address;
 	unsigned int m_port;
-	QUdpSocket *m_socket;
-	T *m_sampleBuffer;;
+	UDPSinkSender *m_sender;
+	T *m_sampleBuffer;
 	int m_sampleBufferIndex;
 };
 
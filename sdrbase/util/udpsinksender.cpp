@@ -0,0 +1,239 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <algorithm>
+
+#include <QUdpSocket>
+#include <QDebug>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include "udpsinksender.h"
+
+UDPSinkSender::UDPSinkSender(unsigned int datagramSize, const QHostAddress& address, quint16 port) :
+    m_datagramSize(datagramSize),
+    m_head(0),
+    m_tail(0),
+    m_nbQueued(0),
+    m_nbDropped(0),
+    m_address(address),
+    m_port(port),
+    m_running(true)
+{
+    m_slots = new char[m_nbSlots * m_datagramSize];
+#ifdef __linux__
+    m_fd = -1;
+    m_sockPort = 0;
+    m_destAddressSize = 0;
+#else
+    m_socket = 0;
+#endif
+    start();
+}
+
+UDPSinkSender::~UDPSinkSender()
+{
+    m_mutex.lock();
+    m_running = false;
+    m_queued.wakeAll();
+    m_mutex.unlock();
+    wait();
+
+    delete[] m_slots;
+}
+
+void UDPSinkSender::setDestination(const QHostAddress& address, quint16 port)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    m_address = address;
+    m_port = port;
+}
+
+void UDPSinkSender::push(const char *datagram)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_nbQueued == m_nbSlots) // the sender does not keep up
+    {
+        if (m_nbDropped++ % 1000 == 0) {
+            qDebug("UDPSinkSender::push: queue full: %u datagrams dropped so far", m_nbDropped);
+        }
+
+        return;
+    }
+
+    memcpy(&m_slots[m_head * m_datagramSize], datagram, m_datagramSize);
+    m_head = (m_head + 1) % m_nbSlots;
+    m_nbQueued++;
+
+    if (m_nbQueued >= m_batchSize) { // do not wait for the flush to send a full batch
+        m_queued.wakeOne();
+    }
+}
+
+void UDPSinkSender::wakeUp()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_nbQueued > 0) {
+        m_queued.wakeOne();
+    }
+}
+
+void UDPSinkSender::run()
+{
+#ifndef __linux__
+    m_socket = new QUdpSocket(); // belongs to this thread
+#endif
+    m_mutex.lock();
+
+    while (m_running)
+    {
+        if (m_nbQueued == 0)
+        {
+            m_queued.wait(&m_mutex);
+            continue;
+        }
+
+        // the slots being sent stay counted as queued so that push does not overwrite them
+        int first = m_tail;
+        int nb = std::min(m_nbQueued, std::min(m_nbSlots - m_tail, m_batchSize));
+        QHostAddress address = m_address;
+        quint16 port = m_port;
+        m_mutex.unlock();
+
+        sendBatch(first, nb, address, port);
+
+        m_mutex.lock();
+        m_tail = (m_tail + nb) % m_nbSlots;
+        m_nbQueued -= nb;
+    }
+
+    m_mutex.unlock();
+#ifdef __linux__
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#else
+    delete m_socket;
+    m_socket = 0;
+#endif
+}
+
+void UDPSinkSender::sendBatch(int first, int nb, const QHostAddress& address, quint16 port)
+{
+#ifdef __linux__
+    if ((m_fd < 0) || (address != m_sockAddress) || (port != m_sockPort))
+    {
+        if (!openSocket(address, port)) {
+            return;
+        }
+    }
+
+    for (int i = 0; i < nb; i++)
+    {
+        m_iovecs[i].iov_base = &m_slots[(first + i) * m_datagramSize];
+        m_iovecs[i].iov_len = m_datagramSize;
+        memset(&m_messages[i], 0, sizeof(struct mmsghdr));
+        m_messages[i].msg_hdr.msg_name = &m_destAddress;
+        m_messages[i].msg_hdr.msg_namelen = m_destAddressSize;
+        m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+        m_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = 0;
+
+    while (sent < nb)
+    {
+        int res = sendmmsg(m_fd, &m_messages[sent], nb - sent, 0);
+
+        if (res < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            qDebug("UDPSinkSender::sendBatch: sendmmsg %s:%u: %s", qPrintable(address.toString()), port, strerror(errno));
+            break;
+        }
+
+        sent += res;
+    }
+#else
+    for (int i = 0; i < nb; i++) {
+        m_socket->writeDatagram(&m_slots[(first + i) * m_datagramSize], (qint64) m_datagramSize, address, port);
+    }
+#endif
+}
+
+#ifdef __linux__
+bool UDPSinkSender::openSocket(const QHostAddress& address, quint16 port)
+{
+    m_destAddressSize = fillAddress(address, port, m_destAddress);
+
+    if ((m_fd >= 0) && (m_sockAddress.protocol() != address.protocol())) // reopen for the other family
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    if (m_fd < 0)
+    {
+        m_fd = socket(m_destAddress.ss_family, SOCK_DGRAM, 0);
+
+        if (m_fd < 0)
+        {
+            qWarning("UDPSinkSender::openSocket: cannot create socket: %s", strerror(errno));
+            return false;
+        }
+    }
+
+    m_sockAddress = address;
+    m_sockPort = port;
+    return true;
+}
+
+socklen_t UDPSinkSender::fillAddress(const QHostAddress& address, quint16 port, struct sockaddr_storage& sockAddress)
+{
+    memset(&sockAddress, 0, sizeof(sockAddress));
+
+    if (address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &sockAddress;
+        Q_IPV6ADDR ipv6 = address.toIPv6Address();
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        memcpy(&sin6->sin6_addr, &ipv6, sizeof(sin6->sin6_addr));
+        return sizeof(struct sockaddr_in6);
+    }
+    else
+    {
+        struct sockaddr_in *sin = (struct sockaddr_in *) &sockAddress;
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(address.toIPv4Address());
+        return sizeof(struct sockaddr_in);
+    }
+}
+#endif
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_UTIL_UDPSINKSENDER_H_
+#define SDRBASE_UTIL_UDPSINKSENDER_H_
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHostAddress>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#include "export.h"
+
+class QUdpSocket;
+
+/**
+ * Sends the datagrams of an UDPSink on its own thread so that the DSP thread that formats
+ * the samples only copies each full datagram in a ring of slots. The queued datagrams are
+ * sent when the sink flushes (sendQueued) or when a batch is pending, several of them per
+ * sendmmsg call on Linux and with a writeDatagram loop elsewhere.
+ *
+ * If the network does not keep up and the ring is full the new datagrams are dropped and
+ * counted. The destination can be changed at any time and applies from the next batch.
+ */
+class SDRBASE_API UDPSinkSender : public QThread
+{
+public:
+    UDPSinkSender(unsigned int datagramSize, const QHostAddress& address, quint16 port);
+    ~UDPSinkSender();
+
+    void setDestination(const QHostAddress& address, quint16 port);
+    /** Queue one datagram of datagramSize bytes */
+    void push(const char *datagram);
+    /** Send the datagrams queued so far */
+    void wakeUp();
+    unsigned int getNbDropped() const { return m_nbDropped; }
+
+private:
+    static const int m_nbSlots = 256;
+    static const int m_batchSize = 64;
+
+    int m_datagramSize;
+    char *m_slots;
+    int m_head;     //!< next slot to write
+    int m_tail;     //!< next slot to send
+    int m_nbQueued; //!< slots written and not sent yet
+    unsigned int m_nbDropped;
+    QHostAddress m_address;
+    quint16 m_port;
+    QMutex m_mutex;
+    QWaitCondition m_queued;
+    volatile bool m_running;
+
+#ifdef __linux__
+    int m_fd;
+    QHostAddress m_sockAddress; //!< destination of the socket
+    quint16 m_sockPort;
+    struct sockaddr_storage m_destAddress;
+    socklen_t m_destAddressSize;
+    struct mmsghdr m_messages[m_batchSize];
+    struct iovec m_iovecs[m_batchSize];
+#else
+    QUdpSocket *m_socket;
+#endif
+
+    void run();
+    void sendBatch(int first, int nb, const QHostAddress& address, quint16 port);
+#ifdef __linux__
+    bool openSocket(const QHostAddress& address, quint16 port);
+    static socklen_t fillAddress(const QHostAddress& address, quint16 port, struct sockaddr_storage& sockAddress);
+#endif
+};
+
+#endif /* SDRBASE_UTIL_UDPSINKSENDER_H_ */
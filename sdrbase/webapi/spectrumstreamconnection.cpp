@@ -0,0 +1,571 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QTcpSocket>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QRegExp>
+#include <QStringList>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <stddef.h>
+#include <string.h>
+
+#include "SWGErrorResponse.h"
+
+#include "dsp/spectrumengine.h"
+#include "spectrumstreamprovider.h"
+#include "spectrumstreamconnection.h"
+
+SpectrumStreamConnection::SpectrumStreamConnection(qintptr socketDescriptor, SpectrumStreamProvider *provider, QObject *parent) :
+    QObject(parent),
+    m_socket(0),
+    m_state(StateRequest),
+    m_pendingState(StateClosed),
+    m_requestPending(false),
+    m_deviceSetIndex(0),
+    m_rate(10),
+    m_nbBins(0),
+    m_decimateMean(false),
+    m_quantized(true),
+    m_autoRange(true),
+    m_minValue(0.0f),
+    m_maxValue(0.0f),
+    m_lastSequence(0),
+    m_sentLines(0),
+    m_droppedLines(0)
+{
+    m_socket = new QTcpSocket(this);
+    m_socket->setSocketDescriptor(socketDescriptor);
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_timer.setTimerType(Qt::PreciseTimer);
+
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(handleRead()));
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(handleDisconnected()));
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(handleTimer()));
+    // the provider lives in the main thread: both ways are queued
+    connect(this, SIGNAL(lineRequested(quintptr, int, bool, bool, float, float, int, bool)),
+            provider, SLOT(requestLine(quintptr, int, bool, bool, float, float, int, bool)));
+    connect(provider, SIGNAL(lineReady(quintptr, bool, QByteArray)),
+            this, SLOT(handleLine(quintptr, bool, QByteArray)));
+
+    qDebug("SpectrumStreamConnection::SpectrumStreamConnection: connection from %s:%d",
+            qPrintable(m_socket->peerAddress().toString()), m_socket->peerPort());
+}
+
+SpectrumStreamConnection::~SpectrumStreamConnection()
+{
+    m_timer.stop();
+    qDebug("SpectrumStreamConnection::~SpectrumStreamConnection: device set %d: sent %llu lines, dropped %llu lines",
+            m_deviceSetIndex, m_sentLines, m_droppedLines);
+}
+
+void SpectrumStreamConnection::handleRead()
+{
+    if (m_state == StateClosed)
+    {
+        m_socket->readAll();
+        return;
+    }
+
+    m_inBuffer.append(m_socket->readAll());
+
+    if (m_state == StatePending) // keep the input until the stream starts
+    {
+        if (m_inBuffer.size() > m_maxRequestSize) {
+            closeStream();
+        }
+
+        return;
+    }
+
+    if (m_state == StateRequest)
+    {
+        int headerEnd = m_inBuffer.indexOf("\r\n\r\n");
+
+        if (headerEnd < 0)
+        {
+            if (m_inBuffer.size() > m_maxRequestSize) {
+                sendHttpError(400, "Bad Request", "Request header too large");
+            }
+
+            return;
+        }
+
+        QByteArray request = m_inBuffer.left(headerEnd);
+        m_inBuffer.remove(0, headerEnd + 4);
+        processRequest(request);
+    }
+
+    if (m_state == StateWebSocket) {
+        processFrames();
+    } else if (m_state == StateChunked) {
+        m_inBuffer.clear(); // nothing expected from the client
+    }
+}
+
+void SpectrumStreamConnection::processRequest(const QByteArray& request)
+{
+    QStringList lines = QString::fromLatin1(request).split("\r\n");
+    QStringList requestLine = lines.at(0).split(' ', QString::SkipEmptyParts);
+
+    if (requestLine.size() < 3)
+    {
+        sendHttpError(400, "Bad Request", "Malformed request line");
+        return;
+    }
+
+    if (requestLine.at(0) != "GET")
+    {
+        sendHttpError(405, "Invalid HTTP method", "Invalid HTTP method");
+        return;
+    }
+
+    QMap<QString, QString> headers;
+
+    for (int i = 1; i < lines.size(); i++)
+    {
+        int colon = lines.at(i).indexOf(':');
+
+        if (colon > 0) {
+            headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+        }
+    }
+
+    QUrl url(requestLine.at(1));
+    QRegExp pathRegex("^/sdrangel/deviceset/([0-9]{1,2})/spectrum/stream$");
+
+    if (!pathRegex.exactMatch(url.path()))
+    {
+        sendHttpError(404, "Not Found", QString("No spectrum stream at %1").arg(url.path()));
+        return;
+    }
+
+    m_deviceSetIndex = pathRegex.cap(1).toInt();
+    QString errorMessage;
+
+    if (!applyParameters(QUrlQuery(url), errorMessage))
+    {
+        sendHttpError(400, "Invalid parameter", errorMessage);
+        return;
+    }
+
+    QByteArray response;
+
+    if (headers.value("upgrade").toLower() == "websocket")
+    {
+        QString key = headers.value("sec-websocket-key");
+
+        if (key.isEmpty())
+        {
+            sendHttpError(400, "Bad Request", "Missing Sec-WebSocket-Key");
+            return;
+        }
+
+        QByteArray accept = QCryptographicHash::hash(
+                (key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11").toLatin1(),
+                QCryptographicHash::Sha1).toBase64();
+        response.append("HTTP/1.1 101 Switching Protocols\r\n");
+        response.append("Upgrade: websocket\r\n");
+        response.append("Connection: Upgrade\r\n");
+        response.append("Sec-WebSocket-Accept: ");
+        response.append(accept);
+        response.append("\r\n\r\n");
+        m_pendingState = StateWebSocket;
+    }
+    else
+    {
+        response.append("HTTP/1.1 200 OK\r\n");
+        response.append("Content-Type: application/octet-stream\r\n");
+        response.append("Transfer-Encoding: chunked\r\n");
+        response.append("Access-Control-Allow-Origin: *\r\n");
+        response.append("Cache-Control: no-cache\r\n\r\n");
+        m_pendingState = StateChunked;
+    }
+
+    // the first line answer tells whether the device set exists
+    m_pendingResponse = response;
+    m_state = StatePending;
+    requestLine();
+}
+
+bool SpectrumStreamConnection::applyParameters(const QUrlQuery& query, QString& errorMessage)
+{
+    bool ok;
+    int rate = m_rate;
+    int nbBins = m_nbBins;
+    bool decimateMean = m_decimateMean;
+    bool quantized = m_quantized;
+    bool autoRange = m_autoRange;
+    float minValue = m_minValue;
+    float maxValue = m_maxValue;
+
+    if (query.hasQueryItem("rate"))
+    {
+        rate = query.queryItemValue("rate").toInt(&ok);
+
+        if (!ok || (rate < 1) || (rate > m_maxRate))
+        {
+            errorMessage = QString("rate must be between 1 and %1 lines per second").arg(m_maxRate);
+            return false;
+        }
+    }
+
+    if (query.hasQueryItem("bins"))
+    {
+        nbBins = query.queryItemValue("bins").toInt(&ok);
+
+        if (!ok || (nbBins < 0))
+        {
+            errorMessage = "bins must be a positive integer or 0 for all bins";
+            return false;
+        }
+    }
+
+    if (query.hasQueryItem("decimation"))
+    {
+        QString decimation = query.queryItemValue("decimation");
+
+        if ((decimation != "max") && (decimation != "mean"))
+        {
+            errorMessage = "decimation must be max or mean";
+            return false;
+        }
+
+        decimateMean = decimation == "mean";
+    }
+
+    if (query.hasQueryItem("format"))
+    {
+        QString format = query.queryItemValue("format");
+
+        if ((format != "uint8") && (format != "float32"))
+        {
+            errorMessage = "format must be uint8 or float32";
+            return false;
+        }
+
+        quantized = format == "uint8";
+    }
+
+    if (query.hasQueryItem("min") || query.hasQueryItem("max"))
+    {
+        bool okMax;
+        minValue = query.queryItemValue("min").toFloat(&ok);
+        maxValue = query.queryItemValue("max").toFloat(&okMax);
+
+        if (!ok || !okMax || (maxValue <= minValue))
+        {
+            errorMessage = "min and max must be given together with min < max";
+            return false;
+        }
+
+        autoRange = false;
+    }
+
+    m_nbBins = nbBins;
+    m_decimateMean = decimateMean;
+    m_quantized = quantized;
+    m_autoRange = autoRange;
+    m_minValue = minValue;
+    m_maxValue = maxValue;
+
+    if (rate != m_rate)
+    {
+        m_rate = rate;
+
+        if (m_timer.isActive()) {
+            m_timer.setInterval(1000 / m_rate);
+        }
+    }
+
+    return true;
+}
+
+void SpectrumStreamConnection::requestLine()
+{
+    m_requestPending = true;
+    emit lineRequested(
+            (quintptr) this,
+            m_deviceSetIndex,
+            m_quantized,
+            m_autoRange,
+            m_minValue,
+            m_maxValue,
+            m_nbBins,
+            m_decimateMean);
+}
+
+void SpectrumStreamConnection::handleTimer()
+{
+    if (m_requestPending) { // main thread is busy: the previous line has not come back yet
+        return;
+    }
+
+    if (m_socket->bytesToWrite() > m_maxPendingBytes)
+    {
+        m_droppedLines++; // client is not keeping up: skip this line rather than queue it
+        return;
+    }
+
+    requestLine();
+}
+
+void SpectrumStreamConnection::handleLine(quintptr requester, bool deviceSetExists, QByteArray line)
+{
+    if (requester != (quintptr) this) { // answer to another connection
+        return;
+    }
+
+    m_requestPending = false;
+
+    if (m_state == StateClosed) {
+        return;
+    }
+
+    if (m_state == StatePending)
+    {
+        if (!deviceSetExists)
+        {
+            sendHttpError(404, "Not Found", QString("There is no spectrum for device set %1").arg(m_deviceSetIndex));
+            return;
+        }
+
+        m_socket->write(m_pendingResponse);
+        m_pendingResponse.clear();
+        m_state = m_pendingState;
+        m_timer.start(1000 / m_rate);
+
+        qDebug("SpectrumStreamConnection::handleLine: %s stream of device set %d at %d lines/s",
+                m_state == StateWebSocket ? "WebSocket" : "chunked HTTP", m_deviceSetIndex, m_rate);
+
+        if (m_state == StateWebSocket) {
+            processFrames(); // frames received while the request was pending
+        } else {
+            m_inBuffer.clear();
+        }
+
+        if (m_state == StateClosed) {
+            return;
+        }
+    }
+
+    if (line.size() >= (int) sizeof(SpectrumEngine::SpectrumHeader))
+    {
+        quint64 sequence;
+        memcpy(&sequence, line.constData() + offsetof(SpectrumEngine::SpectrumHeader, m_sequence), sizeof(sequence));
+
+        if (sequence != m_lastSequence) // do not send the same line twice
+        {
+            m_lastSequence = sequence;
+            sendLine(line);
+            m_sentLines++;
+        }
+    }
+    else if (!deviceSetExists)
+    {
+        qDebug("SpectrumStreamConnection::handleLine: device set %d is gone", m_deviceSetIndex);
+
+        if (m_state == StateWebSocket) {
+            sendClose(1001); // going away
+        }
+
+        closeStream();
+    }
+}
+
+void SpectrumStreamConnection::processFrames()
+{
+    while (m_inBuffer.size() >= 2)
+    {
+        const unsigned char *data = (const unsigned char *) m_inBuffer.constData();
+        quint8 opcode = data[0] & 0x0f;
+        bool masked = (data[1] & 0x80) != 0;
+        quint64 payloadSize = data[1] & 0x7f;
+        int pos = 2;
+
+        if (payloadSize == 126)
+        {
+            if (m_inBuffer.size() < 4) {
+                return;
+            }
+
+            payloadSize = (data[2] << 8) | data[3];
+            pos = 4;
+        }
+        else if (payloadSize == 127)
+        {
+            if (m_inBuffer.size() < 10) {
+                return;
+            }
+
+            payloadSize = 0;
+
+            for (int i = 2; i < 10; i++) {
+                payloadSize = (payloadSize << 8) | data[i];
+            }
+
+            pos = 10;
+        }
+
+        if (!masked) // client frames must be masked
+        {
+            sendClose(1002);
+            closeStream();
+            return;
+        }
+
+        if (payloadSize > (quint64) m_maxFrameSize)
+        {
+            sendClose(1009);
+            closeStream();
+            return;
+        }
+
+        if ((quint64) m_inBuffer.size() < pos + 4 + payloadSize) {
+            return; // wait for the rest of the frame
+        }
+
+        const unsigned char *mask = &data[pos];
+        QByteArray payload(m_inBuffer.constData() + pos + 4, payloadSize);
+
+        for (int i = 0; i < payload.size(); i++) {
+            payload[i] = payload[i] ^ mask[i % 4];
+        }
+
+        m_inBuffer.remove(0, pos + 4 + payloadSize);
+
+        if (opcode == 0x1) // text: new stream parameters as a query string
+        {
+            QString errorMessage;
+
+            if (!applyParameters(QUrlQuery(QString::fromUtf8(payload)), errorMessage)) {
+                sendFrame(0x1, errorMessage.toUtf8());
+            }
+        }
+        else if (opcode == 0x8) // close
+        {
+            sendClose(1000);
+            closeStream();
+            return;
+        }
+        else if (opcode == 0x9) // ping
+        {
+            sendFrame(0xA, payload);
+        }
+    }
+}
+
+void SpectrumStreamConnection::sendFrame(quint8 opcode, const QByteArray& payload)
+{
+    QByteArray frame;
+    quint64 payloadSize = payload.size();
+    frame.append((char) (0x80 | opcode)); // FIN
+
+    if (payloadSize < 126)
+    {
+        frame.append((char) payloadSize);
+    }
+    else if (payloadSize < 65536)
+    {
+        frame.append((char) 126);
+        frame.append((char) ((payloadSize >> 8) & 0xff));
+        frame.append((char) (payloadSize & 0xff));
+    }
+    else
+    {
+        frame.append((char) 127);
+
+        for (int i = 7; i >= 0; i--) {
+            frame.append((char) ((payloadSize >> (8*i)) & 0xff));
+        }
+    }
+
+    frame.append(payload);
+    m_socket->write(frame);
+}
+
+void SpectrumStreamConnection::sendClose(quint16 code)
+{
+    QByteArray payload;
+    payload.append((char) ((code >> 8) & 0xff));
+    payload.append((char) (code & 0xff));
+    sendFrame(0x8, payload);
+}
+
+void SpectrumStreamConnection::sendLine(const QByteArray& line)
+{
+    if (m_state == StateWebSocket)
+    {
+        sendFrame(0x2, line);
+    }
+    else
+    {
+        m_socket->write(QByteArray::number(line.size(), 16));
+        m_socket->write("\r\n");
+        m_socket->write(line);
+        m_socket->write("\r\n");
+    }
+}
+
+void SpectrumStreamConnection::sendHttpError(int status, const QByteArray& statusText, const QString& message)
+{
+    SWGSDRangel::SWGErrorResponse errorResponse;
+    errorResponse.init();
+    *errorResponse.getMessage() = message;
+    QByteArray body = errorResponse.asJson().toUtf8();
+
+    QByteArray response;
+    response.append("HTTP/1.1 ");
+    response.append(QByteArray::number(status));
+    response.append(' ');
+    response.append(statusText);
+    response.append("\r\nContent-Type: application/json\r\n");
+    response.append("Access-Control-Allow-Origin: *\r\n");
+    response.append("Connection: close\r\n");
+    response.append("Content-Length: ");
+    response.append(QByteArray::number(body.size()));
+    response.append("\r\n\r\n");
+    response.append(body);
+    m_socket->write(response);
+
+    closeStream();
+}
+
+void SpectrumStreamConnection::closeStream()
+{
+    m_timer.stop();
+
+    if (m_state == StateChunked) {
+        m_socket->write("0\r\n\r\n");
+    }
+
+    m_state = StateClosed;
+    m_inBuffer.clear();
+
+    if (m_socket->state() == QAbstractSocket::UnconnectedState) {
+        deleteLater();
+    } else {
+        m_socket->disconnectFromHost(); // pending data is written first
+    }
+}
+
+void SpectrumStreamConnection::handleDisconnected()
+{
+    m_timer.stop();
+    deleteLater();
+}
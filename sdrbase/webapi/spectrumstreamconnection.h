@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_WEBAPI_SPECTRUMSTREAMCONNECTION_H_
+#define SDRBASE_WEBAPI_SPECTRUMSTREAMCONNECTION_H_
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QMap>
+
+class QTcpSocket;
+class QUrlQuery;
+class SpectrumStreamProvider;
+
+/**
+ * One client of the SpectrumStreamServer. It parses the HTTP request, upgrades to WebSocket when
+ * asked to (RFC 6455 server side: unmasked outgoing frames, masked incoming frames) or else answers
+ * with a chunked HTTP response, then sends the latest spectrum line of the device set at the
+ * requested rate. Lines are dropped rather than queued when the client does not keep up.
+ * Lines are obtained from the SpectrumStreamProvider in the main thread one request at a time.
+ */
+class SpectrumStreamConnection : public QObject
+{
+    Q_OBJECT
+public:
+    SpectrumStreamConnection(qintptr socketDescriptor, SpectrumStreamProvider *provider, QObject *parent);
+    ~SpectrumStreamConnection();
+
+private:
+    enum State
+    {
+        StateRequest,   //!< waiting for the complete HTTP request header
+        StatePending,   //!< request accepted, waiting for the provider to confirm the device set
+        StateWebSocket, //!< streaming binary WebSocket messages
+        StateChunked,   //!< streaming HTTP chunks
+        StateClosed     //!< closing, waiting for disconnection
+    };
+
+    QTcpSocket *m_socket;
+    QTimer m_timer;
+    State m_state;
+    QByteArray m_inBuffer;
+    QByteArray m_pendingResponse; //!< response header sent once the device set is confirmed
+    State m_pendingState;         //!< streaming state entered once the device set is confirmed
+    bool m_requestPending;        //!< a line request to the provider is not answered yet
+
+    int m_deviceSetIndex;
+    int m_rate;          //!< lines per second
+    int m_nbBins;        //!< maximum number of bins (0 for all)
+    bool m_decimateMean;
+    bool m_quantized;
+    bool m_autoRange;
+    float m_minValue;
+    float m_maxValue;
+
+    quint64 m_lastSequence;
+    quint64 m_sentLines;
+    quint64 m_droppedLines;
+
+    static const int m_maxRequestSize = 8192;
+    static const int m_maxFrameSize = 4096;
+    static const int m_maxRate = 50;
+    static const qint64 m_maxPendingBytes = 1<<18;
+
+    void processRequest(const QByteArray& request);
+    void processFrames();
+    bool applyParameters(const QUrlQuery& query, QString& errorMessage);
+    void sendHttpError(int status, const QByteArray& statusText, const QString& message);
+    void sendFrame(quint8 opcode, const QByteArray& payload);
+    void sendClose(quint16 code);
+    void sendLine(const QByteArray& line);
+    void requestLine();
+    void closeStream();
+
+signals:
+    void lineRequested(
+            quintptr requester,
+            int deviceSetIndex,
+            bool quantized,
+            bool autoRange,
+            float minValue,
+            float maxValue,
+            int nbBins,
+            bool decimateMean);
+
+private slots:
+    void handleRead();
+    void handleTimer();
+    void handleLine(quintptr requester, bool deviceSetExists, QByteArray line);
+    void handleDisconnected();
+};
+
+#endif /* SDRBASE_WEBAPI_SPECTRUMSTREAMCONNECTION_H_ */
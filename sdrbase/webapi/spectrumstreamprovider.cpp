@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QMetaType>
+
+#include "SWGErrorResponse.h"
+#include "SWGSpectrumSettings.h"
+
+#include "webapiadapterinterface.h"
+#include "spectrumstreamprovider.h"
+
+SpectrumStreamProvider::SpectrumStreamProvider(WebAPIAdapterInterface *adapter) :
+    QObject(),
+    m_adapter(adapter)
+{
+    qRegisterMetaType<quintptr>("quintptr");
+}
+
+SpectrumStreamProvider::~SpectrumStreamProvider()
+{
+}
+
+void SpectrumStreamProvider::requestLine(
+        quintptr requester,
+        int deviceSetIndex,
+        bool quantized,
+        bool autoRange,
+        float minValue,
+        float maxValue,
+        int nbBins,
+        bool decimateMean)
+{
+    QByteArray line;
+    SWGSDRangel::SWGErrorResponse error;
+    int status = m_adapter->devicesetSpectrumGet(
+            deviceSetIndex,
+            quantized,
+            autoRange,
+            minValue,
+            maxValue,
+            nbBins,
+            decimateMean,
+            line,
+            error);
+
+    if (status/100 == 2)
+    {
+        emit lineReady(requester, true, line);
+    }
+    else
+    {
+        // no line yet or no such device set
+        SWGSDRangel::SWGSpectrumSettings settings;
+        bool deviceSetExists = m_adapter->devicesetSpectrumSettingsGet(deviceSetIndex, settings, error)/100 == 2;
+        emit lineReady(requester, deviceSetExists, QByteArray());
+    }
+}
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_WEBAPI_SPECTRUMSTREAMPROVIDER_H_
+#define SDRBASE_WEBAPI_SPECTRUMSTREAMPROVIDER_H_
+
+#include <QObject>
+#include <QByteArray>
+
+class WebAPIAdapterInterface;
+
+/**
+ * Gets spectrum lines from the web API adapter on behalf of the SpectrumStreamConnection objects.
+ * It lives in the main thread where device sets are added and removed so the adapter is never
+ * called from the stream server thread. Requests and answers go through queued signals so neither
+ * thread waits for the other. The answer carries the requester so that each connection only
+ * picks up its own lines.
+ */
+class SpectrumStreamProvider : public QObject
+{
+    Q_OBJECT
+public:
+    SpectrumStreamProvider(WebAPIAdapterInterface *adapter);
+    ~SpectrumStreamProvider();
+
+signals:
+    void lineReady(quintptr requester, bool deviceSetExists, QByteArray line); //!< line is empty when no spectrum is available
+
+public slots:
+    void requestLine(
+            quintptr requester,
+            int deviceSetIndex,
+            bool quantized,
+            bool autoRange,
+            float minValue,
+            float maxValue,
+            int nbBins,
+            bool decimateMean);
+
+private:
+    WebAPIAdapterInterface *m_adapter;
+};
+
+#endif /* SDRBASE_WEBAPI_SPECTRUMSTREAMPROVIDER_H_ */
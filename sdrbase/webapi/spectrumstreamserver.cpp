@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QHostAddress>
+#include <QDebug>
+
+#include "spectrumstreamconnection.h"
+#include "spectrumstreamprovider.h"
+#include "spectrumstreamserver.h"
+
+SpectrumStreamServer::SpectrumStreamServer(const QString& host, uint16_t port, WebAPIAdapterInterface *adapter) :
+    QTcpServer(),
+    m_host(host),
+    m_port(port),
+    m_provider(0),
+    m_running(false)
+{
+    m_provider = new SpectrumStreamProvider(adapter);
+    moveToThread(&m_thread);
+}
+
+SpectrumStreamServer::~SpectrumStreamServer()
+{
+    stop();
+    delete m_provider;
+}
+
+void SpectrumStreamServer::start()
+{
+    if (!m_running)
+    {
+        m_thread.start();
+        QMetaObject::invokeMethod(this, "listenOnThread", Qt::QueuedConnection);
+        m_running = true;
+    }
+}
+
+void SpectrumStreamServer::stop()
+{
+    if (m_running)
+    {
+        QMetaObject::invokeMethod(this, "closeOnThread", Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+        m_running = false;
+        qInfo("SpectrumStreamServer::stop: stopped spectrum stream server at %s:%d", qPrintable(m_host), m_port);
+    }
+}
+
+void SpectrumStreamServer::listenOnThread()
+{
+    if (listen(QHostAddress(m_host), m_port)) {
+        qInfo("SpectrumStreamServer::listenOnThread: streaming spectrum at ws://%s:%d", qPrintable(m_host), m_port);
+    } else {
+        qCritical("SpectrumStreamServer::listenOnThread: cannot bind on %s:%d: %s", qPrintable(m_host), m_port, qPrintable(errorString()));
+    }
+}
+
+void SpectrumStreamServer::closeOnThread()
+{
+    close();
+    QList<SpectrumStreamConnection*> connections = findChildren<SpectrumStreamConnection*>();
+
+    foreach (SpectrumStreamConnection *connection, connections) {
+        delete connection;
+    }
+}
+
+void SpectrumStreamServer::incomingConnection(qintptr socketDescriptor)
+{
+    // the connection lives in this thread and is deleted when its socket disconnects
+    new SpectrumStreamConnection(socketDescriptor, m_provider, this);
+}
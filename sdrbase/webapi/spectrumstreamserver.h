@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 F4EXB                                                      //
+// written by Edouard Griffiths                                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_WEBAPI_SPECTRUMSTREAMSERVER_H_
+#define SDRBASE_WEBAPI_SPECTRUMSTREAMSERVER_H_
+
+#include <QTcpServer>
+#include <QThread>
+#include <QString>
+#include <stdint.h>
+
+#include "export.h"
+
+class WebAPIAdapterInterface;
+class SpectrumStreamProvider;
+
+/**
+ * Pushes spectrum lines of device sets to remote clients. It listens on its own port next
+ * to the web API server and runs in its own thread. Clients open:
+ *
+ *   /sdrangel/deviceset/{deviceSetIndex}/spectrum/stream?rate=&bins=&decimation=&format=&min=&max=
+ *
+ * either as a WebSocket (one binary message per line) or as a plain HTTP GET answered with a
+ * chunked response (one chunk per line). Lines have the same binary layout as the
+ * /sdrangel/deviceset/{deviceSetIndex}/spectrum REST answer. A WebSocket client can change the
+ * stream parameters at any time by sending a text message with a new query string.
+ */
+class SDRBASE_API SpectrumStreamServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    SpectrumStreamServer(const QString& host, uint16_t port, WebAPIAdapterInterface *adapter);
+    ~SpectrumStreamServer();
+
+    void start();
+    void stop();
+
+    const QString& getHost() const { return m_host; }
+    int getPort() const { return m_port; }
+
+protected:
+    virtual void incomingConnection(qintptr socketDescriptor);
+
+private:
+    QString m_host;
+    uint16_t m_port;
+    SpectrumStreamProvider *m_provider; //!< lives in the constructing (main) thread
+    QThread m_thread;
+    bool m_running;
+
+private slots:
+    void listenOnThread();
+    void closeOnThread();
+};
+
+#endif /* SDRBASE_WEBAPI_SPECTRUMSTREAMSERVER_H_ */
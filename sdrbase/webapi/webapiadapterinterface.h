@@ -20,6 +20,7 @@
 #define SDRBASE_WEBAPI_WEBAPIADAPTERINTERFACE_H_
 
 #include <QString>
+#include <QByteArray>
 #include <regex>
 
 #include "SWGErrorResponse.h"
@@ -52,6 +53,7 @@ namespace SWGSDRangel
     class SWGChannelSettings;
     class SWGChannelReport;
     class SWGSuccessResponse;
+    class SWGSpectrumSettings;
 }
 
 class SDRBASE_API WebAPIAdapterInterface
@@ -643,6 +645,57 @@ public:
         return 501;
     }
 
+    /**
+     * Handler of /sdrangel/deviceset/{devicesetIndex}/spectrum (GET)
+     * Returns the latest power spectrum of the device set in compact binary form (see SpectrumEngine::serializeSpectrum)
+     * returns the Http status code (default 501: not implemented)
+     */
+    virtual int devicesetSpectrumGet(
+            int deviceSetIndex __attribute__((unused)),
+            bool quantized __attribute__((unused)),   //!< true for uint8 values else float32
+            bool autoRange __attribute__((unused)),   //!< quantisation range from the line minimum and maximum
+            float minValue __attribute__((unused)),   //!< quantisation range lower bound
+            float maxValue __attribute__((unused)),   //!< quantisation range upper bound
+            int nbBins __attribute__((unused)),       //!< maximum number of bins or 0 for all bins
+            bool decimateMean __attribute__((unused)), //!< average merged bins instead of keeping their maximum
+            QByteArray& response __attribute__((unused)),
+            SWGSDRangel::SWGErrorResponse& error)
+    {
+        error.init();
+        *error.getMessage() = QString("Function not implemented");
+        return 501;
+    }
+
+    /**
+     * Handler of /sdrangel/deviceset/{devicesetIndex}/spectrum/settings (GET)
+     * returns the Http status code (default 501: not implemented)
+     */
+    virtual int devicesetSpectrumSettingsGet(
+            int deviceSetIndex __attribute__((unused)),
+            SWGSDRangel::SWGSpectrumSettings& response __attribute__((unused)),
+            SWGSDRangel::SWGErrorResponse& error)
+    {
+        error.init();
+        *error.getMessage() = QString("Function not implemented");
+        return 501;
+    }
+
+    /**
+     * Handler of /sdrangel/deviceset/{devicesetIndex}/spectrum/settings (PUT, PATCH)
+     * returns the Http status code (default 501: not implemented)
+     */
+    virtual int devicesetSpectrumSettingsPutPatch(
+            int deviceSetIndex __attribute__((unused)),
+            bool force __attribute__((unused)), //!< true to force settings = put else patch
+            const QStringList& spectrumSettingsKeys __attribute__((unused)),
+            SWGSDRangel::SWGSpectrumSettings& response __attribute__((unused)),
+            SWGSDRangel::SWGErrorResponse& error)
+    {
+        error.init();
+        *error.getMessage() = QString("Function not implemented");
+        return 501;
+    }
+
     static QString instanceSummaryURL;
     static QString instanceDevicesURL;
     static QString instanceChannelsURL;
@@ -670,6 +723,8 @@ public:
     static std::regex devicesetChannelSettingsURLRe;
     static std::regex devicesetChannelReportURLRe;
     static std::regex devicesetChannelsReportURLRe;
+    static std::regex devicesetSpectrumURLRe;
+    static std::regex devicesetSpectrumSettingsURLRe;
 };
 
 
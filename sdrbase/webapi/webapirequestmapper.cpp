@@ -42,6 +42,7 @@
 #include "SWGChannelsDetail.h"
 #include "SWGChannelSettings.h"
 #include "SWGChannelReport.h"
+#include "SWGSpectrumSettings.h"
 #include "SWGSuccessResponse.h"
 #include "SWGErrorResponse.h"
 
@@ -147,6 +148,10 @@ void WebAPIRequestMapper::service(qtwebapp::HttpRequest& request, qtwebapp::Http
                 devicesetChannelSettingsService(std::string(desc_match[1]), std::string(desc_match[2]), request, response);
             } else if (std::regex_match(pathStr, desc_match, WebAPIAdapterInterface::devicesetChannelReportURLRe)) {
                 devicesetChannelReportService(std::string(desc_match[1]), std::string(desc_match[2]), request, response);
+            } else if (std::regex_match(pathStr, desc_match, WebAPIAdapterInterface::devicesetSpectrumURLRe)) {
+                devicesetSpectrumService(std::string(desc_match[1]), request, response);
+            } else if (std::regex_match(pathStr, desc_match, WebAPIAdapterInterface::devicesetSpectrumSettingsURLRe)) {
+                devicesetSpectrumSettingsService(std::string(desc_match[1]), request, response);
             }
             else // serve static documentation pages
             {
@@ -1616,6 +1621,152 @@ void WebAPIRequestMapper::devicesetChannelReportService(
     }
 }
 
+void WebAPIRequestMapper::devicesetSpectrumService(const std::string& indexStr, qtwebapp::HttpRequest& request, qtwebapp::HttpResponse& response)
+{
+    SWGSDRangel::SWGErrorResponse errorResponse;
+    response.setHeader("Access-Control-Allow-Origin", "*");
+
+    if (request.getMethod() == "GET")
+    {
+        try
+        {
+            int deviceSetIndex = boost::lexical_cast<int>(indexStr);
+            QByteArray formatStr = request.getParameter("format");
+            QByteArray minStr = request.getParameter("min");
+            QByteArray maxStr = request.getParameter("max");
+            QByteArray binsStr = request.getParameter("bins");
+            QByteArray decimationStr = request.getParameter("decimation");
+            bool quantized = (formatStr == "uint8");
+            bool autoRange = minStr.isEmpty() || maxStr.isEmpty();
+            float minValue = autoRange ? 0.0f : minStr.toFloat();
+            float maxValue = autoRange ? 0.0f : maxStr.toFloat();
+            int nbBins = binsStr.isEmpty() ? 0 : binsStr.toInt();
+            bool decimateMean = (decimationStr == "mean");
+
+            if (!formatStr.isEmpty() && !quantized && (formatStr != "float32"))
+            {
+                response.setHeader("Content-Type", "application/json");
+                response.setStatus(400,"Invalid format");
+                errorResponse.init();
+                *errorResponse.getMessage() = "Invalid format. Use float32 or uint8";
+                response.write(errorResponse.asJson().toUtf8());
+                return;
+            }
+
+            QByteArray spectrum;
+            int status = m_adapter->devicesetSpectrumGet(
+                    deviceSetIndex,
+                    quantized,
+                    autoRange,
+                    minValue,
+                    maxValue,
+                    nbBins,
+                    decimateMean,
+                    spectrum,
+                    errorResponse);
+            response.setStatus(status);
+
+            if (status/100 == 2)
+            {
+                response.setHeader("Content-Type", "application/octet-stream");
+                response.write(spectrum);
+            }
+            else
+            {
+                response.setHeader("Content-Type", "application/json");
+                response.write(errorResponse.asJson().toUtf8());
+            }
+        }
+        catch (const boost::bad_lexical_cast &e)
+        {
+            response.setHeader("Content-Type", "application/json");
+            errorResponse.init();
+            *errorResponse.getMessage() = "Wrong integer conversion on device set index";
+            response.setStatus(400,"Invalid data");
+            response.write(errorResponse.asJson().toUtf8());
+        }
+    }
+    else
+    {
+        response.setHeader("Content-Type", "application/json");
+        response.setStatus(405,"Invalid HTTP method");
+        errorResponse.init();
+        *errorResponse.getMessage() = "Invalid HTTP method";
+        response.write(errorResponse.asJson().toUtf8());
+    }
+}
+
+void WebAPIRequestMapper::devicesetSpectrumSettingsService(const std::string& indexStr, qtwebapp::HttpRequest& request, qtwebapp::HttpResponse& response)
+{
+    SWGSDRangel::SWGErrorResponse errorResponse;
+    response.setHeader("Content-Type", "application/json");
+    response.setHeader("Access-Control-Allow-Origin", "*");
+
+    try
+    {
+        int deviceSetIndex = boost::lexical_cast<int>(indexStr);
+
+        if (request.getMethod() == "GET")
+        {
+            SWGSDRangel::SWGSpectrumSettings normalResponse;
+            int status = m_adapter->devicesetSpectrumSettingsGet(deviceSetIndex, normalResponse, errorResponse);
+            response.setStatus(status);
+
+            if (status/100 == 2) {
+                response.write(normalResponse.asJson().toUtf8());
+            } else {
+                response.write(errorResponse.asJson().toUtf8());
+            }
+        }
+        else if ((request.getMethod() == "PUT") || (request.getMethod() == "PATCH"))
+        {
+            QString jsonStr = request.getBody();
+            QJsonObject jsonObject;
+
+            if (parseJsonBody(jsonStr, jsonObject, response))
+            {
+                SWGSDRangel::SWGSpectrumSettings normalResponse;
+                QStringList spectrumSettingsKeys = jsonObject.keys();
+                normalResponse.fromJsonObject(jsonObject);
+                int status = m_adapter->devicesetSpectrumSettingsPutPatch(
+                        deviceSetIndex,
+                        (request.getMethod() == "PUT"), // force settings on PUT
+                        spectrumSettingsKeys,
+                        normalResponse,
+                        errorResponse);
+                response.setStatus(status);
+
+                if (status/100 == 2) {
+                    response.write(normalResponse.asJson().toUtf8());
+                } else {
+                    response.write(errorResponse.asJson().toUtf8());
+                }
+            }
+            else
+            {
+                response.setStatus(400,"Invalid JSON format");
+                errorResponse.init();
+                *errorResponse.getMessage() = "Invalid JSON format";
+                response.write(errorResponse.asJson().toUtf8());
+            }
+        }
+        else
+        {
+            response.setStatus(405,"Invalid HTTP method");
+            errorResponse.init();
+            *errorResponse.getMessage() = "Invalid HTTP method";
+            response.write(errorResponse.asJson().toUtf8());
+        }
+    }
+    catch (const boost::bad_lexical_cast &e)
+    {
+        errorResponse.init();
+        *errorResponse.getMessage() = "Wrong integer conversion on device set index";
+        response.setStatus(400,"Invalid data");
+        response.write(errorResponse.asJson().toUtf8());
+    }
+}
+
 bool WebAPIRequestMapper::parseJsonBody(QString& jsonStr, QJsonObject& jsonObject, qtwebapp::HttpResponse& response)
 {
     SWGSDRangel::SWGErrorResponse errorResponse;
@@ -18,7 +18,14 @@
 
 #include <QDebug>
 #include <QElapsedTimer>
-
+#include <cmath>
+#include <cstdlib>
+#include <string.h>
+#include <algorithm>
+
+#include "dsp/spectrumkernels.h"
+#include "dsp/filerecordcodec.h"
+#include "dsp/iqconverters.h"
 #include "mainbench.h"
 
 MainBench *MainBench::m_instance = 0;
@@ -59,6 +66,14 @@ void MainBench::run()
         testDecimateFI();
     } else if (m_parser.getTestType() == ParserBench::TestDecimatorsFF) {
         testDecimateFF();
+    } else if (m_parser.getTestType() == ParserBench::TestSpectrumKernels) {
+        testSpectrumKernels();
+    } else if (m_parser.getTestType() == ParserBench::TestRecordCodec) {
+        testRecordCodec();
+    } else if (m_parser.getTestType() == ParserBench::TestIQPacker) {
+        testIQPacker();
+    } else if (m_parser.getTestType() == ParserBench::TestIQConverters) {
+        testIQConverters();
     } else {
         qDebug() << "MainBench::run: unknown test type: " << m_parser.getTestType();
     }
@@ -190,6 +205,335 @@ void MainBench::testDecimateFF()
     delete[] buf;
 }
 
+void MainBench::testSpectrumKernels()
+{
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    unsigned int fftSize = 1024 << m_parser.getLog2Factor(); // 1k to 64k bins
+    unsigned int nbLines = m_parser.getNbSamples() / fftSize;
+    nbLines = nbLines == 0 ? 1 : nbLines;
+
+    qDebug() << "MainBench::testSpectrumKernels: create test data: FFT size:" << fftSize << "lines:" << nbLines;
+
+    std::vector<Complex> fftOut(fftSize);
+    std::vector<float> line(fftSize);
+    auto my_rand = std::bind(m_uniform_distribution_f, m_generator);
+
+    for (unsigned int i = 0; i < fftSize; i++) {
+        fftOut[i] = Complex(my_rand(), my_rand());
+    }
+
+    m_movingAverage.resize(fftSize, 10);
+
+    qDebug() << "MainBench::testSpectrumKernels: run test";
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+
+        for (unsigned int l = 0; l < nbLines; l++) {
+            spectrumLine(fftOut.data(), line.data(), fftSize);
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testSpectrumKernels", nsecs);
+}
+
+void MainBench::testRecordCodec()
+{
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    FileRecordCodec::Codec codecType = (FileRecordCodec::Codec) (FileRecordCodec::CodecLossless + (m_parser.getLog2Factor() % 3));
+    unsigned int nbSamples = m_parser.getNbSamples();
+
+    qDebug() << "MainBench::testRecordCodec: create test data: codec:" << FileRecordCodec::getName(codecType);
+
+    // a tone over 12 bit noise in 16 bit samples
+    std::vector<qint16> buf(2*nbSamples);
+    std::vector<qint16> decoded(2*nbSamples);
+    auto my_rand = std::bind(m_uniform_distribution_s16, m_generator);
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        buf[2*i]   = 16000.0 * cos(0.01 * i) + my_rand();
+        buf[2*i+1] = 16000.0 * sin(0.01 * i) + my_rand();
+    }
+
+    FileRecordCodec codec;
+    std::vector<char> encoded;
+    FileRecordCodec::BlockHeader header;
+    bool ok = true;
+
+    qDebug() << "MainBench::testRecordCodec: run test";
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+        codec.init(codecType, 2*sizeof(qint16), 0);
+        codec.encode((const char *) buf.data(), buf.size()*sizeof(qint16), encoded);
+        memcpy(&header, encoded.data(), sizeof(header));
+        ok &= FileRecordCodec::decode(header, encoded.data() + sizeof(header), 2*sizeof(qint16), (char *) decoded.data());
+        nsecs += timer.nsecsElapsed();
+    }
+
+    int maxError = 0;
+
+    for (unsigned int i = 0; i < 2*nbSamples; i++) {
+        maxError = std::max(maxError, std::abs(buf[i] - decoded[i]));
+    }
+
+    qDebug() << "MainBench::testRecordCodec: decoded:" << ok
+        << "ratio:" << (double) (buf.size()*sizeof(qint16)) / encoded.size()
+        << "max error:" << maxError;
+    printResults("MainBench::testRecordCodec", nsecs);
+}
+
+void MainBench::testIQPacker()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    const unsigned int maxBlockSize = 1024;
+
+    qDebug() << "MainBench::testIQPacker: create test data";
+
+    std::vector<Sample> samples;
+    std::vector<Sample> unpacked(nbSamples);
+    std::vector<Sample> reference(nbSamples);
+    std::vector<unsigned int> blockSizes;
+    createIQBlocks(samples, blockSizes, maxBlockSize);
+
+    unsigned int packedSize = 0;
+
+    for (int e = 0; e < IQPacker::EncodingEnd; e++) {
+        packedSize = std::max(packedSize, IQPacker::getPackedSize((IQPacker::Encoding) e, maxBlockSize));
+    }
+
+    std::vector<uint8_t> packed(packedSize);
+
+    qDebug() << "MainBench::testIQPacker: run test on" << blockSizes.size() << "blocks";
+
+    for (int e = 0; e < IQPacker::EncodingEnd; e++)
+    {
+        IQPacker::Encoding encoding = (IQPacker::Encoding) e;
+        qint64 nsecs = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            const Sample *in = samples.data();
+            Sample *out = unpacked.data();
+            timer.start();
+
+            for (unsigned int size : blockSizes)
+            {
+                IQPacker::pack(encoding, in, packed.data(), size, SDR_RX_SAMP_SZ);
+                IQPacker::unpack(encoding, packed.data(), out, size, SDR_RX_SAMP_SZ);
+                in += size;
+                out += size;
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        iqPackerReference(encoding, samples.data(), reference.data(), blockSizes);
+        const FixReal *pin = reinterpret_cast<const FixReal*>(samples.data());
+        const FixReal *pout = reinterpret_cast<const FixReal*>(unpacked.data());
+        const FixReal *pref = reinterpret_cast<const FixReal*>(reference.data());
+        int maxError = 0;
+        int maxQuantization = 0;
+
+        for (unsigned int i = 0; i < 2*nbSamples; i++)
+        {
+            maxError = std::max(maxError, std::abs(pout[i] - pref[i]));
+            maxQuantization = std::max(maxQuantization, std::abs(pout[i] - pin[i]));
+        }
+
+        qDebug() << "MainBench::testIQPacker:" << IQPacker::getName(encoding)
+            << "max error:" << maxError
+            << "max quantization error:" << maxQuantization;
+        printResults(QString("MainBench::testIQPacker: %1").arg(IQPacker::getName(encoding)), nsecs);
+    }
+}
+
+void MainBench::iqPackerReference(IQPacker::Encoding encoding, const Sample *in, Sample *out, const std::vector<unsigned int>& blockSizes)
+{
+    const FixReal *pin = reinterpret_cast<const FixReal*>(in);
+    FixReal *pout = reinterpret_cast<FixReal*>(out);
+    const int groupSize = 2*IQPacker::m_bfpGroupSize;
+    int bits = encoding == IQPacker::Encoding8 ? 8 : encoding == IQPacker::Encoding12 ? 12 : 16;
+
+    for (unsigned int size : blockSizes)
+    {
+        int nbValues = 2*size;
+
+        if ((encoding == IQPacker::Encoding24) || ((encoding != IQPacker::EncodingBFP8) && (bits >= SDR_RX_SAMP_SZ)))
+        {
+            std::copy(pin, pin + nbValues, pout);
+        }
+        else if (encoding != IQPacker::EncodingBFP8)
+        {
+            for (int i = 0; i < nbValues; i++) {
+                pout[i] = (pin[i] >> (SDR_RX_SAMP_SZ - bits)) << (SDR_RX_SAMP_SZ - bits);
+            }
+        }
+        else
+        {
+            // groups start again at each block with the last one possibly partial
+            for (int ig = 0; ig < nbValues; ig += groupSize)
+            {
+                int n = std::min(groupSize, nbValues - ig);
+                int32_t mag = 0;
+
+                for (int i = ig; i < ig + n; i++)
+                {
+                    int32_t w = pin[i] << (24 - SDR_RX_SAMP_SZ);
+                    mag = std::max(mag, w < 0 ? ~w : w);
+                }
+
+                int shift = 0;
+
+                while ((mag >> shift) > 127) {
+                    shift++;
+                }
+
+                for (int i = ig; i < ig + n; i++)
+                {
+                    int32_t m = ((pin[i] << (24 - SDR_RX_SAMP_SZ)) + (shift ? 1 << (shift - 1) : 0)) >> shift;
+                    pout[i] = (std::min(m, 127) << std::min(shift, 16)) >> (24 - SDR_RX_SAMP_SZ);
+                }
+            }
+        }
+
+        pin += nbValues;
+        pout += nbValues;
+    }
+}
+
+void MainBench::testIQConverters()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    const char *formatNames[] = {"CU8", "CS8", "CS16", "CF32"};
+
+    qDebug() << "MainBench::testIQConverters: create test data";
+
+    std::vector<Sample> samples;
+    std::vector<Sample> decoded(nbSamples);
+    std::vector<unsigned int> blockSizes;
+    createIQBlocks(samples, blockSizes, 1024);
+    std::vector<uint8_t> cu8(2*nbSamples);
+    std::vector<int8_t> cs8(2*nbSamples);
+    std::vector<int16_t> cs16(2*nbSamples);
+    std::vector<float> cf32(2*nbSamples);
+
+    qDebug() << "MainBench::testIQConverters: run test on" << blockSizes.size() << "blocks";
+
+    for (int format = 0; format < 4; format++) // in the order of formatNames
+    {
+        qint64 nsecs = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            unsigned int offset = 0;
+            timer.start();
+
+            for (unsigned int size : blockSizes)
+            {
+                const Sample *in = &samples[offset];
+                Sample *out = &decoded[offset];
+
+                switch (format)
+                {
+                case 0:
+                    IQConverters::toCU8(in, &cu8[2*offset], size);
+                    IQConverters::fromCU8(&cu8[2*offset], out, size);
+                    break;
+                case 1:
+                    IQConverters::toCS8(in, &cs8[2*offset], size);
+                    IQConverters::fromCS8(&cs8[2*offset], out, size);
+                    break;
+                case 2:
+                    IQConverters::toCS16(in, &cs16[2*offset], size);
+                    IQConverters::fromCS16(&cs16[2*offset], out, size);
+                    break;
+                default:
+                    IQConverters::toCF32(in, &cf32[2*offset], size);
+                    IQConverters::fromCF32(&cf32[2*offset], out, size);
+                    break;
+                }
+
+                offset += size;
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        // scalar reference: integers keep the most significant bits and floats are exact
+        const FixReal *pin = reinterpret_cast<const FixReal*>(samples.data());
+        const FixReal *pout = reinterpret_cast<const FixReal*>(decoded.data());
+        int shift = format < 2 ? SDR_RX_SAMP_SZ - 8 : format == 2 ? SDR_RX_SAMP_SZ - 16 : 0;
+        float maxEncodedError = 0.0f;
+        int maxError = 0;
+
+        for (unsigned int i = 0; i < 2*nbSamples; i++)
+        {
+            float encodedError;
+
+            switch (format)
+            {
+            case 0:
+                encodedError = std::abs(cu8[i] - ((pin[i] >> shift) + 128));
+                break;
+            case 1:
+                encodedError = std::abs(cs8[i] - (pin[i] >> shift));
+                break;
+            case 2:
+                encodedError = std::abs(cs16[i] - (pin[i] >> shift));
+                break;
+            default:
+                encodedError = std::abs(cf32[i] * SDR_RX_SCALEF - pin[i]);
+                break;
+            }
+
+            maxEncodedError = std::max(maxEncodedError, encodedError);
+            maxError = std::max(maxError, std::abs(pout[i] - ((pin[i] >> shift) << shift)));
+        }
+
+        qDebug() << "MainBench::testIQConverters:" << formatNames[format]
+            << "max encoded error:" << maxEncodedError
+            << "max error:" << maxError;
+        printResults(QString("MainBench::testIQConverters: %1").arg(formatNames[format]), nsecs);
+    }
+}
+
+void MainBench::createIQBlocks(std::vector<Sample>& samples, std::vector<unsigned int>& blockSizes, unsigned int maxBlockSize)
+{
+    // full scale samples cut in random blocks mostly not a multiple of the SIMD width
+    unsigned int nbSamples = m_parser.getNbSamples();
+    std::uniform_int_distribution<qint32> valueDistribution(-(1<<(SDR_RX_SAMP_SZ-1)), (1<<(SDR_RX_SAMP_SZ-1)) - 1);
+    std::uniform_int_distribution<unsigned int> sizeDistribution(1, maxBlockSize);
+    samples.resize(nbSamples);
+
+    for (unsigned int i = 0; i < nbSamples; i++) {
+        samples[i] = Sample(valueDistribution(m_generator), valueDistribution(m_generator));
+    }
+
+    for (unsigned int total = 0; total < nbSamples; total += blockSizes.back()) {
+        blockSizes.push_back(std::min(sizeDistribution(m_generator), nbSamples - total));
+    }
+}
+
+void MainBench::spectrumLine(const Complex *fftOut, float *line, unsigned int fftSize)
+{
+    unsigned int halfSize = fftSize / 2;
+    SpectrumKernels::magSq(fftOut + halfSize, line, halfSize);
+    SpectrumKernels::magSq(fftOut, line + halfSize, halfSize);
+    m_movingAverage.storeAndGetAvg(line, fftSize);
+    m_movingAverage.nextAverage();
+    SpectrumKernels::log2Scale(line, line, fftSize, 10.0f * log10f(2.0f), 20.0f * log10f(1.0f / fftSize));
+}
+
 void MainBench::decimateII(const qint16* buf, int len)
 {
     SampleVector::iterator it = m_convertBuffer.begin();
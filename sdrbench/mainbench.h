@@ -21,12 +21,15 @@
 
 #include <QObject>
 #include <random>
+#include <vector>
 #include <functional>
 
 #include "dsp/decimators.h"
 #include "dsp/decimatorsif.h"
 #include "dsp/decimatorsfi.h"
 #include "dsp/decimatorsff.h"
+#include "dsp/iqpacker.h"
+#include "util/movingaverage2d.h"
 #include "parserbench.h"
 
 namespace qtwebapp {
@@ -51,12 +54,19 @@ private:
     void testDecimateIF();
     void testDecimateFI();
     void testDecimateFF();
+    void testSpectrumKernels();
+    void testRecordCodec();
+    void testIQPacker();
+    void testIQConverters();
+    void createIQBlocks(std::vector<Sample>& samples, std::vector<unsigned int>& blockSizes, unsigned int maxBlockSize);
     void decimateII(const qint16 *buf, int len);
     void decimateInfII(const qint16 *buf, int len);
     void decimateSupII(const qint16 *buf, int len);
     void decimateIF(const qint16 *buf, int len);
     void decimateFI(const float *buf, int len);
     void decimateFF(const float *buf, int len);
+    void spectrumLine(const Complex *fftOut, float *line, unsigned int fftSize);
+    static void iqPackerReference(IQPacker::Encoding encoding, const Sample *in, Sample *out, const std::vector<unsigned int>& blockSizes);
     void printResults(const QString& prefix, qint64 nsecs);
 
     static MainBench *m_instance;
@@ -73,6 +83,7 @@ private:
 
     SampleVector m_convertBuffer;
     FSampleVector m_convertBufferF;
+    MovingAverage2D<float> m_movingAverage;
 };
 
 #endif // SDRBENCH_MAINBENCH_H_
@@ -35,7 +35,7 @@ ParserBench::ParserBench() :
         "repetition",
         "1"),
     m_log2FactorOption(QStringList() << "l" << "log2-factor",
-        "Log2 factor for rate conversion.",
+        "Log2 factor for rate conversion. For spectrum test: FFT size is 1024 << log2. For record codec test: 0 lossless, 1 bfp8, 2 bfp12.",
         "log2",
         "2")
 {
@@ -124,6 +124,14 @@ ParserBench::TestType ParserBench::getTestType() const
         return TestDecimatorsInfII;
     } else if (m_testStr == "decimatesupii") {
         return TestDecimatorsSupII;
+    } else if (m_testStr == "spectrum") {
+        return TestSpectrumKernels;
+    } else if (m_testStr == "recordcodec") {
+        return TestRecordCodec;
+    } else if (m_testStr == "iqpacker") {
+        return TestIQPacker;
+    } else if (m_testStr == "iqconverters") {
+        return TestIQConverters;
     } else {
         return TestDecimatorsII;
     }
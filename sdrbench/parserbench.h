@@ -31,7 +31,11 @@ public:
         TestDecimatorsFI,
         TestDecimatorsFF,
         TestDecimatorsInfII,
-        TestDecimatorsSupII
+        TestDecimatorsSupII,
+        TestSpectrumKernels,
+        TestRecordCodec,
+        TestIQPacker,
+        TestIQConverters
     } TestType;
 
     ParserBench();
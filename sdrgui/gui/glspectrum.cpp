@@ -42,6 +42,9 @@ GLSpectrum::GLSpectrum(QWidget* parent) :
 	m_linear(false),
 	m_decay(0),
 	m_sampleRate(500000),
+	m_deviceSampleRate(500000),
+	m_zoomLog2Decim(0),
+	m_zoomFrequencyOffset(0),
 	m_timingRate(1),
 	m_fftSize(512),
 	m_displayGrid(true),
@@ -197,7 +200,8 @@ void GLSpectrum::setHistoStroke(int stroke)
 
 void GLSpectrum::setSampleRate(qint32 sampleRate)
 {
-	m_sampleRate = sampleRate;
+	m_deviceSampleRate = sampleRate;
+	m_sampleRate = sampleRate / (1<<m_zoomLog2Decim); // rate of the displayed sub-band
 	if (m_messageQueueToGUI) {
 	    m_messageQueueToGUI->push(new MsgReportSampleRate(m_sampleRate));
 	}
@@ -205,6 +209,13 @@ void GLSpectrum::setSampleRate(qint32 sampleRate)
 	update();
 }
 
+void GLSpectrum::setZoom(int log2Decim, qint64 frequencyOffset)
+{
+	m_zoomLog2Decim = log2Decim;
+	m_zoomFrequencyOffset = log2Decim == 0 ? 0 : frequencyOffset;
+	setSampleRate(m_deviceSampleRate);
+}
+
 void GLSpectrum::setTimingRate(qint32 timingRate)
 {
     m_timingRate = timingRate;
@@ -1100,7 +1111,7 @@ void GLSpectrum::applyChanges()
 		leftMargin += 2 * M;
 
 		m_frequencyScale.setSize(width() - leftMargin - rightMargin);
-		m_frequencyScale.setRange(Unit::Frequency, m_centerFrequency - m_sampleRate / 2, m_centerFrequency + m_sampleRate / 2);
+		m_frequencyScale.setRange(Unit::Frequency, m_centerFrequency + m_zoomFrequencyOffset - m_sampleRate / 2, m_centerFrequency + m_zoomFrequencyOffset + m_sampleRate / 2);
 		m_frequencyScale.setMakeOpposite(m_lsbDisplay);
 
 		m_glWaterfallBoxMatrix.setToIdentity();
@@ -1197,7 +1208,7 @@ void GLSpectrum::applyChanges()
 		leftMargin += 2 * M;
 
 		m_frequencyScale.setSize(width() - leftMargin - rightMargin);
-		m_frequencyScale.setRange(Unit::Frequency, m_centerFrequency - m_sampleRate / 2.0, m_centerFrequency + m_sampleRate / 2.0);
+		m_frequencyScale.setRange(Unit::Frequency, m_centerFrequency + m_zoomFrequencyOffset - m_sampleRate / 2.0, m_centerFrequency + m_zoomFrequencyOffset + m_sampleRate / 2.0);
 		m_frequencyScale.setMakeOpposite(m_lsbDisplay);
 
 		m_glWaterfallBoxMatrix.setToIdentity();
@@ -1249,7 +1260,7 @@ void GLSpectrum::applyChanges()
 		leftMargin += 2 * M;
 
 		m_frequencyScale.setSize(width() - leftMargin - rightMargin);
-		m_frequencyScale.setRange(Unit::Frequency, m_centerFrequency - m_sampleRate / 2, m_centerFrequency + m_sampleRate / 2);
+		m_frequencyScale.setRange(Unit::Frequency, m_centerFrequency + m_zoomFrequencyOffset - m_sampleRate / 2, m_centerFrequency + m_zoomFrequencyOffset + m_sampleRate / 2);
 		m_frequencyScale.setMakeOpposite(m_lsbDisplay);
 
 		m_glHistogramSpectrumMatrix.setToIdentity();
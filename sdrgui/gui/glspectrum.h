@@ -65,6 +65,7 @@ public:
 
 	void setCenterFrequency(qint64 frequency);
 	void setSampleRate(qint32 sampleRate);
+	void setZoom(int log2Decim, qint64 frequencyOffset); //!< display the sub-band analysed by the zoom FFT
 	void setTimingRate(qint32 timingRate);
 	void setReferenceLevel(Real referenceLevel);
 	void setPowerRange(Real powerRange);
@@ -83,6 +84,7 @@ public:
 	void setDisplayTraceIntensity(int intensity);
 	void setLinear(bool linear);
 	qint32 getSampleRate() const { return m_sampleRate; }
+	qint32 getDeviceSampleRate() const { return m_deviceSampleRate; }
 
 	void addChannelMarker(ChannelMarker* channelMarker);
 	void removeChannelMarker(ChannelMarker* channelMarker);
@@ -133,7 +135,10 @@ private:
 	Real m_powerRange;
 	bool m_linear;
 	int m_decay;
-	quint32 m_sampleRate;
+	quint32 m_sampleRate;         //!< displayed bandwidth
+	quint32 m_deviceSampleRate;
+	int m_zoomLog2Decim;
+	qint64 m_zoomFrequencyOffset; //!< displayed center frequency relative to the device center frequency
 	quint32 m_timingRate;
 
 	int m_fftSize;
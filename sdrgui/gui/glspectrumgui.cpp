@@ -31,7 +31,10 @@ GLSpectrumGUI::GLSpectrumGUI(QWidget* parent) :
 	m_averagingMode(AvgModeNone),
 	m_averagingIndex(0),
 	m_averagingMaxScale(2),
-	m_averagingNb(0)
+	m_averagingNb(0),
+	m_linear(false),
+	m_zoomLog2Decim(0),
+	m_zoomFrequencyOffset(0)
 {
 	ui->setupUi(this);
 	ui->refLevel->clear();
@@ -41,6 +44,8 @@ GLSpectrumGUI::GLSpectrumGUI(QWidget* parent) :
 	for(int range = 100; range >= 5; range -= 5)
 		ui->levelRange->addItem(QString("%1").arg(range));
 	setAveragingCombo();
+	for(int i = 0; i <= SpectrumEngine::m_maxZoomLog2Decim; i++)
+		ui->zoom->addItem(QString("x%1").arg(1<<i));
 	connect(&m_messageQueue, SIGNAL(messageEnqueued()), this, SLOT(handleInputMessages()));
 }
 
@@ -78,6 +83,8 @@ void GLSpectrumGUI::resetToDefaults()
 	m_averagingMode = AvgModeNone;
 	m_averagingIndex = 0;
 	m_linear = false;
+	m_zoomLog2Decim = 0;
+	m_zoomFrequencyOffset = 0;
 	applySettings();
 }
 
@@ -105,6 +112,8 @@ QByteArray GLSpectrumGUI::serialize() const
 	s.writeS32(19, (int) m_averagingMode);
 	s.writeS32(20, (qint32) getAveragingValue(m_averagingIndex));
 	s.writeBool(21, m_linear);
+	s.writeS32(22, m_zoomLog2Decim);
+	s.writeS64(23, m_zoomFrequencyOffset);
 	return s.final();
 }
 
@@ -145,6 +154,9 @@ bool GLSpectrumGUI::deserialize(const QByteArray& data)
 		m_averagingIndex = getAveragingIndex(tmp);
 	    m_averagingNb = getAveragingValue(m_averagingIndex);
 	    d.readBool(21, &m_linear, false);
+		d.readS32(22, &tmp, 0);
+		m_zoomLog2Decim = tmp < 0 ? 0 : tmp > SpectrumEngine::m_maxZoomLog2Decim ? SpectrumEngine::m_maxZoomLog2Decim : tmp;
+		d.readS64(23, &m_zoomFrequencyOffset, 0);
 
 		m_glSpectrum->setWaterfallShare(waterfallShare);
 		applySettings();
@@ -169,6 +181,9 @@ void GLSpectrumGUI::applySettings()
 	ui->averaging->setCurrentIndex(m_averagingIndex);
 	ui->averagingMode->setCurrentIndex((int) m_averagingMode);
 	ui->linscale->setChecked(m_linear);
+	ui->zoom->setCurrentIndex(m_zoomLog2Decim);
+	ui->zoomOffset->setEnabled(m_zoomLog2Decim != 0);
+	ui->zoomOffset->setValue(m_zoomFrequencyOffset);
 	ui->decay->setSliderPosition(m_decay);
 	ui->holdoff->setSliderPosition(m_histogramLateHoldoff);
 	ui->stroke->setSliderPosition(m_histogramStroke);
@@ -198,6 +213,7 @@ void GLSpectrumGUI::applySettings()
 	m_glSpectrum->setDisplayGrid(m_displayGrid);
 	m_glSpectrum->setDisplayGridIntensity(m_displayGridIntensity);
 	m_glSpectrum->setLinear(m_linear);
+	m_glSpectrum->setZoom(m_zoomLog2Decim, m_zoomFrequencyOffset);
 
 	if (m_spectrumVis) {
 	    m_spectrumVis->configure(m_messageQueueToVis,
@@ -206,7 +222,9 @@ void GLSpectrumGUI::applySettings()
 	            m_averagingNb,
 	            m_averagingMode,
 	            (FFTWindow::Function)m_fftWindow,
-	            m_linear);
+	            m_linear,
+	            m_zoomLog2Decim,
+	            m_zoomFrequencyOffset);
 	}
 
 	setAveragingToolitp();
@@ -222,7 +240,9 @@ void GLSpectrumGUI::on_fftWindow_currentIndexChanged(int index)
                 m_averagingNb,
                 m_averagingMode,
                 (FFTWindow::Function)m_fftWindow,
-                m_linear);
+                m_linear,
+                m_zoomLog2Decim,
+                m_zoomFrequencyOffset);
 	}
 }
 
@@ -236,7 +256,9 @@ void GLSpectrumGUI::on_fftSize_currentIndexChanged(int index)
 	            m_averagingNb,
                 m_averagingMode,
 	            (FFTWindow::Function)m_fftWindow,
-	            m_linear);
+	            m_linear,
+	            m_zoomLog2Decim,
+	            m_zoomFrequencyOffset);
 	}
 	setAveragingToolitp();
 }
@@ -252,7 +274,9 @@ void GLSpectrumGUI::on_averagingMode_currentIndexChanged(int index)
                 m_averagingNb,
                 m_averagingMode,
                 (FFTWindow::Function)m_fftWindow,
-                m_linear);
+                m_linear,
+                m_zoomLog2Decim,
+                m_zoomFrequencyOffset);
     }
 
     if (m_glSpectrum != 0)
@@ -277,7 +301,9 @@ void GLSpectrumGUI::on_averaging_currentIndexChanged(int index)
                 m_averagingNb,
                 m_averagingMode,
                 (FFTWindow::Function)m_fftWindow,
-                m_linear);
+                m_linear,
+                m_zoomLog2Decim,
+                m_zoomFrequencyOffset);
     }
 
     if (m_glSpectrum != 0)
@@ -301,7 +327,9 @@ void GLSpectrumGUI::on_linscale_toggled(bool checked)
                 m_averagingNb,
                 m_averagingMode,
                 (FFTWindow::Function)m_fftWindow,
-                m_linear);
+                m_linear,
+                m_zoomLog2Decim,
+                m_zoomFrequencyOffset);
     }
 
     if(m_glSpectrum != 0)
@@ -315,6 +343,40 @@ void GLSpectrumGUI::on_linscale_toggled(bool checked)
     }
 }
 
+void GLSpectrumGUI::on_zoom_currentIndexChanged(int index)
+{
+    m_zoomLog2Decim = index < 0 ? 0 : index;
+    ui->zoomOffset->setEnabled(m_zoomLog2Decim != 0);
+    applyZoom();
+}
+
+void GLSpectrumGUI::on_zoomOffset_valueChanged(int value)
+{
+    m_zoomFrequencyOffset = value;
+    applyZoom();
+}
+
+void GLSpectrumGUI::applyZoom()
+{
+    if(m_spectrumVis != 0) {
+        m_spectrumVis->configure(m_messageQueueToVis,
+                m_fftSize,
+                m_fftOverlap,
+                m_averagingNb,
+                m_averagingMode,
+                (FFTWindow::Function)m_fftWindow,
+                m_linear,
+                m_zoomLog2Decim,
+                m_zoomFrequencyOffset);
+    }
+
+    if(m_glSpectrum != 0) {
+        m_glSpectrum->setZoom(m_zoomLog2Decim, m_zoomFrequencyOffset);
+    }
+
+    setAveragingToolitp();
+}
+
 void GLSpectrumGUI::on_refLevel_currentIndexChanged(int index)
 {
 	m_refLevel = 0 - index * 5;
@@ -574,6 +636,18 @@ bool GLSpectrumGUI::handleMessage(const Message& message)
 {
     if (GLSpectrum::MsgReportSampleRate::match(message))
     {
+        // the zoomed sub-band must stay within the device bandwidth
+        int maxOffset = m_glSpectrum->getDeviceSampleRate() / 2;
+        ui->zoomOffset->blockSignals(true);
+        ui->zoomOffset->setRange(-maxOffset, maxOffset);
+        ui->zoomOffset->blockSignals(false);
+
+        if (ui->zoomOffset->value() != m_zoomFrequencyOffset)
+        {
+            m_zoomFrequencyOffset = ui->zoomOffset->value();
+            applyZoom();
+        }
+
         setAveragingToolitp();
         return true;
     }
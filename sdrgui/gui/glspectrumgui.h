@@ -64,8 +64,11 @@ private:
 	int m_averagingMaxScale; //!< Max power of 10 multiplier to 2,5,10 base ex: 2 -> 2,5,10,20,50,100,200,500,1000
 	unsigned int m_averagingNb;
 	bool m_linear; //!< linear else logarithmic scale
+	int m_zoomLog2Decim; //!< zoom FFT decimation as a power of 2 (0 for no zoom)
+	qint64 m_zoomFrequencyOffset; //!< zoom FFT sub-band center relative to device center frequency
 
 	void applySettings();
+	void applyZoom();
 	int getAveragingIndex(int averaging) const;
 	int getAveragingValue(int averagingIndex) const;
 	void setAveragingCombo();
@@ -87,6 +90,8 @@ private slots:
 	void on_averagingMode_currentIndexChanged(int index);
     void on_averaging_currentIndexChanged(int index);
     void on_linscale_toggled(bool checked);
+    void on_zoom_currentIndexChanged(int index);
+    void on_zoomOffset_valueChanged(int value);
 
 	void on_waterfall_toggled(bool checked);
 	void on_histogram_toggled(bool checked);
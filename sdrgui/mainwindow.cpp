@@ -54,6 +54,7 @@
 #include "dsp/dspcommands.h"
 #include "dsp/devicesamplesource.h"
 #include "dsp/devicesamplesink.h"
+#include "dsp/filerecord.h"
 #include "plugin/pluginapi.h"
 #include "gui/glspectrum.h"
 #include "gui/glspectrumgui.h"
@@ -201,6 +202,11 @@ MainWindow::MainWindow(qtwebapp::LoggerWithFile *logger, const MainParser& parse
         qWarning("MainWindow::MainWindow: could not register resource file %s/%s", qPrintable(applicationDirPath), "sdrbase.rcc");
     }
 
+	FileRecord::setDirectIO(parser.getRecordDirectIO());
+	FileRecord::setCompression(parser.getRecordCompression());
+	FileRecord::setFormat(parser.getRecordFormat());
+	FileRecord::setTriggerSettings(parser.getRecordTrigger());
+
 	m_apiAdapter = new WebAPIAdapterGUI(*this);
 	m_requestMapper = new WebAPIRequestMapper(this);
 	m_requestMapper->setAdapter(m_apiAdapter);
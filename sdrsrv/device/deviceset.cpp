@@ -16,6 +16,7 @@
 
 #include "dsp/dspdevicesourceengine.h"
 #include "dsp/dspdevicesinkengine.h"
+#include "dsp/spectrumengine.h"
 #include "device/devicesourceapi.h"
 #include "device/devicesinkapi.h"
 #include "plugin/pluginapi.h"
@@ -28,8 +29,13 @@
 #include "deviceset.h"
 
 
-DeviceSet::DeviceSet(int tabIndex)
+DeviceSet::DeviceSet(int tabIndex, bool rxElseTx)
 {
+    if (rxElseTx) {
+        m_spectrumEngine = new SpectrumEngine(SDR_RX_SCALEF);
+    } else {
+        m_spectrumEngine = new SpectrumEngine(SDR_TX_SCALEF);
+    }
     m_deviceSourceEngine = 0;
     m_deviceSourceAPI = 0;
     m_deviceSinkEngine = 0;
@@ -39,6 +45,7 @@ DeviceSet::DeviceSet(int tabIndex)
 
 DeviceSet::~DeviceSet()
 {
+    delete m_spectrumEngine;
 }
 
 void DeviceSet::registerRxChannelInstance(const QString& channelName, ChannelSinkAPI* channelAPI)
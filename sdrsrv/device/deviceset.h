@@ -27,6 +27,7 @@ class PluginAPI;
 class ChannelSinkAPI;
 class ChannelSourceAPI;
 class Preset;
+class SpectrumEngine;
 
 class DeviceSet
 {
@@ -35,8 +36,9 @@ public:
     DeviceSourceAPI *m_deviceSourceAPI;
     DSPDeviceSinkEngine *m_deviceSinkEngine;
     DeviceSinkAPI *m_deviceSinkAPI;
+    SpectrumEngine *m_spectrumEngine;
 
-    DeviceSet(int tabIndex);
+    DeviceSet(int tabIndex, bool rxElseTx);
     ~DeviceSet();
 
     int getNumberOfRxChannels() const { return m_rxChannelInstanceRegistrations.size(); }
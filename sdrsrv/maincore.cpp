@@ -24,6 +24,8 @@
 #include "dsp/dspengine.h"
 #include "dsp/dspdevicesourceengine.h"
 #include "dsp/dspdevicesinkengine.h"
+#include "dsp/filerecord.h"
+#include "dsp/spectrumintegrator.h"
 #include "device/devicesourceapi.h"
 #include "device/devicesinkapi.h"
 #include "device/deviceset.h"
@@ -32,6 +34,7 @@
 #include "loggerwithfile.h"
 #include "webapi/webapirequestmapper.h"
 #include "webapi/webapiserver.h"
+#include "webapi/spectrumstreamserver.h"
 #include "webapi/webapiadaptersrv.h"
 
 #include "maincore.h"
@@ -54,7 +57,8 @@ MainCore::MainCore(qtwebapp::LoggerWithFile *logger, const MainParser& parser, Q
     m_masterTabIndex(-1),
     m_dspEngine(DSPEngine::instance()),
     m_lastEngineState(DSPDeviceSourceEngine::StNotStarted),
-    m_logger(logger)
+    m_logger(logger),
+    m_spectrumStreamServer(0)
 {
     qDebug() << "MainCore::MainCore: start";
 
@@ -77,12 +81,24 @@ MainCore::MainCore(qtwebapp::LoggerWithFile *logger, const MainParser& parser, Q
         qWarning("MainCore::MainCore: could not register resource file %s/%s", qPrintable(applicationDirPath), "sdrbase.rcc");
     }
 
+    FileRecord::setDirectIO(parser.getRecordDirectIO());
+    FileRecord::setCompression(parser.getRecordCompression());
+    FileRecord::setFormat(parser.getRecordFormat());
+    FileRecord::setTriggerSettings(parser.getRecordTrigger());
+    SpectrumIntegrator::setSnapshotDirectory(parser.getSnapshotDirectory());
+
     m_apiAdapter = new WebAPIAdapterSrv(*this);
     m_requestMapper = new WebAPIRequestMapper(this);
     m_requestMapper->setAdapter(m_apiAdapter);
     m_apiServer = new WebAPIServer(parser.getServerAddress(), parser.getServerPort(), m_requestMapper);
     m_apiServer->start();
 
+    if (parser.getStreamPort() != 0)
+    {
+        m_spectrumStreamServer = new SpectrumStreamServer(parser.getServerAddress(), parser.getStreamPort(), m_apiAdapter);
+        m_spectrumStreamServer->start();
+    }
+
     qDebug() << "MainCore::MainCore: end";
 }
 
@@ -92,8 +108,13 @@ MainCore::~MainCore()
         removeLastDevice();
     }
 
+    if (m_spectrumStreamServer) {
+        m_spectrumStreamServer->stop();
+    }
+
 	m_apiServer->stop();
 	m_settings.save();
+    delete m_spectrumStreamServer;
     delete m_apiServer;
     delete m_requestMapper;
     delete m_apiAdapter;
@@ -268,9 +289,10 @@ void MainCore::addSinkDevice()
     sprintf(uidCStr, "UID:%d", dspDeviceSinkEngineUID);
 
     int deviceTabIndex = m_deviceSets.size();
-    m_deviceSets.push_back(new DeviceSet(deviceTabIndex));
+    m_deviceSets.push_back(new DeviceSet(deviceTabIndex, false));
     m_deviceSets.back()->m_deviceSourceEngine = 0;
     m_deviceSets.back()->m_deviceSinkEngine = dspDeviceSinkEngine;
+    dspDeviceSinkEngine->addSpectrumSink(m_deviceSets.back()->m_spectrumEngine);
 
     char tabNameCStr[16];
     sprintf(tabNameCStr, "T%d", deviceTabIndex);
@@ -311,8 +333,9 @@ void MainCore::addSourceDevice()
     sprintf(uidCStr, "UID:%d", dspDeviceSourceEngineUID);
 
     int deviceTabIndex = m_deviceSets.size();
-    m_deviceSets.push_back(new DeviceSet(deviceTabIndex));
+    m_deviceSets.push_back(new DeviceSet(deviceTabIndex, true));
     m_deviceSets.back()->m_deviceSourceEngine = dspDeviceSourceEngine;
+    dspDeviceSourceEngine->addSink(m_deviceSets.back()->m_spectrumEngine);
 
     char tabNameCStr[16];
     sprintf(tabNameCStr, "R%d", deviceTabIndex);
@@ -344,6 +367,7 @@ void MainCore::removeLastDevice()
     {
         DSPDeviceSourceEngine *lastDeviceEngine = m_deviceSets.back()->m_deviceSourceEngine;
         lastDeviceEngine->stopAcquistion();
+        lastDeviceEngine->removeSink(m_deviceSets.back()->m_spectrumEngine);
 
         // deletes old UI and input object
         m_deviceSets.back()->freeRxChannels();      // destroys the channel instances
@@ -364,6 +388,7 @@ void MainCore::removeLastDevice()
     {
         DSPDeviceSinkEngine *lastDeviceEngine = m_deviceSets.back()->m_deviceSinkEngine;
         lastDeviceEngine->stopGeneration();
+        lastDeviceEngine->removeSpectrumSink(m_deviceSets.back()->m_spectrumEngine);
 
         // deletes old UI and output object
         m_deviceSets.back()->freeTxChannels();
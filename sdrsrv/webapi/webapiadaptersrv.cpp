@@ -43,6 +43,7 @@
 #include "SWGErrorResponse.h"
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
+#include "SWGSpectrumSettings.h"
 
 #include "maincore.h"
 #include "loggerwithfile.h"
@@ -53,6 +54,7 @@
 #include "dsp/devicesamplesink.h"
 #include "dsp/devicesamplesource.h"
 #include "dsp/dspengine.h"
+#include "dsp/spectrumintegrator.h"
 #include "channel/channelsourceapi.h"
 #include "channel/channelsinkapi.h"
 #include "plugin/pluginapi.h"
@@ -1634,6 +1636,178 @@ int WebAPIAdapterSrv::devicesetChannelReportGet(
     }
 }
 
+int WebAPIAdapterSrv::devicesetSpectrumGet(
+            int deviceSetIndex,
+            bool quantized,
+            bool autoRange,
+            float minValue,
+            float maxValue,
+            int nbBins,
+            bool decimateMean,
+            QByteArray& response,
+            SWGSDRangel::SWGErrorResponse& error)
+{
+    error.init();
+
+    if ((deviceSetIndex >= 0) && (deviceSetIndex < (int) m_mainCore.m_deviceSets.size()))
+    {
+        DeviceSet *deviceSet = m_mainCore.m_deviceSets[deviceSetIndex];
+        response = deviceSet->m_spectrumEngine->serializeSpectrum(
+                quantized ? SpectrumEngine::FormatUInt8 : SpectrumEngine::FormatFloat32,
+                autoRange,
+                minValue,
+                maxValue,
+                nbBins < 0 ? 0 : nbBins,
+                decimateMean ? SpectrumEngine::DecimationMean : SpectrumEngine::DecimationMax);
+
+        if (response.isEmpty())
+        {
+            *error.getMessage() = QString("No spectrum available yet for device set %1").arg(deviceSetIndex);
+            return 404;
+        }
+        else
+        {
+            return 200;
+        }
+    }
+    else
+    {
+        *error.getMessage() = QString("There is no device set with index %1").arg(deviceSetIndex);
+        return 404;
+    }
+}
+
+int WebAPIAdapterSrv::devicesetSpectrumSettingsGet(
+            int deviceSetIndex,
+            SWGSDRangel::SWGSpectrumSettings& response,
+            SWGSDRangel::SWGErrorResponse& error)
+{
+    error.init();
+
+    if ((deviceSetIndex >= 0) && (deviceSetIndex < (int) m_mainCore.m_deviceSets.size()))
+    {
+        DeviceSet *deviceSet = m_mainCore.m_deviceSets[deviceSetIndex];
+        response.init();
+        formatSpectrumSettings(response, deviceSet->m_spectrumEngine->getSettings());
+        return 200;
+    }
+    else
+    {
+        *error.getMessage() = QString("There is no device set with index %1").arg(deviceSetIndex);
+        return 404;
+    }
+}
+
+int WebAPIAdapterSrv::devicesetSpectrumSettingsPutPatch(
+            int deviceSetIndex,
+            bool force,
+            const QStringList& spectrumSettingsKeys,
+            SWGSDRangel::SWGSpectrumSettings& response,
+            SWGSDRangel::SWGErrorResponse& error)
+{
+    error.init();
+
+    if ((deviceSetIndex >= 0) && (deviceSetIndex < (int) m_mainCore.m_deviceSets.size()))
+    {
+        DeviceSet *deviceSet = m_mainCore.m_deviceSets[deviceSetIndex];
+        SpectrumEngine::Settings settings = force ? SpectrumEngine::Settings() : deviceSet->m_spectrumEngine->getSettings();
+
+        if (spectrumSettingsKeys.contains("fftSize")) {
+            settings.m_fftSize = response.getFftSize();
+        }
+        if (spectrumSettingsKeys.contains("overlapPercent")) {
+            settings.m_overlapPercent = response.getOverlapPercent();
+        }
+        if (spectrumSettingsKeys.contains("fftWindow")) {
+            settings.m_window = (FFTWindow::Function) response.getFftWindow();
+        }
+        if (spectrumSettingsKeys.contains("averagingMode")) {
+            settings.m_averagingMode = (SpectrumEngine::AveragingMode) response.getAveragingMode();
+        }
+        if (spectrumSettingsKeys.contains("averagingNb")) {
+            settings.m_averageNb = response.getAveragingNb() < 0 ? 0 : response.getAveragingNb();
+        }
+        if (spectrumSettingsKeys.contains("linear")) {
+            settings.m_linear = response.getLinear() != 0;
+        }
+        if (spectrumSettingsKeys.contains("integrationTime")) {
+            settings.m_integrationTime = response.getIntegrationTime();
+        }
+        if (spectrumSettingsKeys.contains("snapshotPeriod")) {
+            settings.m_snapshotPeriod = response.getSnapshotPeriod();
+        }
+        if (spectrumSettingsKeys.contains("snapshotFileName") && response.getSnapshotFileName()) {
+            settings.m_snapshotFileName = *response.getSnapshotFileName();
+        }
+        if (spectrumSettingsKeys.contains("zoomLog2Decim")) {
+            settings.m_zoomLog2Decim = response.getZoomLog2Decim();
+        }
+        if (spectrumSettingsKeys.contains("zoomFrequencyOffset")) {
+            settings.m_zoomFrequencyOffset = response.getZoomFrequencyOffset();
+        }
+
+        if ((settings.m_window < FFTWindow::Bartlett) || (settings.m_window > FFTWindow::Rectangle))
+        {
+            *error.getMessage() = QString("Invalid FFT window %1").arg((int) settings.m_window);
+            return 400;
+        }
+
+        if ((settings.m_averagingMode < SpectrumEngine::AvgModeNone) || (settings.m_averagingMode > SpectrumEngine::AvgModeIntegration))
+        {
+            *error.getMessage() = QString("Invalid averaging mode %1").arg((int) settings.m_averagingMode);
+            return 400;
+        }
+
+        if ((settings.m_integrationTime <= 0.0) || (settings.m_snapshotPeriod < 0.0))
+        {
+            *error.getMessage() = QString("Integration time must be positive and snapshot period not negative");
+            return 400;
+        }
+
+        if ((settings.m_zoomLog2Decim < 0) || (settings.m_zoomLog2Decim > SpectrumEngine::m_maxZoomLog2Decim))
+        {
+            *error.getMessage() = QString("Zoom log2 decimation must be between 0 and %1").arg(SpectrumEngine::m_maxZoomLog2Decim);
+            return 400;
+        }
+
+        if ((settings.m_fftSize < 64) || (settings.m_fftSize > SpectrumEngine::m_maxFFTSize) || ((settings.m_fftSize & (settings.m_fftSize - 1)) != 0))
+        {
+            *error.getMessage() = QString("FFT size must be a power of two between 64 and %1").arg(SpectrumEngine::m_maxFFTSize);
+            return 400;
+        }
+
+        if ((settings.m_overlapPercent < 0) || (settings.m_overlapPercent > 99))
+        {
+            *error.getMessage() = QString("Overlap must be between 0 and 99%");
+            return 400;
+        }
+
+        if (!settings.m_snapshotFileName.isEmpty() && !SpectrumIntegrator::isValidSnapshotFileName(settings.m_snapshotFileName))
+        {
+            if (SpectrumIntegrator::getSnapshotDirectory().isEmpty()) {
+                *error.getMessage() = QString("Snapshots are disabled: start the server with a snapshot directory");
+            } else {
+                *error.getMessage() = QString("Snapshot file must be a plain file name in the snapshot directory");
+            }
+
+            return 400;
+        }
+
+        SpectrumEngine::clampSettings(settings); // respond with the settings as applied by the engine
+        SpectrumEngine::MsgConfigureSpectrumEngine *msg = SpectrumEngine::MsgConfigureSpectrumEngine::create(settings);
+        deviceSet->m_spectrumEngine->getInputMessageQueue()->push(msg);
+
+        response.init();
+        formatSpectrumSettings(response, settings);
+        return 200;
+    }
+    else
+    {
+        *error.getMessage() = QString("There is no device set with index %1").arg(deviceSetIndex);
+        return 404;
+    }
+}
+
 int WebAPIAdapterSrv::devicesetChannelSettingsPutPatch(
             int deviceSetIndex,
             int channelIndex,
@@ -1900,3 +2074,18 @@ void WebAPIAdapterSrv::getMsgTypeString(const QtMsgType& msgType, QString& level
         break;
     }
 }
+
+void WebAPIAdapterSrv::formatSpectrumSettings(SWGSDRangel::SWGSpectrumSettings& swgSettings, const SpectrumEngine::Settings& settings)
+{
+    swgSettings.setFftSize(settings.m_fftSize);
+    swgSettings.setOverlapPercent(settings.m_overlapPercent);
+    swgSettings.setFftWindow((int) settings.m_window);
+    swgSettings.setAveragingMode((int) settings.m_averagingMode);
+    swgSettings.setAveragingNb(settings.m_averageNb);
+    swgSettings.setLinear(settings.m_linear ? 1 : 0);
+    swgSettings.setIntegrationTime(settings.m_integrationTime);
+    swgSettings.setSnapshotPeriod(settings.m_snapshotPeriod);
+    *swgSettings.getSnapshotFileName() = settings.m_snapshotFileName;
+    swgSettings.setZoomLog2Decim(settings.m_zoomLog2Decim);
+    swgSettings.setZoomFrequencyOffset(settings.m_zoomFrequencyOffset);
+}
@@ -22,6 +22,7 @@
 #include <QtGlobal>
 
 #include "webapi/webapiadapterinterface.h"
+#include "dsp/spectrumengine.h"
 
 class MainCore;
 class DeviceSet;
@@ -237,6 +238,29 @@ public:
             SWGSDRangel::SWGChannelReport& response,
             SWGSDRangel::SWGErrorResponse& error);
 
+    virtual int devicesetSpectrumGet(
+            int deviceSetIndex,
+            bool quantized,
+            bool autoRange,
+            float minValue,
+            float maxValue,
+            int nbBins,
+            bool decimateMean,
+            QByteArray& response,
+            SWGSDRangel::SWGErrorResponse& error);
+
+    virtual int devicesetSpectrumSettingsGet(
+            int deviceSetIndex,
+            SWGSDRangel::SWGSpectrumSettings& response,
+            SWGSDRangel::SWGErrorResponse& error);
+
+    virtual int devicesetSpectrumSettingsPutPatch(
+            int deviceSetIndex,
+            bool force,
+            const QStringList& spectrumSettingsKeys,
+            SWGSDRangel::SWGSpectrumSettings& response,
+            SWGSDRangel::SWGErrorResponse& error);
+
 private:
     MainCore& m_mainCore;
 
@@ -245,6 +269,7 @@ private:
     void getChannelsDetail(SWGSDRangel::SWGChannelsDetail *channelsDetail, const DeviceSet* deviceSet);
     static QtMsgType getMsgTypeFromString(const QString& msgTypeString);
     static void getMsgTypeString(const QtMsgType& msgType, QString& level);
+    static void formatSpectrumSettings(SWGSDRangel::SWGSpectrumSettings& swgSettings, const SpectrumEngine::Settings& settings);
 };
 
 #endif /* SDRSRV_WEBAPI_WEBAPIADAPTERSRV_H_ */
@@ -56,6 +56,8 @@ SWGDeviceReport::SWGDeviceReport() {
     m_sdr_daemon_source_report_isSet = false;
     sdr_play_report = nullptr;
     m_sdr_play_report_isSet = false;
+    file_record_report = nullptr;
+    m_file_record_report_isSet = false;
 }
 
 SWGDeviceReport::~SWGDeviceReport() {
@@ -92,6 +94,8 @@ SWGDeviceReport::init() {
     m_sdr_daemon_source_report_isSet = false;
     sdr_play_report = new SWGSDRPlayReport();
     m_sdr_play_report_isSet = false;
+    file_record_report = new SWGFileRecordReport();
+    m_file_record_report_isSet = false;
 }
 
 void
@@ -136,6 +140,9 @@ SWGDeviceReport::cleanup() {
     if(sdr_play_report != nullptr) { 
         delete sdr_play_report;
     }
+    if(file_record_report != nullptr) { 
+        delete file_record_report;
+    }
 }
 
 SWGDeviceReport*
@@ -177,6 +184,8 @@ SWGDeviceReport::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&sdr_play_report, pJson["sdrPlayReport"], "SWGSDRPlayReport", "SWGSDRPlayReport");
     
+    ::SWGSDRangel::setValue(&file_record_report, pJson["fileRecordReport"], "SWGFileRecordReport", "SWGFileRecordReport");
+    
 }
 
 QString
@@ -235,6 +244,9 @@ SWGDeviceReport::asJsonObject() {
     if((sdr_play_report != nullptr) && (sdr_play_report->isSet())){
         toJsonValue(QString("sdrPlayReport"), sdr_play_report, obj, QString("SWGSDRPlayReport"));
     }
+    if((file_record_report != nullptr) && (file_record_report->isSet())){
+        toJsonValue(QString("fileRecordReport"), file_record_report, obj, QString("SWGFileRecordReport"));
+    }
 
     return obj;
 }
@@ -379,6 +391,16 @@ SWGDeviceReport::setSdrPlayReport(SWGSDRPlayReport* sdr_play_report) {
     this->m_sdr_play_report_isSet = true;
 }
 
+SWGFileRecordReport*
+SWGDeviceReport::getFileRecordReport() {
+    return file_record_report;
+}
+void
+SWGDeviceReport::setFileRecordReport(SWGFileRecordReport* file_record_report) {
+    this->file_record_report = file_record_report;
+    this->m_file_record_report_isSet = true;
+}
+
 
 bool
 SWGDeviceReport::isSet(){
@@ -398,6 +420,7 @@ SWGDeviceReport::isSet(){
         if(sdr_daemon_sink_report != nullptr && sdr_daemon_sink_report->isSet()){ isObjectUpdated = true; break;}
         if(sdr_daemon_source_report != nullptr && sdr_daemon_source_report->isSet()){ isObjectUpdated = true; break;}
         if(sdr_play_report != nullptr && sdr_play_report->isSet()){ isObjectUpdated = true; break;}
+        if(file_record_report != nullptr && file_record_report->isSet()){ isObjectUpdated = true; break;}
     }while(false);
     return isObjectUpdated;
 }
@@ -24,6 +24,7 @@
 
 #include "SWGAirspyHFReport.h"
 #include "SWGAirspyReport.h"
+#include "SWGFileRecordReport.h"
 #include "SWGFileSourceReport.h"
 #include "SWGLimeSdrInputReport.h"
 #include "SWGLimeSdrOutputReport.h"
@@ -96,6 +97,9 @@ public:
     SWGSDRPlayReport* getSdrPlayReport();
     void setSdrPlayReport(SWGSDRPlayReport* sdr_play_report);
 
+    SWGFileRecordReport* getFileRecordReport();
+    void setFileRecordReport(SWGFileRecordReport* file_record_report);
+
 
     virtual bool isSet() override;
 
@@ -142,6 +146,9 @@ private:
     SWGSDRPlayReport* sdr_play_report;
     bool m_sdr_play_report_isSet;
 
+    SWGFileRecordReport* file_record_report;
+    bool m_file_record_report_isSet;
+
 };
 
 }
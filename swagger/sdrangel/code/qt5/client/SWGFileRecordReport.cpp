@@ -0,0 +1,211 @@
+/**
+ * SDRangel
+ * This is the web REST/JSON API of SDRangel SDR software. SDRangel is an Open Source Qt5/OpenGL 3.0+ (4.3+ in Windows) GUI and server Software Defined Radio and signal analyzer in software. It supports Airspy, BladeRF, HackRF, LimeSDR, PlutoSDR, RTL-SDR, SDRplay RSP1 and FunCube     ---   Limitations and specifcities:       * In SDRangel GUI the first Rx device set cannot be deleted. Conversely the server starts with no device sets and its number of device sets can be reduced to zero by as many calls as necessary to /sdrangel/deviceset with DELETE method.   * Preset import and export from/to file is a server only feature.   * Device set focus is a GUI only feature.   * The following channels are not implemented (status 501 is returned): ATV and DATV demodulators, Channel Analyzer NG, LoRa demodulator   * The device settings and report structures contains only the sub-structure corresponding to the device type. The DeviceSettings and DeviceReport structures documented here shows all of them but only one will be or should be present at a time   * The channel settings and report structures contains only the sub-structure corresponding to the channel type. The ChannelSettings and ChannelReport structures documented here shows all of them but only one will be or should be present at a time    --- 
+ *
+ * OpenAPI spec version: 4.0.6
+ * Contact: f4exb06@gmail.com
+ *
+ * NOTE: This class is auto generated by the swagger code generator program.
+ * https://github.com/swagger-api/swagger-codegen.git
+ * Do not edit the class manually.
+ */
+
+
+#include "SWGFileRecordReport.h"
+
+#include "SWGHelpers.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QObject>
+#include <QDebug>
+
+namespace SWGSDRangel {
+
+SWGFileRecordReport::SWGFileRecordReport(QString* json) {
+    init();
+    this->fromJson(*json);
+}
+
+SWGFileRecordReport::SWGFileRecordReport() {
+    recording = 0;
+    m_recording_isSet = false;
+    recorded_bytes = 0L;
+    m_recorded_bytes_isSet = false;
+    buffered_bytes = 0L;
+    m_buffered_bytes_isSet = false;
+    overruns = 0;
+    m_overruns_isSet = false;
+    dropped_bytes = 0L;
+    m_dropped_bytes_isSet = false;
+    write_errors = 0;
+    m_write_errors_isSet = false;
+}
+
+SWGFileRecordReport::~SWGFileRecordReport() {
+    this->cleanup();
+}
+
+void
+SWGFileRecordReport::init() {
+    recording = 0;
+    m_recording_isSet = false;
+    recorded_bytes = 0L;
+    m_recorded_bytes_isSet = false;
+    buffered_bytes = 0L;
+    m_buffered_bytes_isSet = false;
+    overruns = 0;
+    m_overruns_isSet = false;
+    dropped_bytes = 0L;
+    m_dropped_bytes_isSet = false;
+    write_errors = 0;
+    m_write_errors_isSet = false;
+}
+
+void
+SWGFileRecordReport::cleanup() {
+
+
+
+
+
+
+}
+
+SWGFileRecordReport*
+SWGFileRecordReport::fromJson(QString &json) {
+    QByteArray array (json.toStdString().c_str());
+    QJsonDocument doc = QJsonDocument::fromJson(array);
+    QJsonObject jsonObject = doc.object();
+    this->fromJsonObject(jsonObject);
+    return this;
+}
+
+void
+SWGFileRecordReport::fromJsonObject(QJsonObject &pJson) {
+    ::SWGSDRangel::setValue(&recording, pJson["recording"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&recorded_bytes, pJson["recordedBytes"], "qint64", "");
+    
+    ::SWGSDRangel::setValue(&buffered_bytes, pJson["bufferedBytes"], "qint64", "");
+    
+    ::SWGSDRangel::setValue(&overruns, pJson["overruns"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&dropped_bytes, pJson["droppedBytes"], "qint64", "");
+    
+    ::SWGSDRangel::setValue(&write_errors, pJson["writeErrors"], "qint32", "");
+    
+}
+
+QString
+SWGFileRecordReport::asJson ()
+{
+    QJsonObject* obj = this->asJsonObject();
+
+    QJsonDocument doc(*obj);
+    QByteArray bytes = doc.toJson();
+    delete obj;
+    return QString(bytes);
+}
+
+QJsonObject*
+SWGFileRecordReport::asJsonObject() {
+    QJsonObject* obj = new QJsonObject();
+    if(m_recording_isSet){
+        obj->insert("recording", QJsonValue(recording));
+    }
+    if(m_recorded_bytes_isSet){
+        obj->insert("recordedBytes", QJsonValue(recorded_bytes));
+    }
+    if(m_buffered_bytes_isSet){
+        obj->insert("bufferedBytes", QJsonValue(buffered_bytes));
+    }
+    if(m_overruns_isSet){
+        obj->insert("overruns", QJsonValue(overruns));
+    }
+    if(m_dropped_bytes_isSet){
+        obj->insert("droppedBytes", QJsonValue(dropped_bytes));
+    }
+    if(m_write_errors_isSet){
+        obj->insert("writeErrors", QJsonValue(write_errors));
+    }
+
+    return obj;
+}
+
+qint32
+SWGFileRecordReport::getRecording() {
+    return recording;
+}
+void
+SWGFileRecordReport::setRecording(qint32 recording) {
+    this->recording = recording;
+    this->m_recording_isSet = true;
+}
+
+qint64
+SWGFileRecordReport::getRecordedBytes() {
+    return recorded_bytes;
+}
+void
+SWGFileRecordReport::setRecordedBytes(qint64 recorded_bytes) {
+    this->recorded_bytes = recorded_bytes;
+    this->m_recorded_bytes_isSet = true;
+}
+
+qint64
+SWGFileRecordReport::getBufferedBytes() {
+    return buffered_bytes;
+}
+void
+SWGFileRecordReport::setBufferedBytes(qint64 buffered_bytes) {
+    this->buffered_bytes = buffered_bytes;
+    this->m_buffered_bytes_isSet = true;
+}
+
+qint32
+SWGFileRecordReport::getOverruns() {
+    return overruns;
+}
+void
+SWGFileRecordReport::setOverruns(qint32 overruns) {
+    this->overruns = overruns;
+    this->m_overruns_isSet = true;
+}
+
+qint64
+SWGFileRecordReport::getDroppedBytes() {
+    return dropped_bytes;
+}
+void
+SWGFileRecordReport::setDroppedBytes(qint64 dropped_bytes) {
+    this->dropped_bytes = dropped_bytes;
+    this->m_dropped_bytes_isSet = true;
+}
+
+qint32
+SWGFileRecordReport::getWriteErrors() {
+    return write_errors;
+}
+void
+SWGFileRecordReport::setWriteErrors(qint32 write_errors) {
+    this->write_errors = write_errors;
+    this->m_write_errors_isSet = true;
+}
+
+
+bool
+SWGFileRecordReport::isSet(){
+    bool isObjectUpdated = false;
+    do{
+        if(m_recording_isSet){ isObjectUpdated = true; break;}
+        if(m_recorded_bytes_isSet){ isObjectUpdated = true; break;}
+        if(m_buffered_bytes_isSet){ isObjectUpdated = true; break;}
+        if(m_overruns_isSet){ isObjectUpdated = true; break;}
+        if(m_dropped_bytes_isSet){ isObjectUpdated = true; break;}
+        if(m_write_errors_isSet){ isObjectUpdated = true; break;}
+    }while(false);
+    return isObjectUpdated;
+}
+}
+
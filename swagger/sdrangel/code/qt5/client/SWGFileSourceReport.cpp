@@ -40,6 +40,8 @@ SWGFileSourceReport::SWGFileSourceReport() {
     m_elapsed_time_isSet = false;
     duration_time = nullptr;
     m_duration_time_isSet = false;
+    replay_completed = 0;
+    m_replay_completed_isSet = false;
 }
 
 SWGFileSourceReport::~SWGFileSourceReport() {
@@ -60,6 +62,8 @@ SWGFileSourceReport::init() {
     m_elapsed_time_isSet = false;
     duration_time = new QString("");
     m_duration_time_isSet = false;
+    replay_completed = 0;
+    m_replay_completed_isSet = false;
 }
 
 void
@@ -78,6 +82,7 @@ SWGFileSourceReport::cleanup() {
     if(duration_time != nullptr) { 
         delete duration_time;
     }
+
 }
 
 SWGFileSourceReport*
@@ -103,6 +108,8 @@ SWGFileSourceReport::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&duration_time, pJson["durationTime"], "QString", "QString");
     
+    ::SWGSDRangel::setValue(&replay_completed, pJson["replayCompleted"], "qint32", "");
+    
 }
 
 QString
@@ -137,6 +144,9 @@ SWGFileSourceReport::asJsonObject() {
     if(duration_time != nullptr && *duration_time != QString("")){
         toJsonValue(QString("durationTime"), duration_time, obj, QString("QString"));
     }
+    if(m_replay_completed_isSet){
+        obj->insert("replayCompleted", QJsonValue(replay_completed));
+    }
 
     return obj;
 }
@@ -201,6 +211,16 @@ SWGFileSourceReport::setDurationTime(QString* duration_time) {
     this->m_duration_time_isSet = true;
 }
 
+qint32
+SWGFileSourceReport::getReplayCompleted() {
+    return replay_completed;
+}
+void
+SWGFileSourceReport::setReplayCompleted(qint32 replay_completed) {
+    this->replay_completed = replay_completed;
+    this->m_replay_completed_isSet = true;
+}
+
 
 bool
 SWGFileSourceReport::isSet(){
@@ -212,6 +232,7 @@ SWGFileSourceReport::isSet(){
         if(absolute_time != nullptr && *absolute_time != QString("")){ isObjectUpdated = true; break;}
         if(elapsed_time != nullptr && *elapsed_time != QString("")){ isObjectUpdated = true; break;}
         if(duration_time != nullptr && *duration_time != QString("")){ isObjectUpdated = true; break;}
+        if(m_replay_completed_isSet){ isObjectUpdated = true; break;}
     }while(false);
     return isObjectUpdated;
 }
@@ -60,6 +60,9 @@ public:
     QString* getDurationTime();
     void setDurationTime(QString* duration_time);
 
+    qint32 getReplayCompleted();
+    void setReplayCompleted(qint32 replay_completed);
+
 
     virtual bool isSet() override;
 
@@ -82,6 +85,9 @@ private:
     QString* duration_time;
     bool m_duration_time_isSet;
 
+    qint32 replay_completed;
+    bool m_replay_completed_isSet;
+
 };
 
 }
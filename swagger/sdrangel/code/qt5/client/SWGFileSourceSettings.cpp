@@ -30,6 +30,8 @@ SWGFileSourceSettings::SWGFileSourceSettings(QString* json) {
 SWGFileSourceSettings::SWGFileSourceSettings() {
     file_name = nullptr;
     m_file_name_isSet = false;
+    free_run = 0;
+    m_free_run_isSet = false;
 }
 
 SWGFileSourceSettings::~SWGFileSourceSettings() {
@@ -40,6 +42,8 @@ void
 SWGFileSourceSettings::init() {
     file_name = new QString("");
     m_file_name_isSet = false;
+    free_run = 0;
+    m_free_run_isSet = false;
 }
 
 void
@@ -47,6 +51,7 @@ SWGFileSourceSettings::cleanup() {
     if(file_name != nullptr) { 
         delete file_name;
     }
+
 }
 
 SWGFileSourceSettings*
@@ -62,6 +67,8 @@ void
 SWGFileSourceSettings::fromJsonObject(QJsonObject &pJson) {
     ::SWGSDRangel::setValue(&file_name, pJson["fileName"], "QString", "QString");
     
+    ::SWGSDRangel::setValue(&free_run, pJson["freeRun"], "qint32", "");
+    
 }
 
 QString
@@ -81,6 +88,9 @@ SWGFileSourceSettings::asJsonObject() {
     if(file_name != nullptr && *file_name != QString("")){
         toJsonValue(QString("fileName"), file_name, obj, QString("QString"));
     }
+    if(m_free_run_isSet){
+        obj->insert("freeRun", QJsonValue(free_run));
+    }
 
     return obj;
 }
@@ -95,12 +105,23 @@ SWGFileSourceSettings::setFileName(QString* file_name) {
     this->m_file_name_isSet = true;
 }
 
+qint32
+SWGFileSourceSettings::getFreeRun() {
+    return free_run;
+}
+void
+SWGFileSourceSettings::setFreeRun(qint32 free_run) {
+    this->free_run = free_run;
+    this->m_free_run_isSet = true;
+}
+
 
 bool
 SWGFileSourceSettings::isSet(){
     bool isObjectUpdated = false;
     do{
         if(file_name != nullptr && *file_name != QString("")){ isObjectUpdated = true; break;}
+        if(m_free_run_isSet){ isObjectUpdated = true; break;}
     }while(false);
     return isObjectUpdated;
 }
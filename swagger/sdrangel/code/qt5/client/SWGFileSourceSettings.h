@@ -45,6 +45,9 @@ public:
     QString* getFileName();
     void setFileName(QString* file_name);
 
+    qint32 getFreeRun();
+    void setFreeRun(qint32 free_run);
+
 
     virtual bool isSet() override;
 
@@ -52,6 +55,9 @@ private:
     QString* file_name;
     bool m_file_name_isSet;
 
+    qint32 free_run;
+    bool m_free_run_isSet;
+
 };
 
 }
@@ -32,6 +32,8 @@ SWGSDRdaemonSinkReport::SWGSDRdaemonSinkReport() {
     m_buffer_rw_balance_isSet = false;
     sample_count = 0;
     m_sample_count_isSet = false;
+    nb_fec_blocks = 0;
+    m_nb_fec_blocks_isSet = false;
 }
 
 SWGSDRdaemonSinkReport::~SWGSDRdaemonSinkReport() {
@@ -44,6 +46,8 @@ SWGSDRdaemonSinkReport::init() {
     m_buffer_rw_balance_isSet = false;
     sample_count = 0;
     m_sample_count_isSet = false;
+    nb_fec_blocks = 0;
+    m_nb_fec_blocks_isSet = false;
 }
 
 void
@@ -67,6 +71,8 @@ SWGSDRdaemonSinkReport::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&sample_count, pJson["sampleCount"], "qint32", "");
     
+    ::SWGSDRangel::setValue(&nb_fec_blocks, pJson["nbFECBlocks"], "qint32", "");
+    
 }
 
 QString
@@ -89,6 +95,9 @@ SWGSDRdaemonSinkReport::asJsonObject() {
     if(m_sample_count_isSet){
         obj->insert("sampleCount", QJsonValue(sample_count));
     }
+    if(m_nb_fec_blocks_isSet){
+        obj->insert("nbFECBlocks", QJsonValue(nb_fec_blocks));
+    }
 
     return obj;
 }
@@ -113,6 +122,16 @@ SWGSDRdaemonSinkReport::setSampleCount(qint32 sample_count) {
     this->m_sample_count_isSet = true;
 }
 
+qint32
+SWGSDRdaemonSinkReport::getNbFecBlocks() {
+    return nb_fec_blocks;
+}
+void
+SWGSDRdaemonSinkReport::setNbFecBlocks(qint32 nb_fec_blocks) {
+    this->nb_fec_blocks = nb_fec_blocks;
+    this->m_nb_fec_blocks_isSet = true;
+}
+
 
 bool
 SWGSDRdaemonSinkReport::isSet(){
@@ -120,6 +139,7 @@ SWGSDRdaemonSinkReport::isSet(){
     do{
         if(m_buffer_rw_balance_isSet){ isObjectUpdated = true; break;}
         if(m_sample_count_isSet){ isObjectUpdated = true; break;}
+        if(m_nb_fec_blocks_isSet){ isObjectUpdated = true; break;}
     }while(false);
     return isObjectUpdated;
 }
@@ -47,6 +47,9 @@ public:
     qint32 getSampleCount();
     void setSampleCount(qint32 sample_count);
 
+    qint32 getNbFecBlocks();
+    void setNbFecBlocks(qint32 nb_fec_blocks);
+
 
     virtual bool isSet() override;
 
@@ -57,6 +60,9 @@ private:
     qint32 sample_count;
     bool m_sample_count_isSet;
 
+    qint32 nb_fec_blocks;
+    bool m_nb_fec_blocks_isSet;
+
 };
 
 }
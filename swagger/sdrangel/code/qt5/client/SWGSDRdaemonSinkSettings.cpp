@@ -38,10 +38,20 @@ SWGSDRdaemonSinkSettings::SWGSDRdaemonSinkSettings() {
     m_tx_delay_isSet = false;
     nb_fec_blocks = 0;
     m_nb_fec_blocks_isSet = false;
+    adaptive_fec = 0;
+    m_adaptive_fec_isSet = false;
+    udp_size = 0;
+    m_udp_size_isSet = false;
+    payload_encoding = 0;
+    m_payload_encoding_isSet = false;
     address = nullptr;
     m_address_isSet = false;
     data_port = 0;
     m_data_port_isSet = false;
+    multicast_ttl = 0;
+    m_multicast_ttl_isSet = false;
+    multicast_interface = nullptr;
+    m_multicast_interface_isSet = false;
     control_port = 0;
     m_control_port_isSet = false;
     specific_parameters = nullptr;
@@ -64,10 +74,20 @@ SWGSDRdaemonSinkSettings::init() {
     m_tx_delay_isSet = false;
     nb_fec_blocks = 0;
     m_nb_fec_blocks_isSet = false;
+    adaptive_fec = 0;
+    m_adaptive_fec_isSet = false;
+    udp_size = 0;
+    m_udp_size_isSet = false;
+    payload_encoding = 0;
+    m_payload_encoding_isSet = false;
     address = new QString("");
     m_address_isSet = false;
     data_port = 0;
     m_data_port_isSet = false;
+    multicast_ttl = 0;
+    m_multicast_ttl_isSet = false;
+    multicast_interface = new QString("");
+    m_multicast_interface_isSet = false;
     control_port = 0;
     m_control_port_isSet = false;
     specific_parameters = new QString("");
@@ -86,6 +106,11 @@ SWGSDRdaemonSinkSettings::cleanup() {
     }
 
 
+
+    if(multicast_interface != nullptr) { 
+        delete multicast_interface;
+    }
+
     if(specific_parameters != nullptr) { 
         delete specific_parameters;
     }
@@ -112,10 +137,20 @@ SWGSDRdaemonSinkSettings::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&nb_fec_blocks, pJson["nbFECBlocks"], "qint32", "");
     
+    ::SWGSDRangel::setValue(&adaptive_fec, pJson["adaptiveFEC"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&udp_size, pJson["udpSize"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&payload_encoding, pJson["payloadEncoding"], "qint32", "");
+    
     ::SWGSDRangel::setValue(&address, pJson["address"], "QString", "QString");
     
     ::SWGSDRangel::setValue(&data_port, pJson["dataPort"], "qint32", "");
     
+    ::SWGSDRangel::setValue(&multicast_ttl, pJson["multicastTTL"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&multicast_interface, pJson["multicastInterface"], "QString", "QString");
+    
     ::SWGSDRangel::setValue(&control_port, pJson["controlPort"], "qint32", "");
     
     ::SWGSDRangel::setValue(&specific_parameters, pJson["specificParameters"], "QString", "QString");
@@ -151,12 +186,27 @@ SWGSDRdaemonSinkSettings::asJsonObject() {
     if(m_nb_fec_blocks_isSet){
         obj->insert("nbFECBlocks", QJsonValue(nb_fec_blocks));
     }
+    if(m_adaptive_fec_isSet){
+        obj->insert("adaptiveFEC", QJsonValue(adaptive_fec));
+    }
+    if(m_udp_size_isSet){
+        obj->insert("udpSize", QJsonValue(udp_size));
+    }
+    if(m_payload_encoding_isSet){
+        obj->insert("payloadEncoding", QJsonValue(payload_encoding));
+    }
     if(address != nullptr && *address != QString("")){
         toJsonValue(QString("address"), address, obj, QString("QString"));
     }
     if(m_data_port_isSet){
         obj->insert("dataPort", QJsonValue(data_port));
     }
+    if(m_multicast_ttl_isSet){
+        obj->insert("multicastTTL", QJsonValue(multicast_ttl));
+    }
+    if(multicast_interface != nullptr && *multicast_interface != QString("")){
+        toJsonValue(QString("multicastInterface"), multicast_interface, obj, QString("QString"));
+    }
     if(m_control_port_isSet){
         obj->insert("controlPort", QJsonValue(control_port));
     }
@@ -217,6 +267,36 @@ SWGSDRdaemonSinkSettings::setNbFecBlocks(qint32 nb_fec_blocks) {
     this->m_nb_fec_blocks_isSet = true;
 }
 
+qint32
+SWGSDRdaemonSinkSettings::getAdaptiveFec() {
+    return adaptive_fec;
+}
+void
+SWGSDRdaemonSinkSettings::setAdaptiveFec(qint32 adaptive_fec) {
+    this->adaptive_fec = adaptive_fec;
+    this->m_adaptive_fec_isSet = true;
+}
+
+qint32
+SWGSDRdaemonSinkSettings::getUdpSize() {
+    return udp_size;
+}
+void
+SWGSDRdaemonSinkSettings::setUdpSize(qint32 udp_size) {
+    this->udp_size = udp_size;
+    this->m_udp_size_isSet = true;
+}
+
+qint32
+SWGSDRdaemonSinkSettings::getPayloadEncoding() {
+    return payload_encoding;
+}
+void
+SWGSDRdaemonSinkSettings::setPayloadEncoding(qint32 payload_encoding) {
+    this->payload_encoding = payload_encoding;
+    this->m_payload_encoding_isSet = true;
+}
+
 QString*
 SWGSDRdaemonSinkSettings::getAddress() {
     return address;
@@ -237,6 +317,26 @@ SWGSDRdaemonSinkSettings::setDataPort(qint32 data_port) {
     this->m_data_port_isSet = true;
 }
 
+qint32
+SWGSDRdaemonSinkSettings::getMulticastTtl() {
+    return multicast_ttl;
+}
+void
+SWGSDRdaemonSinkSettings::setMulticastTtl(qint32 multicast_ttl) {
+    this->multicast_ttl = multicast_ttl;
+    this->m_multicast_ttl_isSet = true;
+}
+
+QString*
+SWGSDRdaemonSinkSettings::getMulticastInterface() {
+    return multicast_interface;
+}
+void
+SWGSDRdaemonSinkSettings::setMulticastInterface(QString* multicast_interface) {
+    this->multicast_interface = multicast_interface;
+    this->m_multicast_interface_isSet = true;
+}
+
 qint32
 SWGSDRdaemonSinkSettings::getControlPort() {
     return control_port;
@@ -267,8 +367,13 @@ SWGSDRdaemonSinkSettings::isSet(){
         if(m_log2_interp_isSet){ isObjectUpdated = true; break;}
         if(m_tx_delay_isSet){ isObjectUpdated = true; break;}
         if(m_nb_fec_blocks_isSet){ isObjectUpdated = true; break;}
+        if(m_adaptive_fec_isSet){ isObjectUpdated = true; break;}
+        if(m_udp_size_isSet){ isObjectUpdated = true; break;}
+        if(m_payload_encoding_isSet){ isObjectUpdated = true; break;}
         if(address != nullptr && *address != QString("")){ isObjectUpdated = true; break;}
         if(m_data_port_isSet){ isObjectUpdated = true; break;}
+        if(m_multicast_ttl_isSet){ isObjectUpdated = true; break;}
+        if(multicast_interface != nullptr && *multicast_interface != QString("")){ isObjectUpdated = true; break;}
         if(m_control_port_isSet){ isObjectUpdated = true; break;}
         if(specific_parameters != nullptr && *specific_parameters != QString("")){ isObjectUpdated = true; break;}
     }while(false);
@@ -57,12 +57,27 @@ public:
     qint32 getNbFecBlocks();
     void setNbFecBlocks(qint32 nb_fec_blocks);
 
+    qint32 getAdaptiveFec();
+    void setAdaptiveFec(qint32 adaptive_fec);
+
+    qint32 getUdpSize();
+    void setUdpSize(qint32 udp_size);
+
+    qint32 getPayloadEncoding();
+    void setPayloadEncoding(qint32 payload_encoding);
+
     QString* getAddress();
     void setAddress(QString* address);
 
     qint32 getDataPort();
     void setDataPort(qint32 data_port);
 
+    qint32 getMulticastTtl();
+    void setMulticastTtl(qint32 multicast_ttl);
+
+    QString* getMulticastInterface();
+    void setMulticastInterface(QString* multicast_interface);
+
     qint32 getControlPort();
     void setControlPort(qint32 control_port);
 
@@ -88,12 +103,27 @@ private:
     qint32 nb_fec_blocks;
     bool m_nb_fec_blocks_isSet;
 
+    qint32 adaptive_fec;
+    bool m_adaptive_fec_isSet;
+
+    qint32 udp_size;
+    bool m_udp_size_isSet;
+
+    qint32 payload_encoding;
+    bool m_payload_encoding_isSet;
+
     QString* address;
     bool m_address_isSet;
 
     qint32 data_port;
     bool m_data_port_isSet;
 
+    qint32 multicast_ttl;
+    bool m_multicast_ttl_isSet;
+
+    QString* multicast_interface;
+    bool m_multicast_interface_isSet;
+
     qint32 control_port;
     bool m_control_port_isSet;
 
@@ -0,0 +1,318 @@
+/**
+ * SDRangel
+ * This is the web REST/JSON API of SDRangel SDR software. SDRangel is an Open Source Qt5/OpenGL 3.0+ (4.3+ in Windows) GUI and server Software Defined Radio and signal analyzer in software. It supports Airspy, BladeRF, HackRF, LimeSDR, PlutoSDR, RTL-SDR, SDRplay RSP1 and FunCube     ---   Limitations and specifcities:       * In SDRangel GUI the first Rx device set cannot be deleted. Conversely the server starts with no device sets and its number of device sets can be reduced to zero by as many calls as necessary to /sdrangel/deviceset with DELETE method.   * Preset import and export from/to file is a server only feature.   * Device set focus is a GUI only feature.   * The following channels are not implemented (status 501 is returned): ATV and DATV demodulators, Channel Analyzer NG, LoRa demodulator   * The device settings and report structures contains only the sub-structure corresponding to the device type. The DeviceSettings and DeviceReport structures documented here shows all of them but only one will be or should be present at a time   * The channel settings and report structures contains only the sub-structure corresponding to the channel type. The ChannelSettings and ChannelReport structures documented here shows all of them but only one will be or should be present at a time    --- 
+ *
+ * OpenAPI spec version: 4.0.6
+ * Contact: f4exb06@gmail.com
+ *
+ * NOTE: This class is auto generated by the swagger code generator program.
+ * https://github.com/swagger-api/swagger-codegen.git
+ * Do not edit the class manually.
+ */
+
+
+#include "SWGSpectrumSettings.h"
+
+#include "SWGHelpers.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QObject>
+#include <QDebug>
+
+namespace SWGSDRangel {
+
+SWGSpectrumSettings::SWGSpectrumSettings(QString* json) {
+    init();
+    this->fromJson(*json);
+}
+
+SWGSpectrumSettings::SWGSpectrumSettings() {
+    fft_size = 0;
+    m_fft_size_isSet = false;
+    overlap_percent = 0;
+    m_overlap_percent_isSet = false;
+    fft_window = 0;
+    m_fft_window_isSet = false;
+    averaging_mode = 0;
+    m_averaging_mode_isSet = false;
+    averaging_nb = 0;
+    m_averaging_nb_isSet = false;
+    linear = 0;
+    m_linear_isSet = false;
+    integration_time = 0.0f;
+    m_integration_time_isSet = false;
+    snapshot_period = 0.0f;
+    m_snapshot_period_isSet = false;
+    snapshot_file_name = nullptr;
+    m_snapshot_file_name_isSet = false;
+    zoom_log2_decim = 0;
+    m_zoom_log2_decim_isSet = false;
+    zoom_frequency_offset = 0L;
+    m_zoom_frequency_offset_isSet = false;
+}
+
+SWGSpectrumSettings::~SWGSpectrumSettings() {
+    this->cleanup();
+}
+
+void
+SWGSpectrumSettings::init() {
+    fft_size = 0;
+    m_fft_size_isSet = false;
+    overlap_percent = 0;
+    m_overlap_percent_isSet = false;
+    fft_window = 0;
+    m_fft_window_isSet = false;
+    averaging_mode = 0;
+    m_averaging_mode_isSet = false;
+    averaging_nb = 0;
+    m_averaging_nb_isSet = false;
+    linear = 0;
+    m_linear_isSet = false;
+    integration_time = 0.0f;
+    m_integration_time_isSet = false;
+    snapshot_period = 0.0f;
+    m_snapshot_period_isSet = false;
+    snapshot_file_name = new QString("");
+    m_snapshot_file_name_isSet = false;
+    zoom_log2_decim = 0;
+    m_zoom_log2_decim_isSet = false;
+    zoom_frequency_offset = 0L;
+    m_zoom_frequency_offset_isSet = false;
+}
+
+void
+SWGSpectrumSettings::cleanup() {
+
+
+
+
+
+
+
+
+    if(snapshot_file_name != nullptr) { 
+        delete snapshot_file_name;
+    }
+
+
+}
+
+SWGSpectrumSettings*
+SWGSpectrumSettings::fromJson(QString &json) {
+    QByteArray array (json.toStdString().c_str());
+    QJsonDocument doc = QJsonDocument::fromJson(array);
+    QJsonObject jsonObject = doc.object();
+    this->fromJsonObject(jsonObject);
+    return this;
+}
+
+void
+SWGSpectrumSettings::fromJsonObject(QJsonObject &pJson) {
+    ::SWGSDRangel::setValue(&fft_size, pJson["fftSize"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&overlap_percent, pJson["overlapPercent"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&fft_window, pJson["fftWindow"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&averaging_mode, pJson["averagingMode"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&averaging_nb, pJson["averagingNb"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&linear, pJson["linear"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&integration_time, pJson["integrationTime"], "float", "");
+    
+    ::SWGSDRangel::setValue(&snapshot_period, pJson["snapshotPeriod"], "float", "");
+    
+    ::SWGSDRangel::setValue(&snapshot_file_name, pJson["snapshotFileName"], "QString", "QString");
+    
+    ::SWGSDRangel::setValue(&zoom_log2_decim, pJson["zoomLog2Decim"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&zoom_frequency_offset, pJson["zoomFrequencyOffset"], "qint64", "");
+    
+}
+
+QString
+SWGSpectrumSettings::asJson ()
+{
+    QJsonObject* obj = this->asJsonObject();
+
+    QJsonDocument doc(*obj);
+    QByteArray bytes = doc.toJson();
+    delete obj;
+    return QString(bytes);
+}
+
+QJsonObject*
+SWGSpectrumSettings::asJsonObject() {
+    QJsonObject* obj = new QJsonObject();
+    if(m_fft_size_isSet){
+        obj->insert("fftSize", QJsonValue(fft_size));
+    }
+    if(m_overlap_percent_isSet){
+        obj->insert("overlapPercent", QJsonValue(overlap_percent));
+    }
+    if(m_fft_window_isSet){
+        obj->insert("fftWindow", QJsonValue(fft_window));
+    }
+    if(m_averaging_mode_isSet){
+        obj->insert("averagingMode", QJsonValue(averaging_mode));
+    }
+    if(m_averaging_nb_isSet){
+        obj->insert("averagingNb", QJsonValue(averaging_nb));
+    }
+    if(m_linear_isSet){
+        obj->insert("linear", QJsonValue(linear));
+    }
+    if(m_integration_time_isSet){
+        obj->insert("integrationTime", QJsonValue(integration_time));
+    }
+    if(m_snapshot_period_isSet){
+        obj->insert("snapshotPeriod", QJsonValue(snapshot_period));
+    }
+    if(snapshot_file_name != nullptr && *snapshot_file_name != QString("")){
+        toJsonValue(QString("snapshotFileName"), snapshot_file_name, obj, QString("QString"));
+    }
+    if(m_zoom_log2_decim_isSet){
+        obj->insert("zoomLog2Decim", QJsonValue(zoom_log2_decim));
+    }
+    if(m_zoom_frequency_offset_isSet){
+        obj->insert("zoomFrequencyOffset", QJsonValue(zoom_frequency_offset));
+    }
+
+    return obj;
+}
+
+qint32
+SWGSpectrumSettings::getFftSize() {
+    return fft_size;
+}
+void
+SWGSpectrumSettings::setFftSize(qint32 fft_size) {
+    this->fft_size = fft_size;
+    this->m_fft_size_isSet = true;
+}
+
+qint32
+SWGSpectrumSettings::getOverlapPercent() {
+    return overlap_percent;
+}
+void
+SWGSpectrumSettings::setOverlapPercent(qint32 overlap_percent) {
+    this->overlap_percent = overlap_percent;
+    this->m_overlap_percent_isSet = true;
+}
+
+qint32
+SWGSpectrumSettings::getFftWindow() {
+    return fft_window;
+}
+void
+SWGSpectrumSettings::setFftWindow(qint32 fft_window) {
+    this->fft_window = fft_window;
+    this->m_fft_window_isSet = true;
+}
+
+qint32
+SWGSpectrumSettings::getAveragingMode() {
+    return averaging_mode;
+}
+void
+SWGSpectrumSettings::setAveragingMode(qint32 averaging_mode) {
+    this->averaging_mode = averaging_mode;
+    this->m_averaging_mode_isSet = true;
+}
+
+qint32
+SWGSpectrumSettings::getAveragingNb() {
+    return averaging_nb;
+}
+void
+SWGSpectrumSettings::setAveragingNb(qint32 averaging_nb) {
+    this->averaging_nb = averaging_nb;
+    this->m_averaging_nb_isSet = true;
+}
+
+qint32
+SWGSpectrumSettings::getLinear() {
+    return linear;
+}
+void
+SWGSpectrumSettings::setLinear(qint32 linear) {
+    this->linear = linear;
+    this->m_linear_isSet = true;
+}
+
+float
+SWGSpectrumSettings::getIntegrationTime() {
+    return integration_time;
+}
+void
+SWGSpectrumSettings::setIntegrationTime(float integration_time) {
+    this->integration_time = integration_time;
+    this->m_integration_time_isSet = true;
+}
+
+float
+SWGSpectrumSettings::getSnapshotPeriod() {
+    return snapshot_period;
+}
+void
+SWGSpectrumSettings::setSnapshotPeriod(float snapshot_period) {
+    this->snapshot_period = snapshot_period;
+    this->m_snapshot_period_isSet = true;
+}
+
+QString*
+SWGSpectrumSettings::getSnapshotFileName() {
+    return snapshot_file_name;
+}
+void
+SWGSpectrumSettings::setSnapshotFileName(QString* snapshot_file_name) {
+    this->snapshot_file_name = snapshot_file_name;
+    this->m_snapshot_file_name_isSet = true;
+}
+
+qint32
+SWGSpectrumSettings::getZoomLog2Decim() {
+    return zoom_log2_decim;
+}
+void
+SWGSpectrumSettings::setZoomLog2Decim(qint32 zoom_log2_decim) {
+    this->zoom_log2_decim = zoom_log2_decim;
+    this->m_zoom_log2_decim_isSet = true;
+}
+
+qint64
+SWGSpectrumSettings::getZoomFrequencyOffset() {
+    return zoom_frequency_offset;
+}
+void
+SWGSpectrumSettings::setZoomFrequencyOffset(qint64 zoom_frequency_offset) {
+    this->zoom_frequency_offset = zoom_frequency_offset;
+    this->m_zoom_frequency_offset_isSet = true;
+}
+
+
+bool
+SWGSpectrumSettings::isSet(){
+    bool isObjectUpdated = false;
+    do{
+        if(m_fft_size_isSet){ isObjectUpdated = true; break;}
+        if(m_overlap_percent_isSet){ isObjectUpdated = true; break;}
+        if(m_fft_window_isSet){ isObjectUpdated = true; break;}
+        if(m_averaging_mode_isSet){ isObjectUpdated = true; break;}
+        if(m_averaging_nb_isSet){ isObjectUpdated = true; break;}
+        if(m_linear_isSet){ isObjectUpdated = true; break;}
+        if(m_integration_time_isSet){ isObjectUpdated = true; break;}
+        if(m_snapshot_period_isSet){ isObjectUpdated = true; break;}
+        if(snapshot_file_name != nullptr && *snapshot_file_name != QString("")){ isObjectUpdated = true; break;}
+        if(m_zoom_log2_decim_isSet){ isObjectUpdated = true; break;}
+        if(m_zoom_frequency_offset_isSet){ isObjectUpdated = true; break;}
+    }while(false);
+    return isObjectUpdated;
+}
+}
+
@@ -0,0 +1,119 @@
+/**
+ * SDRangel
+ * This is the web REST/JSON API of SDRangel SDR software. SDRangel is an Open Source Qt5/OpenGL 3.0+ (4.3+ in Windows) GUI and server Software Defined Radio and signal analyzer in software. It supports Airspy, BladeRF, HackRF, LimeSDR, PlutoSDR, RTL-SDR, SDRplay RSP1 and FunCube     ---   Limitations and specifcities:       * In SDRangel GUI the first Rx device set cannot be deleted. Conversely the server starts with no device sets and its number of device sets can be reduced to zero by as many calls as necessary to /sdrangel/deviceset with DELETE method.   * Preset import and export from/to file is a server only feature.   * Device set focus is a GUI only feature.   * The following channels are not implemented (status 501 is returned): ATV and DATV demodulators, Channel Analyzer NG, LoRa demodulator   * The device settings and report structures contains only the sub-structure corresponding to the device type. The DeviceSettings and DeviceReport structures documented here shows all of them but only one will be or should be present at a time   * The channel settings and report structures contains only the sub-structure corresponding to the channel type. The ChannelSettings and ChannelReport structures documented here shows all of them but only one will be or should be present at a time    --- 
+ *
+ * OpenAPI spec version: 4.0.6
+ * Contact: f4exb06@gmail.com
+ *
+ * NOTE: This class is auto generated by the swagger code generator program.
+ * https://github.com/swagger-api/swagger-codegen.git
+ * Do not edit the class manually.
+ */
+
+/*
+ * SWGSpectrumSettings.h
+ *
+ * Headless spectrum engine settings
+ */
+
+#ifndef SWGSpectrumSettings_H_
+#define SWGSpectrumSettings_H_
+
+#include <QJsonObject>
+
+
+#include <QString>
+
+#include "SWGObject.h"
+#include "export.h"
+
+namespace SWGSDRangel {
+
+class SWG_API SWGSpectrumSettings: public SWGObject {
+public:
+    SWGSpectrumSettings();
+    SWGSpectrumSettings(QString* json);
+    virtual ~SWGSpectrumSettings();
+    void init();
+    void cleanup();
+
+    virtual QString asJson () override;
+    virtual QJsonObject* asJsonObject() override;
+    virtual void fromJsonObject(QJsonObject &json) override;
+    virtual SWGSpectrumSettings* fromJson(QString &jsonString) override;
+
+    qint32 getFftSize();
+    void setFftSize(qint32 fft_size);
+
+    qint32 getOverlapPercent();
+    void setOverlapPercent(qint32 overlap_percent);
+
+    qint32 getFftWindow();
+    void setFftWindow(qint32 fft_window);
+
+    qint32 getAveragingMode();
+    void setAveragingMode(qint32 averaging_mode);
+
+    qint32 getAveragingNb();
+    void setAveragingNb(qint32 averaging_nb);
+
+    qint32 getLinear();
+    void setLinear(qint32 linear);
+
+    float getIntegrationTime();
+    void setIntegrationTime(float integration_time);
+
+    float getSnapshotPeriod();
+    void setSnapshotPeriod(float snapshot_period);
+
+    QString* getSnapshotFileName();
+    void setSnapshotFileName(QString* snapshot_file_name);
+
+    qint32 getZoomLog2Decim();
+    void setZoomLog2Decim(qint32 zoom_log2_decim);
+
+    qint64 getZoomFrequencyOffset();
+    void setZoomFrequencyOffset(qint64 zoom_frequency_offset);
+
+
+    virtual bool isSet() override;
+
+private:
+    qint32 fft_size;
+    bool m_fft_size_isSet;
+
+    qint32 overlap_percent;
+    bool m_overlap_percent_isSet;
+
+    qint32 fft_window;
+    bool m_fft_window_isSet;
+
+    qint32 averaging_mode;
+    bool m_averaging_mode_isSet;
+
+    qint32 averaging_nb;
+    bool m_averaging_nb_isSet;
+
+    qint32 linear;
+    bool m_linear_isSet;
+
+    float integration_time;
+    bool m_integration_time_isSet;
+
+    float snapshot_period;
+    bool m_snapshot_period_isSet;
+
+    QString* snapshot_file_name;
+    bool m_snapshot_file_name_isSet;
+
+    qint32 zoom_log2_decim;
+    bool m_zoom_log2_decim_isSet;
+
+    qint64 zoom_frequency_offset;
+    bool m_zoom_frequency_offset_isSet;
+
+};
+
+}
+
+#endif /* SWGSpectrumSettings_H_ */